@@ -5,9 +5,230 @@
 
 #include "I2C_Interface.h" 
 #include "I2C_Master.h"
+#include "SSD1306_Stats.h"
+#include "SSD1306_Trace.h"
+#include "string.h"
 
 static uint8_t i2c_started = 0;
 
+// Staging buffer and state of asynchronous writes
+static uint8_t async_buffer[I2C_ASYNC_BUFFER_SIZE];
+static uint16_t async_count = 0;
+static uint8_t async_address = 0;
+static uint8_t async_pending = 0;
+static uint8_t async_result = I2C_NO_ERROR;
+static uint32_t async_start = 0;
+
+// Timeout, retry and recovery policy
+static I2C_Clock timeout_clock = NULL;
+static uint32_t timeout_ticks = 0;
+static uint8_t max_retries = 0;
+static I2C_RecoveryHook recovery = NULL;
+
+// Data bytes acknowledged by the last blocking write, and whether more may have been
+static uint16_t write_count = 0;
+static uint8_t write_uncertain = 0;
+
+#if I2C_FAULT_INJECTION
+    static I2C_FaultHook fault_hook = NULL;
+    static void *fault_context = NULL;
+#endif
+
+/**
+*   \brief Account a completed write transaction and return its result.
+*
+*   Updates statistics and traffic recorder, when enabled.
+*/
+static uint8_t I2C_Peripheral_WriteDone(uint8_t site, uint8_t device_address,
+                                        uint8_t register_address, const uint8_t* data,
+                                        uint16_t block_size, uint16_t block_count,
+                                        uint16_t stride, uint8_t result)
+{
+    // Unused when statistics and traffic recorder are disabled
+    (void)site;
+    (void)device_address;
+    (void)register_address;
+    (void)data;
+    (void)block_size;
+    (void)block_count;
+    (void)stride;
+    SSD1306_TRACE_WRITE(device_address, register_address, data,
+                            block_size, block_count, stride, result);
+    return SSD1306_STATS_BUS(site, result == I2C_NO_ERROR ? block_size * block_count : 0, result);
+}
+
+/**
+*   \brief Send a write transaction byte by byte.
+*
+*   Waits on each byte as the I2C component does. Sets write_count and
+*   write_uncertain.
+*   \param[in] len number of data bytes to send, at most block_size * block_count.
+*/
+static uint8_t I2C_Peripheral_WriteBytes(uint8_t device_address, uint8_t register_address,
+                                        uint16_t block_size, uint16_t stride,
+                                        const uint8_t* data, uint16_t len)
+{
+    uint16_t col = 0;
+    
+    write_count = 0;
+    write_uncertain = 0;
+    // Send start condition and register address
+    uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
+    if (error == I2C_Master_MSTR_NO_ERROR)
+    {
+        error = I2C_Master_MasterWriteByte(register_address);
+    }
+    if (error != I2C_Master_MSTR_NO_ERROR)
+    {
+        I2C_Master_MasterSendStop();
+        return I2C_DEV_NOT_FOUND;
+    }
+    // Write one block after the other
+    while (write_count < len)
+    {
+        error = I2C_Master_MasterWriteByte(data[col]);
+        if (error != I2C_Master_MSTR_NO_ERROR)
+        {
+            // The byte may have been received even if not acknowledged
+            write_uncertain = 1;
+            I2C_Master_MasterSendStop();
+            return I2C_ERROR;
+        }
+        write_count++;
+        if (++col == block_size)
+        {
+            col = 0;
+            data += stride;
+        }
+    }
+    I2C_Master_MasterSendStop();
+    return I2C_NO_ERROR;
+}
+
+/**
+*   \brief Send a write transaction through the staging buffer, with a timeout.
+*
+*   Data are split in transactions of at most #I2C_ASYNC_BUFFER_SIZE - 1
+*   bytes. Only whole transactions are counted in write_count; when a
+*   transaction fails after its address was acknowledged, write_uncertain is set.
+*   \param[in] len number of data bytes to send, at most block_size * block_count.
+*/
+static uint8_t I2C_Peripheral_WriteTimed(uint8_t device_address, uint8_t register_address,
+                                        uint16_t block_size, uint16_t stride,
+                                        const uint8_t* data, uint16_t len)
+{
+    uint16_t col = 0;
+    
+    write_count = 0;
+    write_uncertain = 0;
+    do
+    {
+        uint16_t n = 0;
+        uint32_t start;
+        uint8_t status;
+        
+        // Gather the next chunk of the strided blocks
+        async_buffer[0] = register_address;
+        while ((n < I2C_ASYNC_BUFFER_SIZE - 1) && (write_count + n < len))
+        {
+            async_buffer[1 + n++] = data[col];
+            if (++col == block_size)
+            {
+                col = 0;
+                data += stride;
+            }
+        }
+        
+        I2C_Master_MasterClearStatus();
+        if (I2C_Master_MasterWriteBuf(device_address, async_buffer, n + 1,
+                                        I2C_Master_MODE_COMPLETE_XFER) != I2C_Master_MSTR_NO_ERROR)
+        {
+            // Bus not acquired: nothing was sent
+            return I2C_ERROR;
+        }
+        start = timeout_clock();
+        while (((status = I2C_Master_MasterStatus()) & I2C_Master_MSTAT_WR_CMPLT) == 0)
+        {
+            if (timeout_clock() - start > timeout_ticks)
+            {
+                write_uncertain = 1;
+                I2C_Peripheral_Recover();
+                return I2C_TIMEOUT;
+            }
+        }
+        I2C_Master_MasterClearStatus();
+        if (status & I2C_Master_MSTAT_ERR_ADDR_NAK)
+        {
+            return I2C_DEV_NOT_FOUND;
+        }
+        if (status & I2C_Master_MSTAT_ERR_XFER)
+        {
+            write_uncertain = 1;
+            return I2C_ERROR;
+        }
+        write_count += n;
+    } while (write_count < len);
+    return I2C_NO_ERROR;
+}
+
+/**
+*   \brief Write strided blocks, retrying while no data reached the device.
+*
+*   Common implementation of the blocking write functions.
+*/
+static uint8_t I2C_Peripheral_Write(uint8_t site, uint8_t device_address,
+                                    uint8_t register_address, uint16_t block_size,
+                                    uint16_t block_count, uint16_t stride,
+                                    const uint8_t* data)
+{
+    uint16_t len = block_size * block_count;
+    uint8_t attempt = 0;
+    uint8_t result;
+    
+    do
+    {
+        uint16_t sent = len;
+        uint8_t fault = I2C_NO_ERROR;
+        
+        #if I2C_FAULT_INJECTION
+            if (fault_hook != NULL)
+            {
+                fault = fault_hook(device_address, register_address, len, &sent, fault_context);
+                if ((fault == I2C_NO_ERROR) || (sent > len))
+                {
+                    sent = len;
+                }
+            }
+        #endif
+        
+        if (fault == I2C_DEV_NOT_FOUND)
+        {
+            write_count = 0;
+            write_uncertain = 0;
+            result = I2C_DEV_NOT_FOUND;
+        }
+        else
+        {
+            result = (timeout_clock != NULL)
+                ? I2C_Peripheral_WriteTimed(device_address, register_address, block_size, stride, data, sent)
+                : I2C_Peripheral_WriteBytes(device_address, register_address, block_size, stride, data, sent);
+            if ((result == I2C_NO_ERROR) && (fault != I2C_NO_ERROR))
+            {
+                result = fault;
+                write_uncertain = 1;
+                if (fault == I2C_TIMEOUT)
+                {
+                    I2C_Peripheral_Recover();
+                }
+            }
+        }
+        result = I2C_Peripheral_WriteDone(site, device_address, register_address, data,
+                                            block_size, block_count, stride, result);
+    } while ((result != I2C_NO_ERROR) && (write_count == 0) && !write_uncertain &&
+                (attempt++ < max_retries));
+    return result;
+}
+
 // Start I2C
 uint8_t I2C_Peripheral_Start(void) 
 {
@@ -31,6 +252,53 @@ uint8_t I2C_Peripheral_Stop(void)
     return I2C_NO_ERROR;
 }
 
+//==========================================
+//         BOUNDED LATENCY POLICY
+//==========================================
+
+void I2C_Peripheral_SetTimeout(I2C_Clock clock, uint32_t ticks)
+{
+    timeout_clock = clock;
+    timeout_ticks = ticks;
+}
+
+void I2C_Peripheral_SetRetries(uint8_t retries)
+{
+    max_retries = retries;
+}
+
+void I2C_Peripheral_SetRecovery(I2C_RecoveryHook hook)
+{
+    recovery = hook;
+}
+
+void I2C_Peripheral_Recover(void)
+{
+    I2C_Master_Stop();
+    if (recovery != NULL)
+    {
+        recovery();
+    }
+    if (i2c_started)
+    {
+        I2C_Master_Start();
+    }
+    async_pending = 0;
+}
+
+uint16_t I2C_Peripheral_GetWriteCount(void)
+{
+    return write_count;
+}
+
+#if I2C_FAULT_INJECTION
+    void I2C_Peripheral_SetFaultHook(I2C_FaultHook hook, void *context)
+    {
+        fault_hook = hook;
+        fault_context = context;
+    }
+#endif
+
 //==========================================
 //           READING FUNCTIONS
 //==========================================
@@ -55,14 +323,14 @@ uint8_t I2C_Peripheral_ReadRegister(uint8_t device_address,
                 *data = I2C_Master_MasterReadByte(I2C_Master_ACK_DATA);
                 // Send stop condition and return no error
                 I2C_Master_MasterSendStop();
-                return I2C_NO_ERROR;
+                return SSD1306_STATS_BUS(SSD1306_STATS_BUS_READ, 1, I2C_NO_ERROR);
             }
         }
     }
     // Send stop condition 
     I2C_Master_MasterSendStop();
     // Return error code
-    return I2C_DEV_NOT_FOUND;
+    return SSD1306_STATS_BUS(SSD1306_STATS_BUS_READ, 0, I2C_DEV_NOT_FOUND);
 }
 
 // Read multiple registers without delay
@@ -95,14 +363,14 @@ uint8_t I2C_Peripheral_ReadRegisterMulti(uint8_t device_address,
                 data[register_count-1] = I2C_Master_MasterReadByte(I2C_Master_NAK_DATA);
                 // Send stop condition and return no error
                 I2C_Master_MasterSendStop();
-                return I2C_NO_ERROR;
+                return SSD1306_STATS_BUS(SSD1306_STATS_BUS_READ, register_count, I2C_NO_ERROR);
             }
         }
     }
     // Send stop condition
     I2C_Master_MasterSendStop();
     // Return error code
-    return I2C_DEV_NOT_FOUND;
+    return SSD1306_STATS_BUS(SSD1306_STATS_BUS_READ, 0, I2C_DEV_NOT_FOUND);
 }
     
 // Read mutiple registers without writing the address of the first
@@ -126,12 +394,12 @@ uint8_t I2C_Peripheral_ReadRegisterMultiNoAddress(uint8_t device_address,
         data[register_count-1] = I2C_Master_MasterReadByte(I2C_Master_NAK_DATA);
         // Send stop condition and return no error
         I2C_Master_MasterSendStop();
-        return I2C_NO_ERROR;
+        return SSD1306_STATS_BUS(SSD1306_STATS_BUS_READ, register_count, I2C_NO_ERROR);
     }
     // Send stop condition
     I2C_Master_MasterSendStop();
     // Return error code
-    return I2C_ERROR;
+    return SSD1306_STATS_BUS(SSD1306_STATS_BUS_READ, 0, I2C_ERROR);
 }
 
 //==========================================
@@ -143,53 +411,16 @@ uint8_t I2C_Peripheral_WriteRegister(uint8_t device_address,
                                         uint8_t register_address,
                                         uint8_t data)
 {
-    // Send start condition
-    uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
-    if (error == I2C_Master_MSTR_NO_ERROR)
-    {
-        // Write register address
-        error = I2C_Master_MasterWriteByte(register_address);
-        if (error == I2C_Master_MSTR_NO_ERROR)
-        {
-            // Write byte of interest
-            error = I2C_Master_MasterWriteByte(data);
-            if (error == I2C_Master_MSTR_NO_ERROR)
-            {
-                // Send stop condition
-                I2C_Master_MasterSendStop();
-                // Return with no error
-                return I2C_NO_ERROR;
-            }
-        }
-    }
-    // Send stop condition 
-    I2C_Master_MasterSendStop();
-    // Return error code
-    return I2C_DEV_NOT_FOUND;
+    return I2C_Peripheral_Write(SSD1306_STATS_BUS_WRITE, device_address,
+                                register_address, 1, 1, 0, &data);
 }
 
 // Write a single register address without any data
 uint8_t I2C_Peripheral_WriteRegisterNoData(uint8_t device_address,
                                         uint8_t register_address)
 {
-    // Send start condition
-    uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
-    if (error == I2C_Master_MSTR_NO_ERROR)
-    {
-        // Write register address
-        error = I2C_Master_MasterWriteByte(register_address);
-        if (error == I2C_Master_MSTR_NO_ERROR)
-        {
-            // Send stop condition
-            I2C_Master_MasterSendStop();
-            // Return with no error
-            return I2C_NO_ERROR; 
-        }
-    }
-    // Send stop condition
-    I2C_Master_MasterSendStop();
-    // Return error code
-    return I2C_DEV_NOT_FOUND;
+    return I2C_Peripheral_Write(SSD1306_STATS_BUS_WRITE_NO_DATA, device_address,
+                                register_address, 0, 1, 0, NULL);
 }
 
 // Write multiple registers
@@ -198,56 +429,119 @@ uint8_t I2C_Peripheral_WriteRegisterMulti(uint8_t device_address,
                                         uint16_t register_count,
                                         const uint8_t* data)
 {
-    // Send start condition
-    uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
-    if (error == I2C_Master_MSTR_NO_ERROR)
+    return I2C_Peripheral_Write(SSD1306_STATS_BUS_WRITE_MULTI, device_address,
+                                register_address, register_count, 1, 0, data);
+}
+
+// Write multiple strided blocks in a single transaction
+uint8_t I2C_Peripheral_WriteRegisterMultiStrided(uint8_t device_address,
+                                        uint8_t register_address,
+                                        uint16_t block_size,
+                                        uint16_t block_count,
+                                        uint16_t stride,
+                                        const uint8_t* data)
+{
+    return I2C_Peripheral_Write(SSD1306_STATS_BUS_WRITE_STRIDED, device_address,
+                                register_address, block_size, block_count, stride, data);
+}
+
+//==========================================
+//        ASYNCHRONOUS FUNCTIONS
+//==========================================
+
+// Start an asynchronous write
+uint8_t I2C_Peripheral_WriteRegisterMultiAsync(uint8_t device_address,
+                                        uint8_t register_address,
+                                        uint16_t register_count,
+                                        const uint8_t* data)
+{
+    if (I2C_Peripheral_IsBusy() == I2C_BUSY)
     {
-        // Write register address
-        error = I2C_Master_MasterWriteByte(register_address);
-        if (error == I2C_Master_MSTR_NO_ERROR)
+        return I2C_BUSY;
+    }
+    if (register_count >= I2C_ASYNC_BUFFER_SIZE)
+    {
+        return I2C_ERROR;
+    }
+    // Copy data so that the caller can reuse its buffer
+    async_buffer[0] = register_address;
+    memcpy(&async_buffer[1], data, register_count);
+    async_count = register_count;
+    async_address = device_address;
+    
+    #if I2C_FAULT_INJECTION
+        if (fault_hook != NULL)
         {
-            // Continue writing until we have data to write
-            uint16_t counter = register_count;
-            while(counter > 0)
+            uint16_t sent = register_count;
+            uint8_t fault = fault_hook(device_address, register_address, register_count,
+                                        &sent, fault_context);
+            if (fault != I2C_NO_ERROR)
             {
-                error = I2C_Master_MasterWriteByte(data[register_count-counter]);
-                if (error != I2C_Master_MSTR_NO_ERROR)
-                {
-                    // Send stop condition
-                    I2C_Master_MasterSendStop();
-                    // Return error code
-                    return I2C_ERROR;
-                }
-                counter--;
+                // The transfer completes at once with the injected error
+                async_result = I2C_Peripheral_WriteDone(SSD1306_STATS_BUS_WRITE_ASYNC,
+                            device_address, register_address, &async_buffer[1], register_count, 1, 0, fault);
+                return I2C_NO_ERROR;
             }
-            // Send stop condition and return no error
-            I2C_Master_MasterSendStop();
-            return I2C_NO_ERROR;
         }
+    #endif
+    
+    I2C_Master_MasterClearStatus();
+    uint8_t error = I2C_Master_MasterWriteBuf(device_address, async_buffer,
+                                    register_count + 1, I2C_Master_MODE_COMPLETE_XFER);
+    if (error != I2C_Master_MSTR_NO_ERROR)
+    {
+        return SSD1306_STATS_BUS(SSD1306_STATS_BUS_WRITE_ASYNC, 0, I2C_ERROR);
     }
-    // Send stop condition
-    I2C_Master_MasterSendStop();
-    // Return error code
-    return I2C_DEV_NOT_FOUND;
+    async_start = (timeout_clock != NULL) ? timeout_clock() : 0;
+    async_pending = 1;
+    return I2C_NO_ERROR;
+}
+
+// Check status of asynchronous write
+uint8_t I2C_Peripheral_IsBusy(void)
+{
+    if (async_pending)
+    {
+        uint8_t status = I2C_Master_MasterStatus();
+        if ((status & I2C_Master_MSTAT_WR_CMPLT) == 0)
+        {
+            if ((timeout_clock == NULL) || (timeout_clock() - async_start <= timeout_ticks))
+            {
+                return I2C_BUSY;
+            }
+            // Abandon the transfer and free the bus
+            I2C_Peripheral_Recover();
+            async_result = I2C_Peripheral_WriteDone(SSD1306_STATS_BUS_WRITE_ASYNC,
+                        async_address, async_buffer[0], &async_buffer[1], async_count, 1, 0, I2C_TIMEOUT);
+            return async_result;
+        }
+        async_pending = 0;
+        I2C_Master_MasterClearStatus();
+        async_result = I2C_Peripheral_WriteDone(SSD1306_STATS_BUS_WRITE_ASYNC,
+                    async_address, async_buffer[0], &async_buffer[1], async_count, 1, 0,
+                    (status & I2C_Master_MSTAT_ERR_XFER) ? I2C_ERROR : I2C_NO_ERROR);
+    }
+    return async_result;
 }
 
 // Check if a device is connected
 uint8_t I2C_Peripheral_IsDeviceConnected(uint8_t device_address)
 {
     // Send a start condition followed by a stop condition
-    uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_READ_XFER_MODE);
+    uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
     
-    // If no error generated during stop, device is connected
+    // Always release the bus, whether the address was acknowledged or not
+    I2C_Master_MasterSendStop();
+    
+    // If no error generated during start, device is connected
     if (error == I2C_Master_MSTR_NO_ERROR)
     {
-        
-        return I2C_NO_ERROR;
+        return SSD1306_STATS_BUS(SSD1306_STATS_BUS_PROBE, 0, I2C_NO_ERROR);
     }
     else
     {
-        return I2C_DEV_NOT_FOUND;
+        return SSD1306_STATS_BUS(SSD1306_STATS_BUS_PROBE, 0, I2C_DEV_NOT_FOUND);
     }
-    I2C_Master_MasterSendStop();
 }
 
 /* [] END OF FILE */
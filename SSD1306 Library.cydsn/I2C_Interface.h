@@ -30,6 +30,58 @@
     **/
     #define I2C_DEV_NOT_FOUND 2
     
+    /** 
+    *   \brief Asynchronous transfer still in progress.
+    **/
+    #define I2C_BUSY 3
+    
+    /** 
+    *   \brief Transfer did not complete within the timeout.
+    **/
+    #define I2C_TIMEOUT 4
+    
+    #ifndef I2C_FAULT_INJECTION
+        /** 
+        *   \brief Set to 1 to compile the fault injection hook.
+        **/
+        #define I2C_FAULT_INJECTION 0
+    #endif
+    
+    #ifndef I2C_ASYNC_BUFFER_SIZE
+        /** 
+        *   \brief Size of the staging buffer used for asynchronous writes.
+        *
+        *   It must hold the register address plus the data bytes of
+        *   the largest asynchronous write (one display page by default).
+        **/
+        #define I2C_ASYNC_BUFFER_SIZE 129
+    #endif
+    
+    /** 
+    *   \brief Free-running counter used to measure timeouts.
+    **/
+    typedef uint32_t (*I2C_Clock)(void);
+    
+    /** 
+    *   \brief Board specific function freeing a stuck bus.
+    *
+    *   It is called with the I2C peripheral stopped. It should drive the
+    *   SCL pin as a GPIO, clock it up to nine times until the slave releases
+    *   SDA, and then generate a STOP condition (SDA rising while SCL is high).
+    **/
+    typedef void (*I2C_RecoveryHook)(void);
+    
+    /** 
+    *   \brief Fault injection hook, called before each write attempt.
+    *
+    *   Return #I2C_NO_ERROR to carry out the write normally. Any other code
+    *   makes the write fail with that code, after only the first *acked data
+    *   bytes (initially len) were sent to the bus. #I2C_DEV_NOT_FOUND sends
+    *   nothing, #I2C_TIMEOUT also runs the bus recovery.
+    **/
+    typedef uint8_t (*I2C_FaultHook)(uint8_t device_address, uint8_t register_address,
+                                        uint16_t len, uint16_t *acked, void *context);
+    
     
     /** \brief Start the I2C peripheral.
     *   
@@ -47,6 +99,65 @@
     */
     uint8_t I2C_Peripheral_Stop(void);
     
+    /** 
+    *   \brief Bound the duration of write transactions.
+    *
+    *   With a timeout set, blocking writes are carried out by the I2C
+    *   interrupt through the staging buffer, in transactions of at most
+    *   #I2C_ASYNC_BUFFER_SIZE - 1 data bytes with the same register address,
+    *   and are aborted with #I2C_TIMEOUT when a transaction takes longer
+    *   than the timeout. The bus is then recovered with #I2C_Peripheral_Recover.
+    *   Asynchronous writes are aborted the same way by #I2C_Peripheral_IsBusy.
+    *   Without a timeout, writes wait on each byte as the I2C component does.
+    *   \param[in] clock free-running counter, NULL to disable timeouts.
+    *   \param[in] ticks timeout of a transaction, in clock ticks.
+    */
+    void I2C_Peripheral_SetTimeout(I2C_Clock clock, uint32_t ticks);
+    
+    /** 
+    *   \brief Set the number of retries of failed writes.
+    *
+    *   A write is retried only when no data byte can have reached the
+    *   device (address not acknowledged, or bus not acquired), so that
+    *   retrying never writes data twice. Writes that fail after some data
+    *   were acknowledged are reported to the caller, which can use
+    *   #I2C_Peripheral_GetWriteCount to resume them.
+    *   \param[in] retries additional attempts, 0 to disable retries.
+    */
+    void I2C_Peripheral_SetRetries(uint8_t retries);
+    
+    /** 
+    *   \brief Set the function used to free a stuck bus.
+    *   \param[in] hook board specific recovery, NULL to only restart the peripheral.
+    */
+    void I2C_Peripheral_SetRecovery(I2C_RecoveryHook hook);
+    
+    /** 
+    *   \brief Recover the bus after a timeout.
+    *
+    *   Stops the I2C peripheral, calls the recovery hook and starts the
+    *   peripheral again. An asynchronous transfer in progress is abandoned.
+    */
+    void I2C_Peripheral_Recover(void);
+    
+    /** 
+    *   \brief Get the number of data bytes acknowledged by the last blocking write.
+    *
+    *   After a failed write, the first bytes returned by this function
+    *   are known to have reached the device.
+    *   \return number of data bytes acknowledged.
+    */
+    uint16_t I2C_Peripheral_GetWriteCount(void);
+    
+    #if I2C_FAULT_INJECTION
+        /** 
+        *   \brief Set the fault injection hook.
+        *   \param[in] hook function deciding the outcome of each write, NULL to disable.
+        *   \param[in] context argument passed to the hook.
+        */
+        void I2C_Peripheral_SetFaultHook(I2C_FaultHook hook, void *context);
+    #endif
+    
     /**
     *   \brief Read one byte over I2C.
     *   
@@ -108,6 +219,7 @@
     *   \retval #I2C_NO_ERROR if no error occurred during I2C communication.
     *   \retval #I2C_ERROR if error occurred when starting the peripheral.
     *   \retval #I2C_DEV_NOT_FOUND if the device was not found on the bus.
+    *   \retval #I2C_TIMEOUT if a timeout is set and the write did not complete in time.
     */
     uint8_t I2C_Peripheral_WriteRegister(uint8_t device_address,
                                             uint8_t register_address,
@@ -125,12 +237,70 @@
     *   \retval #I2C_NO_ERROR if no error occurred during I2C communication.
     *   \retval #I2C_ERROR if error occurred when starting the peripheral.
     *   \retval #I2C_DEV_NOT_FOUND if the device was not found on the bus.
+    *   \retval #I2C_TIMEOUT if a timeout is set and the write did not complete in time.
     */
     uint8_t I2C_Peripheral_WriteRegisterMulti(uint8_t device_address,
                                             uint8_t register_address,
                                             uint16_t register_count,
                                             const uint8_t* data);
     
+    /** 
+    *   \brief Write multiple strided blocks of bytes over I2C in a single transaction.
+    *   
+    *   This function performs a complete writing operation over I2C, sending
+    *   block_count blocks of block_size bytes each. The first byte of each
+    *   block is located stride bytes after the first byte of the previous one.
+    *   It allows to send a rectangular window of a larger buffer without copying it.
+    *   \param[in] device_address I2C address of the device to talk to.
+    *   \param[in] register_address Address of the first register to be written.
+    *   \param[in] block_size Number of bytes of each block.
+    *   \param[in] block_count Number of blocks.
+    *   \param[in] stride Distance in bytes between the start of two blocks.
+    *   \param[in] data Pointer to the first byte of the first block.
+    *   \retval #I2C_NO_ERROR if no error occurred during I2C communication.
+    *   \retval #I2C_ERROR if error occurred when starting the peripheral.
+    *   \retval #I2C_DEV_NOT_FOUND if the device was not found on the bus.
+    *   \retval #I2C_TIMEOUT if a timeout is set and the write did not complete in time.
+    */
+    uint8_t I2C_Peripheral_WriteRegisterMultiStrided(uint8_t device_address,
+                                            uint8_t register_address,
+                                            uint16_t block_size,
+                                            uint16_t block_count,
+                                            uint16_t stride,
+                                            const uint8_t* data);
+    
+    /** 
+    *   \brief Start an asynchronous write of multiple bytes over I2C.
+    *   
+    *   Register address and data are copied to an internal staging buffer
+    *   and the transfer is carried out by the I2C interrupt, so that the 
+    *   function returns immediately and data can be modified afterwards.
+    *   Use #I2C_Peripheral_IsBusy to know when the transfer is over.
+    *   Blocking functions must not be called while a transfer is in progress.
+    *   \param[in] device_address I2C address of the device to talk to.
+    *   \param[in] register_address Address of the first register to be written.
+    *   \param[in] register_count Number of registers that need to be written,
+    *       at most #I2C_ASYNC_BUFFER_SIZE - 1.
+    *   \param[in] data Array of data to be written
+    *   \retval #I2C_NO_ERROR if the transfer was started.
+    *   \retval #I2C_BUSY if a previous transfer is still in progress.
+    *   \retval #I2C_ERROR if the transfer could not be started.
+    */
+    uint8_t I2C_Peripheral_WriteRegisterMultiAsync(uint8_t device_address,
+                                            uint8_t register_address,
+                                            uint16_t register_count,
+                                            const uint8_t* data);
+    
+    /** 
+    *   \brief Check the state of the last asynchronous write.
+    *   
+    *   \retval #I2C_BUSY if the transfer is still in progress.
+    *   \retval #I2C_NO_ERROR if the transfer completed without errors.
+    *   \retval #I2C_ERROR if the transfer completed with errors.
+    *   \retval #I2C_TIMEOUT if a timeout is set and the transfer was abandoned.
+    */
+    uint8_t I2C_Peripheral_IsBusy(void);
+    
     /** 
     *   \brief Write single byte over I2C.
     *   
@@ -141,6 +311,7 @@
     *   \retval #I2C_NO_ERROR if no error occurred during I2C communication.
     *   \retval #I2C_ERROR if error occurred when starting the peripheral.
     *   \retval #I2C_DEV_NOT_FOUND if the device was not found on the bus.
+    *   \retval #I2C_TIMEOUT if a timeout is set and the write did not complete in time.
     */
     uint8_t I2C_Peripheral_WriteRegisterNoData(uint8_t device_address,
                                             uint8_t register_address);
@@ -23,18 +23,21 @@
 #include "SSD1306.h"
 #include "SSD1306_RegMap.h"
 #include "SSD1306_Splash.h"
+#include "SSD1306_Stats.h"
 #include "string.h"
 
 //***************************
 //          MACROS
 //***************************
-#define SSD1306_I2C_ADDR 0x3C
-#define SSD1306_WIDTH 128
-#define SSD1306_HEIGHT 32
-
 #define SSD1306_Swap(a, b)                                                     \
   (((a) ^= (b)), ((b) ^= (a)), ((a) ^= (b))) ///< No-temp-var swap operation
 
+#define SSD1306_TRANSACTION_COST 2  ///< Address and control byte of a transaction
+#define SSD1306_SETUP_MAX 8         ///< Longest setup of a window: mode, columns, pages
+#define SSD1306_RAM_COLUMNS 128     ///< Columns of the controller RAM
+#define SSD1306_COMMAND_MAX 7       ///< Longest command, parameters included
+#define SSD1306_NO_TARGET() (SSD1306_NO_FRAMEBUFFER && (target == NULL)) ///< No buffer to draw into
+
 /**
 *   \brief Draw fast horizontal line.
 *
@@ -67,30 +70,641 @@ static struct {
     uint8_t width;      ///< Width of the display
     uint8_t height;     ///< Height of the display
     uint8_t rotation;   ///< Rotation of 
+    uint8_t clock_div;  ///< Display clock divide ratio/oscillator frequency
+    uint8_t precharge;  ///< Precharge period
+    int16_t origin_x;   ///< Translation of drawing coordinates
+    int16_t origin_y;   ///< Translation of drawing coordinates
 }  settings;
 
-// Static variable holding current display buffer
-static uint8_t buffer[SSD1306_WIDTH*((SSD1306_HEIGHT+7) / 8)];
+/**
+*   \brief Clip rectangle in rotated coordinates, x1 and y1 excluded.
+*/
+typedef struct {
+    int16_t x0;
+    int16_t y0;
+    int16_t x1;
+    int16_t y1;
+} SSD1306_ClipRect;
+
+// I2C address of the display the module talks to
+static uint8_t address = SSD1306_I2C_ADDR;
+
+/**
+*   \brief Controller address pointer and window, as known by the transfer planner.
+*/
+typedef struct {
+    uint8_t mode;           ///< Addressing mode, #SSD1306_ADDRESSING_AUTO if unknown
+    uint8_t fixed;          ///< Mode set by SSD1306_SetAddressingMode
+    uint8_t valid;          ///< Pointer and window are known
+    uint8_t page;           ///< Page pointer
+    uint8_t col;            ///< Column pointer
+    uint8_t page_start;     ///< Page window, horizontal and vertical modes
+    uint8_t page_end;       ///< Page window, horizontal and vertical modes
+    uint8_t col_start;      ///< Column window, horizontal and vertical modes
+    uint8_t col_end;        ///< Column window, horizontal and vertical modes
+} SSD1306_RamState;
+
+static SSD1306_RamState ram = { .mode = SSD1306_ADDRESSING_AUTO, .fixed = SSD1306_ADDRESSING_AUTO };
+
+/**
+*   \brief NOP commands owed to a display whose command was cut by a failed transfer.
+*/
+typedef struct {
+    uint8_t address;    ///< I2C address of the display
+    uint8_t nops;       ///< NOPs owed, 0 if the entry is free
+} SSD1306_Resync;
+
+static SSD1306_Resync resync[SSD1306_RESYNC_DEVICES];
+
+// Controller state if each addressing mode had always been used, and bytes it would have saved
+static SSD1306_RamState shadow[SSD1306_ADDRESSING_AUTO] = {
+    { .mode = SSD1306_ADDRESSING_HORIZONTAL },
+    { .mode = SSD1306_ADDRESSING_VERTICAL },
+    { .mode = SSD1306_ADDRESSING_PAGE },
+};
+static uint16_t credit[SSD1306_ADDRESSING_AUTO];
+
+// Current clip rectangle, always within the display
+static SSD1306_ClipRect clip;
+// Clip rectangles saved by SSD1306_PushClip
+static SSD1306_ClipRect clip_stack[SSD1306_CLIP_DEPTH];
+static uint8_t clip_depth;
+
+#if !SSD1306_NO_FRAMEBUFFER
+// Static variable holding current display buffer, word aligned for the compositor
+static union {
+    uint8_t bytes[SSD1306_BUFFER_SIZE];
+    uint32_t words[SSD1306_BUFFER_SIZE / 4];
+} frame;
+#endif
+
+// First and last modified column of each page (clean if first > last)
+static uint8_t dirty_first[SSD1306_PAGES];
+static uint8_t dirty_last[SSD1306_PAGES];
+
+// Buffer and dirty map written by the drawing functions
+#if SSD1306_NO_FRAMEBUFFER
+static uint8_t *target = NULL;
+#else
+static uint8_t *target = frame.bytes;
+#endif
+static uint8_t *target_first = dirty_first;
+static uint8_t *target_last = dirty_last;
+
+/**
+*   \brief Mark columns of a page range as modified.
+*
+*   \param page_start first page.
+*   \param page_end last page (included).
+*   \param x first column.
+*   \param x_end last column (included).
+*/
+static void SSD1306_MarkDirtyPages(uint8_t page_start, uint8_t page_end, uint8_t x, uint8_t x_end)
+{
+    uint8_t page;
+    for (page = page_start; page <= page_end; page++)
+    {
+        if (x < target_first[page])
+        {
+            target_first[page] = x;
+        }
+        if (x_end > target_last[page])
+        {
+            target_last[page] = x_end;
+        }
+    }
+}
+
+// Mark the whole buffer as clean
+static void SSD1306_ClearDirty(void)
+{
+    memset(dirty_first, 0xFF, sizeof(dirty_first));
+    memset(dirty_last, 0x00, sizeof(dirty_last));
+}
+
+/**
+*   \brief Send the setup commands of a horizontal or vertical window.
+*
+*   Commands that would not change the pointer or the window are skipped.
+*
+*   \param state known controller state, updated as after the commands.
+*   \param mode #SSD1306_ADDRESSING_HORIZONTAL or #SSD1306_ADDRESSING_VERTICAL.
+*   \param page_start first page.
+*   \param page_end last page (included).
+*   \param col_start first column.
+*   \param col_end last column (included).
+*   \param cmd commands, at least #SSD1306_SETUP_MAX bytes.
+*   \return number of command bytes.
+*/
+static uint8_t SSD1306_PlanWindow(SSD1306_RamState *state, uint8_t mode,
+                                    uint8_t page_start, uint8_t page_end,
+                                    uint8_t col_start, uint8_t col_end, uint8_t *cmd)
+{
+    uint8_t valid = state->valid && (state->mode == mode);
+    uint8_t set_cols, set_pages;
+    uint8_t n = 0;
+
+    if (state->mode != mode)
+    {
+        cmd[n++] = SSD1306_MEMORYMODE;
+        cmd[n++] = mode;
+    }
+    if (mode == SSD1306_ADDRESSING_HORIZONTAL)
+    {
+        // Rows must wrap at the window columns, pages must not wrap early
+        set_cols = !valid || (state->col != col_start) ||
+                    (state->col_start != col_start) || (state->col_end != col_end);
+        set_pages = !valid || (state->page != page_start) || (state->page_end < page_end);
+    }
+    else
+    {
+        // Columns must wrap at the window pages; leaving the column window
+        // open to the right lets the next column follow without setup
+        set_pages = !valid || (state->page != page_start) ||
+                    (state->page_start != page_start) || (state->page_end != page_end);
+        set_cols = !valid || (state->col != col_start) || (state->col_end < col_end);
+        col_end = SSD1306_WIDTH - 1;
+    }
+    if (set_cols)
+    {
+        cmd[n++] = SSD1306_COLUMNADDR;
+        cmd[n++] = col_start;
+        cmd[n++] = col_end;
+        state->col_start = col_start;
+        state->col_end = col_end;
+        state->col = col_start;
+    }
+    if (set_pages)
+    {
+        cmd[n++] = SSD1306_PAGEADDR;
+        cmd[n++] = page_start;
+        cmd[n++] = page_end;
+        state->page_start = page_start;
+        state->page_end = page_end;
+        state->page = page_start;
+    }
+    state->mode = mode;
+    state->valid = 1;
+    return n;
+}
+
+/**
+*   \brief Send the setup commands of a run of a page in page addressing mode.
+*
+*   \param state known controller state, updated as after the commands.
+*   \param page page of the run.
+*   \param col first column of the run.
+*   \param cmd commands, at least #SSD1306_SETUP_MAX bytes.
+*   \return number of command bytes.
+*/
+static uint8_t SSD1306_PlanPage(SSD1306_RamState *state, uint8_t page, uint8_t col, uint8_t *cmd)
+{
+    uint8_t valid = state->valid && (state->mode == SSD1306_ADDRESSING_PAGE);
+    uint8_t n = 0;
+
+    if (state->mode != SSD1306_ADDRESSING_PAGE)
+    {
+        cmd[n++] = SSD1306_MEMORYMODE;
+        cmd[n++] = SSD1306_ADDRESSING_PAGE;
+    }
+    if (!valid || (state->page != page))
+    {
+        cmd[n++] = SSD1306_SETPAGESTART | page;
+    }
+    if (!valid || ((state->col & 0x0F) != (col & 0x0F)))
+    {
+        cmd[n++] = SSD1306_SETLOWCOLUMN | (col & 0x0F);
+    }
+    if (!valid || ((state->col >> 4) != (col >> 4)))
+    {
+        cmd[n++] = SSD1306_SETHIGHCOLUMN | (col >> 4);
+    }
+    state->mode = SSD1306_ADDRESSING_PAGE;
+    state->valid = 1;
+    state->page = page;
+    state->col = col;
+    return n;
+}
+
+/**
+*   \brief Bytes on the wire needed to send a window in an addressing mode.
+*
+*   \param state controller state before the window, updated as after it.
+*   \param mode one of the SSD1306_ADDRESSING_* modes, except AUTO.
+*   \return cost in bytes, counting address and control byte of each transaction.
+*/
+static uint16_t SSD1306_PlanCost(SSD1306_RamState *state, uint8_t mode,
+                                    uint8_t page_start, uint8_t page_end,
+                                    uint8_t col_start, uint8_t col_end)
+{
+    uint8_t cmd[SSD1306_SETUP_MAX];
+    uint8_t width = col_end - col_start + 1;
+    uint8_t pages = page_end - page_start + 1;
+    uint16_t cost = 0;
+    uint8_t n, page;
+
+    if (mode == SSD1306_ADDRESSING_PAGE)
+    {
+        // One command and one data transaction per page
+        for (page = page_start; page <= page_end; page++)
+        {
+            n = SSD1306_PlanPage(state, page, col_start, cmd);
+            cost += (n ? SSD1306_TRANSACTION_COST + n : 0) + SSD1306_TRANSACTION_COST + width;
+            state->col = (col_start + width) % SSD1306_RAM_COLUMNS;
+        }
+        return cost;
+    }
+    n = SSD1306_PlanWindow(state, mode, page_start, page_end, col_start, col_end, cmd);
+    cost = n ? SSD1306_TRANSACTION_COST + n : 0;
+    if (mode == SSD1306_ADDRESSING_HORIZONTAL)
+    {
+        // Rows of the window are sent in a single transaction
+        state->col = col_start;
+        state->page = (page_end >= state->page_end) ? state->page_start : page_end + 1;
+        return cost + SSD1306_TRANSACTION_COST + width * pages;
+    }
+    // Columns are not contiguous in the buffer: one transaction each
+    state->page = page_start;
+    state->col = (col_end >= state->col_end) ? state->col_start : col_end + 1;
+    return cost + width * (SSD1306_TRANSACTION_COST + pages);
+}
+
+/**
+*   \brief Choose the addressing mode of a window.
+*
+*   The cost of each mode is also tracked on a shadow state that always
+*   uses that mode, so that a mode whose setup is cheaper in the long run
+*   (e.g. vertical mode for consecutive columns) is selected once the
+*   bytes it would have saved pay for the switch. Otherwise the mode
+*   changes only when the window itself is cheaper in the new mode.
+*
+*   \return one of the SSD1306_ADDRESSING_* modes, except AUTO; the current mode on ties.
+*/
+static uint8_t SSD1306_PlanMode(uint8_t page_start, uint8_t page_end,
+                                uint8_t col_start, uint8_t col_end)
+{
+    uint8_t current = (ram.mode < SSD1306_ADDRESSING_AUTO) ? ram.mode : SSD1306_ADDRESSING_HORIZONTAL;
+    SSD1306_RamState next = ram;
+    uint16_t now = SSD1306_PlanCost(&next, current, page_start, page_end, col_start, col_end);
+    uint16_t best = now;
+    uint8_t mode = current;
+    uint8_t m;
+    
+    for (m = 0; m < SSD1306_ADDRESSING_AUTO; m++)
+    {
+        uint16_t steady = SSD1306_PlanCost(&shadow[m], m, page_start, page_end, col_start, col_end);
+        uint16_t cost;
+        
+        if (m == current)
+        {
+            continue;
+        }
+        next = ram;
+        cost = SSD1306_PlanCost(&next, m, page_start, page_end, col_start, col_end);
+        // Bytes mode m would have saved so far
+        credit[m] = (credit[m] + now > steady) ? credit[m] + now - steady : 0;
+        if ((cost < best) || ((steady < now) && (cost - steady <= credit[m])))
+        {
+            best = (cost < best) ? cost : best;
+            mode = m;
+        }
+    }
+    if (mode != current)
+    {
+        memset(credit, 0, sizeof(credit));
+    }
+    return mode;
+}
+
+/**
+*   \brief Forget the controller state after a failed transfer.
+*/
+static void SSD1306_ForgetRam(void)
+{
+    ram.mode = SSD1306_ADDRESSING_AUTO;
+    ram.valid = 0;
+}
+
+/**
+*   \brief Get the number of bytes of a command, including its parameters.
+*/
+static uint8_t SSD1306_CommandLength(uint8_t c)
+{
+    switch (c)
+    {
+        case SSD1306_MEMORYMODE:
+        case SSD1306_SETCONTRAST:
+        case SSD1306_CHARGEPUMP:
+        case SSD1306_SETMULTIPLEX:
+        case SSD1306_SETDISPLAYOFFSET:
+        case SSD1306_SETDISPLAYCLOCKDIV:
+        case SSD1306_SETPRECHARGE:
+        case SSD1306_SETCOMPINS:
+        case SSD1306_SETVCOMDETECT:
+            return 2;
+        case SSD1306_COLUMNADDR:
+        case SSD1306_PAGEADDR:
+        case SSD1306_SET_VERTICAL_SCROLL_AREA:
+            return 3;
+        case SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL:
+        case SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL:
+            return 6;
+        case SSD1306_RIGHT_HORIZONTAL_SCROLL:
+        case SSD1306_LEFT_HORIZONTAL_SCROLL:
+        case SSD1306_RIGHT_CONTENT_SCROLL:
+        case SSD1306_LEFT_CONTENT_SCROLL:
+            return SSD1306_COMMAND_MAX;
+        default:
+            return 1;
+    }
+}
+
+/**
+*   \brief Send the NOP commands owed to a display.
+*
+*   \param entry entry of the display.
+*   \return result of the I2C transfer.
+*/
+static uint8_t SSD1306_SendResync(SSD1306_Resync *entry)
+{
+    uint8_t nops[SSD1306_COMMAND_MAX - 1];
+    uint8_t i2c_err;
+
+    memset(nops, SSD1306_NOP, sizeof(nops));
+    // Sending more NOPs than needed is harmless if this fails halfway
+    i2c_err = I2C_Peripheral_WriteRegisterMulti(entry->address, 0x00, entry->nops, nops);
+    if (i2c_err == I2C_NO_ERROR)
+    {
+        entry->nops = 0;
+    }
+    return i2c_err;
+}
+
+/**
+*   \brief Find the NOP commands owed to a display.
+*
+*   \param device_address 7-bit I2C address of the display.
+*   \param create 1 to make an entry if the display has none. When all
+*       the entries are taken, the first one is sent its NOPs and reused.
+*   \return entry of the display, NULL if it has none and create is 0.
+*/
+static SSD1306_Resync *SSD1306_FindResync(uint8_t device_address, uint8_t create)
+{
+    SSD1306_Resync *entry = NULL;
+    uint8_t i;
+
+    for (i = 0; i < SSD1306_RESYNC_DEVICES; i++)
+    {
+        if ((resync[i].nops > 0) && (resync[i].address == device_address))
+        {
+            return &resync[i];
+        }
+        if ((resync[i].nops == 0) && (entry == NULL))
+        {
+            entry = &resync[i];
+        }
+    }
+    if (!create)
+    {
+        return NULL;
+    }
+    if (entry == NULL)
+    {
+        // Its display is only left waiting if this fails too
+        entry = &resync[0];
+        SSD1306_SendResync(entry);
+    }
+    entry->address = device_address;
+    entry->nops = 0;
+    return entry;
+}
 
-// 
-static uint8_t SSD1306_SendCommandList(const uint8_t *c, uint8_t n) 
+/**
+*   \brief Send a list of commands.
+*
+*   A transfer that fails after part of the list may have reached the
+*   controller can leave it waiting for the parameters of a command, and
+*   it would take the first bytes of the next list as those parameters.
+*   Before the next list to that display, as many NOP commands as the
+*   parameters of the longest command that may have been cut are sent:
+*   they complete it and are ignored otherwise. The NOPs are kept per
+*   display, so that switching to another one does not send them to the
+*   wrong controller. The controller state is forgotten, as the cut
+*   command may have been executed with NOPs as parameters.
+*/
+static uint8_t SSD1306_SendCommandList(const uint8_t *c, uint8_t n)
 {
-    return I2C_Peripheral_WriteRegisterMulti(SSD1306_I2C_ADDR, 0x00, n, c);
+    SSD1306_Resync *owed = SSD1306_FindResync(address, 0);
+    uint8_t i2c_err;
+    uint8_t i, len, cut = 0;
+
+    if (owed != NULL)
+    {
+        i2c_err = SSD1306_SendResync(owed);
+        if (i2c_err != I2C_NO_ERROR)
+        {
+            return i2c_err;
+        }
+    }
+    i2c_err = I2C_Peripheral_WriteRegisterMulti(address, 0x00, n, c);
+    if (i2c_err != I2C_NO_ERROR)
+    {
+        // Commands not entirely acknowledged may have been cut anywhere
+        for (i = 0; i < n; i += len)
+        {
+            len = SSD1306_CommandLength(c[i]);
+            if ((i + len > I2C_Peripheral_GetWriteCount()) && (len - 1 > cut))
+            {
+                cut = len - 1;
+            }
+        }
+        if (cut > 0)
+        {
+            owed = SSD1306_FindResync(address, 1);
+            if (cut > owed->nops)
+            {
+                owed->nops = cut;
+            }
+        }
+        SSD1306_ForgetRam();
+    }
+    return i2c_err;
 }
 
 static uint8_t SSD1306_Command(uint8_t c) 
 {
-    return I2C_Peripheral_WriteRegister(SSD1306_I2C_ADDR, 0x00, c);
+    return SSD1306_SendCommandList(&c, 1);
 }
 
-uint8_t SSD1306_Start(void)
+/**
+*   \brief Send a window of page-major data.
+*
+*   The addressing mode is chosen by #SSD1306_PlanCost, unless a mode was
+*   fixed with #SSD1306_SetAddressingMode. When a transfer fails, the
+*   controller state is forgotten and only the part of the window that
+*   was not acknowledged is sent again, up to #SSD1306_RESEND_ATTEMPTS times.
+*
+*   \param page_start first page.
+*   \param page_end last page (included).
+*   \param col_start first column.
+*   \param col_end last column (included).
+*   \param data bytes of the window, starting from the first column of the first page.
+*   \param stride distance in bytes between two pages of data.
+*   \param sent first page not acknowledged, page_end + 1 if the window was sent.
+*   \return result of the last I2C transfer.
+*/
+static uint8_t SSD1306_SendWindow(uint8_t page_start, uint8_t page_end,
+                                    uint8_t col_start, uint8_t col_end,
+                                    const uint8_t *data, uint16_t stride, uint8_t *sent)
 {
+    uint8_t cmd[SSD1306_SETUP_MAX];
+    uint8_t attempt = 0;
     uint8_t i2c_err;
+    // Data of page p, column c is at data[(p - page0) * stride + c - col0]
+    uint8_t page0 = page_start;
+    uint8_t col0 = col_start;
+    
+    do
+    {
+        uint8_t width = col_end - col_start + 1;
+        uint8_t mode = (ram.fixed == SSD1306_ADDRESSING_AUTO) ?
+                        SSD1306_PlanMode(page_start, page_end, col_start, col_end) : ram.fixed;
+        uint8_t switched, n, col;
+        uint16_t setup = 0;
+        SSD1306_RamState next = ram;
+        
+        // State of the controller once the whole window is sent
+        SSD1306_PlanCost(&next, mode, page_start, page_end, col_start, col_end);
+        switched = (ram.mode != mode);
+        
+        if (mode == SSD1306_ADDRESSING_PAGE)
+        {
+            i2c_err = I2C_NO_ERROR;
+            for (; page_start <= page_end; page_start++)
+            {
+                n = SSD1306_PlanPage(&ram, page_start, col_start, cmd);
+                setup += n;
+                if (n > 0)
+                {
+                    i2c_err = SSD1306_SendCommandList(cmd, n);
+                }
+                if (i2c_err == I2C_NO_ERROR)
+                {
+                    i2c_err = I2C_Peripheral_WriteRegisterMulti(address, 0x40, width,
+                                            &data[(page_start - page0) * stride + col_start - col0]);
+                    ram.col = (col_start + width) % SSD1306_RAM_COLUMNS;
+                }
+                if (i2c_err != I2C_NO_ERROR)
+                {
+                    break;
+                }
+            }
+        }
+        else
+        {
+            n = SSD1306_PlanWindow(&ram, mode, page_start, page_end, col_start, col_end, cmd);
+            setup = n;
+            i2c_err = (n > 0) ? SSD1306_SendCommandList(cmd, n) : I2C_NO_ERROR;
+            if ((i2c_err == I2C_NO_ERROR) && (mode == SSD1306_ADDRESSING_HORIZONTAL))
+            {
+                // Rows of the window are not contiguous in the buffer unless
+                // the window is as wide as the display: send them with a stride
+                i2c_err = I2C_Peripheral_WriteRegisterMultiStrided(address, 0x40,
+                                                width,
+                                                page_end - page_start + 1,
+                                                stride,
+                                                &data[(page_start - page0) * stride + col_start - col0]);
+                // Pages fully acknowledged are not sent again
+                page_start += I2C_Peripheral_GetWriteCount() / width;
+            }
+            else if (i2c_err == I2C_NO_ERROR)
+            {
+                // One column of the pages after the other
+                for (col = col_start; col <= col_end; col++)
+                {
+                    i2c_err = I2C_Peripheral_WriteRegisterMultiStrided(address, 0x40,
+                                                1,
+                                                page_end - page_start + 1,
+                                                stride,
+                                                &data[(page_start - page0) * stride + col - col0]);
+                    if (i2c_err != I2C_NO_ERROR)
+                    {
+                        break;
+                    }
+                }
+                // Columns acknowledged are not sent again
+                col_start = col;
+                if (col > col_end)
+                {
+                    page_start = page_end + 1;
+                }
+            }
+        }
+        SSD1306_STATS_PLAN(mode, setup, switched);
+        if (i2c_err != I2C_NO_ERROR)
+        {
+            SSD1306_ForgetRam();
+        }
+        else
+        {
+            ram = next;
+            if (ram.fixed == SSD1306_ADDRESSING_AUTO)
+            {
+                shadow[mode] = ram;
+            }
+        }
+    } while ((i2c_err != I2C_NO_ERROR) && (page_start <= page_end) &&
+                (attempt++ < SSD1306_RESEND_ATTEMPTS));
+    *sent = page_start;
+    return i2c_err;
+}
+
+/**
+*   \brief Initialize display settings according to the configuration.
+*
+*   \param comPins value for the SETCOMPINS command.
+*/
+static void SSD1306_InitSettings(uint8_t *comPins)
+{
     settings.vcc_state = SSD1306_SWITCHCAPVCC;
     settings.width = SSD1306_WIDTH;
     settings.height = SSD1306_HEIGHT;
     settings.contrast = 0x8F;
     settings.rotation = 0;
+    settings.clock_div = SSD1306_CLOCK_DIV;
+    settings.origin_x = 0;
+    settings.origin_y = 0;
+    SSD1306_ResetClip();
+    settings.precharge = (settings.vcc_state == SSD1306_EXTERNALVCC) ? 0x22 : 0xF1;
+    
+    *comPins = 0x02;
+    
+    if ((SSD1306_WIDTH == 128) && (SSD1306_HEIGHT == 32)) 
+    {
+        *comPins = 0x02;
+        settings.contrast = 0x8F;
+    }
+    else if ((SSD1306_WIDTH == 128) && (SSD1306_HEIGHT == 64)) 
+    {
+        *comPins = 0x12;
+        settings.contrast = (settings.vcc_state == SSD1306_EXTERNALVCC) ? 0x9F : 0xCF;
+    }
+    else if ((SSD1306_WIDTH == 96) && (SSD1306_HEIGHT == 16)) 
+    {
+        *comPins = 0x2; // ada x12
+        settings.contrast = (settings.vcc_state == SSD1306_EXTERNALVCC) ? 0x10 : 0xAF;
+    }
+    else 
+    {
+        // Other screen varieties -- TBD
+    }
+}
+
+uint8_t SSD1306_Start(void)
+{
+    uint8_t comPins;
+    
+    SSD1306_InitSettings(&comPins);
     
     //SSD1306_ClearDisplay();
     /*
@@ -104,121 +718,330 @@ uint8_t SSD1306_Start(void)
                splash2_data, splash2_width, splash2_height, 1);
     } 
     */
-
-    // Init sequence
-    
-    static const uint8_t init1[] = {SSD1306_DISPLAYOFF,         // 0xAE
-                                        SSD1306_SETDISPLAYCLOCKDIV, // 0xD5
-                                        0x80, // the suggested ratio 0x80
-                                        SSD1306_SETMULTIPLEX,
-                                        SSD1306_HEIGHT - 1, // 0xA8
-                                        SSD1306_SETDISPLAYOFFSET, // 0xD3
-                                        0x00,                      // no offset
-                                        SSD1306_SETSTARTLINE | 0x0, // line #0
-                                        SSD1306_CHARGEPUMP};        // 0x8D
-    i2c_err = SSD1306_SendCommandList(init1, sizeof(init1));
-
-    i2c_err = SSD1306_Command((settings.vcc_state == SSD1306_EXTERNALVCC) ? 0x10 : 0x14);
-
-    static const uint8_t  init3[] = {SSD1306_MEMORYMODE, // 0x20
-                                        0x00, // 0x0 act like ks0108
-                                        SSD1306_SEGREMAP | 0x1,
-                                        SSD1306_COMSCANDEC};
-    i2c_err = SSD1306_SendCommandList(init3, sizeof(init3));
-
-    uint8_t comPins = 0x02;
     
-    if ((SSD1306_WIDTH == 128) && (SSD1306_HEIGHT == 32)) 
+    // Probe the device once, so that a missing display fails fast
+    if (I2C_Peripheral_IsDeviceConnected(address) != I2C_NO_ERROR)
     {
-        comPins = 0x02;
-        settings.contrast = 0x8F;
+        return SSD1306_COMM_ERROR;
     }
-    else if ((SSD1306_WIDTH == 128) && (SSD1306_HEIGHT == 64)) 
+
+    // Init sequence, sent as a single command stream
+    const uint8_t init[] = {SSD1306_DISPLAYOFF,         // 0xAE
+                                SSD1306_SETDISPLAYCLOCKDIV, // 0xD5
+                                settings.clock_div, // the suggested ratio 0x80
+                                SSD1306_SETMULTIPLEX,
+                                SSD1306_HEIGHT - 1, // 0xA8
+                                SSD1306_SETDISPLAYOFFSET, // 0xD3
+                                0x00,                      // no offset
+                                SSD1306_SETSTARTLINE | 0x0, // line #0
+                                SSD1306_CHARGEPUMP,        // 0x8D
+                                (settings.vcc_state == SSD1306_EXTERNALVCC) ? 0x10 : 0x14,
+                                SSD1306_MEMORYMODE, // 0x20
+                                0x00, // 0x0 act like ks0108
+                                SSD1306_SEGREMAP | 0x1,
+                                SSD1306_COMSCANDEC,
+                                SSD1306_SETCOMPINS,
+                                comPins,
+                                SSD1306_SETCONTRAST,
+                                settings.contrast,
+                                SSD1306_SETPRECHARGE, // 0xd9
+                                settings.precharge,
+                                SSD1306_SETVCOMDETECT, // 0xDB
+                                0x40,
+                                SSD1306_DISPLAYALLON_RESUME, // 0xA4
+                                SSD1306_NORMALDISPLAY,       // 0xA6
+                                SSD1306_DEACTIVATE_SCROLL,
+                                SSD1306_DISPLAYON}; // Main screen turn on
+    if (SSD1306_SendCommandList(init, sizeof(init)) != I2C_NO_ERROR)
     {
-        comPins = 0x12;
-        settings.contrast = (settings.vcc_state == SSD1306_EXTERNALVCC) ? 0x9F : 0xCF;
+        SSD1306_ForgetRam();
+        return SSD1306_COMM_ERROR;
     }
-    else if ((SSD1306_WIDTH == 96) && (SSD1306_HEIGHT == 16)) 
+    
+    SSD1306_ClearDirty();
+    // The initialization selects horizontal addressing
+    ram.mode = SSD1306_ADDRESSING_HORIZONTAL;
+    ram.valid = 0;
+    
+    return SSD1306_NO_ERROR;
+}
+
+uint8_t SSD1306_StartWarm(void)
+{
+    uint8_t comPins;
+    
+    SSD1306_InitSettings(&comPins);
+    
+    if (I2C_Peripheral_IsDeviceConnected(address) != I2C_NO_ERROR)
     {
-        comPins = 0x2; // ada x12
-        settings.contrast = (settings.vcc_state == SSD1306_EXTERNALVCC) ? 0x10 : 0xAF;
+        return SSD1306_COMM_ERROR;
     }
-    else 
+    
+    // Oscillator, charge pump and panel configuration are retained by the
+    // controller: only restore the state the driver relies on
+    static const uint8_t init[] = {SSD1306_DEACTIVATE_SCROLL,
+                                    SSD1306_MEMORYMODE,
+                                    0x00,
+                                    SSD1306_DISPLAYALLON_RESUME,
+                                    SSD1306_NORMALDISPLAY,
+                                    SSD1306_DISPLAYON};
+    if (SSD1306_SendCommandList(init, sizeof(init)) != I2C_NO_ERROR)
     {
-        // Other screen varieties -- TBD
+        SSD1306_ForgetRam();
+        return SSD1306_COMM_ERROR;
     }
-
-    i2c_err = SSD1306_Command(SSD1306_SETCOMPINS);
-    i2c_err = SSD1306_Command(comPins);
-    i2c_err = SSD1306_Command(SSD1306_SETCONTRAST);
-    i2c_err = SSD1306_Command(settings.contrast);
-
-    i2c_err = SSD1306_Command(SSD1306_SETPRECHARGE); // 0xd9
-    i2c_err = SSD1306_Command((settings.vcc_state == SSD1306_EXTERNALVCC) ? 0x22 : 0xF1);
-    static const uint8_t init5[] = {SSD1306_SETVCOMDETECT, // 0xDB
-                                        0x40,
-                                        SSD1306_DISPLAYALLON_RESUME, // 0xA4
-                                        SSD1306_NORMALDISPLAY,       // 0xA6
-                                        SSD1306_DEACTIVATE_SCROLL,
-                                        SSD1306_DISPLAYON}; // Main screen turn on
-    i2c_err = SSD1306_SendCommandList(init5, sizeof(init5));
     
-    return i2c_err;
+    SSD1306_ClearDirty();
+    // The initialization selects horizontal addressing
+    ram.mode = SSD1306_ADDRESSING_HORIZONTAL;
+    ram.valid = 0;
+    
+    return SSD1306_NO_ERROR;
 }
 
 void SSD1306_ClearDisplay(void)
 {
-    memset(buffer, 0, SSD1306_WIDTH * ((SSD1306_HEIGHT + 7) / 8));
+    if (SSD1306_NO_TARGET())
+    {
+        return;
+    }
+    SSD1306_STATS_BEGIN();
+    memset(target, 0, SSD1306_BUFFER_SIZE);
+    SSD1306_MarkDirtyPages(0, SSD1306_PAGES - 1, 0, SSD1306_WIDTH - 1);
+    SSD1306_STATS_END(SSD1306_STATS_OP_CLEAR);
 }
 
 
 
+#if !SSD1306_NO_FRAMEBUFFER
 // Update display content
 uint8_t SSD1306_Display(void) {
     
-    static const uint8_t dlist1[] = { SSD1306_PAGEADDR,
-                                        0,                      // Page start address
-                                        0xFF,                   // Page end (not really, but works here)
-                                        SSD1306_COLUMNADDR,
-                                        0}; // Column start address
+    SSD1306_STATS_BEGIN();
+    uint8_t sent, page;
+    uint8_t i2c_err = SSD1306_SendWindow(0, SSD1306_PAGES - 1, 0, SSD1306_WIDTH - 1,
+                                            frame.bytes, SSD1306_WIDTH, &sent);
+    SSD1306_STATS_END(SSD1306_STATS_OP_DISPLAY);
     
-    SSD1306_SendCommandList(dlist1, 5);
-    
-    SSD1306_Command(SSD1306_WIDTH - 1); // Column end address
+    // Pages that were acknowledged are clean, the others must be sent again
+    SSD1306_ClearDirty();
+    if (i2c_err != I2C_NO_ERROR)
+    {
+        for (page = sent; page < SSD1306_PAGES; page++)
+        {
+            dirty_first[page] = 0;
+            dirty_last[page] = SSD1306_WIDTH - 1;
+        }
+        return SSD1306_COMM_ERROR;
+    }
+    SSD1306_STATS_FRAME(0);
+    return SSD1306_NO_ERROR;
+}
 
-    uint16_t count = SSD1306_WIDTH * ((SSD1306_HEIGHT + 7) / 8);
-    //uint8_t *ptr = buffer;
-    uint8_t i2c_err = I2C_Peripheral_WriteRegisterMulti(SSD1306_I2C_ADDR, 0x40, count, buffer);
-    if (i2c_err == I2C_NO_ERROR)
+// Update a window of display content
+uint8_t SSD1306_DisplayWindow(uint8_t page_start, uint8_t page_end,
+                                uint8_t col_start, uint8_t col_end)
+{
+    uint8_t sent;
+    
+    if ((page_end >= SSD1306_PAGES) || (col_end >= SSD1306_WIDTH) ||
+        (page_start > page_end) || (col_start > col_end))
     {
         return SSD1306_NO_ERROR;
     }
-    else
+    
+    SSD1306_STATS_BEGIN();
+    uint8_t i2c_err = SSD1306_SendWindow(page_start, page_end, col_start, col_end,
+                                            &frame.bytes[page_start * SSD1306_WIDTH + col_start],
+                                            SSD1306_WIDTH, &sent);
+    SSD1306_STATS_END(SSD1306_STATS_OP_DISPLAY_WINDOW);
+    if (i2c_err != I2C_NO_ERROR)
     {
+        // Pages not acknowledged are left for SSD1306_DisplayDirty
+        for (; sent <= page_end; sent++)
+        {
+            if (col_start < dirty_first[sent])
+            {
+                dirty_first[sent] = col_start;
+            }
+            if (col_end > dirty_last[sent])
+            {
+                dirty_last[sent] = col_end;
+            }
+        }
         return SSD1306_COMM_ERROR;
     }
+    return SSD1306_NO_ERROR;
+}
+
+// Update only modified display content
+uint8_t SSD1306_DisplayDirty(void)
+{
+    SSD1306_STATS_BEGIN();
+    uint16_t sent = 0;
+    uint8_t page = 0;
+    
+    while (page < SSD1306_PAGES)
+    {
+        if (dirty_first[page] > dirty_last[page])
+        {
+            page++;
+            continue;
+        }
+        // Group consecutive dirty pages in a single window
+        uint8_t page_end = page;
+        uint8_t first = dirty_first[page];
+        uint8_t last = dirty_last[page];
+        uint8_t page_sent;
+        while ((page_end + 1 < SSD1306_PAGES) && 
+                (dirty_first[page_end + 1] <= dirty_last[page_end + 1]))
+        {
+            page_end++;
+            if (dirty_first[page_end] < first)
+            {
+                first = dirty_first[page_end];
+            }
+            if (dirty_last[page_end] > last)
+            {
+                last = dirty_last[page_end];
+            }
+        }
+        uint8_t i2c_err = SSD1306_SendWindow(page, page_end, first, last,
+                                                &frame.bytes[page * SSD1306_WIDTH + first],
+                                                SSD1306_WIDTH, &page_sent);
+        sent += (page_sent - page) * (last - first + 1);
+        // Mark the pages as clean only once they were sent
+        for (; page < page_sent; page++)
+        {
+            dirty_first[page] = 0xFF;
+            dirty_last[page] = 0x00;
+        }
+        if (i2c_err != I2C_NO_ERROR)
+        {
+            SSD1306_STATS_END(SSD1306_STATS_OP_DISPLAY_DIRTY);
+            return SSD1306_COMM_ERROR;
+        }
+    }
+    SSD1306_STATS_END(SSD1306_STATS_OP_DISPLAY_DIRTY);
+    SSD1306_STATS_FRAME(SSD1306_BUFFER_SIZE - sent);
+    return SSD1306_NO_ERROR;
+}
+#endif
+
+// Send data that is not in the display buffer
+uint8_t SSD1306_WriteWindow(uint8_t page_start, uint8_t page_end,
+                            uint8_t col_start, uint8_t col_end,
+                            const uint8_t *data, uint16_t stride)
+{
+    uint8_t sent;
     
+    if ((page_end >= SSD1306_PAGES) || (col_end >= SSD1306_WIDTH) ||
+        (page_start > page_end) || (col_start > col_end))
+    {
+        return SSD1306_NO_ERROR;
+    }
+    
+    SSD1306_STATS_BEGIN();
+    uint8_t i2c_err = SSD1306_SendWindow(page_start, page_end, col_start, col_end,
+                                            data, stride, &sent);
+    SSD1306_STATS_END(SSD1306_STATS_OP_DISPLAY_WINDOW);
+    return i2c_err == I2C_NO_ERROR ? SSD1306_NO_ERROR : SSD1306_COMM_ERROR;
+}
+
+// Select addressing mode of the refresh functions
+uint8_t SSD1306_SetAddressingMode(uint8_t mode)
+{
+    ram.fixed = mode & 0x03;
+    if (ram.fixed == SSD1306_ADDRESSING_AUTO)
+    {
+        return SSD1306_NO_ERROR;
+    }
+    const uint8_t clist[] = { SSD1306_MEMORYMODE, ram.fixed };
+    // The pointer may be moved by whoever needed the mode
+    SSD1306_ForgetRam();
+    if (SSD1306_SendCommandList(clist, sizeof(clist)) != I2C_NO_ERROR)
+    {
+        return SSD1306_COMM_ERROR;
+    }
+    ram.mode = ram.fixed;
+    return SSD1306_NO_ERROR;
+}
+
+// Mark a region of the buffer as modified
+void SSD1306_MarkDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    if (x < 0)
+    {
+        w += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        h += y;
+        y = 0;
+    }
+    if ((x + w) > SSD1306_WIDTH)
+    {
+        w = SSD1306_WIDTH - x;
+    }
+    if ((y + h) > SSD1306_HEIGHT)
+    {
+        h = SSD1306_HEIGHT - y;
+    }
+    if ((w > 0) && (h > 0))
+    {
+        SSD1306_MarkDirtyPages(y / 8, (y + h - 1) / 8, x, x + w - 1);
+    }
 }
 
 // Invert display
 uint8_t SSD1306_InvertDisplay(uint8_t invert) {
     uint8_t i2c_err = SSD1306_Command(invert ? SSD1306_INVERTDISPLAY : SSD1306_NORMALDISPLAY);
-    return i2c_err == I2C_ERROR ? SSD1306_COMM_ERROR : SSD1306_NO_ERROR;
+    return i2c_err == I2C_NO_ERROR ? SSD1306_NO_ERROR : SSD1306_COMM_ERROR;
 }
 
 // Set display contrast
 uint8_t SSD1306_Dim(uint8_t dim) {
     // the range of contrast to too small to be really useful
     // it is useful to dim the display
-    uint8_t i2c_err = SSD1306_Command(SSD1306_SETCONTRAST);
-    i2c_err = SSD1306_Command(dim ? 0 : settings.contrast);
-    return i2c_err > 0 ? SSD1306_COMM_ERROR : SSD1306_NO_ERROR;
+    const uint8_t clist[] = { SSD1306_SETCONTRAST, dim ? 0 : settings.contrast };
+    uint8_t i2c_err = SSD1306_SendCommandList(clist, sizeof(clist));
+    return i2c_err == I2C_NO_ERROR ? SSD1306_NO_ERROR : SSD1306_COMM_ERROR;
+}
+
+// Set display clock
+uint8_t SSD1306_SetClockDiv(uint8_t clock_div)
+{
+    const uint8_t clist[] = { SSD1306_SETDISPLAYCLOCKDIV, clock_div };
+    uint8_t i2c_err = SSD1306_SendCommandList(clist, sizeof(clist));
+    if (i2c_err == I2C_NO_ERROR)
+    {
+        settings.clock_div = clock_div;
+        return SSD1306_NO_ERROR;
+    }
+    return SSD1306_COMM_ERROR;
+}
+
+// Nominal frame rate
+uint16_t SSD1306_GetFrameRate(void)
+{
+    // D: divide ratio, K: phase 1 + phase 2 + 50 DCLKs per row
+    uint32_t d = (settings.clock_div & 0x0F) + 1;
+    uint32_t k = (settings.precharge & 0x0F) + (settings.precharge >> 4) + 50;
+    return (uint16_t)(SSD1306_FOSC_HZ / (d * k * SSD1306_HEIGHT));
 }
 
 void SSD1306_DrawPixel(int16_t x, int16_t y, uint16_t color) {
-    if ((x >= 0) && (x < settings.width) && (y >= 0) && (y < settings.height)) 
+    if (SSD1306_NO_TARGET())
     {
-        // Pixel is in-bounds. Rotate coordinates if needed.
+        return;
+    }
+    SSD1306_STATS_BEGIN();
+    x += settings.origin_x;
+    y += settings.origin_y;
+    if ((x >= clip.x0) && (x < clip.x1) && (y >= clip.y0) && (y < clip.y1)) 
+    {
+        // Pixel is in the clip rectangle. Rotate coordinates if needed.
         switch (settings.rotation) {
             case 1:
               SSD1306_Swap(x, y);
@@ -233,24 +1056,44 @@ void SSD1306_DrawPixel(int16_t x, int16_t y, uint16_t color) {
               y = SSD1306_HEIGHT - y - 1;
               break;
         }
+        SSD1306_MarkDirtyPages(y / 8, y / 8, x, x);
         switch (color) {
             case SSD1306_WHITE:
-              buffer[x + (y / 8) * SSD1306_WIDTH] |= (1 << (y & 7));
+              target[x + (y / 8) * SSD1306_WIDTH] |= (1 << (y & 7));
               break;
             case SSD1306_BLACK:
-              buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y & 7));
+              target[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y & 7));
               break;
             case SSD1306_INVERSE:
-              buffer[x + (y / 8) * SSD1306_WIDTH] ^= (1 << (y & 7));
+              target[x + (y / 8) * SSD1306_WIDTH] ^= (1 << (y & 7));
               break;
         }
     }
+    SSD1306_STATS_END(SSD1306_STATS_OP_PIXEL);
 }
 
 void SSD1306_DrawFastHLine(int16_t x, int16_t y, int16_t w,
                                      uint16_t color) 
 {
+    SSD1306_STATS_BEGIN();
     uint8_t bSwap = 0;
+    // Translate and clip once, before the kernels
+    x += settings.origin_x;
+    y += settings.origin_y;
+    if (x < clip.x0)
+    {
+        w -= clip.x0 - x;
+        x = clip.x0;
+    }
+    if (x + w > clip.x1)
+    {
+        w = clip.x1 - x;
+    }
+    if ((y < clip.y0) || (y >= clip.y1) || (w <= 0))
+    {
+        SSD1306_STATS_END(SSD1306_STATS_OP_HLINE);
+        return;
+    }
     switch (settings.rotation) {
         case 1:
             // 90 degree rotation, swap x & y for rotation, then invert x
@@ -282,11 +1125,30 @@ void SSD1306_DrawFastHLine(int16_t x, int16_t y, int16_t w,
     {
         SSD1306_DrawFastHLineInternal(x, y, w, color);
     }
+    SSD1306_STATS_END(SSD1306_STATS_OP_HLINE);
 }
 
 void SSD1306_DrawFastVLine(int16_t x, int16_t y, int16_t h,
                                      uint16_t color) {
+    SSD1306_STATS_BEGIN();
     uint8_t bSwap = 0;
+    // Translate and clip once, before the kernels
+    x += settings.origin_x;
+    y += settings.origin_y;
+    if (y < clip.y0)
+    {
+        h -= clip.y0 - y;
+        y = clip.y0;
+    }
+    if (y + h > clip.y1)
+    {
+        h = clip.y1 - y;
+    }
+    if ((x < clip.x0) || (x >= clip.x1) || (h <= 0))
+    {
+        SSD1306_STATS_END(SSD1306_STATS_OP_VLINE);
+        return;
+    }
     switch (settings.rotation)
     {
         case 1:
@@ -317,11 +1179,16 @@ void SSD1306_DrawFastVLine(int16_t x, int16_t y, int16_t h,
     }
     else
         SSD1306_DrawFastVLineInternal(x, y, h, color);
+    SSD1306_STATS_END(SSD1306_STATS_OP_VLINE);
 }
 
 void SSD1306_DrawFastHLineInternal(int16_t x, int16_t y, int16_t w,
                                              uint16_t color) {
 
+    if (SSD1306_NO_TARGET())
+    {
+        return;
+    }
     if ((y >= 0) && (y < SSD1306_HEIGHT)) 
     {
         // Y coord in bounds?
@@ -338,7 +1205,8 @@ void SSD1306_DrawFastHLineInternal(int16_t x, int16_t y, int16_t w,
         if (w > 0) 
         {
             // Proceed only if width is positive
-            uint8_t *pBuf = &buffer[(y / 8) * SSD1306_WIDTH + x], mask = 1 << (y & 7);
+            SSD1306_MarkDirtyPages(y / 8, y / 8, x, x + w - 1);
+            uint8_t *pBuf = &target[(y / 8) * SSD1306_WIDTH + x], mask = 1 << (y & 7);
             switch (color) {
                 case SSD1306_WHITE:
                     while (w--) 
@@ -367,6 +1235,10 @@ void SSD1306_DrawFastHLineInternal(int16_t x, int16_t y, int16_t w,
 void SSD1306_DrawFastVLineInternal(int16_t x, int16_t __y,
                                              int16_t __h, uint16_t color) {
 
+    if (SSD1306_NO_TARGET())
+    {
+        return;
+    }
     if ((x >= 0) && (x < SSD1306_WIDTH)) 
     {
         // X coord in bounds?
@@ -386,7 +1258,8 @@ void SSD1306_DrawFastVLineInternal(int16_t x, int16_t __y,
             // this display doesn't need ints for coordinates,
             // use local byte registers for faster juggling
             uint8_t y = __y, h = __h;
-            uint8_t *pBuf = &buffer[(y / 8) * SSD1306_WIDTH + x];
+            SSD1306_MarkDirtyPages(y / 8, (y + h - 1) / 8, x, x);
+            uint8_t *pBuf = &target[(y / 8) * SSD1306_WIDTH + x];
 
             // do the first partial byte, if necessary - this requires some masking
             uint8_t mod = (y & 7);
@@ -474,26 +1347,248 @@ void SSD1306_DrawFastVLineInternal(int16_t x, int16_t __y,
     }   // endif x in bounds
 }                                            
  
-uint8_t SSD1306_StartScrollRight(uint8_t start, uint8_t stop);
+/**
+*   \brief Activate a horizontal scroll.
+*
+*   \param command #SSD1306_RIGHT_HORIZONTAL_SCROLL or #SSD1306_LEFT_HORIZONTAL_SCROLL.
+*   \param start first page.
+*   \param stop last page.
+*/
+static uint8_t SSD1306_StartScroll(uint8_t command, uint8_t start, uint8_t stop)
+{
+    const uint8_t slist[] = { command,
+                                0x00,       // Dummy byte
+                                start,
+                                0x00,       // Interval of 5 frames
+                                stop,
+                                0x00,       // Dummy bytes
+                                0xFF,
+                                SSD1306_ACTIVATE_SCROLL };
+    uint8_t i2c_err = SSD1306_SendCommandList(slist, sizeof(slist));
+    return i2c_err == I2C_NO_ERROR ? SSD1306_NO_ERROR : SSD1306_COMM_ERROR;
+}
+
+uint8_t SSD1306_StartScrollRight(uint8_t start, uint8_t stop)
+{
+    return SSD1306_StartScroll(SSD1306_RIGHT_HORIZONTAL_SCROLL, start, stop);
+}
     
 uint8_t SSD1306_StartScrollLeft(uint8_t start, uint8_t stop)
 {
-    static const uint8_t scrollList2a[] = {SSD1306_LEFT_HORIZONTAL_SCROLL,
-                                                 0X00};
-    SSD1306_SendCommandList(scrollList2a, sizeof(scrollList2a));
-    SSD1306_Command(start);
-    SSD1306_Command(0X00);
-    SSD1306_Command(stop);
-    static const uint8_t scrollList2b[] = {0X00, 0XFF,
-                                                 SSD1306_ACTIVATE_SCROLL};
-    SSD1306_SendCommandList(scrollList2b, sizeof(scrollList2b));
+    return SSD1306_StartScroll(SSD1306_LEFT_HORIZONTAL_SCROLL, start, stop);
 }
     
 uint8_t SSD1306_StopScroll(void)
 {
-    SSD1306_Command(SSD1306_DEACTIVATE_SCROLL);
+    uint8_t i2c_err = SSD1306_Command(SSD1306_DEACTIVATE_SCROLL);
+    return i2c_err == I2C_NO_ERROR ? SSD1306_NO_ERROR : SSD1306_COMM_ERROR;
+}
+
+#if !SSD1306_NO_FRAMEBUFFER
+uint8_t SSD1306_ScrollColumn(uint8_t direction, uint8_t page_start, uint8_t page_end,
+                                uint8_t col_start, uint8_t col_end)
+{
+    uint8_t page;
+
+    if ((page_end >= SSD1306_PAGES) || (col_end >= SSD1306_WIDTH) ||
+        (page_start > page_end) || (col_start >= col_end))
+    {
+        return SSD1306_NO_ERROR;
+    }
+
+    const uint8_t dlist[] = { direction == SSD1306_SCROLL_LEFT ?
+                                    SSD1306_LEFT_CONTENT_SCROLL : SSD1306_RIGHT_CONTENT_SCROLL,
+                                0x00,
+                                page_start,
+                                0x01,
+                                page_end,
+                                col_start,
+                                col_end };
+
+    for (page = page_start; page <= page_end; page++)
+    {
+        uint8_t *row = &frame.bytes[page * SSD1306_WIDTH + col_start];
+        uint8_t n = col_end - col_start;
+        uint8_t wrap;
+
+        if (direction == SSD1306_SCROLL_LEFT)
+        {
+            wrap = row[0];
+            memmove(row, row + 1, n);
+            row[n] = wrap;
+        }
+        else
+        {
+            wrap = row[n];
+            memmove(row + 1, row, n);
+            row[0] = wrap;
+        }
+        // Pending changes moved with the content
+        if ((dirty_first[page] <= dirty_last[page]) &&
+            (dirty_first[page] <= col_end) && (dirty_last[page] >= col_start))
+        {
+            if (col_start < dirty_first[page])
+            {
+                dirty_first[page] = col_start;
+            }
+            if (col_end > dirty_last[page])
+            {
+                dirty_last[page] = col_end;
+            }
+        }
+    }
+
+    if (SSD1306_SendCommandList(dlist, sizeof(dlist)) != I2C_NO_ERROR)
+    {
+        // The controller may not have moved, or may have moved another
+        // window if the command was completed by NOPs: resend everything
+        memset(dirty_first, 0, sizeof(dirty_first));
+        memset(dirty_last, SSD1306_WIDTH - 1, sizeof(dirty_last));
+        return SSD1306_COMM_ERROR;
+    }
+    return SSD1306_NO_ERROR;
 }
+#endif
                                             
+void SSD1306_SetRotation(uint8_t rotation)
+{
+    settings.rotation = rotation & 0x03;
+    if (settings.rotation & 0x01)
+    {
+        settings.width = SSD1306_HEIGHT;
+        settings.height = SSD1306_WIDTH;
+    }
+    else
+    {
+        settings.width = SSD1306_WIDTH;
+        settings.height = SSD1306_HEIGHT;
+    }
+    SSD1306_ResetClip();
+}
+
+uint8_t SSD1306_GetRotation(void)
+{
+    return settings.rotation;
+}
+
+void SSD1306_SetAddress(uint8_t device_address)
+{
+    if (device_address != address)
+    {
+        SSD1306_ForgetRam();
+    }
+    address = device_address;
+}
+
+uint8_t SSD1306_GetAddress(void)
+{
+    return address;
+}
+
+void SSD1306_ForgetAddressing(uint8_t device_address)
+{
+    if (device_address == address)
+    {
+        SSD1306_ForgetRam();
+    }
+}
+
+void SSD1306_SetOrigin(int16_t x, int16_t y)
+{
+    settings.origin_x = x;
+    settings.origin_y = y;
+}
+
+void SSD1306_GetOrigin(int16_t *x, int16_t *y)
+{
+    *x = settings.origin_x;
+    *y = settings.origin_y;
+}
+
+uint8_t SSD1306_PushClip(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    if (clip_depth >= SSD1306_CLIP_DEPTH)
+    {
+        return SSD1306_CLIP_ERROR;
+    }
+    clip_stack[clip_depth++] = clip;
+
+    // Intersect with the current rectangle; an empty result has x1 <= x0
+    x += settings.origin_x;
+    y += settings.origin_y;
+    if (x > clip.x0)
+    {
+        clip.x0 = x;
+    }
+    if (y > clip.y0)
+    {
+        clip.y0 = y;
+    }
+    if (x + w < clip.x1)
+    {
+        clip.x1 = x + w;
+    }
+    if (y + h < clip.y1)
+    {
+        clip.y1 = y + h;
+    }
+    return SSD1306_NO_ERROR;
+}
+
+uint8_t SSD1306_PopClip(void)
+{
+    if (clip_depth == 0)
+    {
+        return SSD1306_CLIP_ERROR;
+    }
+    clip = clip_stack[--clip_depth];
+    return SSD1306_NO_ERROR;
+}
+
+void SSD1306_ResetClip(void)
+{
+    clip_depth = 0;
+    clip.x0 = 0;
+    clip.y0 = 0;
+    clip.x1 = settings.width;
+    clip.y1 = settings.height;
+}
+
+void SSD1306_GetClip(int16_t *x, int16_t *y, int16_t *w, int16_t *h)
+{
+    *x = clip.x0 - settings.origin_x;
+    *y = clip.y0 - settings.origin_y;
+    *w = (clip.x1 > clip.x0) ? clip.x1 - clip.x0 : 0;
+    *h = (clip.y1 > clip.y0) ? clip.y1 - clip.y0 : 0;
+}
+
+void SSD1306_GetControllerClip(int16_t *x, int16_t *y, int16_t *w, int16_t *h)
+{
+    *w = (clip.x1 > clip.x0) ? clip.x1 - clip.x0 : 0;
+    *h = (clip.y1 > clip.y0) ? clip.y1 - clip.y0 : 0;
+    switch (settings.rotation)
+    {
+        case 1:
+            SSD1306_Swap(*w, *h);
+            *x = SSD1306_WIDTH - clip.y0 - *w;
+            *y = clip.x0;
+            break;
+        case 2:
+            *x = SSD1306_WIDTH - clip.x0 - *w;
+            *y = SSD1306_HEIGHT - clip.y0 - *h;
+            break;
+        case 3:
+            SSD1306_Swap(*w, *h);
+            *x = clip.y0;
+            *y = SSD1306_HEIGHT - clip.x0 - *h;
+            break;
+        default:
+            *x = clip.x0;
+            *y = clip.y0;
+            break;
+    }
+}
+
 uint8_t SSD1306_GetWidth(void)
 {
     return settings.width;
@@ -502,6 +1597,57 @@ uint8_t SSD1306_GetWidth(void)
 uint8_t SSD1306_GetHeight(void)
 {
     return settings.height;
+}
+
+uint8 SSD1306_GetPixel(int16_t x, int16_t y)
+{
+    x += settings.origin_x;
+    y += settings.origin_y;
+    if ((x < 0) || (x >= settings.width) || (y < 0) || (y >= settings.height) ||
+        SSD1306_NO_TARGET())
+    {
+        return 0;
+    }
+    switch (settings.rotation) {
+        case 1:
+            SSD1306_Swap(x, y);
+            x = SSD1306_WIDTH - x - 1;
+            break;
+        case 2:
+            x = SSD1306_WIDTH - x - 1;
+            y = SSD1306_HEIGHT - y - 1;
+            break;
+        case 3:
+            SSD1306_Swap(x, y);
+            y = SSD1306_HEIGHT - y - 1;
+            break;
+    }
+    return (target[x + (y / 8) * SSD1306_WIDTH] >> (y & 7)) & 0x01;
+}
+
+uint8_t *SSD1306_GetBuffer(void)
+{
+    return target;
+}
+
+void SSD1306_SetTarget(uint8_t *pixels, uint8_t *first, uint8_t *last)
+{
+    if (pixels == NULL)
+    {
+#if SSD1306_NO_FRAMEBUFFER
+        target = NULL;
+#else
+        target = frame.bytes;
+#endif
+        target_first = dirty_first;
+        target_last = dirty_last;
+    }
+    else
+    {
+        target = pixels;
+        target_first = first;
+        target_last = last;
+    }
 }                                          
                                             
 /* [] END OF FILE */
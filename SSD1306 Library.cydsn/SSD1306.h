@@ -23,6 +23,107 @@
     
     #include "cytypes.h"
     
+    /**********************************
+    *          CONFIGURATION
+    **********************************/
+    
+    #ifndef SSD1306_I2C_ADDR
+        /**
+        *   \brief I2C address of the display (either 0x3C or 0x3D).
+        */
+        #define SSD1306_I2C_ADDR 0x3C
+    #endif
+    
+    #ifndef SSD1306_WIDTH
+        /**
+        *   \brief Width of the display in pixels.
+        */
+        #define SSD1306_WIDTH 128
+    #endif
+    
+    #ifndef SSD1306_HEIGHT
+        /**
+        *   \brief Height of the display in pixels (either 32 or 64).
+        */
+        #define SSD1306_HEIGHT 32
+    #endif
+    
+    #ifndef SSD1306_CLOCK_DIV
+        /**
+        *   \brief Value written with SETDISPLAYCLOCKDIV during #SSD1306_Start.
+        *
+        *   High nibble is the oscillator frequency setting, low nibble is
+        *   the divide ratio minus one. 0x80 is the value suggested by the datasheet.
+        */
+        #define SSD1306_CLOCK_DIV 0x80
+    #endif
+    
+    #ifndef SSD1306_FOSC_HZ
+        /**
+        *   \brief Nominal oscillator frequency for the configured oscillator setting.
+        *
+        *   Typical value for the reset setting (0x8) according to the datasheet.
+        *   Override it if the high nibble of #SSD1306_CLOCK_DIV is changed.
+        */
+        #define SSD1306_FOSC_HZ 370000UL
+    #endif
+    
+    #ifndef SSD1306_RESEND_ATTEMPTS
+        /**
+        *   \brief Times the unacknowledged pages of a refresh are sent again.
+        */
+        #define SSD1306_RESEND_ATTEMPTS 2
+    #endif
+    
+    #ifndef SSD1306_RESYNC_DEVICES
+        /**
+        *   \brief Displays whose cut commands are tracked at the same time.
+        *
+        *   A command cut by a failed transfer leaves its display waiting for
+        *   parameters, and NOPs are owed to that display before its next
+        *   command (see #SSD1306_SetAddress). If more displays than this are
+        *   owed NOPs at once, the first one is sent its NOPs right away to
+        *   make room, and stays out of step if that transfer fails too. The
+        *   default covers both addresses of an SSD1306.
+        */
+        #define SSD1306_RESYNC_DEVICES 2
+    #endif
+    
+    #ifndef SSD1306_NO_FRAMEBUFFER
+        /**
+        *   \brief Build without the display buffer.
+        *
+        *   When set to 1 the #SSD1306_BUFFER_SIZE bytes of the display buffer
+        *   are not allocated, and the functions that refresh the display from
+        *   it (#SSD1306_Display, #SSD1306_DisplayDirty, #SSD1306_DisplayWindow
+        *   and #SSD1306_ScrollColumn) are not available, nor are the modules
+        *   built on them (SSD1306_Canvas, SSD1306_Chart, SSD1306_Queue and
+        *   SSD1306_Stream). The display is then written with
+        *   #SSD1306_WriteWindow, e.g. by #SSD1306_Tile_Flush, which renders
+        *   page-aligned tiles straight to the controller. Drawing functions
+        *   only work on a buffer selected with #SSD1306_SetTarget, and do
+        *   nothing (#SSD1306_GetPixel returns 0) while none is selected.
+        */
+        #define SSD1306_NO_FRAMEBUFFER 0
+    #endif
+    
+    #ifndef SSD1306_CLIP_DEPTH
+        /**
+        *   \brief Maximum number of nested clip rectangles.
+        */
+        #define SSD1306_CLIP_DEPTH 8
+    #endif
+    
+    /**
+    *   \brief Number of 8-pixel pages of the display.
+    */
+    #define SSD1306_PAGES ((SSD1306_HEIGHT + 7) / 8)
+    
+    /**
+    *   \brief Size in bytes of a page-major frame buffer.
+    */
+    #define SSD1306_BUFFER_SIZE (SSD1306_WIDTH * SSD1306_PAGES)
+    
     /**********************************
     *          COLOR MACROS
     **********************************/
@@ -46,6 +147,44 @@
     
     #define SSD1306_WHITE_ON_BLACK 0
     
+    /**********************************
+    *          SCROLL DIRECTIONS
+    **********************************/
+    
+    /**
+    *   \brief Content moves towards higher columns.
+    */
+    #define SSD1306_SCROLL_RIGHT 0
+    
+    /**
+    *   \brief Content moves towards lower columns.
+    */
+    #define SSD1306_SCROLL_LEFT 1
+    
+    /**********************************
+    *          ADDRESSING MODES
+    **********************************/
+    
+    /**
+    *   \brief Pointer moves along the columns, then to the next page.
+    */
+    #define SSD1306_ADDRESSING_HORIZONTAL 0
+    
+    /**
+    *   \brief Pointer moves along the pages, then to the next column.
+    */
+    #define SSD1306_ADDRESSING_VERTICAL 1
+    
+    /**
+    *   \brief Pointer moves along the columns of a single page.
+    */
+    #define SSD1306_ADDRESSING_PAGE 2
+    
+    /**
+    *   \brief Mode chosen by the transfer planner for each update.
+    */
+    #define SSD1306_ADDRESSING_AUTO 3
+    
     /**********************************
     *          ERROR CODES
     **********************************/
@@ -60,17 +199,40 @@
     */
     #define SSD1306_COMM_ERROR  1
     
+    /**
+    *   \brief Clip stack overflow or underflow.
+    */
+    #define SSD1306_CLIP_ERROR  4
+    
     /**
     *   \brief Start the display.
     *
     *   This function initializes the display with the configured 
-    *   settings and prepares it for later use.
+    *   settings and prepares it for later use. The device is probed
+    *   once and then the whole initialization sequence is sent in a
+    *   single I2C transaction.
     *
     *   \retval #SSD1306_OK if device was found and initialized.
     *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication.
     */
     uint8_t SSD1306_Start(void);
     
+    /**
+    *   \brief Start a display that kept its configuration and content.
+    *
+    *   Use this function instead of #SSD1306_Start when the microcontroller
+    *   restarted but the display stayed powered, so that the controller
+    *   retained oscillator and charge pump configuration and the content
+    *   of its display RAM. Only the state the library relies on is restored,
+    *   and nothing is sent from the buffer: the next #SSD1306_DisplayDirty
+    *   only updates the regions drawn after the restart.
+    *
+    *   \retval #SSD1306_NO_ERROR if device was found and initialized.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication.
+    */
+    uint8_t SSD1306_StartWarm(void);
+    
+    #if !SSD1306_NO_FRAMEBUFFER
     /**
     *   \brief Refresh content of display.
     *
@@ -79,12 +241,112 @@
     *   buffer, which has a dimension dipending on display
     *   width and height, is sent over I2C. So make sure 
     *   to call this function when appropriate.
+    *   If the transfer fails, the pages that were not acknowledged
+    *   are sent again, up to #SSD1306_RESEND_ATTEMPTS times. Pages
+    *   still not sent are left dirty, so that #SSD1306_DisplayDirty
+    *   sends only them.
     *   
-    *   \retval #SSD1306_OK if device was found and initialized.
+    *   \retval #SSD1306_NO_ERROR if the whole buffer was sent.
     *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication.
     */
     uint8_t SSD1306_Display(void);
     
+    /**
+    *   \brief Refresh only the regions of the buffer changed since last refresh.
+    *
+    *   Drawing functions keep track, for each page, of the range of
+    *   columns they modified. This function sends only those windows
+    *   of the buffer, grouping consecutive dirty pages in a single
+    *   transfer. Nothing is sent if the buffer was not modified.
+    *   Pages are marked clean once acknowledged, so that after an
+    *   error the next call resumes from the first page not sent.
+    *
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication.
+    */
+    uint8_t SSD1306_DisplayDirty(void);
+    
+    /**
+    *   \brief Refresh a rectangular window of the display.
+    *
+    *   The window is expressed in controller coordinates (pages and
+    *   columns, not affected by rotation) and is sent with the
+    *   addressing mode selected by #SSD1306_SetAddressingMode. The
+    *   pages that were not acknowledged are sent again, up to
+    *   #SSD1306_RESEND_ATTEMPTS times, and are then left dirty.
+    *
+    *   \param page_start first page of the window.
+    *   \param page_end last page of the window (included).
+    *   \param col_start first column of the window.
+    *   \param col_end last column of the window (included).
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication.
+    */
+    uint8_t SSD1306_DisplayWindow(uint8_t page_start, uint8_t page_end,
+                                    uint8_t col_start, uint8_t col_end);
+    #endif
+    
+    /**
+    *   \brief Send page-major data to a window of the display.
+    *
+    *   Like #SSD1306_DisplayWindow, but the data does not come from the
+    *   display buffer, so that content can be rendered straight to the
+    *   controller without one. The window is in controller coordinates and
+    *   is sent with the addressing mode selected by
+    *   #SSD1306_SetAddressingMode.
+    *
+    *   \param page_start first page of the window.
+    *   \param page_end last page of the window (included).
+    *   \param col_start first column of the window.
+    *   \param col_end last column of the window (included).
+    *   \param data bytes of the window, starting from the first column of
+    *       the first page.
+    *   \param stride distance in bytes between two pages of data.
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication.
+    */
+    uint8_t SSD1306_WriteWindow(uint8_t page_start, uint8_t page_end,
+                                    uint8_t col_start, uint8_t col_end,
+                                    const uint8_t *data, uint16_t stride);
+    
+    /**
+    *   \brief Select the addressing mode used by the refresh functions.
+    *
+    *   In #SSD1306_ADDRESSING_AUTO mode (the default), the refresh functions
+    *   keep track of the address pointer of the controller and choose for
+    *   each window the addressing mode that sends the fewest bytes:
+    *   horizontal windows for rectangles, vertical windows for single
+    *   columns written one after the other, and page addressing, whose
+    *   setup commands take one byte each, for short runs. The mode is
+    *   switched only when the two bytes of the switch are paid back by the
+    *   update itself, and setup commands that would not change the pointer
+    *   are skipped.
+    *
+    *   A fixed mode is sent at once. It must be selected before writing
+    *   to the controller outside the refresh functions, e.g.
+    *   #SSD1306_ADDRESSING_HORIZONTAL for #SSD1306_Gray_Start.
+    *
+    *   \param mode one of the SSD1306_ADDRESSING_* modes.
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication.
+    */
+    uint8_t SSD1306_SetAddressingMode(uint8_t mode);
+    
+    /**
+    *   \brief Mark a region of the buffer as modified.
+    *
+    *   Drawing functions of this library mark the regions they change
+    *   automatically. Call this function after writing directly into
+    *   the buffer, so that #SSD1306_DisplayDirty sends the change.
+    *   Coordinates are in controller space (not affected by rotation).
+    *
+    *   \param x first column.
+    *   \param y first row.
+    *   \param w width of the region.
+    *   \param h height of the region.
+    */
+    void SSD1306_MarkDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+    
     /**
     *   \brief Clear current content of the display.
     *
@@ -121,6 +383,28 @@
     */
     uint8_t SSD1306_Dim(uint8_t dim);
     
+    /**
+    *   \brief Change display clock divide ratio and oscillator frequency.
+    *
+    *   \param clock_div new value for the SETDISPLAYCLOCKDIV command,
+    *   see #SSD1306_CLOCK_DIV.
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication.
+    */
+    uint8_t SSD1306_SetClockDiv(uint8_t clock_div);
+    
+    /**
+    *   \brief Get nominal frame rate of the controller.
+    *
+    *   The frame rate is computed from the datasheet formula
+    *   Ffrm = Fosc / (D * K * MUX), where D is the divide ratio,
+    *   K the number of display clocks per row (precharge phases plus 50)
+    *   and MUX the multiplex ratio. Fosc is #SSD1306_FOSC_HZ.
+    *
+    *   \return nominal frame rate in Hz.
+    */
+    uint16_t SSD1306_GetFrameRate(void);
+    
 
     
     void SSD1306_DrawPixel(int16_t x, int16_t y, uint16_t color);
@@ -129,22 +413,183 @@
     
     void SSD1306_DrawFastVLine(int16_t x, int16_t y, int16_t w, uint16_t color);
     
+    /**
+    *   \brief Activate a right-handed scroll for all or part of the display.
+    *
+    *   \param start first page for the scroll.
+    *   \param stop last page for the scroll.
+    *   \retval #SSD1306_NO_ERROR if no error occurred during configuration.
+    *   \retval #SSD1306_COMM_ERROR if I2C error occurred.
+    *
+    *   \note To scroll the whole display, run: SSD1306_StartScrollRight(0x00, 0x0F)
+    */
     uint8_t SSD1306_StartScrollRight(uint8_t start, uint8_t stop);
     
     /**
     *   \brief Activate a left-handed scroll for all or part of the display.
     *
-    *   \param start first row for the scroll.
-    *   \param stop last row for the scroll.
-    *   \retval #SSD1306_OK if no error occurred during configuration.
-    *   \retval #SSD1306_COMM_ERR if I2C error occurred.
+    *   \param start first page for the scroll.
+    *   \param stop last page for the scroll.
+    *   \retval #SSD1306_NO_ERROR if no error occurred during configuration.
+    *   \retval #SSD1306_COMM_ERROR if I2C error occurred.
     *
     *   \note To scroll the whole display, run: SSD1306_StartScrollLeft(0x00, 0x0F)
     */
     uint8_t SSD1306_StartScrollLeft(uint8_t start, uint8_t stop);
     
+    /**
+    *   \brief Stop the scroll started by #SSD1306_StartScrollRight or #SSD1306_StartScrollLeft.
+    *
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if I2C error occurred.
+    */
     uint8_t SSD1306_StopScroll(void);
     
+    #if !SSD1306_NO_FRAMEBUFFER
+    /**
+    *   \brief Scroll a window of the display content by one column.
+    *
+    *   The controller moves the window content by one column, the column
+    *   pushed out re-entering on the other side, and the buffer is moved
+    *   the same way so that the two stay in sync. Only the command is sent:
+    *   the column that re-entered can then be redrawn and sent alone with
+    *   #SSD1306_DisplayWindow. Pages of the window with pending changes are
+    *   marked dirty across the whole window.
+    *
+    *   The window is in controller coordinates and the scroll must be
+    *   stopped. The controller needs two frames (see #SSD1306_GetFrameRate)
+    *   to complete the scroll before the next one.
+    *
+    *   \param direction #SSD1306_SCROLL_RIGHT or #SSD1306_SCROLL_LEFT.
+    *   \param page_start first page of the window.
+    *   \param page_end last page of the window (included).
+    *   \param col_start first column of the window.
+    *   \param col_end last column of the window (included).
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication,
+    *       in which case the whole buffer is marked dirty.
+    */
+    uint8_t SSD1306_ScrollColumn(uint8_t direction, uint8_t page_start, uint8_t page_end,
+                                    uint8_t col_start, uint8_t col_end);
+    #endif
+    
+    /**
+    *   \brief Select the display the module talks to.
+    *
+    *   All the functions that send data over I2C use this address, which
+    *   defaults to #SSD1306_I2C_ADDR. Several displays on the same bus can
+    *   be started and refreshed by changing it in between. NOPs owed to
+    *   a display after a failed transfer are kept for that display, and
+    *   sent before its next command whichever displays were used since.
+    *
+    *   \param device_address 7-bit I2C address of the display.
+    */
+    void SSD1306_SetAddress(uint8_t device_address);
+    
+    /**
+    *   \brief Get the address of the display the module talks to.
+    *
+    *   \return 7-bit I2C address of the display.
+    */
+    uint8_t SSD1306_GetAddress(void);
+    
+    /**
+    *   \brief Forget the address pointer and window of a display.
+    *
+    *   Call it after the controller was written without this module, e.g.
+    *   by a panel of SSD1306_Wall on its own bus, so that the next refresh
+    *   sets up its window again instead of relying on a stale one.
+    *
+    *   \param device_address 7-bit I2C address of the display.
+    */
+    void SSD1306_ForgetAddressing(uint8_t device_address);
+    
+    /**
+    *   \brief Set rotation of the drawing coordinates.
+    *
+    *   \param rotation number of clockwise 90 degree steps, from 0 to 3.
+    *   Width and height are swapped for rotations 1 and 3. The clip
+    *   stack is reset.
+    */
+    void SSD1306_SetRotation(uint8_t rotation);
+    
+    /**
+    *   \brief Get rotation of the drawing coordinates.
+    *
+    *   \return number of clockwise 90 degree steps, from 0 to 3.
+    */
+    uint8_t SSD1306_GetRotation(void);
+    
+    /**
+    *   \brief Set the translation origin of the drawing coordinates.
+    *
+    *   All drawing coordinates (and clip rectangles) are relative to
+    *   the origin, which is given in rotated display coordinates.
+    *
+    *   \param x origin column.
+    *   \param y origin row.
+    */
+    void SSD1306_SetOrigin(int16_t x, int16_t y);
+    
+    /**
+    *   \brief Get the translation origin of the drawing coordinates.
+    *
+    *   \param x origin column.
+    *   \param y origin row.
+    */
+    void SSD1306_GetOrigin(int16_t *x, int16_t *y);
+    
+    /**
+    *   \brief Restrict drawing to a rectangle.
+    *
+    *   The new clip rectangle is the intersection of the given rectangle,
+    *   relative to the current origin, with the current clip rectangle.
+    *   Drawing outside it is rejected by every primitive.
+    *
+    *   \param x left column of the rectangle.
+    *   \param y top row of the rectangle.
+    *   \param w width of the rectangle.
+    *   \param h height of the rectangle.
+    *   \retval #SSD1306_NO_ERROR if the rectangle was pushed.
+    *   \retval #SSD1306_CLIP_ERROR if the stack already holds #SSD1306_CLIP_DEPTH rectangles.
+    */
+    uint8_t SSD1306_PushClip(int16_t x, int16_t y, int16_t w, int16_t h);
+    
+    /**
+    *   \brief Restore the clip rectangle active before the last #SSD1306_PushClip.
+    *
+    *   \retval #SSD1306_NO_ERROR if the rectangle was popped.
+    *   \retval #SSD1306_CLIP_ERROR if the stack is empty.
+    */
+    uint8_t SSD1306_PopClip(void);
+    
+    /**
+    *   \brief Empty the clip stack, so that the whole display can be drawn.
+    */
+    void SSD1306_ResetClip(void);
+    
+    /**
+    *   \brief Get the current clip rectangle, relative to the origin.
+    *
+    *   \param x left column of the rectangle.
+    *   \param y top row of the rectangle.
+    *   \param w width of the rectangle, 0 if nothing can be drawn.
+    *   \param h height of the rectangle, 0 if nothing can be drawn.
+    */
+    void SSD1306_GetClip(int16_t *x, int16_t *y, int16_t *w, int16_t *h);
+    
+    /**
+    *   \brief Get the current clip rectangle in controller coordinates.
+    *
+    *   Used by the primitives that write the buffer directly.
+    *
+    *   \param x left column of the rectangle.
+    *   \param y top row of the rectangle.
+    *   \param w width of the rectangle, 0 if nothing can be drawn.
+    *   \param h height of the rectangle, 0 if nothing can be drawn.
+    */
+    void SSD1306_GetControllerClip(int16_t *x, int16_t *y, int16_t *w, int16_t *h);
+    
     /**
     *   \brief Get current width of the display.
     *
@@ -164,7 +609,8 @@
     *
     *   \param x column of the display, from 0 (left) to width -1 (right).
     *   \param y row of the display, from 0 (top) to height -1 (bottom).
-    *   \return pixel value in the data buffer.
+    *   Coordinates are rotated and relative to the origin, as for drawing.
+    *   \return pixel value in the data buffer, 0 outside the display.
     *
     *   \note This function returns the value in the display buffer,
     *   so it may not be equal to what it is actually shown on the display,
@@ -172,8 +618,36 @@
     */
     uint8 SSD1306_GetPixel(int16_t x, int16_t y);
     
+    /**
+    *   \brief Get a pointer to the buffer written by the drawing functions.
+    *
+    *   This is the display buffer, unless another target was selected with
+    *   #SSD1306_SetTarget (NULL if none was selected and
+    *   #SSD1306_NO_FRAMEBUFFER is set). The buffer is page-major: byte
+    *   (x + page * #SSD1306_WIDTH) holds rows 8 * page to 8 * page + 7 of
+    *   column x, LSB on top. Coordinates are in controller space. After
+    *   writing into the buffer, call #SSD1306_MarkDirty so that the change
+    *   is tracked (and sent by #SSD1306_DisplayDirty).
+    *
+    *   \return pointer to the #SSD1306_BUFFER_SIZE bytes of the buffer.
+    */
     uint8_t *SSD1306_GetBuffer(void);
     
+    /**
+    *   \brief Redirect the drawing functions to another buffer.
+    *
+    *   Drawing functions, #SSD1306_ClearDisplay, #SSD1306_MarkDirty and
+    *   #SSD1306_GetBuffer then work on the given buffer and dirty map.
+    *   The refresh functions always send the display buffer.
+    *
+    *   \param pixels page-major buffer of #SSD1306_BUFFER_SIZE bytes,
+    *       NULL to draw into the display buffer again (to select no
+    *       buffer if #SSD1306_NO_FRAMEBUFFER is set).
+    *   \param first first modified column of each page, #SSD1306_PAGES bytes.
+    *   \param last last modified column of each page, #SSD1306_PAGES bytes.
+    */
+    void SSD1306_SetTarget(uint8_t *pixels, uint8_t *first, uint8_t *last);
+    
     
 #endif
 
@@ -0,0 +1,264 @@
+/**
+ *  \file SSD1306_Blit.c
+ *
+ *  \brief Source file for scaled and rotated blits.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306_Blit.h"
+#include "string.h"
+
+//***************************
+//          MACROS
+//***************************
+#define SSD1306_BLIT_MAX_BYTES 5    ///< Pages touched by a strip of 8 * #SSD1306_BLIT_MAX_SCALE rows
+
+/**
+*   \brief Each bit of a nibble repeated 2, 3 and 4 times, LSB first.
+*/
+static const uint16_t blit_expand[SSD1306_BLIT_MAX_SCALE - 1][16] = {
+    { 0x0000, 0x0003, 0x000C, 0x000F, 0x0030, 0x0033, 0x003C, 0x003F,
+      0x00C0, 0x00C3, 0x00CC, 0x00CF, 0x00F0, 0x00F3, 0x00FC, 0x00FF },
+    { 0x0000, 0x0007, 0x0038, 0x003F, 0x01C0, 0x01C7, 0x01F8, 0x01FF,
+      0x0E00, 0x0E07, 0x0E38, 0x0E3F, 0x0FC0, 0x0FC7, 0x0FF8, 0x0FFF },
+    { 0x0000, 0x000F, 0x00F0, 0x00FF, 0x0F00, 0x0F0F, 0x0FF0, 0x0FFF,
+      0xF000, 0xF00F, 0xF0F0, 0xF0FF, 0xFF00, 0xFF0F, 0xFFF0, 0xFFFF },
+};
+
+/**
+*   \brief Expand eight rows to a strip of 8 * scale rows.
+*
+*   \param bits rows, LSB on top.
+*   \param scale scale factor, 1 to #SSD1306_BLIT_MAX_SCALE.
+*   \return strip, LSB on top.
+*/
+static uint32_t SSD1306_Blit_Expand(uint8_t bits, uint8_t scale)
+{
+    const uint16_t *lut;
+
+    if (scale == 1)
+    {
+        return bits;
+    }
+    lut = blit_expand[scale - 2];
+    return lut[bits & 0x0F] | ((uint32_t)lut[bits >> 4] << (4 * scale));
+}
+
+/**
+*   \brief Transpose an 8x8 bit matrix.
+*
+*   Bit (8 * i + j) is moved to bit (8 * j + i): byte i of the result holds
+*   bit i of each input byte.
+*/
+static uint64_t SSD1306_Blit_Transpose(uint64_t m)
+{
+    uint64_t t;
+
+    t = (m ^ (m >> 7)) & 0x00AA00AA00AA00AAULL;
+    m ^= t ^ (t << 7);
+    t = (m ^ (m >> 14)) & 0x0000CCCC0000CCCCULL;
+    m ^= t ^ (t << 14);
+    t = (m ^ (m >> 28)) & 0x00000000F0F0F0F0ULL;
+    m ^= t ^ (t << 28);
+    return m;
+}
+
+/**
+*   \brief Reverse the order of the bits of a byte.
+*/
+static uint8_t SSD1306_Blit_Reverse(uint8_t b)
+{
+    b = (uint8_t)((b >> 4) | (b << 4));
+    b = (uint8_t)(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+    b = (uint8_t)(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+    return b;
+}
+
+void SSD1306_Blit_Draw(const uint8_t *image, uint8_t width, uint8_t height,
+                        int16_t x, int16_t y, uint8_t scale, uint8_t mode)
+{
+    uint8_t *buffer = SSD1306_GetBuffer();
+    uint8_t pages = (height + 7) / 8;
+    uint8_t strip = 8 * scale;
+    int16_t cx, cy, cw, ch;
+    int16_t x0, y0, x1, y1;
+    uint8_t page;
+
+    if ((scale == 0) || (scale > SSD1306_BLIT_MAX_SCALE))
+    {
+        return;
+    }
+
+    // Footprint of the image inside the clip rectangle
+    SSD1306_GetControllerClip(&cx, &cy, &cw, &ch);
+    x0 = (x > cx) ? x : cx;
+    y0 = (y > cy) ? y : cy;
+    x1 = (x + width * scale < cx + cw) ? x + width * scale : cx + cw;
+    y1 = (y + height * scale < cy + ch) ? y + height * scale : cy + ch;
+    if ((x0 >= x1) || (y0 >= y1) || (buffer == NULL))
+    {
+        return;
+    }
+
+    for (page = 0; page < pages; page++)
+    {
+        int16_t top = y + page * strip;
+        uint8_t rows = (height - page * 8 < 8) ? height - page * 8 : 8;
+        uint32_t footprint = SSD1306_Blit_Expand(0xFF >> (8 - rows), scale);
+        int16_t dst_page;
+        uint8_t shift, count, col, rep;
+        int16_t dx;
+
+        // Rows of the strip inside the clip rectangle
+        if (top < y0)
+        {
+            footprint = (y0 - top < 32) ? footprint & (0xFFFFFFFFUL << (y0 - top)) : 0;
+        }
+        if (top + strip > y1)
+        {
+            footprint = (y1 > top) ? footprint & ((1UL << (y1 - top)) - 1) : 0;
+        }
+        if (footprint == 0)
+        {
+            continue;
+        }
+
+        // Offset by whole pages so that the division rounds down for negative rows
+        dst_page = (top + 8 * SSD1306_PAGES * SSD1306_BLIT_MAX_SCALE) / 8
+                    - SSD1306_PAGES * SSD1306_BLIT_MAX_SCALE;
+        shift = top - dst_page * 8;
+        count = (shift + strip + 7) / 8;
+
+        col = (x0 - x) / scale;
+        rep = (x0 - x) % scale;
+        dx = x0;
+        while (dx < x1)
+        {
+            uint64_t value = (uint64_t)(SSD1306_Blit_Expand(image[col + page * width], scale) & footprint) << shift;
+            uint64_t mask = (uint64_t)footprint << shift;
+            uint8_t v[SSD1306_BLIT_MAX_BYTES], m[SSD1306_BLIT_MAX_BYTES];
+            uint8_t k;
+
+            for (k = 0; k < count; k++)
+            {
+                v[k] = (uint8_t)(value >> (8 * k));
+                m[k] = (uint8_t)(mask >> (8 * k));
+            }
+
+            // The same strip is written to scale columns
+            for (; (rep < scale) && (dx < x1); rep++, dx++)
+            {
+                for (k = 0; k < count; k++)
+                {
+                    uint8_t *dst;
+                    if (m[k] == 0)
+                    {
+                        continue;
+                    }
+                    dst = &buffer[(dst_page + k) * SSD1306_WIDTH + dx];
+                    switch (mode)
+                    {
+                        case SSD1306_BLIT_COPY:
+                            *dst = (*dst & ~m[k]) | v[k];
+                            break;
+                        case SSD1306_BLIT_OR:
+                            *dst |= v[k];
+                            break;
+                        case SSD1306_BLIT_AND:
+                            *dst &= v[k] | ~m[k];
+                            break;
+                        case SSD1306_BLIT_XOR:
+                            *dst ^= v[k];
+                            break;
+                    }
+                }
+            }
+            rep = 0;
+            col++;
+        }
+    }
+    SSD1306_MarkDirty(x0, y0, x1 - x0, y1 - y0);
+}
+
+void SSD1306_Blit_Rotate(const uint8_t *image, uint8_t width, uint8_t height,
+                            uint8_t orientation, uint8_t *dst)
+{
+    uint8_t pages = (height + 7) / 8;
+    uint8_t page, col, i;
+
+    switch (orientation)
+    {
+        case SSD1306_BLIT_ROTATE_0:
+            memcpy(dst, image, SSD1306_BLIT_SIZE(width, height));
+            if (height % 8)
+            {
+                for (col = 0; col < width; col++)
+                {
+                    dst[col + (pages - 1) * width] &= 0xFF >> (8 - height % 8);
+                }
+            }
+            break;
+
+        case SSD1306_BLIT_ROTATE_180:
+        {
+            // A column read bottom-up is its bytes in reverse order with
+            // reversed bits, shifted up by the unused rows of the last page
+            uint8_t pad = pages * 8 - height;
+            for (col = 0; col < width; col++)
+            {
+                const uint8_t *src = &image[width - 1 - col];
+                for (page = 0; page < pages; page++)
+                {
+                    uint8_t lo = SSD1306_Blit_Reverse(src[(pages - 1 - page) * width]);
+                    uint8_t hi = (page + 1 < pages) ? SSD1306_Blit_Reverse(src[(pages - 2 - page) * width]) : 0;
+                    dst[col + page * width] = (uint8_t)((lo >> pad) | (hi << (8 - pad)));
+                }
+            }
+            break;
+        }
+
+        case SSD1306_BLIT_ROTATE_90:
+        case SSD1306_BLIT_ROTATE_270:
+        {
+            // Each 8x8 block becomes a block of the rotated image: eight
+            // source columns give one destination page of eight columns
+            uint8_t dst_pages = (width + 7) / 8;
+            uint8_t dst_page;
+            for (dst_page = 0; dst_page < dst_pages; dst_page++)
+            {
+                for (page = 0; page < pages; page++)
+                {
+                    uint64_t block = 0;
+                    for (i = 0; i < 8; i++)
+                    {
+                        // Row (8 * dst_page + i) of the rotated image
+                        int16_t src_col = (orientation == SSD1306_BLIT_ROTATE_90)
+                                            ? dst_page * 8 + i : width - 1 - dst_page * 8 - i;
+                        if ((src_col >= 0) && (src_col < width))
+                        {
+                            block |= (uint64_t)image[src_col + page * width] << (8 * i);
+                        }
+                    }
+                    block = SSD1306_Blit_Transpose(block);
+                    for (i = 0; (i < 8) && (page * 8 + i < height); i++)
+                    {
+                        uint8_t row = page * 8 + i;
+                        uint8_t dst_col = (orientation == SSD1306_BLIT_ROTATE_90) ? height - 1 - row : row;
+                        dst[dst_col + dst_page * height] = (uint8_t)(block >> (8 * i));
+                    }
+                }
+            }
+            break;
+        }
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,130 @@
+/**
+ *   \file SSD1306_Blit.h
+ *
+ *   \brief Scaled and rotated blits of page-major images.
+ *
+ *   #SSD1306_Blit_Draw copies an image into the current render target at
+ *   1x to 4x integer scale. Each source byte (eight rows of a column) is
+ *   expanded with nibble lookup tables into a strip of 8 * scale rows,
+ *   which is then written with at most five byte operations per output
+ *   column, instead of drawing every pixel on its own.
+ *
+ *   #SSD1306_Blit_Rotate turns an image by 90, 180 or 270 degrees
+ *   clockwise into a second buffer. Quarter turns transpose 8x8 blocks
+ *   with shifts and masks on a 64-bit word; half turns reverse the bits of
+ *   each byte. The result is again page-major, so rotated icons can be
+ *   computed once and then drawn with #SSD1306_Blit_Draw.
+ *
+ *   Images are page-major, like the frame buffer: byte (x + page * width)
+ *   holds rows 8 * page to 8 * page + 7 of column x, LSB on top. Positions
+ *   are in controller coordinates, independent of the rotation set with
+ *   #SSD1306_SetRotation, and drawing is limited to the current clip
+ *   rectangle.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_BLIT_H__
+    #define __SSD1306_BLIT_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    /**
+    *   \brief Largest scale factor of #SSD1306_Blit_Draw.
+    */
+    #define SSD1306_BLIT_MAX_SCALE 4
+
+    /**
+    *   \brief Size in bytes of a page-major image.
+    */
+    #define SSD1306_BLIT_SIZE(width, height) ((width) * (((height) + 7) / 8))
+
+    /**********************************
+    *          DRAWING MODES
+    **********************************/
+
+    /**
+    *   \brief Image replaces the pixels it covers.
+    */
+    #define SSD1306_BLIT_COPY 0
+
+    /**
+    *   \brief Set pixels where the image is set.
+    */
+    #define SSD1306_BLIT_OR 1
+
+    /**
+    *   \brief Clear pixels where the image is clear.
+    */
+    #define SSD1306_BLIT_AND 2
+
+    /**
+    *   \brief Invert pixels where the image is set.
+    */
+    #define SSD1306_BLIT_XOR 3
+
+    /**********************************
+    *          ORIENTATIONS
+    **********************************/
+
+    /**
+    *   \brief Image as stored.
+    */
+    #define SSD1306_BLIT_ROTATE_0 0
+
+    /**
+    *   \brief Image turned by 90 degrees clockwise.
+    */
+    #define SSD1306_BLIT_ROTATE_90 1
+
+    /**
+    *   \brief Image turned by 180 degrees.
+    */
+    #define SSD1306_BLIT_ROTATE_180 2
+
+    /**
+    *   \brief Image turned by 270 degrees clockwise.
+    */
+    #define SSD1306_BLIT_ROTATE_270 3
+
+    /**
+    *   \brief Draw a page-major image at an integer scale.
+    *
+    *   \param image page-major image.
+    *   \param width width of the image in pixels.
+    *   \param height height of the image in pixels.
+    *   \param x column of the top-left corner, in controller coordinates.
+    *   \param y row of the top-left corner, in controller coordinates.
+    *   \param scale scale factor, 1 to #SSD1306_BLIT_MAX_SCALE.
+    *   \param mode drawing mode, one of the SSD1306_BLIT_* modes.
+    */
+    void SSD1306_Blit_Draw(const uint8_t *image, uint8_t width, uint8_t height,
+                            int16_t x, int16_t y, uint8_t scale, uint8_t mode);
+
+    /**
+    *   \brief Rotate a page-major image.
+    *
+    *   After a quarter turn the image is height pixels wide and width pixels
+    *   high, so dst must hold #SSD1306_BLIT_SIZE(height, width) bytes;
+    *   otherwise it must hold #SSD1306_BLIT_SIZE(width, height) bytes. Unused
+    *   rows of the last page of dst are cleared. dst must not overlap image.
+    *
+    *   \param image page-major image.
+    *   \param width width of the image in pixels.
+    *   \param height height of the image in pixels.
+    *   \param orientation one of the SSD1306_BLIT_ROTATE_* orientations.
+    *   \param dst page-major rotated image.
+    */
+    void SSD1306_Blit_Rotate(const uint8_t *image, uint8_t width, uint8_t height,
+                                uint8_t orientation, uint8_t *dst);
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,184 @@
+/**
+ *  \file SSD1306_Canvas.c
+ *
+ *  \brief Source file for off-screen layers.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306_Canvas.h"
+#include "string.h"
+
+#if !SSD1306_NO_FRAMEBUFFER
+
+/**
+*   \brief Mark a canvas as clean.
+*
+*   \param canvas canvas state.
+*/
+static void SSD1306_Canvas_ClearDirty(SSD1306_Canvas *canvas)
+{
+    memset(canvas->dirty_first, 0xFF, sizeof(canvas->dirty_first));
+    memset(canvas->dirty_last, 0x00, sizeof(canvas->dirty_last));
+}
+
+/**
+*   \brief Extend a column range with the modified columns of a page of a canvas.
+*/
+static void SSD1306_Canvas_UnionDirty(const SSD1306_Canvas *canvas, uint8_t page,
+                                        uint8_t *first, uint8_t *last)
+{
+    if (canvas->dirty_first[page] < *first)
+    {
+        *first = canvas->dirty_first[page];
+    }
+    if ((canvas->dirty_first[page] <= canvas->dirty_last[page]) &&
+        (canvas->dirty_last[page] > *last))
+    {
+        *last = canvas->dirty_last[page];
+    }
+}
+
+void SSD1306_Canvas_Init(SSD1306_Canvas *canvas, uint32_t *pixels, uint8_t op)
+{
+    canvas->pixels = pixels;
+    canvas->mask = NULL;
+    canvas->op = op;
+    canvas->visible = 1;
+    memset(pixels, 0, SSD1306_BUFFER_SIZE);
+    SSD1306_Canvas_Invalidate(canvas);
+}
+
+void SSD1306_Canvas_SetMask(SSD1306_Canvas *canvas, SSD1306_Canvas *mask)
+{
+    canvas->mask = mask;
+    SSD1306_Canvas_Invalidate(canvas);
+}
+
+void SSD1306_Canvas_SetVisible(SSD1306_Canvas *canvas, uint8_t visible)
+{
+    if (canvas->visible != visible)
+    {
+        canvas->visible = visible;
+        SSD1306_Canvas_Invalidate(canvas);
+    }
+}
+
+void SSD1306_Canvas_Invalidate(SSD1306_Canvas *canvas)
+{
+    memset(canvas->dirty_first, 0x00, sizeof(canvas->dirty_first));
+    memset(canvas->dirty_last, SSD1306_WIDTH - 1, sizeof(canvas->dirty_last));
+}
+
+void SSD1306_Canvas_Begin(SSD1306_Canvas *canvas)
+{
+    SSD1306_SetTarget((uint8_t *)canvas->pixels, canvas->dirty_first, canvas->dirty_last);
+}
+
+void SSD1306_Canvas_End(void)
+{
+    SSD1306_SetTarget(NULL, NULL, NULL);
+}
+
+uint8_t SSD1306_Canvas_Compose(SSD1306_Canvas *const *layers, uint8_t count)
+{
+    uint32_t *frame;
+    uint8_t composed = 0;
+    uint8_t page, i;
+
+    SSD1306_SetTarget(NULL, NULL, NULL);
+    frame = (uint32_t *)SSD1306_GetBuffer();
+
+    for (page = 0; page < SSD1306_PAGES; page++)
+    {
+        uint8_t first = 0xFF, last = 0x00;
+        int16_t changed_first = -1, changed_last = -1;
+        uint16_t base = page * (SSD1306_WIDTH / 4);
+        uint16_t w;
+
+        // Columns changed in any layer, visible or not (hiding a layer
+        // invalidates it)
+        for (i = 0; i < count; i++)
+        {
+            SSD1306_Canvas_UnionDirty(layers[i], page, &first, &last);
+            if ((layers[i]->op == SSD1306_CANVAS_MASK) && (layers[i]->mask != NULL))
+            {
+                SSD1306_Canvas_UnionDirty(layers[i]->mask, page, &first, &last);
+            }
+        }
+        if (first > last)
+        {
+            continue;
+        }
+        composed++;
+
+        for (w = base + first / 4; w <= base + last / 4; w++)
+        {
+            uint32_t value = 0;
+            for (i = 0; i < count; i++)
+            {
+                const SSD1306_Canvas *layer = layers[i];
+                uint32_t mask;
+
+                if (!layer->visible)
+                {
+                    continue;
+                }
+                switch (layer->op)
+                {
+                    case SSD1306_CANVAS_COPY:
+                        value = layer->pixels[w];
+                        break;
+                    case SSD1306_CANVAS_OR:
+                        value |= layer->pixels[w];
+                        break;
+                    case SSD1306_CANVAS_AND:
+                        value &= layer->pixels[w];
+                        break;
+                    case SSD1306_CANVAS_XOR:
+                        value ^= layer->pixels[w];
+                        break;
+                    case SSD1306_CANVAS_MASK:
+                        mask = (layer->mask != NULL) ? layer->mask->pixels[w] : 0xFFFFFFFFUL;
+                        value = (value & ~mask) | (layer->pixels[w] & mask);
+                        break;
+                }
+            }
+            if (value != frame[w])
+            {
+                frame[w] = value;
+                if (changed_first < 0)
+                {
+                    changed_first = w - base;
+                }
+                changed_last = w - base;
+            }
+        }
+        if (changed_first >= 0)
+        {
+            SSD1306_MarkDirty(changed_first * 4, page * 8,
+                                (changed_last - changed_first + 1) * 4, 8);
+        }
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        SSD1306_Canvas_ClearDirty(layers[i]);
+        if (layers[i]->mask != NULL)
+        {
+            SSD1306_Canvas_ClearDirty(layers[i]->mask);
+        }
+    }
+    return composed;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,149 @@
+/**
+ *   \file SSD1306_Canvas.h
+ *
+ *   \brief Off-screen layers composited into the frame buffer.
+ *
+ *   A canvas is a page-major buffer with the same format as the display
+ *   buffer and its own dirty map. Between #SSD1306_Canvas_Begin and
+ *   #SSD1306_Canvas_End all the drawing functions of the library write into
+ *   the canvas instead of the display buffer.
+ *
+ *   #SSD1306_Canvas_Compose combines a stack of canvases, bottom first,
+ *   into the display buffer. Only the columns that changed in some layer
+ *   since the last composition are recomputed, four columns at a time
+ *   with 32-bit operations, and only the bytes whose value changed are
+ *   marked dirty. The cost of an update therefore depends on what changed,
+ *   not on how many layers make up the screen.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_CANVAS_H__
+    #define __SSD1306_CANVAS_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    #if !SSD1306_NO_FRAMEBUFFER
+
+    #if (SSD1306_WIDTH % 4) != 0
+        #error "SSD1306_Canvas requires a display width multiple of 4"
+    #endif
+
+    /**
+    *   \brief Number of 32-bit words of the storage of a canvas.
+    */
+    #define SSD1306_CANVAS_WORDS (SSD1306_BUFFER_SIZE / 4)
+
+    /**********************************
+    *          COMPOSITION OPERATIONS
+    **********************************/
+
+    /**
+    *   \brief Layer replaces what is below.
+    */
+    #define SSD1306_CANVAS_COPY 0
+
+    /**
+    *   \brief Set pixels of the layer are added to what is below.
+    */
+    #define SSD1306_CANVAS_OR 1
+
+    /**
+    *   \brief Clear pixels of the layer are cleared in what is below.
+    */
+    #define SSD1306_CANVAS_AND 2
+
+    /**
+    *   \brief Set pixels of the layer invert what is below.
+    */
+    #define SSD1306_CANVAS_XOR 3
+
+    /**
+    *   \brief Layer replaces what is below where its mask canvas is set.
+    */
+    #define SSD1306_CANVAS_MASK 4
+
+    /**
+    *   \brief State of a canvas.
+    */
+    typedef struct SSD1306_Canvas {
+        uint32_t *pixels;                       ///< Page-major storage, #SSD1306_CANVAS_WORDS words
+        uint8_t dirty_first[SSD1306_PAGES];     ///< First modified column of each page
+        uint8_t dirty_last[SSD1306_PAGES];      ///< Last modified column of each page
+        struct SSD1306_Canvas *mask;            ///< Mask used by #SSD1306_CANVAS_MASK
+        uint8_t op;                             ///< Composition operation
+        uint8_t visible;                        ///< Layer is composited
+    } SSD1306_Canvas;
+
+    /**
+    *   \brief Initialize a visible, blank canvas.
+    *
+    *   \param canvas canvas state.
+    *   \param pixels storage of #SSD1306_CANVAS_WORDS words.
+    *   \param op composition operation, one of the SSD1306_CANVAS_* operations.
+    */
+    void SSD1306_Canvas_Init(SSD1306_Canvas *canvas, uint32_t *pixels, uint8_t op);
+
+    /**
+    *   \brief Set the mask of a #SSD1306_CANVAS_MASK layer.
+    *
+    *   The mask is a canvas too; changes drawn into it are tracked like
+    *   changes of the layer.
+    *
+    *   \param canvas canvas state.
+    *   \param mask mask canvas.
+    */
+    void SSD1306_Canvas_SetMask(SSD1306_Canvas *canvas, SSD1306_Canvas *mask);
+
+    /**
+    *   \brief Show or hide a layer.
+    *
+    *   \param canvas canvas state.
+    *   \param visible 1 to composite the layer, 0 to skip it.
+    */
+    void SSD1306_Canvas_SetVisible(SSD1306_Canvas *canvas, uint8_t visible);
+
+    /**
+    *   \brief Mark the whole canvas as modified.
+    *
+    *   \param canvas canvas state.
+    */
+    void SSD1306_Canvas_Invalidate(SSD1306_Canvas *canvas);
+
+    /**
+    *   \brief Redirect the drawing functions to a canvas.
+    *
+    *   \param canvas canvas state.
+    */
+    void SSD1306_Canvas_Begin(SSD1306_Canvas *canvas);
+
+    /**
+    *   \brief Redirect the drawing functions to the display buffer again.
+    */
+    void SSD1306_Canvas_End(void);
+
+    /**
+    *   \brief Composite a stack of layers into the display buffer.
+    *
+    *   Layers are applied bottom first, starting from a blank page. The
+    *   dirty maps of the layers (and of their masks) are cleared. Drawing
+    *   is redirected to the display buffer.
+    *
+    *   \param layers layers, bottom first.
+    *   \param count number of layers.
+    *   \return number of pages that were recomposited.
+    */
+    uint8_t SSD1306_Canvas_Compose(SSD1306_Canvas *const *layers, uint8_t count);
+
+    #endif
+
+#endif
+
+/* [] END OF FILE */
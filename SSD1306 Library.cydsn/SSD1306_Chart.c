@@ -0,0 +1,222 @@
+/**
+ *  \file SSD1306_Chart.c
+ *
+ *  \brief Source file for the strip chart.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306_Chart.h"
+
+#if !SSD1306_NO_FRAMEBUFFER
+
+/**
+*   \brief Get the band row of a sample, 0 being the top row.
+*
+*   \param chart chart state.
+*   \param sample sample value.
+*   \return row of the sample.
+*/
+static int16_t SSD1306_Chart_Row(const SSD1306_Chart *chart, int16_t sample)
+{
+    int16_t rows = (chart->page_end - chart->page_start + 1) * 8;
+
+    if (sample <= chart->min)
+    {
+        return rows - 1;
+    }
+    if (sample >= chart->max)
+    {
+        return 0;
+    }
+    return rows - 1 - (int16_t)(((int32_t)(sample - chart->min) * (rows - 1) +
+                                    (chart->max - chart->min) / 2) / (chart->max - chart->min));
+}
+
+/**
+*   \brief Render one column of the band.
+*
+*   The rows from the previous sample to the sample are set, all the other
+*   rows of the column are cleared.
+*
+*   \param chart chart state.
+*   \param col column of the band.
+*   \param row row of the sample, negative for a blank column.
+*   \param prev row of the previous sample, negative to draw a single point.
+*/
+static void SSD1306_Chart_Column(const SSD1306_Chart *chart, uint8_t col,
+                                    int16_t row, int16_t prev)
+{
+    uint8_t *dst = &SSD1306_GetBuffer()[chart->page_start * SSD1306_WIDTH + chart->x + col];
+    int16_t y0 = row, y1 = row;
+    uint8_t page;
+
+    if ((prev >= 0) && (row >= 0))
+    {
+        y0 = (prev < row) ? prev : row;
+        y1 = (prev > row) ? prev : row;
+    }
+    for (page = chart->page_start; page <= chart->page_end; page++)
+    {
+        int16_t top = (page - chart->page_start) * 8;
+        uint8_t bits = 0;
+
+        // Same masks as a vertical line: rows y0 to y1 falling in the page
+        if ((row >= 0) && (y0 < top + 8) && (y1 >= top))
+        {
+            bits = 0xFF;
+            if (y0 > top)
+            {
+                bits &= 0xFF << (y0 - top);
+            }
+            if (y1 < top + 7)
+            {
+                bits &= 0xFF >> (top + 7 - y1);
+            }
+        }
+        *dst = bits;
+        dst += SSD1306_WIDTH;
+    }
+}
+
+/**
+*   \brief Get a sample of the ring buffer.
+*
+*   \param chart chart state.
+*   \param age 0 for the newest sample, 1 for the one before and so on.
+*   \return row of the sample, -1 if there is no such sample.
+*/
+static int16_t SSD1306_Chart_RowAt(const SSD1306_Chart *chart, uint8_t age)
+{
+    if (age >= chart->count)
+    {
+        return -1;
+    }
+    return SSD1306_Chart_Row(chart,
+                chart->samples[(chart->head + chart->width - 1 - age) % chart->width]);
+}
+
+void SSD1306_Chart_Init(SSD1306_Chart *chart, int16_t *samples, uint8_t x,
+                            uint8_t width, uint8_t page_start, uint8_t pages,
+                            int16_t min, int16_t max, uint8_t mode)
+{
+    chart->samples = samples;
+    chart->head = 0;
+    chart->count = 0;
+    chart->x = x;
+    chart->width = width;
+    chart->page_start = page_start;
+    chart->page_end = page_start + pages - 1;
+    chart->mode = mode;
+    chart->min = min;
+    chart->max = max;
+    SSD1306_Chart_Redraw(chart);
+}
+
+void SSD1306_Chart_SetRange(SSD1306_Chart *chart, int16_t min, int16_t max)
+{
+    chart->min = min;
+    chart->max = max;
+    SSD1306_Chart_Redraw(chart);
+}
+
+void SSD1306_Chart_Redraw(SSD1306_Chart *chart)
+{
+    uint8_t col, age;
+    int16_t prev;
+
+    for (col = 0; col < chart->width; col++)
+    {
+        if (chart->mode == SSD1306_CHART_SCROLL)
+        {
+            // Newest sample in the last column
+            age = chart->width - 1 - col;
+            prev = SSD1306_Chart_RowAt(chart, age + 1);
+        }
+        else if (col == chart->head)
+        {
+            // Blank column at the cursor
+            SSD1306_Chart_Column(chart, col, -1, -1);
+            continue;
+        }
+        else
+        {
+            // Sample i in column i, the one after the cursor has no predecessor on screen
+            age = (chart->head + chart->width - 1 - col) % chart->width;
+            prev = (col == (chart->head + 1) % chart->width) ? -1 :
+                        SSD1306_Chart_RowAt(chart, age + 1);
+        }
+        SSD1306_Chart_Column(chart, col, SSD1306_Chart_RowAt(chart, age), prev);
+    }
+    SSD1306_MarkDirty(chart->x, chart->page_start * 8, chart->width,
+                        (chart->page_end - chart->page_start + 1) * 8);
+}
+
+uint8_t SSD1306_Chart_Push(SSD1306_Chart *chart, int16_t sample)
+{
+    uint8_t col = chart->head;
+    uint8_t last = chart->x + chart->width - 1;
+    uint8_t err;
+
+    chart->samples[chart->head] = sample;
+    chart->head = (chart->head + 1) % chart->width;
+    if (chart->count < chart->width)
+    {
+        chart->count++;
+    }
+
+    if (chart->mode == SSD1306_CHART_SCROLL)
+    {
+        err = SSD1306_ScrollColumn(SSD1306_SCROLL_LEFT, chart->page_start, chart->page_end,
+                                    chart->x, last);
+        SSD1306_Chart_Column(chart, chart->width - 1, SSD1306_Chart_RowAt(chart, 0),
+                                SSD1306_Chart_RowAt(chart, 1));
+        if (err == SSD1306_NO_ERROR)
+        {
+            err = SSD1306_DisplayWindow(chart->page_start, chart->page_end, last, last);
+        }
+        if (err != SSD1306_NO_ERROR)
+        {
+            SSD1306_MarkDirty(last, chart->page_start * 8, 1,
+                                (chart->page_end - chart->page_start + 1) * 8);
+        }
+        return err;
+    }
+
+    // Sweep: sample at the cursor, blank column after it
+    SSD1306_Chart_Column(chart, col, SSD1306_Chart_RowAt(chart, 0),
+                            SSD1306_Chart_RowAt(chart, 1));
+    SSD1306_Chart_Column(chart, chart->head, -1, -1);
+    if (chart->head == col + 1)
+    {
+        err = SSD1306_DisplayWindow(chart->page_start, chart->page_end,
+                                    chart->x + col, chart->x + col + 1);
+    }
+    else
+    {
+        err = SSD1306_DisplayWindow(chart->page_start, chart->page_end,
+                                    chart->x + col, chart->x + col);
+        if (err == SSD1306_NO_ERROR)
+        {
+            err = SSD1306_DisplayWindow(chart->page_start, chart->page_end,
+                                        chart->x, chart->x);
+        }
+    }
+    if (err != SSD1306_NO_ERROR)
+    {
+        SSD1306_MarkDirty(chart->x, chart->page_start * 8, chart->width,
+                            (chart->page_end - chart->page_start + 1) * 8);
+    }
+    return err;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,122 @@
+/**
+ *   \file SSD1306_Chart.h
+ *
+ *   \brief Strip chart updated one column per sample.
+ *
+ *   A chart keeps the last samples in a ring buffer and occupies a band of
+ *   whole pages of the display. Adding a sample renders a single column of
+ *   the band, the trace joining the previous sample with a vertical span,
+ *   and sends only that column:
+ *     - #SSD1306_CHART_SCROLL: the band is moved left by one column with
+ *       the controller content scroll (#SSD1306_ScrollColumn) and the new
+ *       sample appears on the right;
+ *     - #SSD1306_CHART_SWEEP: the band is not moved, the new sample is
+ *       written at a cursor that wraps around, followed by a blank column.
+ *
+ *   Either way a sample costs one or two columns of the band plus a few
+ *   command bytes on the bus, instead of a whole frame.
+ *
+ *   Coordinates are in controller space. The chart writes to the display
+ *   buffer, so it must not be used while a canvas is the render target.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_CHART_H__
+    #define __SSD1306_CHART_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    #if !SSD1306_NO_FRAMEBUFFER
+
+    /**********************************
+    *          CHART MODES
+    **********************************/
+
+    /**
+    *   \brief Content scrolls left, newest sample on the right.
+    */
+    #define SSD1306_CHART_SCROLL 0
+
+    /**
+    *   \brief Content stays, newest sample at a wrapping cursor.
+    */
+    #define SSD1306_CHART_SWEEP 1
+
+    /**
+    *   \brief State of a chart.
+    */
+    typedef struct {
+        int16_t *samples;       ///< Ring buffer, one sample per column
+        uint8_t head;           ///< Index of the next sample
+        uint8_t count;          ///< Number of samples stored
+        uint8_t x;              ///< First column of the band
+        uint8_t width;          ///< Number of columns of the band
+        uint8_t page_start;     ///< First page of the band
+        uint8_t page_end;       ///< Last page of the band
+        uint8_t mode;           ///< Chart mode
+        int16_t min;            ///< Value drawn on the bottom row
+        int16_t max;            ///< Value drawn on the top row
+    } SSD1306_Chart;
+
+    /**
+    *   \brief Initialize an empty chart and clear its band.
+    *
+    *   \param chart chart state.
+    *   \param samples storage of width samples.
+    *   \param x first column of the band.
+    *   \param width number of columns of the band, at least 2.
+    *   \param page_start first page of the band.
+    *   \param pages number of pages of the band.
+    *   \param min value drawn on the bottom row.
+    *   \param max value drawn on the top row, greater than min.
+    *   \param mode #SSD1306_CHART_SCROLL or #SSD1306_CHART_SWEEP.
+    */
+    void SSD1306_Chart_Init(SSD1306_Chart *chart, int16_t *samples, uint8_t x,
+                                uint8_t width, uint8_t page_start, uint8_t pages,
+                                int16_t min, int16_t max, uint8_t mode);
+
+    /**
+    *   \brief Change the vertical range and redraw the chart.
+    *
+    *   \param chart chart state.
+    *   \param min value drawn on the bottom row.
+    *   \param max value drawn on the top row, greater than min.
+    */
+    void SSD1306_Chart_SetRange(SSD1306_Chart *chart, int16_t min, int16_t max);
+
+    /**
+    *   \brief Draw the whole chart into the buffer.
+    *
+    *   The band is marked dirty and sent by the next #SSD1306_DisplayDirty.
+    *
+    *   \param chart chart state.
+    */
+    void SSD1306_Chart_Redraw(SSD1306_Chart *chart);
+
+    /**
+    *   \brief Add a sample, and update the display.
+    *
+    *   In #SSD1306_CHART_SCROLL mode samples must not be added faster than
+    *   half the frame rate of the controller.
+    *
+    *   \param chart chart state.
+    *   \param sample new sample, clamped to the range of the chart.
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication,
+    *       in which case the columns not sent are marked dirty.
+    */
+    uint8_t SSD1306_Chart_Push(SSD1306_Chart *chart, int16_t sample);
+
+    #endif
+
+#endif
+
+/* [] END OF FILE */
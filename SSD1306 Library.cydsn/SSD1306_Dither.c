@@ -0,0 +1,215 @@
+/**
+ *  \file SSD1306_Dither.c
+ *
+ *  \brief Source file for streaming image dithering.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306_Dither.h"
+#include "string.h"
+
+/**
+*   \brief Pack the bit of column i into the page being built.
+*
+*   Bits of four consecutive columns are collected in a 32-bit word, one
+*   per byte (little-endian, as on Cortex-M), and then shifted into the row
+*   position and or-ed into the page with a single word operation.
+*/
+#define SSD1306_DITHER_PACK(i, bit)                                             \
+    do {                                                                        \
+        word |= (uint32_t)(bit) << (((i) & 3) * 8);                             \
+        if (((i) & 3) == 3)                                                     \
+        {                                                                       \
+            page_bits.words[(i) >> 2] |= word << shift;                         \
+            word = 0;                                                           \
+        }                                                                       \
+    } while (0)
+
+/**
+*   \brief Struct with state of the conversion.
+*/
+static struct {
+    int16_t x;          ///< First visible column
+    int16_t y;          ///< Display row of next image row
+    uint16_t skip;      ///< Image columns on the left of the display
+    uint16_t cols;      ///< Visible columns
+    uint8_t mode;       ///< Dithering mode
+    uint8_t mask;       ///< Rows of the current page already converted
+} dither;
+
+// Page being built, one byte per visible column
+static union {
+    uint32_t words[(SSD1306_WIDTH + 3) / 4];
+    uint8_t bytes[((SSD1306_WIDTH + 3) / 4) * 4];
+} page_bits;
+
+// Diffused error, in 1/16 of gray level, for the next two rows.
+// Index c + 1 holds column c, index 0 is a guard for column -1.
+static int16_t err_next[SSD1306_WIDTH + 2];
+static int16_t err_next2[SSD1306_WIDTH + 2];
+
+// 8x8 Bayer matrix
+static const uint8_t bayer[8][8] = {
+    { 0, 32,  8, 40,  2, 34, 10, 42},
+    {48, 16, 56, 24, 50, 18, 58, 26},
+    {12, 44,  4, 36, 14, 46,  6, 38},
+    {60, 28, 52, 20, 62, 30, 54, 22},
+    { 3, 35, 11, 43,  1, 33,  9, 41},
+    {51, 19, 59, 27, 49, 17, 57, 25},
+    {15, 47,  7, 39, 13, 45,  5, 37},
+    {63, 31, 55, 23, 61, 29, 53, 21}
+};
+
+/**
+*   \brief Write the page being built into the display buffer.
+*
+*   \param row last display row converted.
+*/
+static void SSD1306_Dither_Flush(int16_t row)
+{
+    if ((row >= 0) && (row < SSD1306_HEIGHT) && (dither.cols > 0) && (SSD1306_GetBuffer() != NULL))
+    {
+        uint8_t *pBuf = SSD1306_GetBuffer() + (row / 8) * SSD1306_WIDTH + dither.x;
+        uint8_t mask = dither.mask;
+        uint16_t i;
+        for (i = 0; i < dither.cols; i++)
+        {
+            pBuf[i] = (pBuf[i] & ~mask) | (page_bits.bytes[i] & mask);
+        }
+        SSD1306_MarkDirty(dither.x, (row / 8) * 8, dither.cols, 8);
+    }
+    memset(&page_bits, 0, sizeof(page_bits));
+    dither.mask = 0;
+}
+
+void SSD1306_Dither_Begin(int16_t x, int16_t y, uint16_t width, uint8_t mode)
+{
+    dither.skip = 0;
+    if (x < 0)
+    {
+        dither.skip = -x;
+        x = 0;
+    }
+    dither.cols = 0;
+    if ((width > dither.skip) && (x < SSD1306_WIDTH))
+    {
+        dither.cols = width - dither.skip;
+        if ((x + dither.cols) > SSD1306_WIDTH)
+        {
+            dither.cols = SSD1306_WIDTH - x;
+        }
+    }
+    dither.x = x;
+    dither.y = y;
+    dither.mode = mode;
+    dither.mask = 0;
+    memset(&page_bits, 0, sizeof(page_bits));
+    memset(err_next, 0, sizeof(err_next));
+    memset(err_next2, 0, sizeof(err_next2));
+}
+
+void SSD1306_Dither_WriteRow(const uint8_t *row)
+{
+    const uint8_t *src = row + dither.skip;
+    uint8_t shift = dither.y & 7;
+    uint32_t word = 0;
+    uint16_t i;
+
+    switch (dither.mode)
+    {
+        case SSD1306_DITHER_BAYER:
+        {
+            const uint8_t *thresholds = bayer[dither.y & 7];
+            for (i = 0; i < dither.cols; i++)
+            {
+                // Matrix entries scaled to 2..254
+                uint8_t bit = src[i] > (thresholds[(dither.x + i) & 7] * 4 + 2);
+                SSD1306_DITHER_PACK(i, bit);
+            }
+            break;
+        }
+        case SSD1306_DITHER_FLOYD_STEINBERG:
+        {
+            // Error for the right neighbour and for the next row
+            // (column i - 1 and column i), kept in registers so that
+            // a single error row can be updated in place
+            int16_t right = 0, below_prev = 0, below_cur = 0;
+            for (i = 0; i < dither.cols; i++)
+            {
+                int16_t v = src[i] + ((err_next[i + 1] + right) >> 4);
+                uint8_t bit = v >= 128;
+                int16_t e = bit ? v - 255 : v;
+                right = 7 * e;
+                err_next[i] = below_prev + 3 * e;
+                below_prev = below_cur + 5 * e;
+                below_cur = e;
+                SSD1306_DITHER_PACK(i, bit);
+            }
+            err_next[i] = below_prev;
+            break;
+        }
+        case SSD1306_DITHER_ATKINSON:
+        {
+            // Each neighbour receives 1/8 of the error, that is 2/16
+            int16_t right1 = 0, right2 = 0, below_prev = 0, below_cur = 0, e_prev = 0;
+            for (i = 0; i < dither.cols; i++)
+            {
+                int16_t v = src[i] + ((err_next[i + 1] + right1) >> 4);
+                uint8_t bit = v >= 128;
+                int16_t e = 2 * (bit ? v - 255 : v);
+                right1 = right2 + e;
+                right2 = e;
+                // Column i - 1 is complete: merge the error diffused two rows
+                // down by the previous row and store the one of this row
+                err_next[i] = below_prev + e + err_next2[i];
+                err_next2[i] = e_prev;
+                below_prev = below_cur + e;
+                below_cur = e;
+                e_prev = e;
+                SSD1306_DITHER_PACK(i, bit);
+            }
+            err_next[i] = below_prev + err_next2[i];
+            err_next2[i] = e_prev;
+            break;
+        }
+        default:
+        {
+            for (i = 0; i < dither.cols; i++)
+            {
+                uint8_t bit = src[i] >= 128;
+                SSD1306_DITHER_PACK(i, bit);
+            }
+            break;
+        }
+    }
+    // Pack the last incomplete group of columns
+    if (i & 3)
+    {
+        page_bits.words[i >> 2] |= word << shift;
+    }
+
+    dither.mask |= 1 << shift;
+    dither.y++;
+    if ((dither.y & 7) == 0)
+    {
+        SSD1306_Dither_Flush(dither.y - 1);
+    }
+}
+
+void SSD1306_Dither_End(void)
+{
+    if (dither.mask)
+    {
+        SSD1306_Dither_Flush(dither.y - 1);
+    }
+}
+
+/* [] END OF FILE */
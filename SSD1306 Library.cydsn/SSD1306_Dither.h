@@ -0,0 +1,84 @@
+/**
+ *   \file SSD1306_Dither.h
+ *
+ *   \brief Streaming conversion of 8-bit grayscale images into the display buffer.
+ *
+ *   Rows of 8-bit pixels (0 = black, 255 = white) are dithered one at a time
+ *   and packed into a page of column bytes. Every eight rows the page is
+ *   written into the display buffer, so the whole image never needs to be
+ *   stored in RAM. Only integer arithmetic is used.
+ *
+ *   Error diffusion state is kept in rows of 16-bit errors: Floyd-Steinberg
+ *   needs a single row, Atkinson two rows since it spreads error two rows down.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_DITHER_H__
+    #define __SSD1306_DITHER_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    /**********************************
+    *          DITHERING MODES
+    **********************************/
+
+    /**
+    *   \brief Plain threshold at mid-gray.
+    */
+    #define SSD1306_DITHER_THRESHOLD 0
+
+    /**
+    *   \brief Ordered dithering with an 8x8 Bayer matrix.
+    */
+    #define SSD1306_DITHER_BAYER 1
+
+    /**
+    *   \brief Floyd-Steinberg error diffusion.
+    */
+    #define SSD1306_DITHER_FLOYD_STEINBERG 2
+
+    /**
+    *   \brief Atkinson error diffusion (diffuses 6/8 of the error).
+    */
+    #define SSD1306_DITHER_ATKINSON 3
+
+    /**
+    *   \brief Start the conversion of an image.
+    *
+    *   \param x first column of the image, in controller coordinates.
+    *   \param y first row of the image, in controller coordinates.
+    *   \param width width of the image in pixels. Columns falling outside
+    *       the display are discarded.
+    *   \param mode dithering mode, one of:
+    *       - #SSD1306_DITHER_THRESHOLD
+    *       - #SSD1306_DITHER_BAYER
+    *       - #SSD1306_DITHER_FLOYD_STEINBERG
+    *       - #SSD1306_DITHER_ATKINSON
+    */
+    void SSD1306_Dither_Begin(int16_t x, int16_t y, uint16_t width, uint8_t mode);
+
+    /**
+    *   \brief Convert next row of the image.
+    *
+    *   \param row width pixels of the row, 8 bits each.
+    */
+    void SSD1306_Dither_WriteRow(const uint8_t *row);
+
+    /**
+    *   \brief Complete the conversion of the image.
+    *
+    *   Writes the last, partially filled page into the buffer.
+    */
+    void SSD1306_Dither_End(void);
+
+#endif
+
+/* [] END OF FILE */
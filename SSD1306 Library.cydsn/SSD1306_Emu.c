@@ -0,0 +1,293 @@
+/**
+ *  \file SSD1306_Emu.c
+ *
+ *  \brief Source file for the SSD1306 controller model.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306_Emu.h"
+#include "SSD1306_RegMap.h"
+#include "string.h"
+
+/**
+*   \brief Get total length of a command, including its parameters.
+*
+*   \param cmd first byte of the command.
+*   \return number of bytes of the command.
+*/
+static uint8_t SSD1306_Emu_CommandLength(uint8_t cmd)
+{
+    switch (cmd)
+    {
+        case SSD1306_MEMORYMODE:
+        case SSD1306_SETCONTRAST:
+        case SSD1306_CHARGEPUMP:
+        case SSD1306_SETMULTIPLEX:
+        case SSD1306_SETDISPLAYOFFSET:
+        case SSD1306_SETDISPLAYCLOCKDIV:
+        case SSD1306_SETPRECHARGE:
+        case SSD1306_SETCOMPINS:
+        case SSD1306_SETVCOMDETECT:
+            return 2;
+        case SSD1306_COLUMNADDR:
+        case SSD1306_PAGEADDR:
+        case SSD1306_SET_VERTICAL_SCROLL_AREA:
+            return 3;
+        case SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL:
+        case SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL:
+            return 6;
+        case SSD1306_RIGHT_HORIZONTAL_SCROLL:
+        case SSD1306_LEFT_HORIZONTAL_SCROLL:
+        case SSD1306_RIGHT_CONTENT_SCROLL:
+        case SSD1306_LEFT_CONTENT_SCROLL:
+            return 7;
+        default:
+            return 1;
+    }
+}
+
+/**
+*   \brief Move a window of the GDDRAM by one column, wrapping around.
+*
+*   \param emu emulator state.
+*   \param cmd content scroll command with its parameters.
+*/
+static void SSD1306_Emu_ContentScroll(SSD1306_Emu *emu, const uint8_t *cmd)
+{
+    uint8_t page_start = cmd[2] & 0x07;
+    uint8_t page_end = cmd[4] & 0x07;
+    uint8_t col_start = cmd[5] & 0x7F;
+    uint8_t col_end = cmd[6] & 0x7F;
+    uint8_t page;
+
+    if ((page_start > page_end) || (col_start >= col_end))
+    {
+        return;
+    }
+    for (page = page_start; page <= page_end; page++)
+    {
+        uint8_t *row = &emu->gddram[page * SSD1306_EMU_COLUMNS + col_start];
+        uint8_t n = col_end - col_start;
+        uint8_t wrap;
+
+        if (cmd[0] == SSD1306_LEFT_CONTENT_SCROLL)
+        {
+            wrap = row[0];
+            memmove(row, row + 1, n);
+            row[n] = wrap;
+        }
+        else
+        {
+            wrap = row[n];
+            memmove(row + 1, row, n);
+            row[0] = wrap;
+        }
+    }
+}
+
+/**
+*   \brief Execute a complete command.
+*
+*   \param emu emulator state.
+*/
+static void SSD1306_Emu_Execute(SSD1306_Emu *emu)
+{
+    uint8_t *cmd = emu->cmd;
+
+    emu->commands++;
+    if (cmd[0] <= 0x0F)
+    {
+        // Lower nibble of column start, page addressing mode
+        emu->col = (emu->col & 0xF0) | cmd[0];
+        return;
+    }
+    if (cmd[0] <= 0x1F)
+    {
+        // Higher nibble of column start, page addressing mode
+        emu->col = ((cmd[0] & 0x07) << 4) | (emu->col & 0x0F);
+        return;
+    }
+    if ((cmd[0] >= SSD1306_SETSTARTLINE) && (cmd[0] <= 0x7F))
+    {
+        emu->start_line = cmd[0] & 0x3F;
+        return;
+    }
+    if ((cmd[0] & 0xF8) == 0xB0)
+    {
+        // Page start, page addressing mode
+        emu->page = cmd[0] & 0x07;
+        return;
+    }
+    switch (cmd[0])
+    {
+        case SSD1306_MEMORYMODE:
+            if ((cmd[1] & 0x03) != 0x03)
+            {
+                emu->mode = cmd[1] & 0x03;
+            }
+            break;
+        case SSD1306_COLUMNADDR:
+            emu->col_start = cmd[1] & 0x7F;
+            emu->col_end = cmd[2] & 0x7F;
+            emu->col = emu->col_start;
+            break;
+        case SSD1306_PAGEADDR:
+            emu->page_start = cmd[1] & 0x07;
+            emu->page_end = cmd[2] & 0x07;
+            emu->page = emu->page_start;
+            break;
+        case SSD1306_SETCONTRAST:
+            emu->contrast = cmd[1];
+            break;
+        case SSD1306_SETMULTIPLEX:
+            emu->multiplex = cmd[1] & 0x3F;
+            break;
+        case SSD1306_SETDISPLAYCLOCKDIV:
+            emu->clock_div = cmd[1];
+            break;
+        case SSD1306_NORMALDISPLAY:
+            emu->inverted = 0;
+            break;
+        case SSD1306_INVERTDISPLAY:
+            emu->inverted = 1;
+            break;
+        case SSD1306_DISPLAYOFF:
+            emu->display_on = 0;
+            break;
+        case SSD1306_DISPLAYON:
+            emu->display_on = 1;
+            break;
+        case SSD1306_DEACTIVATE_SCROLL:
+            emu->scrolling = 0;
+            break;
+        case SSD1306_ACTIVATE_SCROLL:
+            emu->scrolling = 1;
+            break;
+        case SSD1306_RIGHT_CONTENT_SCROLL:
+        case SSD1306_LEFT_CONTENT_SCROLL:
+            SSD1306_Emu_ContentScroll(emu, cmd);
+            break;
+        default:
+            // Commands that do not change the emulated state
+            break;
+    }
+}
+
+/**
+*   \brief Write a display data byte and advance the pointers.
+*
+*   \param emu emulator state.
+*   \param value byte to be written.
+*/
+static void SSD1306_Emu_Data(SSD1306_Emu *emu, uint8_t value)
+{
+    emu->gddram[emu->page * SSD1306_EMU_COLUMNS + emu->col] = value;
+    emu->data_bytes++;
+
+    switch (emu->mode)
+    {
+        case SSD1306_EMU_MODE_HORIZONTAL:
+            if (emu->col >= emu->col_end)
+            {
+                emu->col = emu->col_start;
+                emu->page = (emu->page >= emu->page_end) ? emu->page_start : emu->page + 1;
+            }
+            else
+            {
+                emu->col++;
+            }
+            break;
+        case SSD1306_EMU_MODE_VERTICAL:
+            if (emu->page >= emu->page_end)
+            {
+                emu->page = emu->page_start;
+                emu->col = (emu->col >= emu->col_end) ? emu->col_start : emu->col + 1;
+            }
+            else
+            {
+                emu->page++;
+            }
+            break;
+        default:
+            // Page addressing: the page pointer never changes
+            emu->col = (emu->col >= SSD1306_EMU_COLUMNS - 1) ? 0 : emu->col + 1;
+            break;
+    }
+}
+
+void SSD1306_Emu_Init(SSD1306_Emu *emu)
+{
+    memset(emu, 0, sizeof(*emu));
+    emu->mode = SSD1306_EMU_MODE_PAGE;
+    emu->col_end = SSD1306_EMU_COLUMNS - 1;
+    emu->page_end = SSD1306_EMU_PAGES - 1;
+    emu->contrast = 0x7F;
+    emu->multiplex = 63;
+    emu->clock_div = 0x80;
+}
+
+void SSD1306_Emu_Write(SSD1306_Emu *emu, uint8_t control, const uint8_t *data, uint16_t len)
+{
+    while (len > 0)
+    {
+        if (control & 0x40)
+        {
+            SSD1306_Emu_Data(emu, *data);
+        }
+        else
+        {
+            emu->cmd[emu->cmd_len++] = *data;
+            if (emu->cmd_len >= SSD1306_Emu_CommandLength(emu->cmd[0]))
+            {
+                SSD1306_Emu_Execute(emu);
+                emu->cmd_len = 0;
+            }
+        }
+        data++;
+        len--;
+        // With continuation bit set, a new control byte follows each byte
+        if ((control & 0x80) && (len > 0))
+        {
+            control = *data++;
+            len--;
+        }
+    }
+}
+
+uint8_t SSD1306_Emu_GetPixel(const SSD1306_Emu *emu, uint8_t x, uint8_t y)
+{
+    if ((x >= SSD1306_EMU_COLUMNS) || (y >= SSD1306_EMU_PAGES * 8))
+    {
+        return 0;
+    }
+    return (emu->gddram[(y / 8) * SSD1306_EMU_COLUMNS + x] >> (y & 7)) & 0x01;
+}
+
+uint16_t SSD1306_Emu_Compare(const SSD1306_Emu *emu, const uint8_t *pixels,
+                                uint8_t width, uint8_t pages)
+{
+    uint16_t diff = 0;
+    uint8_t page, col;
+
+    for (page = 0; (page < pages) && (page < SSD1306_EMU_PAGES); page++)
+    {
+        for (col = 0; (col < width) && (col < SSD1306_EMU_COLUMNS); col++)
+        {
+            if (emu->gddram[page * SSD1306_EMU_COLUMNS + col] != pixels[page * width + col])
+            {
+                diff++;
+            }
+        }
+    }
+    return diff;
+}
+
+/* [] END OF FILE */
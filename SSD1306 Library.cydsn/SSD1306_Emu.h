@@ -0,0 +1,123 @@
+/**
+ *   \file SSD1306_Emu.h
+ *
+ *   \brief Software model of the SSD1306 controller.
+ *
+ *   The emulator interprets the byte stream the library sends over I2C
+ *   (control byte followed by commands or display data) and keeps a copy of
+ *   the controller GDDRAM and of the relevant registers. It has no hardware
+ *   dependency and is meant for the host: the tests feed it the traffic of
+ *   the mock I2C bus, and #SSD1306_Trace_Replay replays recorded traffic on
+ *   it. It is not part of the firmware project.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_EMU_H__
+    #define __SSD1306_EMU_H__
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Number of GDDRAM pages of the controller.
+    */
+    #define SSD1306_EMU_PAGES 8
+
+    /**
+    *   \brief Number of GDDRAM columns of the controller.
+    */
+    #define SSD1306_EMU_COLUMNS 128
+
+    /**
+    *   \brief Horizontal addressing mode.
+    */
+    #define SSD1306_EMU_MODE_HORIZONTAL 0
+
+    /**
+    *   \brief Vertical addressing mode.
+    */
+    #define SSD1306_EMU_MODE_VERTICAL 1
+
+    /**
+    *   \brief Page addressing mode.
+    */
+    #define SSD1306_EMU_MODE_PAGE 2
+
+    /**
+    *   \brief State of the emulated controller.
+    */
+    typedef struct {
+        uint8_t gddram[SSD1306_EMU_PAGES * SSD1306_EMU_COLUMNS]; ///< Display RAM, page-major
+        uint8_t mode;           ///< Memory addressing mode
+        uint8_t col_start;      ///< Column window start
+        uint8_t col_end;        ///< Column window end
+        uint8_t page_start;     ///< Page window start
+        uint8_t page_end;       ///< Page window end
+        uint8_t col;            ///< Column pointer
+        uint8_t page;           ///< Page pointer
+        uint8_t display_on;     ///< Display on
+        uint8_t inverted;       ///< Inverted display
+        uint8_t contrast;       ///< Contrast value
+        uint8_t start_line;     ///< Display start line
+        uint8_t multiplex;      ///< Multiplex ratio minus one
+        uint8_t clock_div;      ///< Clock divide ratio/oscillator frequency
+        uint8_t scrolling;      ///< Scroll activated
+        uint8_t cmd[8];         ///< Command being received
+        uint8_t cmd_len;        ///< Bytes of the command received
+        uint32_t commands;      ///< Number of commands executed
+        uint32_t data_bytes;    ///< Number of display data bytes written
+    } SSD1306_Emu;
+
+    /**
+    *   \brief Reset the emulator to the controller reset state.
+    *
+    *   \param emu emulator state.
+    */
+    void SSD1306_Emu_Init(SSD1306_Emu *emu);
+
+    /**
+    *   \brief Process one I2C write transaction.
+    *
+    *   \param emu emulator state.
+    *   \param control control byte (0x00 for commands, 0x40 for data,
+    *       with bit 7 set for a single byte followed by a new control byte).
+    *   \param data bytes following the control byte.
+    *   \param len number of bytes.
+    */
+    void SSD1306_Emu_Write(SSD1306_Emu *emu, uint8_t control, const uint8_t *data, uint16_t len);
+
+    /**
+    *   \brief Get a pixel of the display RAM.
+    *
+    *   \param emu emulator state.
+    *   \param x column.
+    *   \param y row.
+    *   \return 1 if the pixel is on, 0 otherwise.
+    */
+    uint8_t SSD1306_Emu_GetPixel(const SSD1306_Emu *emu, uint8_t x, uint8_t y);
+
+    /**
+    *   \brief Compare the display RAM with a page-major image.
+    *
+    *   Used to check that what was sent leaves the controller showing the
+    *   expected image, e.g. that a build without the display buffer
+    *   produces the same screen as the display buffer path.
+    *
+    *   \param emu emulator state.
+    *   \param pixels page-major image placed at the top-left corner.
+    *   \param width width of the image in columns.
+    *   \param pages height of the image in pages.
+    *   \return number of bytes that differ.
+    */
+    uint16_t SSD1306_Emu_Compare(const SSD1306_Emu *emu, const uint8_t *pixels,
+                                    uint8_t width, uint8_t pages);
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,252 @@
+/**
+ *  \file SSD1306_Export.c
+ *
+ *  \brief Source file for the export of page-major images.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306_Export.h"
+
+//***************************
+//          MACROS
+//***************************
+#define SSD1306_EXPORT_CRC_POLY 0xEDB88320UL   ///< Reflected CRC-32 polynomial
+#define SSD1306_EXPORT_ADLER_MOD 65521UL        ///< Modulus of Adler-32
+
+// PNG file signature
+static const uint8_t png_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+/**
+*   \brief PNG chunk being written.
+*/
+typedef struct {
+    SSD1306_ExportSink sink;    ///< Function receiving the bytes
+    void *context;              ///< Argument of the sink
+    uint32_t crc;               ///< Running CRC-32 of type and data
+} SSD1306_ExportChunk;
+
+/**
+*   \brief Update a CRC-32 (before the final inversion) with some bytes.
+*/
+static uint32_t SSD1306_Export_CrcUpdate(uint32_t crc, const uint8_t *data, uint16_t len)
+{
+    uint8_t k;
+
+    while (len-- > 0)
+    {
+        crc ^= *data++;
+        for (k = 0; k < 8; k++)
+        {
+            crc = (crc >> 1) ^ (SSD1306_EXPORT_CRC_POLY & (0UL - (crc & 1)));
+        }
+    }
+    return crc;
+}
+
+/**
+*   \brief Store a 32-bit value big-endian.
+*/
+static void SSD1306_Export_Put32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >> 8);
+    dst[3] = (uint8_t)value;
+}
+
+/**
+*   \brief Write bytes of a chunk, updating its CRC.
+*/
+static void SSD1306_Export_ChunkData(SSD1306_ExportChunk *c, const uint8_t *data, uint16_t len)
+{
+    c->crc = SSD1306_Export_CrcUpdate(c->crc, data, len);
+    c->sink(data, len, c->context);
+}
+
+/**
+*   \brief Write the length and the type of a chunk.
+*/
+static void SSD1306_Export_ChunkBegin(SSD1306_ExportChunk *c, uint32_t len, const char *type)
+{
+    uint8_t header[4];
+
+    SSD1306_Export_Put32(header, len);
+    c->sink(header, 4, c->context);
+    c->crc = 0xFFFFFFFFUL;
+    SSD1306_Export_ChunkData(c, (const uint8_t *)type, 4);
+}
+
+/**
+*   \brief Write the CRC of a chunk.
+*/
+static void SSD1306_Export_ChunkEnd(SSD1306_ExportChunk *c)
+{
+    uint8_t crc[4];
+
+    SSD1306_Export_Put32(crc, ~c->crc);
+    c->sink(crc, 4, c->context);
+}
+
+/**
+*   \brief Write an unsigned number in decimal followed by a separator.
+*
+*   \param dst destination, at least 4 bytes.
+*   \param value number, at most 255.
+*   \param sep separator.
+*   \return number of bytes written.
+*/
+static uint8_t SSD1306_Export_PutNumber(uint8_t *dst, uint8_t value, uint8_t sep)
+{
+    uint8_t n = 0;
+    if (value >= 100)
+    {
+        dst[n++] = '0' + value / 100;
+    }
+    if (value >= 10)
+    {
+        dst[n++] = '0' + (value / 10) % 10;
+    }
+    dst[n++] = '0' + value % 10;
+    dst[n++] = sep;
+    return n;
+}
+
+/**
+*   \brief Pack a row of a page-major image, MSB first.
+*
+*   \param row destination, (width + 7) / 8 bytes.
+*   \return number of bytes of the row.
+*/
+static uint8_t SSD1306_Export_PackRow(const uint8_t *pages, uint8_t stride, uint8_t width,
+                                        uint8_t y, uint8_t *row)
+{
+    const uint8_t *src = &pages[(y / 8) * stride];
+    uint8_t bit = 1 << (y & 7);
+    uint8_t bytes = (width + 7) / 8;
+    uint8_t x, i;
+
+    for (i = 0; i < bytes; i++)
+    {
+        uint8_t value = 0;
+        for (x = i * 8; (x < i * 8 + 8) && (x < width); x++)
+        {
+            if (src[x] & bit)
+            {
+                value |= 0x80 >> (x & 7);
+            }
+        }
+        row[i] = value;
+    }
+    return bytes;
+}
+
+void SSD1306_Export_Pbm(const uint8_t *pages, uint8_t stride, uint8_t width,
+                            uint8_t height, SSD1306_ExportSink sink, void *context)
+{
+    uint8_t row[32];
+    uint8_t n = 0, y, i, bytes;
+
+    // Header: magic, width and height
+    row[n++] = 'P';
+    row[n++] = '4';
+    row[n++] = '\n';
+    n += SSD1306_Export_PutNumber(&row[n], width, ' ');
+    n += SSD1306_Export_PutNumber(&row[n], height, '\n');
+    sink(row, n, context);
+
+    for (y = 0; y < height; y++)
+    {
+        bytes = SSD1306_Export_PackRow(pages, stride, width, y, row);
+        // In PBM 1 is black: invert lit pixels, padding bits stay 0
+        for (i = 0; i < bytes; i++)
+        {
+            row[i] = ~row[i];
+        }
+        if (width & 7)
+        {
+            row[bytes - 1] &= 0xFF << (8 - (width & 7));
+        }
+        sink(row, bytes, context);
+    }
+}
+
+void SSD1306_Export_Png(const uint8_t *pages, uint8_t stride, uint8_t width,
+                            uint8_t height, SSD1306_ExportSink sink, void *context)
+{
+    SSD1306_ExportChunk c = { sink, context, 0 };
+    uint8_t row[1 + 32];
+    uint8_t header[13];
+    uint8_t bytes = (width + 7) / 8;
+    // Filter byte and pixels of each row, in a single stored block (at most 8415 bytes)
+    uint16_t raw = (uint16_t)height * (1 + bytes);
+    uint32_t a = 1, b = 0;
+    uint16_t i;
+    uint8_t y;
+
+    sink(png_signature, sizeof(png_signature), context);
+
+    // IHDR: size, bit depth 1, grayscale, deflate, no filter, no interlace
+    SSD1306_Export_Put32(&header[0], width);
+    SSD1306_Export_Put32(&header[4], height);
+    header[8] = 1;
+    header[9] = 0;
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+    SSD1306_Export_ChunkBegin(&c, sizeof(header), "IHDR");
+    SSD1306_Export_ChunkData(&c, header, sizeof(header));
+    SSD1306_Export_ChunkEnd(&c);
+
+    // IDAT: zlib header, stored block header, rows, Adler-32 of the rows
+    SSD1306_Export_ChunkBegin(&c, 2 + 5 + raw + 4, "IDAT");
+    header[0] = 0x78;
+    header[1] = 0x01;
+    header[2] = 0x01;
+    header[3] = (uint8_t)raw;
+    header[4] = (uint8_t)(raw >> 8);
+    header[5] = (uint8_t)~raw;
+    header[6] = (uint8_t)(~raw >> 8);
+    SSD1306_Export_ChunkData(&c, header, 7);
+    for (y = 0; y < height; y++)
+    {
+        row[0] = 0;
+        SSD1306_Export_PackRow(pages, stride, width, y, &row[1]);
+        for (i = 0; i <= bytes; i++)
+        {
+            a = (a + row[i]) % SSD1306_EXPORT_ADLER_MOD;
+            b = (b + a) % SSD1306_EXPORT_ADLER_MOD;
+        }
+        SSD1306_Export_ChunkData(&c, row, 1 + bytes);
+    }
+    SSD1306_Export_Put32(header, (b << 16) | a);
+    SSD1306_Export_ChunkData(&c, header, 4);
+    SSD1306_Export_ChunkEnd(&c);
+
+    SSD1306_Export_ChunkBegin(&c, 0, "IEND");
+    SSD1306_Export_ChunkEnd(&c);
+}
+
+uint32_t SSD1306_Export_Crc32(const uint8_t *pages, uint8_t stride, uint8_t width,
+                                uint8_t height)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+    uint8_t row[32];
+    uint8_t y, bytes;
+
+    for (y = 0; y < height; y++)
+    {
+        bytes = SSD1306_Export_PackRow(pages, stride, width, y, row);
+        crc = SSD1306_Export_CrcUpdate(crc, row, bytes);
+    }
+    return ~crc;
+}
+
+/* [] END OF FILE */
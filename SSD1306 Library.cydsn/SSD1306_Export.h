@@ -0,0 +1,84 @@
+/**
+ *   \file SSD1306_Export.h
+ *
+ *   \brief Export of page-major images, for golden-image comparisons.
+ *
+ *   The display buffer (#SSD1306_GetBuffer), a canvas or the GDDRAM of the
+ *   controller emulator (SSD1306_Emu.h) can be written as a binary PBM
+ *   (P4) or a 1-bit grayscale PNG image, or reduced to a CRC-32 to be
+ *   compared with the one of a reference rendering. PNG data is stored
+ *   uncompressed (deflate stored block), so the writer needs no buffer
+ *   and the same image always gives the same bytes. The module is meant for
+ *   the host tests and tools, where the sink writes to a file, and is not
+ *   part of the firmware project.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_EXPORT_H__
+    #define __SSD1306_EXPORT_H__
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Sink receiving the exported bytes (e.g. a wrapper of fwrite).
+    */
+    typedef void (*SSD1306_ExportSink)(const uint8_t *data, uint16_t len, void *context);
+
+    /**
+    *   \brief Write a page-major image as a binary PBM.
+    *
+    *   Lit pixels are written as white, so that the image looks like the
+    *   display.
+    *
+    *   \param pages page-major image: byte (x + page * stride) holds
+    *       rows 8 * page to 8 * page + 7 of column x, LSB on top.
+    *   \param stride number of columns of a page in memory
+    *       (#SSD1306_WIDTH for the buffer, #SSD1306_EMU_COLUMNS for the emulator).
+    *   \param width width of the image, at most stride.
+    *   \param height height of the image.
+    *   \param sink function receiving the bytes.
+    *   \param context argument passed to the sink.
+    */
+    void SSD1306_Export_Pbm(const uint8_t *pages, uint8_t stride, uint8_t width,
+                                uint8_t height, SSD1306_ExportSink sink, void *context);
+
+    /**
+    *   \brief Write a page-major image as a PNG.
+    *
+    *   1-bit grayscale, lit pixels white, no interlace.
+    *
+    *   \param pages page-major image.
+    *   \param stride number of columns of a page in memory.
+    *   \param width width of the image, at most stride.
+    *   \param height height of the image.
+    *   \param sink function receiving the bytes.
+    *   \param context argument passed to the sink.
+    */
+    void SSD1306_Export_Png(const uint8_t *pages, uint8_t stride, uint8_t width,
+                                uint8_t height, SSD1306_ExportSink sink, void *context);
+
+    /**
+    *   \brief Compute the CRC-32 (IEEE 802.3) of a page-major image.
+    *
+    *   Only the pixels of the image are used: bits of the last page below
+    *   height and columns beyond width do not change the result.
+    *
+    *   \param pages page-major image.
+    *   \param stride number of columns of a page in memory.
+    *   \param width width of the image.
+    *   \param height height of the image.
+    *   \return CRC-32 of the image.
+    */
+    uint32_t SSD1306_Export_Crc32(const uint8_t *pages, uint8_t stride, uint8_t width,
+                                    uint8_t height);
+
+#endif
+
+/* [] END OF FILE */
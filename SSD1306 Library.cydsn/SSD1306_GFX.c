@@ -32,9 +32,61 @@
 
 
 #include "stdlib.h"
+#include "string.h"
 
 #include "SSD1306_GFX.h"
 #include "SSD1306.h"
+#include "SSD1306_Stats.h"
+
+/**
+*   \brief Edge of a polygon being filled, in controller coordinates.
+*/
+typedef struct {
+    int32_t x;          ///< X at the center of the current row, 16.16 fixed point
+    int32_t slope;      ///< X increment per row, 16.16 fixed point
+    int32_t rem;        ///< Fraction of x below the 16.16 resolution, in 1/dy units
+    int32_t slope_rem;  ///< Fraction of the slope below the 16.16 resolution
+    int32_t dy;         ///< Rows spanned by the edge
+    int16_t y_start;    ///< First row crossed by the edge
+    int16_t y_end;      ///< Last row crossed by the edge
+    int8_t winding;     ///< +1 for downward edges, -1 for upward edges
+} SSD1306_GFX_Edge;
+
+// Edge table, sorted by first row
+static SSD1306_GFX_Edge edges[SSD1306_GFX_MAX_EDGES];
+// Active edges of the current row
+static uint8_t active[SSD1306_GFX_MAX_EDGES];
+// Clip rectangle of the polygon being filled, in controller coordinates
+static struct {
+    int16_t x0;
+    int16_t y0;
+    int16_t x1;     ///< Excluded
+    int16_t y1;     ///< Excluded
+} poly_clip;
+
+/**
+*   \brief Vertical run of a column to be searched by the flood fill.
+*/
+typedef struct {
+    uint8_t x;      ///< Column
+    uint8_t y0;     ///< First row
+    uint8_t y1;     ///< Last row (included)
+    int8_t dir;     ///< Direction from the column where the run was found
+} SSD1306_GFX_Run;
+
+/**
+*   \brief Rows of a column to be searched by the flood fill after a stack overflow.
+*/
+typedef struct {
+    uint8_t x;                      ///< Column
+    uint8_t rows[SSD1306_PAGES];    ///< A bit per row, as in the display buffer
+} SSD1306_GFX_Pending;
+
+// Runs waiting to be searched by the flood fill
+static SSD1306_GFX_Run fill_stack[SSD1306_GFX_FILL_STACK];
+// Columns of the runs that did not fit in the stack: each marked pixel
+// is next to a filled pixel
+static SSD1306_GFX_Pending fill_pending[SSD1306_GFX_FILL_PENDING];
 
 #define _swap_int16_t(a, b)                                                    \
     {                                                                          \
@@ -43,22 +95,61 @@
         b = t;                                                                 \
     }
 
-    
-void SSD1306_GFX_WriteLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
-                             uint16_t color) 
+/**
+*   \brief Check if a bounding box intersects the clip rectangle.
+*
+*   \return 1 if some pixel of the box can be drawn.
+*/
+static uint8_t SSD1306_GFX_Visible(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    int16_t cx, cy, cw, ch;
+
+    SSD1306_GetClip(&cx, &cy, &cw, &ch);
+    return (w > 0) && (h > 0) && (x < cx + cw) && (x + w > cx) &&
+            (y < cy + ch) && (y + h > cy);
+}
+
+/**
+*   \brief Draw a clipped line as runs of pixels.
+*
+*   Pixels of a line that share the minor coordinate form a run along the
+*   major axis, drawn with #SSD1306_DrawFastHLine or #SSD1306_DrawFastVLine
+*   instead of pixel by pixel.
+*
+*   \param last 1 to draw the pixel at (x1, y1), 0 to leave it out, so that
+*       lines joined end to start draw the shared pixel once.
+*/
+static void SSD1306_GFX_Line(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                uint16_t color, uint8_t last)
 {
-    
+    int16_t cx, cy, cw, ch;
+    int16_t u_min, u_max, v_min, v_max, u_end, run;
+    int32_t skip = 0, steps;
+    uint8_t skip_start = 0;
+
+    SSD1306_GetClip(&cx, &cy, &cw, &ch);
     int16_t steep = abs(y1 - y0) > abs(x1 - x0);
     if (steep) 
     {
         _swap_int16_t(x0, y0);
         _swap_int16_t(x1, y1);
+        _swap_int16_t(cx, cy);
+        _swap_int16_t(cw, ch);
     }
+    // Clip range along the major (u) and minor (v) axis
+    u_min = cx;
+    u_max = cx + cw - 1;
+    v_min = cy;
+    v_max = cy + ch - 1;
 
     if (x0 > x1) {
         _swap_int16_t(x0, x1);
         _swap_int16_t(y0, y1);
+        // The pixel left out is now the first one
+        skip_start = !last;
     }
+    // Last column drawn; the slope is still given by the whole line
+    u_end = (last || skip_start) ? x1 : x1 - 1;
 
     int16_t dx, dy;
     dx = x1 - x0;
@@ -76,17 +167,69 @@ void SSD1306_GFX_WriteLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
         ystep = -1;
     }
 
-    for (; x0 <= x1; x0++) 
+    // Reject lines outside the clip rectangle
+    if ((cw <= 0) || (ch <= 0) || (x1 < u_min) || (x0 > u_max) ||
+        ((y0 < v_min) && (y1 < v_min)) || ((y0 > v_max) && (y1 > v_max)))
+    {
+        return;
+    }
+
+    // Skip the steps before the line enters the clip rectangle: along u,
+    // and along v when the line comes from above or below it
+    if (x0 < u_min)
+    {
+        skip = u_min - x0;
+    }
+    if (skip_start && (skip == 0))
     {
-        if (steep) 
+        skip = 1;
+    }
+    if ((dy > 0) && (((ystep > 0) && (y0 < v_min)) || ((ystep < 0) && (y0 > v_max))))
+    {
+        // First step after which v has moved by m = |v limit - y0|
+        int32_t m = (ystep > 0) ? v_min - y0 : y0 - v_max;
+        steps = ((m - 1) * dx + dx / 2) / dy + 1;
+        if (steps > skip)
         {
-            SSD1306_GFX_WritePixel(y0, x0, color);
-        } 
-        else
+            skip = steps;
+        }
+    }
+    if (skip > 0)
+    {
+        // After k steps, v moved by the smallest m keeping the error non-negative
+        int32_t m = (int32_t)skip * dy - dx / 2;
+        m = (m <= 0) ? 0 : (m + dx - 1) / dx;
+        x0 += skip;
+        y0 += ystep * m;
+        err = dx / 2 - (int32_t)skip * dy + m * dx;
+    }
+    if (u_end > u_max)
+    {
+        u_end = u_max;
+    }
+
+    run = x0;
+    for (; x0 <= u_end; x0++) 
+    {
+        // Stop when the line leaves the clip rectangle along v
+        if ((ystep > 0) ? (y0 > v_max) : (y0 < v_min))
         {
-            SSD1306_GFX_WritePixel(x0, y0, color);
+            break;
         }
         err -= dy;
+        if ((err < 0) || (x0 == u_end))
+        {
+            // End of the run of pixels on this row (column if steep)
+            if (steep) 
+            {
+                SSD1306_DrawFastVLine(y0, run, x0 - run + 1, color);
+            } 
+            else
+            {
+                SSD1306_DrawFastHLine(run, y0, x0 - run + 1, color);
+            }
+            run = x0 + 1;
+        }
         if (err < 0) 
         {
             y0 += ystep;
@@ -95,6 +238,14 @@ void SSD1306_GFX_WriteLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
     }
 }
 
+void SSD1306_GFX_WriteLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                             uint16_t color) 
+{
+    SSD1306_STATS_BEGIN();
+    SSD1306_GFX_Line(x0, y0, x1, y1, color, 1);
+    SSD1306_STATS_END(SSD1306_STATS_OP_LINE);
+}
+
 void SSD1306_GFX_WritePixel(int16_t x, int16_t y, uint16_t color) 
 {
     SSD1306_DrawPixel(x, y, color);
@@ -103,6 +254,7 @@ void SSD1306_GFX_WritePixel(int16_t x, int16_t y, uint16_t color)
 void SSD1306_GFX_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
                             uint16_t color) 
 {
+    SSD1306_STATS_BEGIN();
     if (x0 == x1) 
     {
         if (y0 > y1)
@@ -120,7 +272,1225 @@ void SSD1306_GFX_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
         SSD1306_DrawFastHLine(x0, y0, x1 - x0 + 1, color);
     } 
     else {
-        SSD1306_GFX_WriteLine(x0, y0, x1, y1, color);
+        SSD1306_GFX_Line(x0, y0, x1, y1, color, 1);
+    }
+    SSD1306_STATS_END(SSD1306_STATS_OP_LINE);
+}
+
+void SSD1306_GFX_DrawPolyline(const SSD1306_Point *points, uint16_t count,
+                                uint8_t closed, uint16_t color)
+{
+    uint16_t i;
+
+    if (count == 0)
+    {
+        return;
+    }
+    // Each segment leaves out its end pixel, which starts the next one
+    for (i = 0; i + 1 < count; i++)
+    {
+        SSD1306_GFX_Line(points[i].x, points[i].y, points[i + 1].x, points[i + 1].y,
+                            color, 0);
+    }
+    if (closed && (count > 1))
+    {
+        SSD1306_GFX_Line(points[count - 1].x, points[count - 1].y, points[0].x, points[0].y,
+                            color, 0);
+    }
+    else
+    {
+        SSD1306_DrawPixel(points[count - 1].x, points[count - 1].y, color);
+    }
+}
+
+/**
+*   \brief Draw a span along the axis that maps to controller columns or pages.
+*
+*   Symmetric filled shapes are produced as a set of spans across an axis u,
+*   each one running along the other axis v. When vertical is set, u is x
+*   and spans are vertical: with the page layout of the buffer they are
+*   written a whole byte at a time. Otherwise u is y and spans are horizontal.
+*
+*   \param vertical 1 for vertical spans, 0 for horizontal spans.
+*   \param u coordinate across the spans.
+*   \param v start coordinate along the span.
+*   \param len length of the span.
+*   \param color color of the span.
+*/
+static void SSD1306_GFX_Span(uint8_t vertical, int16_t u, int16_t v, int16_t len,
+                                uint16_t color)
+{
+    if (len > 0)
+    {
+        if (vertical)
+        {
+            SSD1306_DrawFastVLine(u, v, len, color);
+        }
+        else
+        {
+            SSD1306_DrawFastHLine(v, u, len, color);
+        }
+    }
+}
+
+/**
+*   \brief Check which span direction is cheaper for the current rotation.
+*
+*   \return 1 if logical vertical spans map to controller columns.
+*/
+static uint8_t SSD1306_GFX_VerticalSpans(void)
+{
+    return (SSD1306_GetRotation() & 0x01) == 0;
+}
+
+/**
+*   \brief Draw quarter circle arcs, used by circles and rounded rectangles.
+*
+*   \param x0 center x.
+*   \param y0 center y.
+*   \param r radius.
+*   \param corners mask of the quarters to draw: 0x1 top-left, 0x2 top-right,
+*       0x4 bottom-right, 0x8 bottom-left.
+*   \param color color of the arcs.
+*/
+static void SSD1306_GFX_DrawCircleHelper(int16_t x0, int16_t y0, int16_t r,
+                                            uint8_t corners, uint16_t color)
+{
+    int16_t f = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+
+    while (x < y) 
+    {
+        if (f >= 0) 
+        {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        // Past the diagonal the points mirror the previous ones, or the axis
+        // points drawn by the caller: drawing them again would undo INVERSE
+        if (x > y)
+        {
+            break;
+        }
+        if (corners & 0x4) 
+        {
+            SSD1306_DrawPixel(x0 + x, y0 + y, color);
+            if (x != y)
+            {
+                SSD1306_DrawPixel(x0 + y, y0 + x, color);
+            }
+        }
+        if (corners & 0x2) 
+        {
+            SSD1306_DrawPixel(x0 + x, y0 - y, color);
+            if (x != y)
+            {
+                SSD1306_DrawPixel(x0 + y, y0 - x, color);
+            }
+        }
+        if (corners & 0x8) 
+        {
+            SSD1306_DrawPixel(x0 - y, y0 + x, color);
+            if (x != y)
+            {
+                SSD1306_DrawPixel(x0 - x, y0 + y, color);
+            }
+        }
+        if (corners & 0x1) 
+        {
+            SSD1306_DrawPixel(x0 - y, y0 - x, color);
+            if (x != y)
+            {
+                SSD1306_DrawPixel(x0 - x, y0 - y, color);
+            }
+        }
+    }
+}
+
+void SSD1306_GFX_DrawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color)
+{
+    if (!SSD1306_GFX_Visible(x, y, w, h))
+    {
+        return;
+    }
+    SSD1306_DrawFastHLine(x, y, w, color);
+    if (h > 1)
+    {
+        SSD1306_DrawFastHLine(x, y + h - 1, w, color);
+    }
+    if (h > 2)
+    {
+        SSD1306_DrawFastVLine(x, y + 1, h - 2, color);
+        if (w > 1)
+        {
+            SSD1306_DrawFastVLine(x + w - 1, y + 1, h - 2, color);
+        }
+    }
+}
+
+void SSD1306_GFX_FillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color)
+{
+    int16_t i;
+    SSD1306_STATS_BEGIN();
+
+    if (!SSD1306_GFX_Visible(x, y, w, h))
+    {
+        SSD1306_STATS_END(SSD1306_STATS_OP_FILL_RECT);
+        return;
+    }
+    if (SSD1306_GFX_VerticalSpans())
+    {
+        for (i = x; i < x + w; i++)
+        {
+            SSD1306_DrawFastVLine(i, y, h, color);
+        }
+    }
+    else
+    {
+        for (i = y; i < y + h; i++)
+        {
+            SSD1306_DrawFastHLine(x, i, w, color);
+        }
+    }
+    SSD1306_STATS_END(SSD1306_STATS_OP_FILL_RECT);
+}
+
+void SSD1306_GFX_DrawCircle(int16_t x0, int16_t y0, int16_t r,
+                              uint16_t color)
+{
+    if ((r < 0) || !SSD1306_GFX_Visible(x0 - r, y0 - r, 2 * r + 1, 2 * r + 1))
+    {
+        return;
+    }
+    SSD1306_DrawPixel(x0, y0 + r, color);
+    if (r > 0)
+    {
+        SSD1306_DrawPixel(x0, y0 - r, color);
+        SSD1306_DrawPixel(x0 + r, y0, color);
+        SSD1306_DrawPixel(x0 - r, y0, color);
+        SSD1306_GFX_DrawCircleHelper(x0, y0, r, 0x0F, color);
+    }
+}
+
+void SSD1306_GFX_FillCircle(int16_t x0, int16_t y0, int16_t r,
+                              uint16_t color)
+{
+    uint8_t vertical = SSD1306_GFX_VerticalSpans();
+    int16_t u0 = vertical ? x0 : y0;
+    int16_t v0 = vertical ? y0 : x0;
+    int32_t limit = (int32_t)r * r + r;
+    int16_t du, dv = r;
+    SSD1306_STATS_BEGIN();
+
+    if ((r < 0) || !SSD1306_GFX_Visible(x0 - r, y0 - r, 2 * r + 1, 2 * r + 1))
+    {
+        SSD1306_STATS_END(SSD1306_STATS_OP_FILL_CIRCLE);
+        return;
+    }
+    // One span per offset across the circle: every pixel is written once
+    SSD1306_GFX_Span(vertical, u0, v0 - r, 2 * r + 1, color);
+    for (du = 1; du <= r; du++)
+    {
+        while ((int32_t)du * du + (int32_t)dv * dv > limit)
+        {
+            dv--;
+        }
+        SSD1306_GFX_Span(vertical, u0 - du, v0 - dv, 2 * dv + 1, color);
+        SSD1306_GFX_Span(vertical, u0 + du, v0 - dv, 2 * dv + 1, color);
+    }
+    SSD1306_STATS_END(SSD1306_STATS_OP_FILL_CIRCLE);
+}
+
+void SSD1306_GFX_DrawEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry,
+                               uint16_t color)
+{
+    int32_t rx2 = (int32_t)rx * rx;
+    int32_t ry2 = (int32_t)ry * ry;
+    int32_t x = 0, y = ry;
+    int32_t px = 0, py = 2 * rx2 * y;
+    int32_t p;
+    int16_t last_x = -1, last_y = -1;
+
+    if ((rx < 0) || (ry < 0) ||
+        !SSD1306_GFX_Visible(x0 - rx, y0 - ry, 2 * rx + 1, 2 * ry + 1))
+    {
+        return;
+    }
+
+    // Region 1: slope above -1, x advances every step
+    p = ry2 - rx2 * ry + rx2 / 4;
+    while (px < py)
+    {
+        if ((x != last_x) || (y != last_y))
+        {
+            SSD1306_DrawPixel(x0 + x, y0 + y, color);
+            if (x != 0)
+            {
+                SSD1306_DrawPixel(x0 - x, y0 + y, color);
+            }
+            if (y != 0)
+            {
+                SSD1306_DrawPixel(x0 + x, y0 - y, color);
+                if (x != 0)
+                {
+                    SSD1306_DrawPixel(x0 - x, y0 - y, color);
+                }
+            }
+            last_x = x;
+            last_y = y;
+        }
+        x++;
+        px += 2 * ry2;
+        if (p < 0)
+        {
+            p += ry2 + px;
+        }
+        else
+        {
+            y--;
+            py -= 2 * rx2;
+            p += ry2 + px - py;
+        }
+    }
+
+    // Region 2: slope below -1, y decreases every step
+    p = ry2 * (2 * x + 1) * (2 * x + 1) / 4 + rx2 * (y - 1) * (y - 1) - rx2 * ry2;
+    while (y >= 0)
+    {
+        if ((x != last_x) || (y != last_y))
+        {
+            SSD1306_DrawPixel(x0 + x, y0 + y, color);
+            if (x != 0)
+            {
+                SSD1306_DrawPixel(x0 - x, y0 + y, color);
+            }
+            if (y != 0)
+            {
+                SSD1306_DrawPixel(x0 + x, y0 - y, color);
+                if (x != 0)
+                {
+                    SSD1306_DrawPixel(x0 - x, y0 - y, color);
+                }
+            }
+            last_x = x;
+            last_y = y;
+        }
+        y--;
+        py -= 2 * rx2;
+        if (p > 0)
+        {
+            p += rx2 - py;
+        }
+        else
+        {
+            x++;
+            px += 2 * ry2;
+            p += rx2 - py + px;
+        }
+    }
+}
+
+void SSD1306_GFX_FillEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry,
+                               uint16_t color)
+{
+    uint8_t vertical = SSD1306_GFX_VerticalSpans();
+    int16_t u0 = vertical ? x0 : y0;
+    int16_t v0 = vertical ? y0 : x0;
+    int32_t ru = vertical ? rx : ry;
+    int32_t rv = vertical ? ry : rx;
+    // A point (u, v) is inside if u^2 rv^2 + v^2 ru^2 <= ru^2 rv^2, with
+    // half a pixel of tolerance along v to match the midpoint outline
+    int32_t ru2 = ru * ru;
+    int32_t rv2 = rv * rv;
+    int32_t limit = ru2 * rv2 + ru2 * rv;
+    int32_t du, dv = rv;
+    SSD1306_STATS_BEGIN();
+
+    if ((rx < 0) || (ry < 0) ||
+        !SSD1306_GFX_Visible(x0 - rx, y0 - ry, 2 * rx + 1, 2 * ry + 1))
+    {
+        SSD1306_STATS_END(SSD1306_STATS_OP_FILL_ELLIPSE);
+        return;
+    }
+    SSD1306_GFX_Span(vertical, u0, v0 - rv, 2 * rv + 1, color);
+    for (du = 1; du <= ru; du++)
+    {
+        while ((dv > 0) && (du * du * rv2 + dv * dv * ru2 > limit))
+        {
+            dv--;
+        }
+        SSD1306_GFX_Span(vertical, u0 - du, v0 - dv, 2 * dv + 1, color);
+        SSD1306_GFX_Span(vertical, u0 + du, v0 - dv, 2 * dv + 1, color);
+    }
+    SSD1306_STATS_END(SSD1306_STATS_OP_FILL_ELLIPSE);
+}
+
+void SSD1306_GFX_DrawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                                 int16_t r, uint16_t color)
+{
+    int16_t max_radius = ((w < h) ? w : h) / 2;
+
+    if (!SSD1306_GFX_Visible(x, y, w, h))
+    {
+        return;
+    }
+    if (r > max_radius)
+    {
+        r = max_radius;
+    }
+    if (r <= 0)
+    {
+        // Square corners: the sides must not overlap
+        SSD1306_GFX_DrawRect(x, y, w, h, color);
+        return;
+    }
+    // Straight sides, then the corners
+    SSD1306_DrawFastHLine(x + r, y, w - 2 * r, color);
+    SSD1306_DrawFastHLine(x + r, y + h - 1, w - 2 * r, color);
+    SSD1306_DrawFastVLine(x, y + r, h - 2 * r, color);
+    SSD1306_DrawFastVLine(x + w - 1, y + r, h - 2 * r, color);
+    SSD1306_GFX_DrawCircleHelper(x + r, y + r, r, 0x1, color);
+    SSD1306_GFX_DrawCircleHelper(x + w - r - 1, y + r, r, 0x2, color);
+    SSD1306_GFX_DrawCircleHelper(x + w - r - 1, y + h - r - 1, r, 0x4, color);
+    SSD1306_GFX_DrawCircleHelper(x + r, y + h - r - 1, r, 0x8, color);
+}
+
+void SSD1306_GFX_FillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                                 int16_t r, uint16_t color)
+{
+    uint8_t vertical = SSD1306_GFX_VerticalSpans();
+    int16_t u = vertical ? x : y;
+    int16_t lu = vertical ? w : h;
+    int16_t v = vertical ? y : x;
+    int16_t lv = vertical ? h : w;
+    int16_t max_radius = ((w < h) ? w : h) / 2;
+    int32_t limit;
+    int16_t du, dv, i;
+    SSD1306_STATS_BEGIN();
+
+    if (!SSD1306_GFX_Visible(x, y, w, h))
+    {
+        SSD1306_STATS_END(SSD1306_STATS_OP_FILL_ROUND_RECT);
+        return;
+    }
+    if (r > max_radius)
+    {
+        r = max_radius;
+    }
+    if (r < 0)
+    {
+        r = 0;
+    }
+    // Full-length spans between the corners
+    for (i = u + r; i < u + lu - r; i++)
+    {
+        SSD1306_GFX_Span(vertical, i, v, lv, color);
+    }
+    // Spans shortened by the quarter circles, mirrored on both ends
+    limit = (int32_t)r * r + r;
+    dv = r;
+    for (du = 1; du <= r; du++)
+    {
+        while ((int32_t)du * du + (int32_t)dv * dv > limit)
+        {
+            dv--;
+        }
+        SSD1306_GFX_Span(vertical, u + r - du, v + r - dv, lv - 2 * (r - dv), color);
+        SSD1306_GFX_Span(vertical, u + lu - 1 - r + du, v + r - dv, lv - 2 * (r - dv), color);
+    }
+    SSD1306_STATS_END(SSD1306_STATS_OP_FILL_ROUND_RECT);
+}
+
+void SSD1306_GFX_DrawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                int16_t x2, int16_t y2, uint16_t color)
+{
+    SSD1306_GFX_DrawLine(x0, y0, x1, y1, color);
+    SSD1306_GFX_DrawLine(x1, y1, x2, y2, color);
+    SSD1306_GFX_DrawLine(x2, y2, x0, y0, color);
+}
+
+void SSD1306_GFX_FillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                int16_t x2, int16_t y2, uint16_t color)
+{
+    int16_t a, b, y, last;
+    SSD1306_STATS_BEGIN();
+
+    // Sort coordinates by y (y2 >= y1 >= y0)
+    if (y0 > y1) 
+    {
+        _swap_int16_t(y0, y1);
+        _swap_int16_t(x0, x1);
+    }
+    if (y1 > y2) 
+    {
+        _swap_int16_t(y2, y1);
+        _swap_int16_t(x2, x1);
+    }
+    if (y0 > y1) 
+    {
+        _swap_int16_t(y0, y1);
+        _swap_int16_t(x0, x1);
+    }
+
+    a = b = x0;
+    if (x1 < a)
+    {
+        a = x1;
+    }
+    else if (x1 > b)
+    {
+        b = x1;
+    }
+    if (x2 < a)
+    {
+        a = x2;
+    }
+    else if (x2 > b)
+    {
+        b = x2;
+    }
+    if (!SSD1306_GFX_Visible(a, y0, b - a + 1, y2 - y0 + 1))
+    {
+        SSD1306_STATS_END(SSD1306_STATS_OP_FILL_TRIANGLE);
+        return;
+    }
+
+    if (y0 == y2) 
+    {
+        // All on the same line: a single span
+        SSD1306_DrawFastHLine(a, y0, b - a + 1, color);
+        SSD1306_STATS_END(SSD1306_STATS_OP_FILL_TRIANGLE);
+        return;
+    }
+
+    int16_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0,
+            dx12 = x2 - x1, dy12 = y2 - y1;
+    int32_t sa = 0, sb = 0;
+
+    // Upper part: spans between edges 0-1 and 0-2. If y1 == y2 the
+    // last line belongs to this part, otherwise it is left to the lower one
+    last = (y1 == y2) ? y1 : y1 - 1;
+
+    for (y = y0; y <= last; y++) 
+    {
+        a = x0 + sa / dy01;
+        b = x0 + sb / dy02;
+        sa += dx01;
+        sb += dx02;
+        if (a > b)
+        {
+            _swap_int16_t(a, b);
+        }
+        SSD1306_DrawFastHLine(a, y, b - a + 1, color);
+    }
+
+    // Lower part: spans between edges 1-2 and 0-2
+    sa = (int32_t)dx12 * (y - y1);
+    sb = (int32_t)dx02 * (y - y0);
+    for (; y <= y2; y++) 
+    {
+        a = x1 + sa / dy12;
+        b = x0 + sb / dy02;
+        sa += dx12;
+        sb += dx02;
+        if (a > b)
+        {
+            _swap_int16_t(a, b);
+        }
+        SSD1306_DrawFastHLine(a, y, b - a + 1, color);
+    }
+    SSD1306_STATS_END(SSD1306_STATS_OP_FILL_TRIANGLE);
+}
+
+/**
+*   \brief Map a vertex from rotated to controller coordinates.
+*
+*   Vertices lie on pixel corners, so the mapping differs by one from the
+*   one applied to pixels by #SSD1306_DrawPixel. Coordinates are in
+*   1 / #SSD1306_GFX_SUBPIXEL pixel units.
+*/
+static void SSD1306_GFX_ToController(int32_t *x, int32_t *y)
+{
+    int32_t t;
+
+    switch (SSD1306_GetRotation())
+    {
+        case 1:
+            t = *x;
+            *x = SSD1306_WIDTH * SSD1306_GFX_SUBPIXEL - *y;
+            *y = t;
+            break;
+        case 2:
+            *x = SSD1306_WIDTH * SSD1306_GFX_SUBPIXEL - *x;
+            *y = SSD1306_HEIGHT * SSD1306_GFX_SUBPIXEL - *y;
+            break;
+        case 3:
+            t = *x;
+            *x = *y;
+            *y = SSD1306_HEIGHT * SSD1306_GFX_SUBPIXEL - t;
+            break;
+    }
+}
+
+/**
+*   \brief Division rounding towards minus infinity, for a positive divisor.
+*/
+static int64_t SSD1306_GFX_FloorDiv(int64_t num, int32_t den)
+{
+    int64_t q = num / den;
+    return ((num % den) < 0) ? q - 1 : q;
+}
+
+/**
+*   \brief Add the edge between two vertices to the edge table.
+*
+*   Horizontal edges and edges not crossing any row of the clip rectangle
+*   are skipped. Vertices are in 1 / #SSD1306_GFX_SUBPIXEL pixel units.
+*
+*   \return 0 if the edge table is full, 1 otherwise.
+*/
+static uint8_t SSD1306_GFX_AddEdge(uint8_t *count, int32_t x0, int32_t y0,
+                                    int32_t x1, int32_t y1)
+{
+    int8_t winding = 1;
+    int32_t dx, dy, t, y_first, y_last;
+    int64_t num;
+    int16_t y_start, y_end;
+    uint8_t i;
+
+    if (y0 == y1)
+    {
+        return 1;
+    }
+    if (y0 > y1)
+    {
+        t = x0;
+        x0 = x1;
+        x1 = t;
+        t = y0;
+        y0 = y1;
+        y1 = t;
+        winding = -1;
+    }
+    // Rows whose centers lie in [y0, y1)
+    y_first = -(int32_t)SSD1306_GFX_FloorDiv(SSD1306_GFX_SUBPIXEL / 2 - y0, SSD1306_GFX_SUBPIXEL);
+    y_last = -(int32_t)SSD1306_GFX_FloorDiv(SSD1306_GFX_SUBPIXEL / 2 - y1, SSD1306_GFX_SUBPIXEL) - 1;
+    if ((y_first >= poly_clip.y1) || (y_last < poly_clip.y0) || (y_first > y_last))
+    {
+        return 1;
+    }
+    y_start = (y_first < poly_clip.y0) ? poly_clip.y0 : y_first;
+    y_end = (y_last >= poly_clip.y1) ? poly_clip.y1 - 1 : y_last;
+    if (*count >= SSD1306_GFX_MAX_EDGES)
+    {
+        return 0;
+    }
+
+    // Insertion keeps the table sorted by first row
+    i = *count;
+    while ((i > 0) && (edges[i - 1].y_start > y_start))
+    {
+        edges[i] = edges[i - 1];
+        i--;
+    }
+    dx = x1 - x0;
+    dy = y1 - y0;
+    // x and slope are kept exact with a remainder, so that the rounding of
+    // a row does not depend on the row where the edge was clipped. Values
+    // can be negative, so they are scaled by multiplying, not by shifting
+    num = (int64_t)dx * ((int32_t)y_start * SSD1306_GFX_SUBPIXEL + SSD1306_GFX_SUBPIXEL / 2 - y0)
+            * (1 << (16 - SSD1306_GFX_SUBPIXEL_BITS));
+    edges[i].x = x0 * (1 << (16 - SSD1306_GFX_SUBPIXEL_BITS)) + (int32_t)SSD1306_GFX_FloorDiv(num, dy);
+    edges[i].rem = (int32_t)(num - SSD1306_GFX_FloorDiv(num, dy) * dy);
+    num = (int64_t)dx * 65536;
+    edges[i].slope = (int32_t)SSD1306_GFX_FloorDiv(num, dy);
+    edges[i].slope_rem = (int32_t)(num - SSD1306_GFX_FloorDiv(num, dy) * dy);
+    edges[i].dy = dy;
+    edges[i].y_start = y_start;
+    edges[i].y_end = y_end;
+    edges[i].winding = winding;
+    (*count)++;
+    return 1;
+}
+
+/**
+*   \brief Fill a polygon made of one or more closed contours.
+*
+*   \param subpixel 1 if the vertices are in 1 / #SSD1306_GFX_SUBPIXEL
+*       pixel units, 0 if they are in pixels.
+*/
+static uint8_t SSD1306_GFX_Fill(const SSD1306_Point *points, const uint16_t *counts,
+                                uint8_t contours, uint8_t rule, uint16_t color,
+                                uint8_t subpixel)
+{
+    uint8_t masks[SSD1306_WIDTH];
+    int32_t x_min = INT32_MAX, x_max = INT32_MIN;
+    int32_t y_min = INT32_MAX, y_max = INT32_MIN;
+    uint8_t edge_count = 0, active_count = 0, next_edge = 0;
+    uint8_t shift = subpixel ? 0 : SSD1306_GFX_SUBPIXEL_BITS;
+    uint16_t first = 0, c, i;
+    int16_t y, page, ox, oy, cx, cy, cw, ch;
+
+    SSD1306_GetOrigin(&ox, &oy);
+    SSD1306_GetControllerClip(&cx, &cy, &cw, &ch);
+    if ((cw == 0) || (ch == 0) || (SSD1306_GetBuffer() == NULL))
+    {
+        return SSD1306_NO_ERROR;
+    }
+    poly_clip.x0 = cx;
+    poly_clip.y0 = cy;
+    poly_clip.x1 = cx + cw;
+    poly_clip.y1 = cy + ch;
+
+    // Build the edge table in controller coordinates
+    for (c = 0; c < contours; c++)
+    {
+        int32_t px = 0, py = 0, fx = 0, fy = 0;
+        for (i = 0; i < counts[c]; i++)
+        {
+            int32_t vx = (int32_t)points[first + i].x * (1 << shift) + (int32_t)ox * SSD1306_GFX_SUBPIXEL;
+            int32_t vy = (int32_t)points[first + i].y * (1 << shift) + (int32_t)oy * SSD1306_GFX_SUBPIXEL;
+            SSD1306_GFX_ToController(&vx, &vy);
+            x_min = (vx < x_min) ? vx : x_min;
+            x_max = (vx > x_max) ? vx : x_max;
+            y_min = (vy < y_min) ? vy : y_min;
+            y_max = (vy > y_max) ? vy : y_max;
+            if (i == 0)
+            {
+                fx = vx;
+                fy = vy;
+            }
+            else if (!SSD1306_GFX_AddEdge(&edge_count, px, py, vx, vy))
+            {
+                return SSD1306_GFX_OVERFLOW_ERROR;
+            }
+            px = vx;
+            py = vy;
+        }
+        if ((counts[c] > 0) && !SSD1306_GFX_AddEdge(&edge_count, px, py, fx, fy))
+        {
+            return SSD1306_GFX_OVERFLOW_ERROR;
+        }
+        first += counts[c];
+    }
+
+    if (edge_count == 0)
+    {
+        return SSD1306_NO_ERROR;
+    }
+    // Bounding box in pixels, then trivial rejection of polygons outside
+    // the clip rectangle
+    x_min = (int32_t)SSD1306_GFX_FloorDiv(x_min, SSD1306_GFX_SUBPIXEL);
+    y_min = (int32_t)SSD1306_GFX_FloorDiv(y_min, SSD1306_GFX_SUBPIXEL);
+    x_max = -(int32_t)SSD1306_GFX_FloorDiv(-x_max, SSD1306_GFX_SUBPIXEL);
+    y_max = -(int32_t)SSD1306_GFX_FloorDiv(-y_max, SSD1306_GFX_SUBPIXEL);
+    if ((x_max <= poly_clip.x0) || (x_min >= poly_clip.x1) ||
+        (y_max <= poly_clip.y0) || (y_min >= poly_clip.y1))
+    {
+        return SSD1306_NO_ERROR;
+    }
+    if (x_min < poly_clip.x0)
+    {
+        x_min = poly_clip.x0;
+    }
+    if (x_max > poly_clip.x1)
+    {
+        x_max = poly_clip.x1;
+    }
+    if (y_min < poly_clip.y0)
+    {
+        y_min = poly_clip.y0;
+    }
+
+    // Rows are collected in a column mask for each page, so that every
+    // byte of the buffer is written once per page
+    for (page = y_min / 8; page <= (poly_clip.y1 - 1) / 8; page++)
+    {
+        uint8_t *row = SSD1306_GetBuffer() + page * SSD1306_WIDTH;
+        int16_t col_first = SSD1306_WIDTH, col_last = -1;
+
+        if ((next_edge == edge_count) && (active_count == 0))
+        {
+            break;
+        }
+        memset(&masks[x_min], 0, x_max - x_min);
+
+        for (y = page * 8; y < page * 8 + 8; y++)
+        {
+            int16_t winding = 0;
+            int32_t x_prev = 0;
+
+            // Drop finished edges, add the ones starting on this row
+            for (i = 0; i < active_count; )
+            {
+                if (edges[active[i]].y_end < y)
+                {
+                    active[i] = active[--active_count];
+                }
+                else
+                {
+                    i++;
+                }
+            }
+            while ((next_edge < edge_count) && (edges[next_edge].y_start == y))
+            {
+                active[active_count++] = next_edge++;
+            }
+
+            // Sort crossings by x; the order changes little between rows
+            for (i = 1; i < active_count; i++)
+            {
+                uint8_t e = active[i];
+                uint16_t j = i;
+                while ((j > 0) && (edges[active[j - 1]].x > edges[e].x))
+                {
+                    active[j] = active[j - 1];
+                    j--;
+                }
+                active[j] = e;
+            }
+
+            // Walk the crossings, filling the inside intervals
+            for (i = 0; i < active_count; i++)
+            {
+                SSD1306_GFX_Edge *e = &edges[active[i]];
+                uint8_t inside = (rule == SSD1306_GFX_NONZERO) ? (winding != 0) :
+                                    (rule == SSD1306_GFX_POSITIVE) ? (winding > 0) : (winding & 1);
+                if (inside)
+                {
+                    // Pixels whose centers are in [x_prev, x)
+                    int32_t xa = (x_prev + 0x7FFF) >> 16;
+                    int32_t xb = (e->x + 0x7FFF) >> 16;
+                    if (xa < poly_clip.x0)
+                    {
+                        xa = poly_clip.x0;
+                    }
+                    if (xb > poly_clip.x1)
+                    {
+                        xb = poly_clip.x1;
+                    }
+                    if (xa < xb)
+                    {
+                        uint8_t bit = 1 << (y & 7);
+                        if (xa < col_first)
+                        {
+                            col_first = xa;
+                        }
+                        if (xb - 1 > col_last)
+                        {
+                            col_last = xb - 1;
+                        }
+                        for (; xa < xb; xa++)
+                        {
+                            masks[xa] |= bit;
+                        }
+                    }
+                }
+                winding += (rule != SSD1306_GFX_EVEN_ODD) ? e->winding : 1;
+                x_prev = e->x;
+                e->x += e->slope;
+                e->rem += e->slope_rem;
+                if (e->rem >= e->dy)
+                {
+                    e->x++;
+                    e->rem -= e->dy;
+                }
+            }
+        }
+
+        // Apply the masks of the page
+        if (col_last >= col_first)
+        {
+            SSD1306_MarkDirty(col_first, page * 8, col_last - col_first + 1, 8);
+            for (i = col_first; i <= col_last; i++)
+            {
+                switch (color)
+                {
+                    case SSD1306_WHITE:
+                        row[i] |= masks[i];
+                        break;
+                    case SSD1306_BLACK:
+                        row[i] &= ~masks[i];
+                        break;
+                    case SSD1306_INVERSE:
+                        row[i] ^= masks[i];
+                        break;
+                }
+            }
+        }
+    }
+    return SSD1306_NO_ERROR;
+}
+
+uint8_t SSD1306_GFX_FillPath(const SSD1306_Point *points, const uint16_t *counts,
+                                uint8_t contours, uint8_t rule, uint16_t color)
+{
+    uint8_t result;
+    SSD1306_STATS_BEGIN();
+
+    result = SSD1306_GFX_Fill(points, counts, contours, rule, color, 0);
+    SSD1306_STATS_END(SSD1306_STATS_OP_POLYGON);
+    return result;
+}
+
+uint8_t SSD1306_GFX_FillPathSubpixel(const SSD1306_Point *points, const uint16_t *counts,
+                                        uint8_t contours, uint8_t rule, uint16_t color)
+{
+    uint8_t result;
+    SSD1306_STATS_BEGIN();
+
+    result = SSD1306_GFX_Fill(points, counts, contours, rule, color, 1);
+    SSD1306_STATS_END(SSD1306_STATS_OP_POLYGON);
+    return result;
+}
+
+uint8_t SSD1306_GFX_FillPolygon(const SSD1306_Point *points, uint16_t count,
+                                  uint8_t rule, uint16_t color)
+{
+    return SSD1306_GFX_FillPath(points, &count, 1, rule, color);
+}
+
+/**
+*   \brief State of the flood fill in progress, in controller coordinates.
+*/
+static struct {
+    uint8_t *buf;           ///< Buffer being filled
+    uint8_t old;            ///< Value of the pixels to be replaced, 0x00 or 0xFF
+    uint8_t x0;             ///< Clip rectangle
+    uint8_t y0;             ///< Clip rectangle
+    uint8_t x1;             ///< Clip rectangle, included
+    uint8_t y1;             ///< Clip rectangle, included
+    uint8_t depth;          ///< Runs in the stack
+    uint8_t pending;        ///< Columns in the pending rows
+    uint8_t lost;           ///< Some runs fit neither in the stack nor in the pending rows
+    uint8_t dirty_x0;       ///< Bounding box of the filled pixels
+    uint8_t dirty_x1;       ///< Bounding box of the filled pixels
+    uint8_t dirty_y0;       ///< Bounding box of the filled pixels
+    uint8_t dirty_y1;       ///< Bounding box of the filled pixels
+} fill;
+
+/**
+*   \brief Check if a pixel has the value being replaced.
+*/
+static uint8_t SSD1306_GFX_FillMatch(uint8_t x, uint8_t y)
+{
+    return ((fill.buf[x + (y / 8) * SSD1306_WIDTH] ^ fill.old) & (1 << (y & 7))) == 0;
+}
+
+/**
+*   \brief Check if the whole byte holding a row has the value being replaced.
+*/
+static uint8_t SSD1306_GFX_FillMatchByte(uint8_t x, uint8_t y)
+{
+    return fill.buf[x + (y / 8) * SSD1306_WIDTH] == fill.old;
+}
+
+/**
+*   \brief Check if rows y0 to y1 of a column have some pixel to be replaced.
+*/
+static uint8_t SSD1306_GFX_FillAny(uint8_t x, uint8_t y0, uint8_t y1)
+{
+    uint8_t page;
+
+    for (page = y0 / 8; page <= y1 / 8; page++)
+    {
+        uint8_t mask = 0xFF;
+        if (page == y0 / 8)
+        {
+            mask &= 0xFF << (y0 & 7);
+        }
+        if (page == y1 / 8)
+        {
+            mask &= 0xFF >> (7 - (y1 & 7));
+        }
+        if (((fill.buf[x + page * SSD1306_WIDTH] ^ fill.old) & mask) != mask)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+*   \brief Queue a run of a column to be searched.
+*
+*   Runs with nothing to fill are not queued. When the stack is full the
+*   rows of the run are marked in the pending rows of its column, which
+*   are searched once the stack is empty. Only the rows of the run are
+*   marked, since the rows between two runs may belong to another region.
+*   When no column is left the run is dropped.
+*/
+static void SSD1306_GFX_FillPush(int16_t x, uint8_t y0, uint8_t y1, int8_t dir)
+{
+    uint8_t page, i;
+
+    if ((x < fill.x0) || (x > fill.x1) || !SSD1306_GFX_FillAny(x, y0, y1))
+    {
+        return;
+    }
+    if (fill.depth < SSD1306_GFX_FILL_STACK)
+    {
+        fill_stack[fill.depth].x = x;
+        fill_stack[fill.depth].y0 = y0;
+        fill_stack[fill.depth].y1 = y1;
+        fill_stack[fill.depth].dir = dir;
+        fill.depth++;
+        return;
+    }
+    for (i = 0; (i < fill.pending) && (fill_pending[i].x != x); i++)
+    {
+    }
+    if (i == fill.pending)
+    {
+        if (fill.pending == SSD1306_GFX_FILL_PENDING)
+        {
+            fill.lost = 1;
+            return;
+        }
+        fill_pending[i].x = x;
+        memset(fill_pending[i].rows, 0, sizeof(fill_pending[i].rows));
+        fill.pending++;
+    }
+    for (page = y0 / 8; page <= y1 / 8; page++)
+    {
+        uint8_t mask = 0xFF;
+        if (page == y0 / 8)
+        {
+            mask &= 0xFF << (y0 & 7);
+        }
+        if (page == y1 / 8)
+        {
+            mask &= 0xFF >> (7 - (y1 & 7));
+        }
+        fill_pending[i].rows[page] |= mask;
+    }
+}
+
+/**
+*   \brief Fill rows y0 to y1 of a column, a byte at a time.
+*/
+static void SSD1306_GFX_FillRun(uint8_t x, uint8_t y0, uint8_t y1)
+{
+    uint8_t page;
+
+    for (page = y0 / 8; page <= y1 / 8; page++)
+    {
+        uint8_t mask = 0xFF;
+        if (page == y0 / 8)
+        {
+            mask &= 0xFF << (y0 & 7);
+        }
+        if (page == y1 / 8)
+        {
+            mask &= 0xFF >> (7 - (y1 & 7));
+        }
+        fill.buf[x + page * SSD1306_WIDTH] ^= mask;
+    }
+    fill.dirty_x0 = (x < fill.dirty_x0) ? x : fill.dirty_x0;
+    fill.dirty_x1 = (x > fill.dirty_x1) ? x : fill.dirty_x1;
+    fill.dirty_y0 = (y0 < fill.dirty_y0) ? y0 : fill.dirty_y0;
+    fill.dirty_y1 = (y1 > fill.dirty_y1) ? y1 : fill.dirty_y1;
+}
+
+/**
+*   \brief Fill the runs of a column touching rows y0 to y1.
+*
+*   Each matching run is extended up and down as far as it goes, filled,
+*   and its rows are queued in the next column along dir. In the column
+*   the search came from, only the rows beyond y0 to y1 are queued, since
+*   the others were filled already (dir 0 queues both columns entirely).
+*   Bytes entirely made of matching (or non-matching) pixels are skipped
+*   eight rows at a time.
+*/
+static void SSD1306_GFX_FillColumn(uint8_t x, uint8_t y0, uint8_t y1, int8_t dir)
+{
+    uint16_t y = y0;
+
+    while (y <= y1)
+    {
+        uint8_t a, b;
+
+        if (!SSD1306_GFX_FillMatch(x, y))
+        {
+            // Skip bytes with no matching pixel
+            if (((y & 7) == 0) && (y + 7 <= y1) &&
+                ((fill.buf[x + (y / 8) * SSD1306_WIDTH] ^ fill.old) == 0xFF))
+            {
+                y += 8;
+            }
+            else
+            {
+                y++;
+            }
+            continue;
+        }
+
+        // Extend the run up
+        a = y;
+        while (a > fill.y0)
+        {
+            if (((a & 7) == 0) && (a - 8 >= fill.y0) && SSD1306_GFX_FillMatchByte(x, a - 8))
+            {
+                a -= 8;
+            }
+            else if (SSD1306_GFX_FillMatch(x, a - 1))
+            {
+                a--;
+            }
+            else
+            {
+                break;
+            }
+        }
+        // Extend the run down
+        b = y;
+        while (b < fill.y1)
+        {
+            if (((b & 7) == 7) && (b + 8 <= fill.y1) && SSD1306_GFX_FillMatchByte(x, b + 1))
+            {
+                b += 8;
+            }
+            else if (SSD1306_GFX_FillMatch(x, b + 1))
+            {
+                b++;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        SSD1306_GFX_FillRun(x, a, b);
+        if (dir == 0)
+        {
+            SSD1306_GFX_FillPush(x - 1, a, b, -1);
+            SSD1306_GFX_FillPush(x + 1, a, b, 1);
+        }
+        else
+        {
+            if (a < y0)
+            {
+                SSD1306_GFX_FillPush(x - dir, a, y0 - 1, -dir);
+            }
+            if (b > y1)
+            {
+                SSD1306_GFX_FillPush(x - dir, y1 + 1, b, -dir);
+            }
+            SSD1306_GFX_FillPush(x + dir, a, b, dir);
+        }
+        y = b + 2;
+    }
+}
+
+uint8_t SSD1306_GFX_FloodFill(int16_t x, int16_t y, uint16_t color)
+{
+    int16_t cx, cy, cw, ch, ox, oy, t;
+    uint8_t rows[SSD1306_PAGES];
+    uint8_t seed, col, page, bit;
+    SSD1306_STATS_BEGIN();
+
+    // Seed in controller coordinates, mapped as in SSD1306_DrawPixel
+    SSD1306_GetOrigin(&ox, &oy);
+    x += ox;
+    y += oy;
+    switch (SSD1306_GetRotation())
+    {
+        case 1:
+            t = x;
+            x = SSD1306_WIDTH - y - 1;
+            y = t;
+            break;
+        case 2:
+            x = SSD1306_WIDTH - x - 1;
+            y = SSD1306_HEIGHT - y - 1;
+            break;
+        case 3:
+            t = x;
+            x = y;
+            y = SSD1306_HEIGHT - t - 1;
+            break;
+    }
+    SSD1306_GetControllerClip(&cx, &cy, &cw, &ch);
+    fill.buf = SSD1306_GetBuffer();
+    if ((x < cx) || (x >= cx + cw) || (y < cy) || (y >= cy + ch) || (fill.buf == NULL))
+    {
+        SSD1306_STATS_END(SSD1306_STATS_OP_FLOOD_FILL);
+        return SSD1306_NO_ERROR;
+    }
+    seed = (fill.buf[x + (y / 8) * SSD1306_WIDTH] >> (y & 7)) & 0x01;
+    // Inverse fills the region with the opposite of its value
+    if (((color == SSD1306_WHITE) && seed) || ((color == SSD1306_BLACK) && !seed))
+    {
+        SSD1306_STATS_END(SSD1306_STATS_OP_FLOOD_FILL);
+        return SSD1306_NO_ERROR;
+    }
+    fill.old = seed ? 0xFF : 0x00;
+    fill.x0 = cx;
+    fill.y0 = cy;
+    fill.x1 = cx + cw - 1;
+    fill.y1 = cy + ch - 1;
+    fill.depth = 0;
+    fill.dirty_x0 = 0xFF;
+    fill.dirty_x1 = 0;
+    fill.dirty_y0 = 0xFF;
+    fill.dirty_y1 = 0;
+    fill.pending = 0;
+    fill.lost = 0;
+
+    SSD1306_GFX_FillColumn(x, y, y, 0);
+    for (;;)
+    {
+        while (fill.depth > 0)
+        {
+            fill.depth--;
+            SSD1306_GFX_FillColumn(fill_stack[fill.depth].x, fill_stack[fill.depth].y0,
+                                    fill_stack[fill.depth].y1, fill_stack[fill.depth].dir);
+        }
+        if (fill.pending == 0)
+        {
+            break;
+        }
+        // Search the rows of a column that did not fit in the stack, copied
+        // since the search may mark rows of other columns in its place
+        fill.pending--;
+        col = fill_pending[fill.pending].x;
+        memcpy(rows, fill_pending[fill.pending].rows, sizeof(rows));
+        for (page = fill.y0 / 8; page <= fill.y1 / 8; page++)
+        {
+            uint8_t pending = rows[page];
+            for (bit = 0; pending != 0; bit++, pending >>= 1)
+            {
+                if ((pending & 0x01) && SSD1306_GFX_FillMatch(col, page * 8 + bit))
+                {
+                    SSD1306_GFX_FillColumn(col, page * 8 + bit, page * 8 + bit, 0);
+                    while (fill.depth > 0)
+                    {
+                        fill.depth--;
+                        SSD1306_GFX_FillColumn(fill_stack[fill.depth].x,
+                                                fill_stack[fill.depth].y0,
+                                                fill_stack[fill.depth].y1,
+                                                fill_stack[fill.depth].dir);
+                    }
+                }
+            }
+        }
+    }
+
+    if (fill.dirty_x0 <= fill.dirty_x1)
+    {
+        SSD1306_MarkDirty(fill.dirty_x0, fill.dirty_y0, fill.dirty_x1 - fill.dirty_x0 + 1,
+                            fill.dirty_y1 - fill.dirty_y0 + 1);
     }
+    SSD1306_STATS_END(SSD1306_STATS_OP_FLOOD_FILL);
+    return fill.lost ? SSD1306_GFX_OVERFLOW_ERROR : SSD1306_NO_ERROR;
 }
 /* [] END OF FILE */
@@ -13,6 +13,82 @@
     #define __SSD1306_GFX_H__
     
     #include "cytypes.h"
+    #include "SSD1306.h"
+    
+    #ifndef SSD1306_GFX_MAX_EDGES
+        /**
+        *   \brief Maximum number of non-horizontal edges of a filled polygon.
+        */
+        #define SSD1306_GFX_MAX_EDGES 32
+    #endif
+    
+    #ifndef SSD1306_GFX_FILL_STACK
+        /**
+        *   \brief Capacity, in column runs, of the flood fill stack.
+        *
+        *   Four bytes each, 16 by default when #SSD1306_NO_FRAMEBUFFER is set.
+        */
+        #if SSD1306_NO_FRAMEBUFFER
+            #define SSD1306_GFX_FILL_STACK 16
+        #else
+            #define SSD1306_GFX_FILL_STACK 64
+        #endif
+    #endif
+    
+    #ifndef SSD1306_GFX_FILL_PENDING
+        /**
+        *   \brief Columns whose rows can wait for the flood fill when its stack is full.
+        *
+        *   Each one takes #SSD1306_PAGES + 1 bytes. Must be at least 1; 8 by
+        *   default when #SSD1306_NO_FRAMEBUFFER is set.
+        */
+        #if SSD1306_NO_FRAMEBUFFER
+            #define SSD1306_GFX_FILL_PENDING 8
+        #else
+            #define SSD1306_GFX_FILL_PENDING 32
+        #endif
+    #endif
+    
+    /**
+    *   \brief Even-odd fill rule: a pixel is inside if a ray crosses an odd number of edges.
+    */
+    #define SSD1306_GFX_EVEN_ODD 0
+    
+    /**
+    *   \brief Non-zero fill rule: a pixel is inside if the winding number is not zero.
+    */
+    #define SSD1306_GFX_NONZERO 1
+    
+    /**
+    *   \brief Positive fill rule: a pixel is inside if the winding number is above zero.
+    *
+    *   Contours with the opposite orientation then remove what they overlap.
+    */
+    #define SSD1306_GFX_POSITIVE 2
+    
+    /**
+    *   \brief Bits of the fraction of the vertices of #SSD1306_GFX_FillPathSubpixel.
+    */
+    #define SSD1306_GFX_SUBPIXEL_BITS 4
+    
+    /**
+    *   \brief Subpixel units per pixel of #SSD1306_GFX_FillPathSubpixel.
+    */
+    #define SSD1306_GFX_SUBPIXEL (1 << SSD1306_GFX_SUBPIXEL_BITS)
+    
+    /**
+    *   \brief Polygon has more edges than #SSD1306_GFX_MAX_EDGES, or flood fill
+    *   has more runs than its stack and pending rows hold.
+    */
+    #define SSD1306_GFX_OVERFLOW_ERROR 3
+    
+    /**
+    *   \brief Point with integer coordinates.
+    */
+    typedef struct {
+        int16_t x;  ///< X coordinate
+        int16_t y;  ///< Y coordinate
+    } SSD1306_Point;
     
     void SSD1306_GFX_WriteLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
                              uint16_t color);
@@ -22,5 +98,138 @@
     void SSD1306_GFX_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
                             uint16_t color);
     
+    /**
+    *   \brief Draw connected lines through a list of points.
+    *
+    *   Lines are drawn as runs of pixels, and the pixel shared by two
+    *   consecutive lines is drawn once, so that #SSD1306_INVERSE does not
+    *   clear the vertices.
+    *
+    *   \param points vertices.
+    *   \param count number of vertices.
+    *   \param closed 1 to join the last vertex to the first one.
+    *   \param color color of the lines.
+    */
+    void SSD1306_GFX_DrawPolyline(const SSD1306_Point *points, uint16_t count,
+                            uint8_t closed, uint16_t color);
+    
+    /**
+    *   \brief Draw the outline of a rectangle.
+    */
+    void SSD1306_GFX_DrawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color);
+    
+    /**
+    *   \brief Draw a filled rectangle.
+    */
+    void SSD1306_GFX_FillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color);
+    
+    /**
+    *   \brief Draw the outline of a circle of center (x0, y0) and radius r.
+    */
+    void SSD1306_GFX_DrawCircle(int16_t x0, int16_t y0, int16_t r,
+                            uint16_t color);
+    
+    /**
+    *   \brief Draw a filled circle of center (x0, y0) and radius r.
+    */
+    void SSD1306_GFX_FillCircle(int16_t x0, int16_t y0, int16_t r,
+                            uint16_t color);
+    
+    /**
+    *   \brief Draw the outline of an axis-aligned ellipse with radii rx and ry.
+    */
+    void SSD1306_GFX_DrawEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry,
+                            uint16_t color);
+    
+    /**
+    *   \brief Draw a filled axis-aligned ellipse with radii rx and ry.
+    */
+    void SSD1306_GFX_FillEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry,
+                            uint16_t color);
+    
+    /**
+    *   \brief Draw the outline of a rectangle with corners of radius r.
+    */
+    void SSD1306_GFX_DrawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            int16_t r, uint16_t color);
+    
+    /**
+    *   \brief Draw a filled rectangle with corners of radius r.
+    */
+    void SSD1306_GFX_FillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            int16_t r, uint16_t color);
+    
+    /**
+    *   \brief Draw the outline of a triangle.
+    */
+    void SSD1306_GFX_DrawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                            int16_t x2, int16_t y2, uint16_t color);
+    
+    /**
+    *   \brief Draw a filled triangle.
+    */
+    void SSD1306_GFX_FillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                            int16_t x2, int16_t y2, uint16_t color);
+    
+    /**
+    *   \brief Draw a filled polygon made of one or more closed contours.
+    *
+    *   Vertices are pixel corners: a pixel is filled if its center is inside
+    *   the polygon, so polygons sharing an edge do not overlap. Contours are
+    *   closed implicitly and may be convex, concave or self-intersecting;
+    *   holes are made with additional contours.
+    *
+    *   \param points vertices of all the contours, one after the other.
+    *   \param counts number of vertices of each contour.
+    *   \param contours number of contours.
+    *   \param rule #SSD1306_GFX_EVEN_ODD, #SSD1306_GFX_NONZERO or
+    *       #SSD1306_GFX_POSITIVE.
+    *   \param color color of the polygon.
+    *   \retval #SSD1306_NO_ERROR if the polygon was drawn.
+    *   \retval #SSD1306_GFX_OVERFLOW_ERROR if the polygon has too many edges.
+    */
+    uint8_t SSD1306_GFX_FillPath(const SSD1306_Point *points, const uint16_t *counts,
+                            uint8_t contours, uint8_t rule, uint16_t color);
+    
+    /**
+    *   \brief Draw a filled polygon with vertices between pixel corners.
+    *
+    *   Like #SSD1306_GFX_FillPath, with coordinates in 1 / #SSD1306_GFX_SUBPIXEL
+    *   pixel units, so that shapes computed with fractions of pixels (e.g.
+    *   thick lines at any angle) keep their exact size.
+    */
+    uint8_t SSD1306_GFX_FillPathSubpixel(const SSD1306_Point *points, const uint16_t *counts,
+                            uint8_t contours, uint8_t rule, uint16_t color);
+    
+    /**
+    *   \brief Draw a filled polygon with a single contour.
+    *
+    *   See #SSD1306_GFX_FillPath.
+    */
+    uint8_t SSD1306_GFX_FillPolygon(const SSD1306_Point *points, uint16_t count,
+                            uint8_t rule, uint16_t color);
+    
+    /**
+    *   \brief Fill the 4-connected region containing a pixel.
+    *
+    *   The region is made of the pixels with the same value as (x, y),
+    *   inside the clip rectangle. It is filled column run by column run,
+    *   a byte at a time, with a stack of #SSD1306_GFX_FILL_STACK runs and
+    *   no recursion. The rows of the runs that do not fit in the stack are
+    *   marked in a row bitmap for each of up to #SSD1306_GFX_FILL_PENDING
+    *   columns, and searched when the stack is empty. Runs that fit in
+    *   neither are dropped, and the pixels only reachable through them are
+    *   left as they are.
+    *
+    *   \param x column of the seed pixel.
+    *   \param y row of the seed pixel.
+    *   \param color color of the region; #SSD1306_INVERSE inverts it.
+    *   \retval #SSD1306_NO_ERROR if the whole region was filled.
+    *   \retval #SSD1306_GFX_OVERFLOW_ERROR if part of the region was left out.
+    */
+    uint8_t SSD1306_GFX_FloodFill(int16_t x, int16_t y, uint16_t color);
+    
 #endif
 /* [] END OF FILE */
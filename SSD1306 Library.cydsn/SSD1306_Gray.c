@@ -0,0 +1,323 @@
+/**
+ *  \file SSD1306_Gray.c
+ *
+ *  \brief Source file for SSD1306 grayscale emulation.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "I2C_Interface.h"
+#include "SSD1306_Gray.h"
+#include "SSD1306_RegMap.h"
+#include "string.h"
+
+//***************************
+//          MACROS
+//***************************
+#define SSD1306_GRAY_HOLD   0   ///< Showing current plane
+#define SSD1306_GRAY_WINDOW 1   ///< Next step sets the page window
+#define SSD1306_GRAY_DATA   2   ///< Next step sends page data
+#define SSD1306_GRAY_PAD    2   ///< Parameters of the longest window command
+
+/**
+*   \brief Struct with grayscale mode state.
+*/
+static struct {
+    uint8_t *planes;            ///< Plane storage
+    uint8_t plane_count;        ///< Number of planes
+    uint8_t shown;              ///< Plane currently held by the controller
+    uint8_t next;               ///< Plane being transferred
+    uint8_t state;              ///< State of the transfer
+    uint8_t page;               ///< Page being transferred
+    uint8_t sending;            ///< 1 while the transfer of the current step is in progress
+    uint8_t pad;                ///< NOP commands owed to a window command cut by a failed transfer
+    uint32_t planes_sent;       ///< Number of planes sent
+    uint32_t pages_skipped;     ///< Number of pages not sent
+} gray;
+
+// Frames elapsed since the current plane was shown
+static volatile uint16_t frames;
+
+// Number of plane transfers that still have to send each page
+static uint8_t resend[SSD1306_PAGES];
+
+/**
+*   \brief Mark a page as modified in all the planes.
+*/
+static void SSD1306_Gray_Touch(uint8_t page)
+{
+    resend[page] = gray.plane_count;
+}
+
+/**
+*   \brief Check if a page of the next plane has to be sent.
+*/
+static uint8_t SSD1306_Gray_PageChanged(uint8_t page)
+{
+    if (resend[page])
+    {
+        return 1;
+    }
+    return memcmp(&gray.planes[gray.next * SSD1306_BUFFER_SIZE + page * SSD1306_WIDTH],
+                  &gray.planes[gray.shown * SSD1306_BUFFER_SIZE + page * SSD1306_WIDTH],
+                  SSD1306_WIDTH) != 0;
+}
+
+uint8_t SSD1306_Gray_Start(uint8_t *planes, uint8_t plane_count)
+{
+    if ((planes == NULL) || (plane_count == 0) || (plane_count > SSD1306_GRAY_MAX_PLANES))
+    {
+        return SSD1306_COMM_ERROR;
+    }
+    // Plane pages are sent as horizontal windows
+    if (SSD1306_SetAddressingMode(SSD1306_ADDRESSING_HORIZONTAL) != SSD1306_NO_ERROR)
+    {
+        return SSD1306_COMM_ERROR;
+    }
+    gray.planes = planes;
+    gray.plane_count = plane_count;
+    gray.shown = 0;
+    gray.next = 0;
+    gray.page = 0;
+    gray.sending = 0;
+    gray.pad = 0;
+    gray.planes_sent = 0;
+    gray.pages_skipped = 0;
+    SSD1306_Gray_Clear();
+    // Send first plane as soon as Update is called
+    gray.state = SSD1306_GRAY_WINDOW;
+    frames = 0;
+    return SSD1306_NO_ERROR;
+}
+
+void SSD1306_Gray_Stop(void)
+{
+    while (I2C_Peripheral_IsBusy() == I2C_BUSY);
+    if (gray.sending && (gray.state == SSD1306_GRAY_WINDOW) &&
+            (I2C_Peripheral_IsBusy() != I2C_NO_ERROR))
+    {
+        gray.pad = SSD1306_GRAY_PAD;
+    }
+    if (gray.pad > 0)
+    {
+        // Complete a cut window command before other commands are sent
+        const uint8_t nops[SSD1306_GRAY_PAD] = { SSD1306_NOP, SSD1306_NOP };
+        I2C_Peripheral_WriteRegisterMulti(SSD1306_GetAddress(), 0x00, gray.pad, nops);
+        gray.pad = 0;
+    }
+    gray.sending = 0;
+    gray.planes = NULL;
+    SSD1306_SetAddressingMode(SSD1306_ADDRESSING_AUTO);
+}
+
+void SSD1306_Gray_Clear(void)
+{
+    uint8_t page;
+    memset(gray.planes, 0, SSD1306_GRAY_PLANES_SIZE(gray.plane_count));
+    for (page = 0; page < SSD1306_PAGES; page++)
+    {
+        SSD1306_Gray_Touch(page);
+    }
+}
+
+void SSD1306_Gray_DrawPixel(int16_t x, int16_t y, uint8_t level)
+{
+    if ((x >= 0) && (x < SSD1306_WIDTH) && (y >= 0) && (y < SSD1306_HEIGHT))
+    {
+        uint8_t plane;
+        uint8_t mask = 1 << (y & 7);
+        uint8_t *pBuf = &gray.planes[x + (y / 8) * SSD1306_WIDTH];
+        
+        // Bit k of the level goes to plane k
+        for (plane = 0; plane < gray.plane_count; plane++)
+        {
+            if (level & (1 << plane))
+            {
+                *pBuf |= mask;
+            }
+            else
+            {
+                *pBuf &= ~mask;
+            }
+            pBuf += SSD1306_BUFFER_SIZE;
+        }
+        SSD1306_Gray_Touch(y / 8);
+    }
+}
+
+void SSD1306_Gray_DrawFastVLine(int16_t x, int16_t y, int16_t h, uint8_t level)
+{
+    if ((x < 0) || (x >= SSD1306_WIDTH))
+    {
+        return;
+    }
+    if (y < 0)
+    {
+        h += y;
+        y = 0;
+    }
+    if ((y + h) > SSD1306_HEIGHT)
+    {
+        h = SSD1306_HEIGHT - y;
+    }
+    while (h > 0)
+    {
+        // Mask of the rows of this page covered by the line
+        uint8_t mod = y & 7;
+        uint8_t rows = (h < 8 - mod) ? h : 8 - mod;
+        uint8_t mask = (uint8_t)(((1 << rows) - 1) << mod);
+        uint8_t *pBuf = &gray.planes[x + (y / 8) * SSD1306_WIDTH];
+        uint8_t plane;
+        
+        for (plane = 0; plane < gray.plane_count; plane++)
+        {
+            if (level & (1 << plane))
+            {
+                *pBuf |= mask;
+            }
+            else
+            {
+                *pBuf &= ~mask;
+            }
+            pBuf += SSD1306_BUFFER_SIZE;
+        }
+        SSD1306_Gray_Touch(y / 8);
+        y += rows;
+        h -= rows;
+    }
+}
+
+void SSD1306_Gray_Tick(void)
+{
+    if (frames < 0xFFFF)
+    {
+        frames++;
+    }
+}
+
+uint8_t SSD1306_Gray_Update(void)
+{
+    if (gray.planes == NULL)
+    {
+        return SSD1306_NO_ERROR;
+    }
+    
+    // Nothing to do while a transfer is in progress
+    uint8_t i2c_err = I2C_Peripheral_IsBusy();
+    if (i2c_err == I2C_BUSY)
+    {
+        return SSD1306_NO_ERROR;
+    }
+    
+    // The step is completed only once its transfer was acknowledged
+    if (gray.sending)
+    {
+        gray.sending = 0;
+        if (i2c_err != I2C_NO_ERROR)
+        {
+            if (gray.state == SSD1306_GRAY_WINDOW)
+            {
+                // The controller may be waiting for parameters
+                gray.pad = SSD1306_GRAY_PAD;
+            }
+            // Send the window and the page again, in all the planes
+            gray.state = SSD1306_GRAY_WINDOW;
+            SSD1306_Gray_Touch(gray.page);
+            return SSD1306_COMM_ERROR;
+        }
+        if (gray.state == SSD1306_GRAY_WINDOW)
+        {
+            gray.pad = 0;
+            gray.state = SSD1306_GRAY_DATA;
+        }
+        else
+        {
+            if (resend[gray.page])
+            {
+                resend[gray.page]--;
+            }
+            gray.page++;
+            gray.state = SSD1306_GRAY_WINDOW;
+        }
+    }
+    
+    if (gray.state == SSD1306_GRAY_HOLD)
+    {
+        // Plane k is held for 2^k frames
+        if (frames < (1 << gray.shown))
+        {
+            return SSD1306_NO_ERROR;
+        }
+        gray.next = (gray.shown + 1) % gray.plane_count;
+        gray.page = 0;
+        gray.state = SSD1306_GRAY_WINDOW;
+    }
+    
+    i2c_err = I2C_NO_ERROR;
+    if (gray.state == SSD1306_GRAY_WINDOW)
+    {
+        // Skip pages equal to the ones held by the controller
+        while ((gray.page < SSD1306_PAGES) && !SSD1306_Gray_PageChanged(gray.page))
+        {
+            gray.page++;
+            gray.pages_skipped++;
+        }
+        if (gray.page < SSD1306_PAGES)
+        {
+            // Leading NOPs complete a cut command, if any
+            const uint8_t dlist[] = { SSD1306_NOP,
+                                        SSD1306_NOP,
+                                        SSD1306_PAGEADDR,
+                                        gray.page,
+                                        gray.page,
+                                        SSD1306_COLUMNADDR,
+                                        0,
+                                        SSD1306_WIDTH - 1 };
+            i2c_err = I2C_Peripheral_WriteRegisterMultiAsync(SSD1306_GetAddress(), 0x00,
+                                                    sizeof(dlist) - SSD1306_GRAY_PAD + gray.pad,
+                                                    &dlist[SSD1306_GRAY_PAD - gray.pad]);
+        }
+        else
+        {
+            // Plane completed: start holding it
+            gray.shown = gray.next;
+            gray.planes_sent++;
+            gray.state = SSD1306_GRAY_HOLD;
+            frames = 0;
+            return SSD1306_NO_ERROR;
+        }
+    }
+    else
+    {
+        i2c_err = I2C_Peripheral_WriteRegisterMultiAsync(SSD1306_GetAddress(), 0x40, SSD1306_WIDTH,
+                            &gray.planes[gray.next * SSD1306_BUFFER_SIZE + gray.page * SSD1306_WIDTH]);
+    }
+    
+    if (i2c_err != I2C_NO_ERROR)
+    {
+        // Not started: the same step is tried again by the next call
+        SSD1306_Gray_Touch(gray.page);
+        return SSD1306_COMM_ERROR;
+    }
+    gray.sending = 1;
+    return SSD1306_NO_ERROR;
+}
+
+uint32_t SSD1306_Gray_GetPlanesSent(void)
+{
+    return gray.planes_sent;
+}
+
+uint32_t SSD1306_Gray_GetPagesSkipped(void)
+{
+    return gray.pages_skipped;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,126 @@
+/**
+ *   \file SSD1306_Gray.h
+ *
+ *   \brief Grayscale emulation for SSD1306 displays.
+ *
+ *   Up to #SSD1306_GRAY_MAX_PLANES page-major bitplanes are shown one after
+ *   the other, each one for a number of controller frames proportional to
+ *   its weight (plane k is held for 2^k frames). The eye integrates the
+ *   planes, so that a pixel appears with one of 2^N gray levels.
+ *
+ *   Planes are sent with asynchronous I2C transfers and only the pages that
+ *   differ from what the controller is currently showing are transmitted.
+ *   The application drives the module with two calls:
+ *     - #SSD1306_Gray_Tick, once per controller frame (e.g. from a timer
+ *       interrupt running at #SSD1306_GetFrameRate Hz);
+ *     - #SSD1306_Gray_Update, as often as possible from the main loop.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_GRAY_H__
+    #define __SSD1306_GRAY_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    /**
+    *   \brief Maximum number of bitplanes (3 planes = 8 gray levels).
+    */
+    #define SSD1306_GRAY_MAX_PLANES 3
+
+    /**
+    *   \brief Size in bytes of the plane storage for the given number of planes.
+    */
+    #define SSD1306_GRAY_PLANES_SIZE(n) ((n) * SSD1306_BUFFER_SIZE)
+
+    /**
+    *   \brief Start grayscale mode.
+    *
+    *   \param planes storage for the planes, #SSD1306_GRAY_PLANES_SIZE bytes.
+    *   \param plane_count number of planes, from 1 to #SSD1306_GRAY_MAX_PLANES.
+    *   \retval #SSD1306_NO_ERROR if grayscale mode was started.
+    *   \retval #SSD1306_COMM_ERROR if the number of planes is not valid,
+    *       or horizontal addressing could not be selected.
+    */
+    uint8_t SSD1306_Gray_Start(uint8_t *planes, uint8_t plane_count);
+
+    /**
+    *   \brief Stop grayscale mode.
+    *
+    *   Waits for the transfer in progress, if any, to be completed. The display keeps
+    *   showing the last plane that was sent. The refresh functions choose
+    *   the addressing mode again.
+    */
+    void SSD1306_Gray_Stop(void);
+
+    /**
+    *   \brief Clear all the planes.
+    */
+    void SSD1306_Gray_Clear(void);
+
+    /**
+    *   \brief Draw a pixel with a gray level.
+    *
+    *   \param x column, in controller coordinates.
+    *   \param y row, in controller coordinates.
+    *   \param level gray level, from 0 (black) to 2^N - 1 (white).
+    */
+    void SSD1306_Gray_DrawPixel(int16_t x, int16_t y, uint8_t level);
+
+    /**
+    *   \brief Draw a vertical line with a gray level.
+    *
+    *   \param x column, in controller coordinates.
+    *   \param y first row, in controller coordinates.
+    *   \param h height of the line.
+    *   \param level gray level, from 0 (black) to 2^N - 1 (white).
+    */
+    void SSD1306_Gray_DrawFastVLine(int16_t x, int16_t y, int16_t h, uint8_t level);
+
+    /**
+    *   \brief Signal that the controller completed a frame.
+    *
+    *   Safe to be called from an interrupt service routine.
+    */
+    void SSD1306_Gray_Tick(void);
+
+    /**
+    *   \brief Advance the transfer of the planes.
+    *
+    *   This function never blocks: it starts the next asynchronous transfer
+    *   when the previous one completed and the current plane was shown
+    *   for its number of frames. A page whose transfer failed is sent
+    *   again, in all the planes, by the next calls.
+    *
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if the last transfer failed or could not be started.
+    */
+    uint8_t SSD1306_Gray_Update(void);
+
+    /**
+    *   \brief Get the number of planes completely sent since start.
+    *
+    *   Sampling this counter over a known interval gives the sustained
+    *   plane rate of the configuration.
+    *
+    *   \return number of planes sent.
+    */
+    uint32_t SSD1306_Gray_GetPlanesSent(void);
+
+    /**
+    *   \brief Get the number of page transfers skipped since start.
+    *
+    *   \return number of pages that were equal to the displayed ones.
+    */
+    uint32_t SSD1306_Gray_GetPagesSkipped(void);
+
+#endif
+
+/* [] END OF FILE */
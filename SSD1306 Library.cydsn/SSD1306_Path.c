@@ -0,0 +1,259 @@
+/**
+ *  \file SSD1306_Path.c
+ *
+ *  \brief Source file for fixed-point vector paths.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Path.h"
+
+// Sine of 0 to 90 degrees, Q16
+static const int32_t path_sin[91] = {
+        0,  1144,  2287,  3430,  4572,  5712,  6850,  7987,
+     9121, 10252, 11380, 12505, 13626, 14742, 15855, 16962,
+    18064, 19161, 20252, 21336, 22415, 23486, 24550, 25607,
+    26656, 27697, 28729, 29753, 30767, 31772, 32768, 33754,
+    34729, 35693, 36647, 37590, 38521, 39441, 40348, 41243,
+    42126, 42995, 43852, 44695, 45525, 46341, 47143, 47930,
+    48703, 49461, 50203, 50931, 51643, 52339, 53020, 53684,
+    54332, 54963, 55578, 56175, 56756, 57319, 57865, 58393,
+    58903, 59396, 59870, 60326, 60764, 61183, 61584, 61966,
+    62328, 62672, 62997, 63303, 63589, 63856, 64104, 64332,
+    64540, 64729, 64898, 65048, 65177, 65287, 65376, 65446,
+    65496, 65526, 65536
+};
+
+/**
+*   \brief Multiply two Q16 numbers, rounding to nearest.
+*/
+static SSD1306_Fixed SSD1306_Path_Mul(SSD1306_Fixed a, SSD1306_Fixed b)
+{
+    return (SSD1306_Fixed)(((int64_t)a * b + 0x8000) >> 16);
+}
+
+/**
+*   \brief Round a Q16 coordinate to the nearest pixel, saturating to 16 bits.
+*/
+static int16_t SSD1306_Path_Round(int64_t v)
+{
+    v = (v + 0x8000) >> 16;
+    if (v > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    if (v < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return (int16_t)v;
+}
+
+/**
+*   \brief Check if the vertices of a path can touch the clip rectangle.
+*
+*   \param path path state.
+*   \param pixels 1 if vertices are pixels (strokes), 0 if they are pixel
+*       corners (fills).
+*   \return 1 if some pixel of the path can be drawn.
+*/
+static uint8_t SSD1306_Path_Visible(const SSD1306_Path *path, uint8_t pixels)
+{
+    int16_t x_min = INT16_MAX, x_max = INT16_MIN;
+    int16_t y_min = INT16_MAX, y_max = INT16_MIN;
+    int16_t cx, cy, cw, ch;
+    uint16_t i;
+
+    if (path->count == 0)
+    {
+        return 0;
+    }
+    for (i = 0; i < path->count; i++)
+    {
+        const SSD1306_Point *p = &path->points[i];
+        x_min = (p->x < x_min) ? p->x : x_min;
+        x_max = (p->x > x_max) ? p->x : x_max;
+        y_min = (p->y < y_min) ? p->y : y_min;
+        y_max = (p->y > y_max) ? p->y : y_max;
+    }
+    SSD1306_GetClip(&cx, &cy, &cw, &ch);
+    return (cw > 0) && (ch > 0) &&
+            ((int32_t)x_max + pixels > cx) && (x_min < cx + cw) &&
+            ((int32_t)y_max + pixels > cy) && (y_min < cy + ch);
+}
+
+SSD1306_Fixed SSD1306_Path_Sin(int16_t angle)
+{
+    SSD1306_Fixed s;
+
+    angle %= 360;
+    if (angle < 0)
+    {
+        angle += 360;
+    }
+    s = path_sin[angle <= 90 ? angle :
+                    angle <= 180 ? 180 - angle :
+                    angle <= 270 ? angle - 180 : 360 - angle];
+    return angle > 180 ? -s : s;
+}
+
+SSD1306_Fixed SSD1306_Path_Cos(int16_t angle)
+{
+    return SSD1306_Path_Sin((angle % 360) + 90);
+}
+
+void SSD1306_Path_Identity(SSD1306_Transform *t)
+{
+    t->a = SSD1306_FIXED_ONE;
+    t->b = 0;
+    t->c = 0;
+    t->d = SSD1306_FIXED_ONE;
+    t->tx = 0;
+    t->ty = 0;
+}
+
+void SSD1306_Path_Translate(SSD1306_Transform *t, SSD1306_Fixed tx, SSD1306_Fixed ty)
+{
+    t->tx += SSD1306_Path_Mul(t->a, tx) + SSD1306_Path_Mul(t->b, ty);
+    t->ty += SSD1306_Path_Mul(t->c, tx) + SSD1306_Path_Mul(t->d, ty);
+}
+
+void SSD1306_Path_Rotate(SSD1306_Transform *t, int16_t angle)
+{
+    SSD1306_Fixed s = SSD1306_Path_Sin(angle);
+    SSD1306_Fixed c = SSD1306_Path_Cos(angle);
+    SSD1306_Fixed a = t->a, b = t->b;
+
+    // Right product with [c -s; s c]
+    t->a = SSD1306_Path_Mul(a, c) + SSD1306_Path_Mul(b, s);
+    t->b = SSD1306_Path_Mul(b, c) - SSD1306_Path_Mul(a, s);
+    a = t->c;
+    b = t->d;
+    t->c = SSD1306_Path_Mul(a, c) + SSD1306_Path_Mul(b, s);
+    t->d = SSD1306_Path_Mul(b, c) - SSD1306_Path_Mul(a, s);
+}
+
+void SSD1306_Path_Scale(SSD1306_Transform *t, SSD1306_Fixed sx, SSD1306_Fixed sy)
+{
+    t->a = SSD1306_Path_Mul(t->a, sx);
+    t->c = SSD1306_Path_Mul(t->c, sx);
+    t->b = SSD1306_Path_Mul(t->b, sy);
+    t->d = SSD1306_Path_Mul(t->d, sy);
+}
+
+void SSD1306_Path_Apply(const SSD1306_Transform *t, int16_t x, int16_t y,
+                        SSD1306_Point *p)
+{
+    p->x = SSD1306_Path_Round((int64_t)t->a * x + (int64_t)t->b * y + t->tx);
+    p->y = SSD1306_Path_Round((int64_t)t->c * x + (int64_t)t->d * y + t->ty);
+}
+
+void SSD1306_Path_Init(SSD1306_Path *path, SSD1306_Point *points, uint16_t capacity)
+{
+    SSD1306_Path_Identity(&path->transform);
+    path->points = points;
+    path->capacity = capacity;
+    SSD1306_Path_Clear(path);
+}
+
+void SSD1306_Path_Clear(SSD1306_Path *path)
+{
+    path->count = 0;
+    path->contours = 0;
+    path->closed = 0;
+}
+
+uint8_t SSD1306_Path_MoveTo(SSD1306_Path *path, int16_t x, int16_t y)
+{
+    if ((path->contours >= SSD1306_PATH_MAX_CONTOURS) || (path->count >= path->capacity))
+    {
+        return SSD1306_GFX_OVERFLOW_ERROR;
+    }
+    path->counts[path->contours++] = 0;
+    return SSD1306_Path_LineTo(path, x, y);
+}
+
+uint8_t SSD1306_Path_LineTo(SSD1306_Path *path, int16_t x, int16_t y)
+{
+    if (path->contours == 0)
+    {
+        return SSD1306_Path_MoveTo(path, x, y);
+    }
+    if (path->count >= path->capacity)
+    {
+        return SSD1306_GFX_OVERFLOW_ERROR;
+    }
+    SSD1306_Path_Apply(&path->transform, x, y, &path->points[path->count++]);
+    path->counts[path->contours - 1]++;
+    return SSD1306_NO_ERROR;
+}
+
+void SSD1306_Path_Close(SSD1306_Path *path)
+{
+    if (path->contours > 0)
+    {
+        path->closed |= 1U << (path->contours - 1);
+    }
+}
+
+uint8_t SSD1306_Path_Polyline(SSD1306_Path *path, const SSD1306_Point *points,
+                                uint16_t count, uint8_t closed)
+{
+    uint16_t i;
+
+    if (count == 0)
+    {
+        return SSD1306_NO_ERROR;
+    }
+    // Check the room first, so that a failure leaves no partial contour
+    if ((path->contours >= SSD1306_PATH_MAX_CONTOURS) ||
+        (count > path->capacity - path->count))
+    {
+        return SSD1306_GFX_OVERFLOW_ERROR;
+    }
+    SSD1306_Path_MoveTo(path, points[0].x, points[0].y);
+    for (i = 1; i < count; i++)
+    {
+        SSD1306_Path_LineTo(path, points[i].x, points[i].y);
+    }
+    if (closed)
+    {
+        SSD1306_Path_Close(path);
+    }
+    return SSD1306_NO_ERROR;
+}
+
+void SSD1306_Path_Stroke(const SSD1306_Path *path, uint16_t color)
+{
+    const SSD1306_Point *points = path->points;
+    uint8_t c;
+
+    if (!SSD1306_Path_Visible(path, 1))
+    {
+        return;
+    }
+    for (c = 0; c < path->contours; c++)
+    {
+        SSD1306_GFX_DrawPolyline(points, path->counts[c], (path->closed >> c) & 0x01, color);
+        points += path->counts[c];
+    }
+}
+
+uint8_t SSD1306_Path_Fill(const SSD1306_Path *path, uint8_t rule, uint16_t color)
+{
+    if (!SSD1306_Path_Visible(path, 0))
+    {
+        return SSD1306_NO_ERROR;
+    }
+    return SSD1306_GFX_FillPath(path->points, path->counts, path->contours, rule, color);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,240 @@
+/**
+ *   \file SSD1306_Path.h
+ *
+ *   \brief Vector paths drawn through a fixed-point affine transform.
+ *
+ *   A path is a list of contours built with #SSD1306_Path_MoveTo,
+ *   #SSD1306_Path_LineTo and #SSD1306_Path_Close. Vertices are mapped by
+ *   the 2x3 transform of the path as they are added, in Q16 fixed point,
+ *   and rounded to pixels, so that a shape defined once (e.g. a compass
+ *   needle around its pivot) is rotated, scaled and moved without any
+ *   floating point. Rotations use a table of sines in whole degrees.
+ *
+ *   #SSD1306_Path_Stroke draws the contours with #SSD1306_GFX_DrawPolyline,
+ *   which writes each line as runs of pixels, and #SSD1306_Path_Fill fills
+ *   them with #SSD1306_GFX_FillPath, which writes whole bytes of each page.
+ *   Both reject at once a path whose bounding box is outside the clip
+ *   rectangle.
+ *
+ *   The transform maps a point (x, y) to
+ *   (a * x + b * y + tx, c * x + d * y + ty). Operations are applied to the
+ *   coordinates of the path before the ones already in the transform, so
+ *   translating to a pivot and then rotating turns the shape around the
+ *   pivot. Angles are in degrees, clockwise on the display.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_PATH_H__
+    #define __SSD1306_PATH_H__
+
+    #include "cytypes.h"
+    #include "SSD1306_GFX.h"
+
+    #ifndef SSD1306_PATH_MAX_CONTOURS
+        /**
+        *   \brief Maximum number of contours of a path.
+        */
+        #define SSD1306_PATH_MAX_CONTOURS 8
+    #endif
+
+    #if SSD1306_PATH_MAX_CONTOURS > 16
+        #error "SSD1306_Path supports at most 16 contours"
+    #endif
+
+    /**
+    *   \brief One in Q16 fixed point.
+    */
+    #define SSD1306_FIXED_ONE 65536L
+
+    /**
+    *   \brief Convert an integer to Q16 fixed point.
+    */
+    #define SSD1306_FIXED(value) ((SSD1306_Fixed)(value) * SSD1306_FIXED_ONE)
+
+    /**
+    *   \brief Convert a ratio of integers to Q16 fixed point.
+    */
+    #define SSD1306_FIXED_RATIO(num, den) ((SSD1306_Fixed)(((int32_t)(num) * SSD1306_FIXED_ONE) / (den)))
+
+    /**
+    *   \brief Signed Q16 fixed point number.
+    */
+    typedef int32_t SSD1306_Fixed;
+
+    /**
+    *   \brief Affine transform, Q16 fixed point.
+    */
+    typedef struct {
+        SSD1306_Fixed a;    ///< X scale and rotation
+        SSD1306_Fixed b;    ///< Rotation and shear of x by y
+        SSD1306_Fixed c;    ///< Rotation and shear of y by x
+        SSD1306_Fixed d;    ///< Y scale and rotation
+        SSD1306_Fixed tx;   ///< X translation, in pixels
+        SSD1306_Fixed ty;   ///< Y translation, in pixels
+    } SSD1306_Transform;
+
+    /**
+    *   \brief State of a path.
+    */
+    typedef struct {
+        SSD1306_Transform transform;                ///< Transform of the vertices being added
+        SSD1306_Point *points;                      ///< Transformed vertices of all the contours
+        uint16_t capacity;                          ///< Size of points
+        uint16_t count;                             ///< Vertices of all the contours
+        uint16_t counts[SSD1306_PATH_MAX_CONTOURS]; ///< Vertices of each contour
+        uint8_t contours;                           ///< Contours started
+        uint16_t closed;                            ///< Closed contours, bit n for contour n
+    } SSD1306_Path;
+
+    /**
+    *   \brief Get the sine of an angle.
+    *
+    *   \param angle angle in degrees, any value.
+    *   \return sine, Q16.
+    */
+    SSD1306_Fixed SSD1306_Path_Sin(int16_t angle);
+
+    /**
+    *   \brief Get the cosine of an angle.
+    *
+    *   \param angle angle in degrees, any value.
+    *   \return cosine, Q16.
+    */
+    SSD1306_Fixed SSD1306_Path_Cos(int16_t angle);
+
+    /**
+    *   \brief Reset a transform to the identity.
+    *
+    *   \param t transform.
+    */
+    void SSD1306_Path_Identity(SSD1306_Transform *t);
+
+    /**
+    *   \brief Move the origin of a transform.
+    *
+    *   \param t transform.
+    *   \param tx horizontal offset, Q16.
+    *   \param ty vertical offset, Q16.
+    */
+    void SSD1306_Path_Translate(SSD1306_Transform *t, SSD1306_Fixed tx, SSD1306_Fixed ty);
+
+    /**
+    *   \brief Rotate a transform around its origin.
+    *
+    *   \param t transform.
+    *   \param angle angle in degrees, clockwise.
+    */
+    void SSD1306_Path_Rotate(SSD1306_Transform *t, int16_t angle);
+
+    /**
+    *   \brief Scale a transform around its origin.
+    *
+    *   \param t transform.
+    *   \param sx horizontal factor, Q16.
+    *   \param sy vertical factor, Q16.
+    */
+    void SSD1306_Path_Scale(SSD1306_Transform *t, SSD1306_Fixed sx, SSD1306_Fixed sy);
+
+    /**
+    *   \brief Map a point with a transform.
+    *
+    *   \param t transform.
+    *   \param x x coordinate.
+    *   \param y y coordinate.
+    *   \param p transformed point, rounded to the nearest pixel.
+    */
+    void SSD1306_Path_Apply(const SSD1306_Transform *t, int16_t x, int16_t y,
+                            SSD1306_Point *p);
+
+    /**
+    *   \brief Initialize an empty path with the identity transform.
+    *
+    *   \param path path state.
+    *   \param points storage of the transformed vertices.
+    *   \param capacity number of vertices of points.
+    */
+    void SSD1306_Path_Init(SSD1306_Path *path, SSD1306_Point *points, uint16_t capacity);
+
+    /**
+    *   \brief Remove all the contours of a path, keeping its transform.
+    *
+    *   \param path path state.
+    */
+    void SSD1306_Path_Clear(SSD1306_Path *path);
+
+    /**
+    *   \brief Start a new contour.
+    *
+    *   \param path path state.
+    *   \param x x coordinate, mapped by the transform of the path.
+    *   \param y y coordinate, mapped by the transform of the path.
+    *   \retval #SSD1306_NO_ERROR if the vertex was added.
+    *   \retval #SSD1306_GFX_OVERFLOW_ERROR if there is no room for the vertex
+    *       or the contour.
+    */
+    uint8_t SSD1306_Path_MoveTo(SSD1306_Path *path, int16_t x, int16_t y);
+
+    /**
+    *   \brief Add a line from the last vertex of the current contour.
+    *
+    *   A contour is started at the vertex if there is none.
+    *
+    *   \param path path state.
+    *   \param x x coordinate, mapped by the transform of the path.
+    *   \param y y coordinate, mapped by the transform of the path.
+    *   \retval #SSD1306_NO_ERROR if the vertex was added.
+    *   \retval #SSD1306_GFX_OVERFLOW_ERROR if there is no room for the vertex.
+    */
+    uint8_t SSD1306_Path_LineTo(SSD1306_Path *path, int16_t x, int16_t y);
+
+    /**
+    *   \brief Join the last vertex of the current contour to its first one.
+    *
+    *   Contours are always closed when filled; closing matters for strokes.
+    *
+    *   \param path path state.
+    */
+    void SSD1306_Path_Close(SSD1306_Path *path);
+
+    /**
+    *   \brief Add a contour through a list of points.
+    *
+    *   \param path path state.
+    *   \param points vertices, mapped by the transform of the path.
+    *   \param count number of vertices.
+    *   \param closed 1 to close the contour.
+    *   \retval #SSD1306_NO_ERROR if the contour was added.
+    *   \retval #SSD1306_GFX_OVERFLOW_ERROR if there is no room for the contour.
+    */
+    uint8_t SSD1306_Path_Polyline(SSD1306_Path *path, const SSD1306_Point *points,
+                                    uint16_t count, uint8_t closed);
+
+    /**
+    *   \brief Draw the contours of a path as lines.
+    *
+    *   \param path path state.
+    *   \param color color of the lines.
+    */
+    void SSD1306_Path_Stroke(const SSD1306_Path *path, uint16_t color);
+
+    /**
+    *   \brief Fill the contours of a path.
+    *
+    *   \param path path state.
+    *   \param rule #SSD1306_GFX_EVEN_ODD or #SSD1306_GFX_NONZERO.
+    *   \param color color of the fill.
+    *   \retval #SSD1306_NO_ERROR if the path was drawn.
+    *   \retval #SSD1306_GFX_OVERFLOW_ERROR if the path has too many edges.
+    */
+    uint8_t SSD1306_Path_Fill(const SSD1306_Path *path, uint8_t rule, uint16_t color);
+
+#endif
+
+/* [] END OF FILE */
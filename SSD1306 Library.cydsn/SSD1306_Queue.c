@@ -0,0 +1,265 @@
+/**
+ *  \file SSD1306_Queue.c
+ *
+ *  \brief Source file for the drawing command queue.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_GFX.h"
+#include "SSD1306_Queue.h"
+
+#if !SSD1306_NO_FRAMEBUFFER
+
+#if SSD1306_QUEUE_MULTI_PRODUCER && SSD1306_QUEUE_CRITICAL
+    #include "CyLib.h"
+#endif
+
+//***************************
+//          MACROS
+//***************************
+#define SSD1306_QUEUE_BARRIER() __sync_synchronize()   ///< Full memory barrier
+
+#if SSD1306_QUEUE_MULTI_PRODUCER
+    /** \brief Increment a counter shared by the producers. */
+    #define SSD1306_QUEUE_COUNT(counter) __sync_fetch_and_add(&(counter), 1)
+#else
+    #define SSD1306_QUEUE_COUNT(counter) ((counter)++)
+#endif
+
+void SSD1306_Queue_Init(SSD1306_Queue *queue, SSD1306_QueueSlot *slots, uint32_t count)
+{
+    uint32_t i;
+
+    queue->slots = slots;
+    queue->mask = count - 1;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->stats.pushed = 0;
+    queue->stats.dropped = 0;
+    queue->stats.executed = 0;
+    queue->stats.flush_errors = 0;
+    queue->stats.high_water = 0;
+    // Slot n is ready for the producer of position n
+    for (i = 0; i < count; i++)
+    {
+        slots[i].sequence = i;
+    }
+    SSD1306_QUEUE_BARRIER();
+}
+
+/**
+*   \brief Claim the next position of the queue for a producer.
+*
+*   \param queue queue state.
+*   \param pos destination of the claimed position.
+*   \return 1 if claimed, 0 if the queue is full.
+*/
+static uint8_t SSD1306_Queue_Reserve(SSD1306_Queue *queue, uint32_t *pos)
+{
+#if SSD1306_QUEUE_MULTI_PRODUCER && SSD1306_QUEUE_CRITICAL
+    // Nothing else can claim a position until the critical section ends
+    uint8_t state = CyEnterCriticalSection();
+    uint8_t claimed;
+
+    *pos = queue->head;
+    claimed = (queue->slots[*pos & queue->mask].sequence == *pos);
+    if (claimed)
+    {
+        queue->head = *pos + 1;
+        queue->stats.pushed++;
+    }
+    else
+    {
+        // Slot still holds a command of the previous lap
+        queue->stats.dropped++;
+    }
+    CyExitCriticalSection(state);
+    return claimed;
+#else
+    uint32_t p = queue->head;
+
+    for (;;)
+    {
+        int32_t diff = (int32_t)(queue->slots[p & queue->mask].sequence - p);
+
+        if (diff < 0)
+        {
+            // Slot still holds a command of the previous lap
+            SSD1306_QUEUE_COUNT(queue->stats.dropped);
+            return 0;
+        }
+        if (diff > 0)
+        {
+            // Another producer claimed the position
+            p = queue->head;
+            continue;
+        }
+        #if SSD1306_QUEUE_MULTI_PRODUCER
+            if (__sync_bool_compare_and_swap(&queue->head, p, p + 1))
+            {
+                break;
+            }
+            p = queue->head;
+        #else
+            queue->head = p + 1;
+            break;
+        #endif
+    }
+    SSD1306_QUEUE_COUNT(queue->stats.pushed);
+    *pos = p;
+    return 1;
+#endif
+}
+
+uint8_t SSD1306_Queue_Push(SSD1306_Queue *queue, const SSD1306_QueueCommand *command)
+{
+    SSD1306_QueueSlot *slot;
+    uint32_t pos, used;
+
+    if (!SSD1306_Queue_Reserve(queue, &pos))
+    {
+        return SSD1306_QUEUE_FULL_ERROR;
+    }
+    slot = &queue->slots[pos & queue->mask];
+    slot->command = *command;
+    // Publish the command only once it is written
+    SSD1306_QUEUE_BARRIER();
+    slot->sequence = pos + 1;
+
+    used = pos + 1 - queue->tail;
+    if (used > queue->stats.high_water)
+    {
+        // Approximate with several producers
+        queue->stats.high_water = (uint16_t)used;
+    }
+    return SSD1306_NO_ERROR;
+}
+
+uint8_t SSD1306_Queue_Draw(SSD1306_Queue *queue, uint8_t op, int16_t a, int16_t b,
+                            int16_t c, int16_t d, uint8_t color)
+{
+    SSD1306_QueueCommand command;
+
+    command.op = op;
+    command.color = color;
+    command.args[0] = a;
+    command.args[1] = b;
+    command.args[2] = c;
+    command.args[3] = d;
+    command.function = NULL;
+    command.context = NULL;
+    return SSD1306_Queue_Push(queue, &command);
+}
+
+uint8_t SSD1306_Queue_Flush(SSD1306_Queue *queue)
+{
+    return SSD1306_Queue_Draw(queue, SSD1306_QUEUE_FLUSH, 0, 0, 0, 0, 0);
+}
+
+uint8_t SSD1306_Queue_Call(SSD1306_Queue *queue, void (*function)(void *), void *context)
+{
+    SSD1306_QueueCommand command;
+
+    command.op = SSD1306_QUEUE_CALL;
+    command.color = 0;
+    command.function = function;
+    command.context = context;
+    return SSD1306_Queue_Push(queue, &command);
+}
+
+/**
+*   \brief Execute a command.
+*
+*   \param queue queue state.
+*   \param command command to be executed.
+*/
+static void SSD1306_Queue_Execute(SSD1306_Queue *queue, const SSD1306_QueueCommand *command)
+{
+    const int16_t *a = command->args;
+
+    switch (command->op)
+    {
+        case SSD1306_QUEUE_PIXEL:
+            SSD1306_DrawPixel(a[0], a[1], command->color);
+            break;
+        case SSD1306_QUEUE_LINE:
+            SSD1306_GFX_DrawLine(a[0], a[1], a[2], a[3], command->color);
+            break;
+        case SSD1306_QUEUE_RECT:
+            SSD1306_GFX_DrawRect(a[0], a[1], a[2], a[3], command->color);
+            break;
+        case SSD1306_QUEUE_FILL_RECT:
+            SSD1306_GFX_FillRect(a[0], a[1], a[2], a[3], command->color);
+            break;
+        case SSD1306_QUEUE_CIRCLE:
+            SSD1306_GFX_DrawCircle(a[0], a[1], a[2], command->color);
+            break;
+        case SSD1306_QUEUE_FILL_CIRCLE:
+            SSD1306_GFX_FillCircle(a[0], a[1], a[2], command->color);
+            break;
+        case SSD1306_QUEUE_CLEAR:
+            SSD1306_ClearDisplay();
+            break;
+        case SSD1306_QUEUE_FLUSH:
+            if (SSD1306_DisplayDirty() != SSD1306_NO_ERROR)
+            {
+                queue->stats.flush_errors++;
+            }
+            break;
+        case SSD1306_QUEUE_CALL:
+            if (command->function != NULL)
+            {
+                command->function(command->context);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+uint16_t SSD1306_Queue_Drain(SSD1306_Queue *queue, uint16_t max)
+{
+    uint16_t executed = 0;
+
+    while (executed < max)
+    {
+        uint32_t pos = queue->tail;
+        SSD1306_QueueSlot *slot = &queue->slots[pos & queue->mask];
+        SSD1306_QueueCommand command;
+
+        if ((int32_t)(slot->sequence - (pos + 1)) < 0)
+        {
+            // Not published yet
+            break;
+        }
+        SSD1306_QUEUE_BARRIER();
+        command = slot->command;
+        // Release the slot before executing, producers can refill it
+        SSD1306_QUEUE_BARRIER();
+        slot->sequence = pos + queue->mask + 1;
+        queue->tail = pos + 1;
+
+        SSD1306_Queue_Execute(queue, &command);
+        executed++;
+    }
+    queue->stats.executed += executed;
+    return executed;
+}
+
+uint32_t SSD1306_Queue_GetCount(const SSD1306_Queue *queue)
+{
+    return queue->head - queue->tail;
+}
+
+#endif
+
+/* [] END OF FILE */
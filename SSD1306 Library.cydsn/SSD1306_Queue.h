@@ -0,0 +1,197 @@
+/**
+ *   \file SSD1306_Queue.h
+ *
+ *   \brief Lock-free queue of drawing commands for a display task.
+ *
+ *   Under an RTOS, tasks that want to update the display push drawing and
+ *   flush commands into a queue instead of calling the library; a single
+ *   display task drains the queue, so that the buffer and the I2C bus are
+ *   only ever used by one task. Pushing never blocks: when the queue is
+ *   full the command is dropped and counted.
+ *
+ *   Each slot carries a sequence number (bounded queue of D. Vyukov): a
+ *   producer claims a slot by advancing the head, fills it and then
+ *   publishes it by updating its sequence; the consumer frees it the same
+ *   way. With #SSD1306_QUEUE_MULTI_PRODUCER the head is claimed with a
+ *   compare-and-swap, so any number of tasks and interrupts can push;
+ *   otherwise only one producer is allowed and a plain store is used.
+ *   Cores without exclusive load and store (the Cortex-M0 of PSoC 4) have
+ *   no native compare-and-swap: there, with #SSD1306_QUEUE_CRITICAL, the
+ *   head is claimed in a short critical section instead.
+ *   Memory barriers order the slot contents and the sequence numbers.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_QUEUE_H__
+    #define __SSD1306_QUEUE_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    #if !SSD1306_NO_FRAMEBUFFER
+
+    #ifndef SSD1306_QUEUE_MULTI_PRODUCER
+        /**
+        *   \brief Set to 1 to allow several producers.
+        */
+        #define SSD1306_QUEUE_MULTI_PRODUCER 0
+    #endif
+
+    #ifndef SSD1306_QUEUE_CRITICAL
+        /**
+        *   \brief 1 to claim slots with interrupts disabled instead of a compare-and-swap.
+        *
+        *   Only used with #SSD1306_QUEUE_MULTI_PRODUCER. Set by default on
+        *   ARMv6-M (Cortex-M0, M0+).
+        */
+        #if defined(__ARM_ARCH_6M__)
+            #define SSD1306_QUEUE_CRITICAL 1
+        #else
+            #define SSD1306_QUEUE_CRITICAL 0
+        #endif
+    #endif
+
+    /**
+    *   \brief Queue is full, the command was dropped.
+    */
+    #define SSD1306_QUEUE_FULL_ERROR 6
+
+    /**********************************
+    *          COMMANDS
+    **********************************/
+
+    #define SSD1306_QUEUE_PIXEL         0   ///< x, y
+    #define SSD1306_QUEUE_LINE          1   ///< x0, y0, x1, y1
+    #define SSD1306_QUEUE_RECT          2   ///< x, y, w, h
+    #define SSD1306_QUEUE_FILL_RECT     3   ///< x, y, w, h
+    #define SSD1306_QUEUE_CIRCLE        4   ///< x, y, r
+    #define SSD1306_QUEUE_FILL_CIRCLE   5   ///< x, y, r
+    #define SSD1306_QUEUE_CLEAR         6   ///< Clear the buffer
+    #define SSD1306_QUEUE_FLUSH         7   ///< Send the dirty regions
+    #define SSD1306_QUEUE_CALL          8   ///< Call a function in the display task
+
+    /**
+    *   \brief Drawing command.
+    */
+    typedef struct {
+        uint8_t op;                     ///< One of the SSD1306_QUEUE_* commands
+        uint8_t color;                  ///< Color of drawing commands
+        int16_t args[4];                ///< Coordinates of drawing commands
+        void (*function)(void *);       ///< Function of #SSD1306_QUEUE_CALL
+        void *context;                  ///< Argument of the function
+    } SSD1306_QueueCommand;
+
+    /**
+    *   \brief Slot of the queue.
+    */
+    typedef struct {
+        volatile uint32_t sequence;     ///< Position the slot is ready for
+        SSD1306_QueueCommand command;   ///< Command stored in the slot
+    } SSD1306_QueueSlot;
+
+    /**
+    *   \brief Queue statistics.
+    */
+    typedef struct {
+        uint32_t pushed;        ///< Commands queued
+        uint32_t dropped;       ///< Commands dropped because the queue was full
+        uint32_t executed;      ///< Commands executed by the display task
+        uint32_t flush_errors;  ///< Flushes that failed
+        uint16_t high_water;    ///< Highest number of queued commands seen
+    } SSD1306_QueueStats;
+
+    /**
+    *   \brief State of a queue.
+    */
+    typedef struct {
+        SSD1306_QueueSlot *slots;       ///< Slots, a power of two
+        uint32_t mask;                  ///< Number of slots minus one
+        volatile uint32_t head;         ///< Next position to be claimed by a producer
+        volatile uint32_t tail;         ///< Next position to be executed
+        SSD1306_QueueStats stats;       ///< Statistics
+    } SSD1306_Queue;
+
+    /**
+    *   \brief Initialize an empty queue.
+    *
+    *   \param queue queue state.
+    *   \param slots storage of the slots.
+    *   \param count number of slots, a power of two.
+    */
+    void SSD1306_Queue_Init(SSD1306_Queue *queue, SSD1306_QueueSlot *slots, uint32_t count);
+
+    /**
+    *   \brief Push a command, without blocking.
+    *
+    *   \param queue queue state.
+    *   \param command command to be copied into the queue.
+    *   \retval #SSD1306_NO_ERROR if the command was queued.
+    *   \retval #SSD1306_QUEUE_FULL_ERROR if the queue is full.
+    */
+    uint8_t SSD1306_Queue_Push(SSD1306_Queue *queue, const SSD1306_QueueCommand *command);
+
+    /**
+    *   \brief Push a drawing command.
+    *
+    *   \param queue queue state.
+    *   \param op drawing command.
+    *   \param a first argument.
+    *   \param b second argument.
+    *   \param c third argument.
+    *   \param d fourth argument.
+    *   \param color color.
+    *   \retval #SSD1306_NO_ERROR if the command was queued.
+    *   \retval #SSD1306_QUEUE_FULL_ERROR if the queue is full.
+    */
+    uint8_t SSD1306_Queue_Draw(SSD1306_Queue *queue, uint8_t op, int16_t a, int16_t b,
+                                int16_t c, int16_t d, uint8_t color);
+
+    /**
+    *   \brief Push a flush of the dirty regions.
+    *
+    *   \param queue queue state.
+    *   \retval #SSD1306_NO_ERROR if the command was queued.
+    *   \retval #SSD1306_QUEUE_FULL_ERROR if the queue is full.
+    */
+    uint8_t SSD1306_Queue_Flush(SSD1306_Queue *queue);
+
+    /**
+    *   \brief Push a function call to be made by the display task.
+    *
+    *   \param queue queue state.
+    *   \param function function to be called.
+    *   \param context argument of the function.
+    *   \retval #SSD1306_NO_ERROR if the command was queued.
+    *   \retval #SSD1306_QUEUE_FULL_ERROR if the queue is full.
+    */
+    uint8_t SSD1306_Queue_Call(SSD1306_Queue *queue, void (*function)(void *), void *context);
+
+    /**
+    *   \brief Execute queued commands, in the display task.
+    *
+    *   \param queue queue state.
+    *   \param max maximum number of commands to execute.
+    *   \return number of commands executed.
+    */
+    uint16_t SSD1306_Queue_Drain(SSD1306_Queue *queue, uint16_t max);
+
+    /**
+    *   \brief Get the number of queued commands.
+    *
+    *   \param queue queue state.
+    *   \return number of commands waiting to be executed.
+    */
+    uint32_t SSD1306_Queue_GetCount(const SSD1306_Queue *queue);
+
+    #endif
+
+#endif
+
+/* [] END OF FILE */
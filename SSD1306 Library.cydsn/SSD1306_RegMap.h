@@ -33,9 +33,11 @@
     #define SSD1306_SETPRECHARGE 0xD9        ///< See datasheet
     #define SSD1306_SETCOMPINS 0xDA          ///< See datasheet
     #define SSD1306_SETVCOMDETECT 0xDB       ///< See datasheet
+    #define SSD1306_NOP 0xE3                 ///< See datasheet
 
-    #define SSD1306_SETLOWCOLUMN 0x00  ///< Not currently used
-    #define SSD1306_SETHIGHCOLUMN 0x10 ///< Not currently used
+    #define SSD1306_SETLOWCOLUMN 0x00  ///< Lower nibble of column, page addressing mode
+    #define SSD1306_SETHIGHCOLUMN 0x10 ///< Higher nibble of column, page addressing mode
+    #define SSD1306_SETPAGESTART 0xB0  ///< Page, page addressing mode
     #define SSD1306_SETSTARTLINE 0x40  ///< See datasheet
 
     #define SSD1306_EXTERNALVCC 0x01  ///< External display voltage source
@@ -45,6 +47,8 @@
     #define SSD1306_LEFT_HORIZONTAL_SCROLL 0x27               ///< Init left scroll
     #define SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL 0x29 ///< Init diag scroll
     #define SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL 0x2A  ///< Init diag scroll
+    #define SSD1306_RIGHT_CONTENT_SCROLL 0x2C                 ///< Scroll by one column
+    #define SSD1306_LEFT_CONTENT_SCROLL 0x2D                  ///< Scroll by one column
     #define SSD1306_DEACTIVATE_SCROLL 0x2E                    ///< Stop scroll
     #define SSD1306_ACTIVATE_SCROLL 0x2F                      ///< Start scroll
     #define SSD1306_SET_VERTICAL_SCROLL_AREA 0xA3             ///< Set scroll range
@@ -0,0 +1,189 @@
+/**
+ *  \file SSD1306_Sprite.c
+ *
+ *  \brief Source file for sprites with save-under.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306_Sprite.h"
+
+/**
+*   \brief Get eight rows of an image column.
+*
+*   \param image page-major image.
+*   \param width width of the image.
+*   \param pages number of pages of the image.
+*   \param col column of the image.
+*   \param row first row, may be negative. Rows outside the image read as 0.
+*   \return rows row to row + 7, LSB first.
+*/
+static uint8_t SSD1306_Sprite_Bits(const uint8_t *image, uint8_t width, uint8_t pages,
+                                    uint8_t col, int16_t row)
+{
+    // Offset by one page so that the division rounds down for negative rows
+    int16_t page = (row + 8) / 8 - 1;
+    uint8_t shift = (row + 8) % 8;
+    uint16_t lo = ((page >= 0) && (page < pages)) ? image[col + page * width] : 0;
+    uint16_t hi = ((page + 1 >= 0) && (page + 1 < pages)) ? image[col + (page + 1) * width] : 0;
+
+    return (uint8_t)(((hi << 8) | lo) >> shift);
+}
+
+/**
+*   \brief Put back the background saved under a sprite.
+*
+*   \param sprite sprite state.
+*/
+static void SSD1306_Sprite_Restore(SSD1306_Sprite *sprite)
+{
+    uint8_t *buffer = SSD1306_GetBuffer();
+    const uint8_t *save = sprite->save;
+    uint8_t page, col;
+
+    if (!sprite->visible || (buffer == NULL))
+    {
+        return;
+    }
+    for (page = sprite->save_page; page < sprite->save_page + sprite->save_pages; page++)
+    {
+        uint8_t *dst = &buffer[page * SSD1306_WIDTH + sprite->save_x];
+        for (col = 0; col < sprite->save_w; col++)
+        {
+            *dst++ = *save++;
+        }
+    }
+    SSD1306_MarkDirty(sprite->save_x, sprite->save_page * 8,
+                        sprite->save_w, sprite->save_pages * 8);
+    sprite->visible = 0;
+}
+
+/**
+*   \brief Save the background under a sprite and draw it.
+*
+*   \param sprite sprite state.
+*/
+static void SSD1306_Sprite_Draw(SSD1306_Sprite *sprite)
+{
+    uint8_t *buffer = SSD1306_GetBuffer();
+    uint8_t *save = sprite->save;
+    uint8_t pages = (sprite->height + 7) / 8;
+    int16_t cx, cy, cw, ch;
+    int16_t x0, y0, x1, y1;
+    uint8_t page, col;
+
+    // Footprint of the sprite inside the clip rectangle
+    SSD1306_GetControllerClip(&cx, &cy, &cw, &ch);
+    x0 = (sprite->x > cx) ? sprite->x : cx;
+    y0 = (sprite->y > cy) ? sprite->y : cy;
+    x1 = (sprite->x + sprite->width < cx + cw) ? sprite->x + sprite->width : cx + cw;
+    y1 = (sprite->y + sprite->height < cy + ch) ? sprite->y + sprite->height : cy + ch;
+
+    sprite->visible = 1;
+    if ((x0 >= x1) || (y0 >= y1) || (buffer == NULL))
+    {
+        sprite->save_w = 0;
+        sprite->save_pages = 0;
+        return;
+    }
+    sprite->save_x = x0;
+    sprite->save_w = x1 - x0;
+    sprite->save_page = y0 / 8;
+    sprite->save_pages = (y1 - 1) / 8 - y0 / 8 + 1;
+
+    for (page = sprite->save_page; page < sprite->save_page + sprite->save_pages; page++)
+    {
+        uint8_t *dst = &buffer[page * SSD1306_WIDTH + x0];
+        int16_t row = page * 8 - sprite->y;
+        // Rows of the page covered by the sprite
+        uint8_t footprint = 0xFF;
+        if (page * 8 < y0)
+        {
+            footprint &= 0xFF << (y0 - page * 8);
+        }
+        if (page * 8 + 8 > y1)
+        {
+            footprint &= 0xFF >> (page * 8 + 8 - y1);
+        }
+
+        for (col = x0 - sprite->x; col < x1 - sprite->x; col++)
+        {
+            uint8_t bits = SSD1306_Sprite_Bits(sprite->image, sprite->width, pages, col, row);
+            uint8_t mask;
+
+            *save++ = *dst;
+            switch (sprite->mode)
+            {
+                case SSD1306_SPRITE_OR:
+                    *dst |= bits & footprint;
+                    break;
+                case SSD1306_SPRITE_AND:
+                    *dst &= bits | ~footprint;
+                    break;
+                case SSD1306_SPRITE_XOR:
+                    *dst ^= bits & footprint;
+                    break;
+                case SSD1306_SPRITE_MASK:
+                    mask = SSD1306_Sprite_Bits(sprite->mask, sprite->width, pages, col, row) & footprint;
+                    *dst = (*dst & ~mask) | (bits & mask);
+                    break;
+            }
+            dst++;
+        }
+    }
+    SSD1306_MarkDirty(sprite->save_x, sprite->save_page * 8,
+                        sprite->save_w, sprite->save_pages * 8);
+}
+
+void SSD1306_Sprite_Init(SSD1306_Sprite *sprite, const uint8_t *image,
+                            const uint8_t *mask, uint8_t width, uint8_t height,
+                            uint8_t mode, uint8_t *save)
+{
+    sprite->image = image;
+    sprite->mask = mask;
+    sprite->save = save;
+    sprite->width = width;
+    sprite->height = height;
+    sprite->mode = mode;
+    sprite->visible = 0;
+    sprite->x = 0;
+    sprite->y = 0;
+    sprite->save_w = 0;
+    sprite->save_pages = 0;
+}
+
+void SSD1306_Sprite_Move(SSD1306_Sprite *sprite, int16_t x, int16_t y)
+{
+    SSD1306_Sprite_Restore(sprite);
+    sprite->x = x;
+    sprite->y = y;
+    SSD1306_Sprite_Draw(sprite);
+}
+
+void SSD1306_Sprite_SetImage(SSD1306_Sprite *sprite, const uint8_t *image,
+                                const uint8_t *mask)
+{
+    uint8_t visible = sprite->visible;
+
+    SSD1306_Sprite_Restore(sprite);
+    sprite->image = image;
+    sprite->mask = mask;
+    if (visible)
+    {
+        SSD1306_Sprite_Draw(sprite);
+    }
+}
+
+void SSD1306_Sprite_Hide(SSD1306_Sprite *sprite)
+{
+    SSD1306_Sprite_Restore(sprite);
+}
+
+/* [] END OF FILE */
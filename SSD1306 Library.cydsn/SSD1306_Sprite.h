@@ -0,0 +1,131 @@
+/**
+ *   \file SSD1306_Sprite.h
+ *
+ *   \brief Sprites drawn over the frame buffer with save-under.
+ *
+ *   A sprite saves the page-aligned buffer bytes it covers before being
+ *   drawn, and puts them back when it is moved or hidden. Moving a sprite
+ *   over a static background therefore does not require the background to
+ *   be redrawn, and only the old and new footprints are marked dirty, so
+ *   that #SSD1306_DisplayDirty sends just a few dozen bytes per frame.
+ *
+ *   Images and masks are page-major, like the frame buffer: byte
+ *   (x + page * width) holds rows 8 * page to 8 * page + 7 of column x,
+ *   LSB on top. Positions are in controller coordinates, and drawing is
+ *   limited to the current clip rectangle.
+ *
+ *   Overlapping sprites must be hidden in the reverse order they were
+ *   shown, and the background under a visible sprite must not be drawn,
+ *   otherwise the saved bytes would overwrite the changes.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_SPRITE_H__
+    #define __SSD1306_SPRITE_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    /**********************************
+    *          DRAWING MODES
+    **********************************/
+
+    /**
+    *   \brief Set pixels where the image is set.
+    */
+    #define SSD1306_SPRITE_OR 0
+
+    /**
+    *   \brief Clear pixels where the image is clear.
+    */
+    #define SSD1306_SPRITE_AND 1
+
+    /**
+    *   \brief Invert pixels where the image is set.
+    */
+    #define SSD1306_SPRITE_XOR 2
+
+    /**
+    *   \brief Copy image pixels where the mask is set, keep background elsewhere.
+    */
+    #define SSD1306_SPRITE_MASK 3
+
+    /**
+    *   \brief Size in bytes of the save-under storage of a sprite.
+    *
+    *   A sprite not aligned to a page covers one page more than its image.
+    */
+    #define SSD1306_SPRITE_SAVE_SIZE(width, height) ((width) * (((height) + 7) / 8 + 1))
+
+    /**
+    *   \brief State of a sprite.
+    */
+    typedef struct {
+        const uint8_t *image;   ///< Page-major image
+        const uint8_t *mask;    ///< Page-major mask, used by #SSD1306_SPRITE_MASK
+        uint8_t *save;          ///< Save-under storage, #SSD1306_SPRITE_SAVE_SIZE bytes
+        uint8_t width;          ///< Width of the image in pixels
+        uint8_t height;         ///< Height of the image in pixels
+        uint8_t mode;           ///< Drawing mode
+        uint8_t visible;        ///< Sprite drawn and background saved
+        int16_t x;              ///< Column of the last position
+        int16_t y;              ///< Row of the last position
+        uint8_t save_x;         ///< First saved column
+        uint8_t save_w;         ///< Number of saved columns
+        uint8_t save_page;      ///< First saved page
+        uint8_t save_pages;     ///< Number of saved pages
+    } SSD1306_Sprite;
+
+    /**
+    *   \brief Initialize a hidden sprite.
+    *
+    *   \param sprite sprite state.
+    *   \param image page-major image.
+    *   \param mask page-major mask, only needed by #SSD1306_SPRITE_MASK.
+    *   \param width width of the image in pixels.
+    *   \param height height of the image in pixels.
+    *   \param mode drawing mode, one of the SSD1306_SPRITE_* modes.
+    *   \param save storage of #SSD1306_SPRITE_SAVE_SIZE bytes.
+    */
+    void SSD1306_Sprite_Init(SSD1306_Sprite *sprite, const uint8_t *image,
+                                const uint8_t *mask, uint8_t width, uint8_t height,
+                                uint8_t mode, uint8_t *save);
+
+    /**
+    *   \brief Show a sprite at a position, restoring the background at the old one.
+    *
+    *   \param sprite sprite state.
+    *   \param x column of the top-left corner, in controller coordinates.
+    *   \param y row of the top-left corner, in controller coordinates.
+    */
+    void SSD1306_Sprite_Move(SSD1306_Sprite *sprite, int16_t x, int16_t y);
+
+    /**
+    *   \brief Change the image of a sprite, keeping its position.
+    *
+    *   The new image must have the same size as the old one.
+    *
+    *   \param sprite sprite state.
+    *   \param image page-major image.
+    *   \param mask page-major mask, only needed by #SSD1306_SPRITE_MASK.
+    */
+    void SSD1306_Sprite_SetImage(SSD1306_Sprite *sprite, const uint8_t *image,
+                                    const uint8_t *mask);
+
+    /**
+    *   \brief Hide a sprite, restoring the background.
+    *
+    *   \param sprite sprite state.
+    */
+    void SSD1306_Sprite_Hide(SSD1306_Sprite *sprite);
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,121 @@
+/**
+ *  \file SSD1306_Stats.c
+ *
+ *  \brief Source file for SSD1306 library instrumentation.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "I2C_Interface.h"
+#include "SSD1306_Stats.h"
+#include "string.h"
+
+#if SSD1306_STATS_ENABLED
+
+// Current statistics
+static SSD1306_Stats stats;
+
+// Cycle counter supplied by the application
+static SSD1306_CycleCounter cycle_counter = NULL;
+
+void SSD1306_Stats_SetCycleCounter(SSD1306_CycleCounter counter)
+{
+    cycle_counter = counter;
+}
+
+const SSD1306_Stats *SSD1306_Stats_Get(void)
+{
+    return &stats;
+}
+
+uint32_t SSD1306_Stats_GetAverage(uint8_t op)
+{
+    if ((op >= SSD1306_STATS_OP_COUNT) || (stats.ops[op].count == 0))
+    {
+        return 0;
+    }
+    return (uint32_t)(stats.ops[op].total / stats.ops[op].count);
+}
+
+void SSD1306_Stats_Reset(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+uint32_t SSD1306_Stats_Begin(void)
+{
+    return cycle_counter ? cycle_counter() : 0;
+}
+
+void SSD1306_Stats_End(uint8_t op, uint32_t start)
+{
+    SSD1306_OpStats *op_stats = &stats.ops[op];
+    uint32_t cycles = cycle_counter ? cycle_counter() - start : 0;
+    uint8_t bin = 0;
+
+    if (op_stats->count == 0)
+    {
+        op_stats->min = cycles;
+    }
+    op_stats->count++;
+    op_stats->total += cycles;
+    if (cycles < op_stats->min)
+    {
+        op_stats->min = cycles;
+    }
+    if (cycles > op_stats->max)
+    {
+        op_stats->max = cycles;
+    }
+    // Each bin is four times as wide as the previous one
+    while ((cycles >= 4) && (bin < SSD1306_STATS_HISTOGRAM_BINS - 1))
+    {
+        cycles >>= 2;
+        bin++;
+    }
+    op_stats->histogram[bin]++;
+}
+
+uint8_t SSD1306_Stats_Bus(uint8_t site, uint16_t bytes, uint8_t result)
+{
+    SSD1306_BusStats *bus_stats = &stats.bus[site];
+
+    bus_stats->transactions++;
+    if (result == I2C_NO_ERROR)
+    {
+        bus_stats->bytes += bytes;
+    }
+    else if (result == I2C_DEV_NOT_FOUND)
+    {
+        bus_stats->nacks++;
+    }
+    else if (result != I2C_BUSY)
+    {
+        bus_stats->errors++;
+    }
+    return result;
+}
+
+void SSD1306_Stats_Frame(uint16_t bytes_skipped)
+{
+    stats.frames++;
+    stats.bytes_skipped += bytes_skipped;
+}
+
+void SSD1306_Stats_Plan(uint8_t mode, uint16_t setup_bytes, uint8_t switched)
+{
+    stats.plans[mode]++;
+    stats.mode_switches += switched;
+    stats.setup_bytes += setup_bytes;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,196 @@
+/**
+ *   \file SSD1306_Stats.h
+ *
+ *   \brief Optional instrumentation of the SSD1306 library.
+ *
+ *   When #SSD1306_STATS_ENABLED is set to 1 (in this file or as a compiler
+ *   define), the library counts flushed frames, bus transactions, bytes and
+ *   errors for each I2C function, bytes saved by partial updates, and the
+ *   time spent in the drawing primitives and refresh functions.
+ *   When it is 0 the instrumentation macros expand to nothing, no storage
+ *   is allocated and the accessors are macros that do nothing
+ *   (#SSD1306_Stats_Get returns NULL).
+ *
+ *   Timings are read from a cycle counter supplied by the application with
+ *   #SSD1306_Stats_SetCycleCounter. On Cortex-M3 (PSoC 5LP) the DWT cycle
+ *   counter can be used:
+ *
+ *       static uint32_t ReadCycles(void) { return DWT->CYCCNT; }
+ *
+ *       CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+ *       DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+ *       SSD1306_Stats_SetCycleCounter(ReadCycles);
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_STATS_H__
+    #define __SSD1306_STATS_H__
+
+    #include "cytypes.h"
+
+    #ifndef SSD1306_STATS_ENABLED
+        /**
+        *   \brief Set to 1 to compile the instrumentation in the library.
+        */
+        #define SSD1306_STATS_ENABLED 0
+    #endif
+
+    /**********************************
+    *          TIMED OPERATIONS
+    **********************************/
+
+    #define SSD1306_STATS_OP_DISPLAY        0   ///< #SSD1306_Display
+    #define SSD1306_STATS_OP_DISPLAY_DIRTY  1   ///< #SSD1306_DisplayDirty
+    #define SSD1306_STATS_OP_DISPLAY_WINDOW 2   ///< #SSD1306_DisplayWindow
+    #define SSD1306_STATS_OP_CLEAR          3   ///< #SSD1306_ClearDisplay
+    #define SSD1306_STATS_OP_PIXEL          4   ///< #SSD1306_DrawPixel
+    #define SSD1306_STATS_OP_HLINE          5   ///< #SSD1306_DrawFastHLine
+    #define SSD1306_STATS_OP_VLINE          6   ///< #SSD1306_DrawFastVLine
+    #define SSD1306_STATS_OP_LINE           7   ///< #SSD1306_GFX_DrawLine, #SSD1306_GFX_WriteLine
+    #define SSD1306_STATS_OP_FILL_RECT      8   ///< #SSD1306_GFX_FillRect
+    #define SSD1306_STATS_OP_FILL_CIRCLE    9   ///< #SSD1306_GFX_FillCircle
+    #define SSD1306_STATS_OP_FILL_ELLIPSE   10  ///< #SSD1306_GFX_FillEllipse
+    #define SSD1306_STATS_OP_FILL_ROUND_RECT 11 ///< #SSD1306_GFX_FillRoundRect
+    #define SSD1306_STATS_OP_FILL_TRIANGLE  12  ///< #SSD1306_GFX_FillTriangle
+    #define SSD1306_STATS_OP_POLYGON        13  ///< #SSD1306_GFX_FillPath and the functions built on it
+    #define SSD1306_STATS_OP_FLOOD_FILL     14  ///< #SSD1306_GFX_FloodFill
+    #define SSD1306_STATS_OP_COUNT          15  ///< Number of timed operations
+
+    // Outlines (rectangles, circles, ellipses, rounded rectangles, triangles
+    // and polylines) are not timed on their own: they are drawn with the
+    // pixels and lines timed above.
+
+    /**********************************
+    *          BUS CALL SITES
+    **********************************/
+
+    #define SSD1306_STATS_BUS_READ          0   ///< Read functions
+    #define SSD1306_STATS_BUS_WRITE         1   ///< I2C_Peripheral_WriteRegister
+    #define SSD1306_STATS_BUS_WRITE_NO_DATA 2   ///< I2C_Peripheral_WriteRegisterNoData
+    #define SSD1306_STATS_BUS_WRITE_MULTI   3   ///< I2C_Peripheral_WriteRegisterMulti
+    #define SSD1306_STATS_BUS_WRITE_STRIDED 4   ///< I2C_Peripheral_WriteRegisterMultiStrided
+    #define SSD1306_STATS_BUS_WRITE_ASYNC   5   ///< I2C_Peripheral_WriteRegisterMultiAsync
+    #define SSD1306_STATS_BUS_PROBE         6   ///< I2C_Peripheral_IsDeviceConnected
+    #define SSD1306_STATS_BUS_COUNT         7   ///< Number of call sites
+
+    /**
+    *   \brief Number of addressing modes the transfer planner can choose.
+    */
+    #define SSD1306_STATS_PLAN_COUNT 3
+
+    /**
+    *   \brief Number of histogram bins. Bin i counts durations in [4^i, 4^(i+1)) cycles.
+    */
+    #define SSD1306_STATS_HISTOGRAM_BINS 16
+
+    /**
+    *   \brief Timing statistics of an operation.
+    */
+    typedef struct {
+        uint32_t count;                                 ///< Number of calls
+        uint32_t min;                                   ///< Minimum duration, in cycles
+        uint32_t max;                                   ///< Maximum duration, in cycles
+        uint64_t total;                                 ///< Total duration, in cycles
+        uint32_t histogram[SSD1306_STATS_HISTOGRAM_BINS]; ///< Duration histogram
+    } SSD1306_OpStats;
+
+    /**
+    *   \brief Traffic statistics of an I2C call site.
+    */
+    typedef struct {
+        uint32_t transactions;  ///< Number of transactions
+        uint32_t bytes;         ///< Payload bytes transferred without errors
+        uint32_t nacks;         ///< Transactions not acknowledged by the device
+        uint32_t errors;        ///< Transactions failed after the address phase
+    } SSD1306_BusStats;
+
+    /**
+    *   \brief Statistics of the library.
+    */
+    typedef struct {
+        uint32_t frames;                                ///< Successful refreshes
+        uint32_t bytes_skipped;                         ///< Bytes not sent thanks to partial updates
+        uint32_t plans[SSD1306_STATS_PLAN_COUNT];       ///< Windows sent in each addressing mode
+        uint32_t mode_switches;                         ///< Addressing mode changes
+        uint32_t setup_bytes;                           ///< Command bytes spent on window setup
+        SSD1306_BusStats bus[SSD1306_STATS_BUS_COUNT];  ///< Traffic per call site
+        SSD1306_OpStats ops[SSD1306_STATS_OP_COUNT];    ///< Timing per operation
+    } SSD1306_Stats;
+
+    /**
+    *   \brief Cycle counter function, returning a free-running 32-bit count.
+    */
+    typedef uint32_t (*SSD1306_CycleCounter)(void);
+
+    #if SSD1306_STATS_ENABLED
+
+        /**
+        *   \brief Set the cycle counter used to time operations.
+        *
+        *   \param counter cycle counter, NULL to disable timing (calls are still counted).
+        */
+        void SSD1306_Stats_SetCycleCounter(SSD1306_CycleCounter counter);
+
+        /**
+        *   \brief Get current statistics.
+        *
+        *   \return pointer to the statistics.
+        */
+        const SSD1306_Stats *SSD1306_Stats_Get(void);
+
+        /**
+        *   \brief Get average duration of an operation.
+        *
+        *   \param op operation, one of the SSD1306_STATS_OP_* values.
+        *   \return average duration in cycles, 0 if never called.
+        */
+        uint32_t SSD1306_Stats_GetAverage(uint8_t op);
+
+        /**
+        *   \brief Reset all the statistics.
+        */
+        void SSD1306_Stats_Reset(void);
+
+        uint32_t SSD1306_Stats_Begin(void);
+        void SSD1306_Stats_End(uint8_t op, uint32_t start);
+        uint8_t SSD1306_Stats_Bus(uint8_t site, uint16_t bytes, uint8_t result);
+        void SSD1306_Stats_Frame(uint16_t bytes_skipped);
+        void SSD1306_Stats_Plan(uint8_t mode, uint16_t setup_bytes, uint8_t switched);
+
+        /** \brief Start timing an operation of the current function. */
+        #define SSD1306_STATS_BEGIN() uint32_t ssd1306_stats_start = SSD1306_Stats_Begin()
+        /** \brief Stop timing the operation started with #SSD1306_STATS_BEGIN. */
+        #define SSD1306_STATS_END(op) SSD1306_Stats_End((op), ssd1306_stats_start)
+        /** \brief Account a bus transaction and evaluate to its result. */
+        #define SSD1306_STATS_BUS(site, bytes, result) SSD1306_Stats_Bus((site), (bytes), (result))
+        /** \brief Account a refresh and the bytes it did not need to send. */
+        #define SSD1306_STATS_FRAME(bytes_skipped) SSD1306_Stats_Frame(bytes_skipped)
+        /** \brief Account the addressing mode and setup chosen for a window. */
+        #define SSD1306_STATS_PLAN(mode, setup_bytes, switched) \
+            SSD1306_Stats_Plan((mode), (setup_bytes), (switched))
+
+    #else
+
+        #define SSD1306_Stats_SetCycleCounter(counter) ((void)(counter))
+        #define SSD1306_Stats_Get() ((const SSD1306_Stats *)NULL)
+        #define SSD1306_Stats_GetAverage(op) ((void)(op), (uint32_t)0)
+        #define SSD1306_Stats_Reset() ((void)0)
+
+        #define SSD1306_STATS_BEGIN()
+        #define SSD1306_STATS_END(op)
+        #define SSD1306_STATS_BUS(site, bytes, result) (result)
+        #define SSD1306_STATS_FRAME(bytes_skipped)
+        #define SSD1306_STATS_PLAN(mode, setup_bytes, switched) ((void)(setup_bytes), (void)(switched))
+
+    #endif
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,570 @@
+/**
+ *  \file SSD1306_Stream.c
+ *
+ *  \brief Source file for the frame streaming protocol.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306_Stream.h"
+#include "string.h"
+
+#if !SSD1306_NO_FRAMEBUFFER
+
+//***************************
+//          MACROS
+//***************************
+#define SSD1306_STREAM_MIN_RUN  3       ///< Shortest run worth encoding
+#define SSD1306_STREAM_MAX_RUN  130     ///< Longest run of a control byte
+#define SSD1306_STREAM_MAX_LIT  128     ///< Longest literal of a control byte
+
+// Decoder states
+#define SSD1306_STREAM_WAIT_SYNC    0
+#define SSD1306_STREAM_WAIT_TYPE    1
+#define SSD1306_STREAM_WAIT_LEN_LO  2
+#define SSD1306_STREAM_WAIT_LEN_HI  3
+#define SSD1306_STREAM_WAIT_PAYLOAD 4
+#define SSD1306_STREAM_WAIT_CRC     5
+
+// Delta encoded by SSD1306_Stream_Encode, while the full frame goes to the destination
+static uint8_t delta_frame[SSD1306_STREAM_MAX_FRAME];
+
+/**
+*   \brief Rectangle of bytes of one or two buffers, read page by page.
+*/
+typedef struct {
+    const uint8_t *pixels;      ///< First byte of the rectangle
+    const uint8_t *previous;    ///< Same rectangle of the old buffer to XOR with, or NULL
+    uint16_t width;             ///< Bytes of each page
+} SSD1306_StreamSource;
+
+/**
+*   \brief Frame being written.
+*/
+typedef struct {
+    uint8_t *out;       ///< Destination
+    uint16_t max;       ///< Size of the destination
+    uint16_t len;       ///< Bytes written
+} SSD1306_StreamWriter;
+
+/**
+*   \brief Update a CRC-8 (polynomial 0x07) with one byte.
+*/
+static uint8_t SSD1306_Stream_Crc(uint8_t crc, uint8_t value)
+{
+    uint8_t k;
+
+    crc ^= value;
+    for (k = 0; k < 8; k++)
+    {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+/**
+*   \brief Compute the CRC-16 (polynomial 0x1021) of a buffer, the base of deltas.
+*/
+static uint16_t SSD1306_Stream_BaseCrc(const uint8_t *pixels)
+{
+    uint16_t crc = 0xFFFF, i;
+    uint8_t k;
+
+    for (i = 0; i < SSD1306_BUFFER_SIZE; i++)
+    {
+        crc ^= (uint16_t)pixels[i] << 8;
+        for (k = 0; k < 8; k++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+*   \brief Get a byte of a source.
+*
+*   \param src source.
+*   \param i index of the byte, page by page.
+*   \return byte, XORed with the old buffer for deltas.
+*/
+static uint8_t SSD1306_Stream_Get(const SSD1306_StreamSource *src, uint16_t i)
+{
+    uint16_t offset = (i / src->width) * SSD1306_WIDTH + i % src->width;
+    uint8_t value = src->pixels[offset];
+
+    if (src->previous != NULL)
+    {
+        value ^= src->previous[offset];
+    }
+    return value;
+}
+
+/**
+*   \brief Append a byte to a frame.
+*/
+static void SSD1306_Stream_Put(SSD1306_StreamWriter *w, uint8_t value)
+{
+    if (w->len < w->max)
+    {
+        w->out[w->len] = value;
+    }
+    w->len++;
+}
+
+/**
+*   \brief Run-length encode a source.
+*
+*   \param w frame being written.
+*   \param src source.
+*   \param count number of bytes of the source.
+*/
+static void SSD1306_Stream_Pack(SSD1306_StreamWriter *w, const SSD1306_StreamSource *src,
+                                    uint16_t count)
+{
+    uint16_t i = 0;
+    uint16_t literal = 0;   // Position of the control byte of the open literal
+    uint8_t literals = 0;
+
+    while (i < count)
+    {
+        uint8_t value = SSD1306_Stream_Get(src, i);
+        uint16_t run = 1;
+
+        while ((i + run < count) && (run < SSD1306_STREAM_MAX_RUN) &&
+                (SSD1306_Stream_Get(src, i + run) == value))
+        {
+            run++;
+        }
+        if (run >= SSD1306_STREAM_MIN_RUN)
+        {
+            literals = 0;
+            SSD1306_Stream_Put(w, (uint8_t)(run + 125));
+            SSD1306_Stream_Put(w, value);
+            i += run;
+            continue;
+        }
+        if (literals == 0)
+        {
+            literal = w->len;
+            SSD1306_Stream_Put(w, 0);
+        }
+        SSD1306_Stream_Put(w, value);
+        literals++;
+        if (literal < w->max)
+        {
+            w->out[literal] = literals - 1;
+        }
+        if (literals == SSD1306_STREAM_MAX_LIT)
+        {
+            literals = 0;
+        }
+        i++;
+    }
+}
+
+/**
+*   \brief Write the header of a frame, leaving room for the length.
+*/
+static void SSD1306_Stream_Begin(SSD1306_StreamWriter *w, uint8_t *out, uint16_t max, uint8_t type)
+{
+    w->out = out;
+    w->max = max;
+    w->len = 0;
+    SSD1306_Stream_Put(w, SSD1306_STREAM_SYNC);
+    SSD1306_Stream_Put(w, type);
+    SSD1306_Stream_Put(w, 0);
+    SSD1306_Stream_Put(w, 0);
+}
+
+/**
+*   \brief Fill in the length and append the CRC of a frame.
+*
+*   \return size of the frame, 0 if it does not fit.
+*/
+static uint16_t SSD1306_Stream_End(SSD1306_StreamWriter *w)
+{
+    uint16_t payload = w->len - 4;
+    uint8_t crc = 0;
+    uint16_t i;
+
+    if (w->len + 1 > w->max)
+    {
+        return 0;
+    }
+    w->out[2] = (uint8_t)payload;
+    w->out[3] = (uint8_t)(payload >> 8);
+    for (i = 1; i < w->len; i++)
+    {
+        crc = SSD1306_Stream_Crc(crc, w->out[i]);
+    }
+    SSD1306_Stream_Put(w, crc);
+    return w->len;
+}
+
+uint16_t SSD1306_Stream_EncodeFull(const uint8_t *pixels, uint8_t *out, uint16_t max)
+{
+    SSD1306_StreamWriter w;
+    SSD1306_StreamSource src = { pixels, NULL, SSD1306_WIDTH };
+
+    SSD1306_Stream_Begin(&w, out, max, SSD1306_STREAM_FULL);
+    SSD1306_Stream_Pack(&w, &src, SSD1306_BUFFER_SIZE);
+    return SSD1306_Stream_End(&w);
+}
+
+uint16_t SSD1306_Stream_EncodeDelta(const uint8_t *previous, const uint8_t *pixels,
+                                        uint8_t *out, uint16_t max)
+{
+    SSD1306_StreamWriter w;
+    uint16_t base = SSD1306_Stream_BaseCrc(previous);
+    uint8_t page;
+
+    SSD1306_Stream_Begin(&w, out, max, SSD1306_STREAM_DELTA);
+    SSD1306_Stream_Put(&w, (uint8_t)base);
+    SSD1306_Stream_Put(&w, (uint8_t)(base >> 8));
+    for (page = 0; page < SSD1306_PAGES; page++)
+    {
+        const uint8_t *row = &pixels[page * SSD1306_WIDTH];
+        const uint8_t *old = &previous[page * SSD1306_WIDTH];
+        int16_t first = 0, last = SSD1306_WIDTH - 1;
+        SSD1306_StreamSource src;
+
+        while ((first < SSD1306_WIDTH) && (row[first] == old[first]))
+        {
+            first++;
+        }
+        if (first == SSD1306_WIDTH)
+        {
+            continue;
+        }
+        while (row[last] == old[last])
+        {
+            last--;
+        }
+        SSD1306_Stream_Put(&w, page);
+        SSD1306_Stream_Put(&w, (uint8_t)first);
+        SSD1306_Stream_Put(&w, (uint8_t)(last - first + 1));
+        src.pixels = &row[first];
+        src.previous = &old[first];
+        src.width = last - first + 1;
+        SSD1306_Stream_Pack(&w, &src, src.width);
+    }
+    return SSD1306_Stream_End(&w);
+}
+
+uint16_t SSD1306_Stream_Encode(const uint8_t *previous, const uint8_t *pixels,
+                                uint8_t *out, uint16_t max)
+{
+    uint16_t delta = 0, full;
+
+    if (previous != NULL)
+    {
+        delta = SSD1306_Stream_EncodeDelta(previous, pixels, delta_frame,
+                                            (max < sizeof(delta_frame)) ? max : sizeof(delta_frame));
+    }
+    // A full frame can be smaller, e.g. after the screen was cleared
+    full = SSD1306_Stream_EncodeFull(pixels, out, max);
+    if ((delta > 0) && ((full == 0) || (delta < full)))
+    {
+        memcpy(out, delta_frame, delta);
+        return delta;
+    }
+    return full;
+}
+
+uint16_t SSD1306_Stream_EncodeWindow(const uint8_t *pixels, uint8_t page_start,
+                                        uint8_t page_end, uint8_t col_start,
+                                        uint8_t col_end, uint8_t *out, uint16_t max)
+{
+    SSD1306_StreamWriter w;
+    SSD1306_StreamSource src;
+
+    if ((page_end >= SSD1306_PAGES) || (col_end >= SSD1306_WIDTH) ||
+        (page_start > page_end) || (col_start > col_end))
+    {
+        return 0;
+    }
+    SSD1306_Stream_Begin(&w, out, max, SSD1306_STREAM_WINDOW);
+    SSD1306_Stream_Put(&w, page_start);
+    SSD1306_Stream_Put(&w, page_end);
+    SSD1306_Stream_Put(&w, col_start);
+    SSD1306_Stream_Put(&w, col_end);
+    src.pixels = &pixels[page_start * SSD1306_WIDTH + col_start];
+    src.previous = NULL;
+    src.width = col_end - col_start + 1;
+    SSD1306_Stream_Pack(&w, &src, src.width * (page_end - page_start + 1));
+    return SSD1306_Stream_End(&w);
+}
+
+uint16_t SSD1306_Stream_EncodeCommand(uint8_t command, uint8_t argument,
+                                        uint8_t *out, uint16_t max)
+{
+    SSD1306_StreamWriter w;
+
+    SSD1306_Stream_Begin(&w, out, max, SSD1306_STREAM_COMMAND);
+    SSD1306_Stream_Put(&w, command);
+    SSD1306_Stream_Put(&w, argument);
+    return SSD1306_Stream_End(&w);
+}
+
+/**
+*   \brief Decode run-length encoded bytes into a rectangle of the buffer.
+*
+*   \param src payload.
+*   \param len size of the payload.
+*   \param pos position in the payload, advanced past the encoded bytes.
+*   \param dst first byte of the rectangle.
+*   \param width bytes of each page of the rectangle.
+*   \param count number of bytes to decode.
+*   \param xor 1 to XOR the bytes into the buffer, 0 to copy them.
+*   \return 1 if decoded, 0 if the payload is malformed.
+*/
+static uint8_t SSD1306_Stream_Unpack(const uint8_t *src, uint16_t len, uint16_t *pos,
+                                        uint8_t *dst, uint16_t width, uint16_t count,
+                                        uint8_t xor)
+{
+    uint16_t i = 0;
+
+    while (i < count)
+    {
+        uint8_t control, n, k;
+
+        if (*pos >= len)
+        {
+            return 0;
+        }
+        control = src[(*pos)++];
+        n = (control < 128) ? control + 1 : control - 125;
+        if ((i + n > count) || (*pos + (control < 128 ? n : 1) > len))
+        {
+            return 0;
+        }
+        for (k = 0; k < n; k++)
+        {
+            uint8_t value = (control < 128) ? src[*pos + k] : src[*pos];
+            uint8_t *p = &dst[(i / width) * SSD1306_WIDTH + i % width];
+            *p = xor ? (*p ^ value) : value;
+            i++;
+        }
+        *pos += (control < 128) ? n : 1;
+    }
+    return 1;
+}
+
+/**
+*   \brief Apply a complete frame.
+*
+*   \return 1 if applied, 0 if the payload is malformed.
+*/
+static uint8_t SSD1306_Stream_Apply(SSD1306_StreamDecoder *decoder)
+{
+    const uint8_t *p = decoder->payload;
+    uint16_t len = decoder->length;
+    uint8_t *pixels = SSD1306_GetBuffer();
+    uint16_t pos = 0;
+
+    switch (decoder->type)
+    {
+        case SSD1306_STREAM_FULL:
+            SSD1306_MarkDirty(0, 0, SSD1306_WIDTH, SSD1306_HEIGHT);
+            return SSD1306_Stream_Unpack(p, len, &pos, pixels, SSD1306_WIDTH,
+                                            SSD1306_BUFFER_SIZE, 0) && (pos == len);
+        case SSD1306_STREAM_DELTA:
+            // The base was checked by SSD1306_Stream_Feed
+            if (len < 2)
+            {
+                return 0;
+            }
+            pos = 2;
+            while (pos < len)
+            {
+                uint8_t page, first, count;
+
+                if (pos + 3 > len)
+                {
+                    return 0;
+                }
+                page = p[pos];
+                first = p[pos + 1];
+                count = p[pos + 2];
+                pos += 3;
+                if ((page >= SSD1306_PAGES) || (count == 0) || (first + count > SSD1306_WIDTH))
+                {
+                    return 0;
+                }
+                SSD1306_MarkDirty(first, page * 8, count, 8);
+                if (!SSD1306_Stream_Unpack(p, len, &pos, &pixels[page * SSD1306_WIDTH + first],
+                                            count, count, 1))
+                {
+                    return 0;
+                }
+            }
+            return 1;
+        case SSD1306_STREAM_WINDOW:
+            if ((len < 4) || (p[1] >= SSD1306_PAGES) || (p[3] >= SSD1306_WIDTH) ||
+                (p[0] > p[1]) || (p[2] > p[3]))
+            {
+                return 0;
+            }
+            pos = 4;
+            SSD1306_MarkDirty(p[2], p[0] * 8, p[3] - p[2] + 1, (p[1] - p[0] + 1) * 8);
+            return SSD1306_Stream_Unpack(p, len, &pos, &pixels[p[0] * SSD1306_WIDTH + p[2]],
+                                            p[3] - p[2] + 1,
+                                            (p[3] - p[2] + 1) * (p[1] - p[0] + 1), 0) &&
+                    (pos == len);
+        case SSD1306_STREAM_COMMAND:
+            if (len != 2)
+            {
+                return 0;
+            }
+            switch (p[0])
+            {
+                case SSD1306_STREAM_CMD_INVERT:
+                    SSD1306_InvertDisplay(p[1]);
+                    break;
+                case SSD1306_STREAM_CMD_DIM:
+                    SSD1306_Dim(p[1]);
+                    break;
+                case SSD1306_STREAM_CMD_CLOCK_DIV:
+                    SSD1306_SetClockDiv(p[1]);
+                    break;
+                case SSD1306_STREAM_CMD_CLEAR:
+                    SSD1306_ClearDisplay();
+                    break;
+                case SSD1306_STREAM_CMD_REFRESH:
+                    if (SSD1306_Display() != SSD1306_NO_ERROR)
+                    {
+                        decoder->stats.flush_errors++;
+                    }
+                    break;
+                default:
+                    return 0;
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+void SSD1306_Stream_Init(SSD1306_StreamDecoder *decoder, uint8_t *payload,
+                            uint16_t capacity, uint8_t auto_flush)
+{
+    decoder->payload = payload;
+    decoder->capacity = capacity;
+    decoder->state = SSD1306_STREAM_WAIT_SYNC;
+    decoder->auto_flush = auto_flush;
+    decoder->key_needed = 0;
+    decoder->stats.frames = 0;
+    decoder->stats.crc_errors = 0;
+    decoder->stats.format_errors = 0;
+    decoder->stats.base_errors = 0;
+    decoder->stats.flush_errors = 0;
+    decoder->stats.skipped = 0;
+}
+
+uint16_t SSD1306_Stream_Feed(SSD1306_StreamDecoder *decoder, const uint8_t *data,
+                                uint16_t len)
+{
+    uint16_t applied = 0;
+
+    while (len > 0)
+    {
+        uint8_t b = *data++;
+        len--;
+
+        switch (decoder->state)
+        {
+            case SSD1306_STREAM_WAIT_SYNC:
+                if (b == SSD1306_STREAM_SYNC)
+                {
+                    decoder->crc = 0;
+                    decoder->state = SSD1306_STREAM_WAIT_TYPE;
+                }
+                else
+                {
+                    decoder->stats.skipped++;
+                }
+                break;
+            case SSD1306_STREAM_WAIT_TYPE:
+                decoder->type = b;
+                decoder->crc = SSD1306_Stream_Crc(decoder->crc, b);
+                decoder->state = SSD1306_STREAM_WAIT_LEN_LO;
+                break;
+            case SSD1306_STREAM_WAIT_LEN_LO:
+                decoder->length = b;
+                decoder->crc = SSD1306_Stream_Crc(decoder->crc, b);
+                decoder->state = SSD1306_STREAM_WAIT_LEN_HI;
+                break;
+            case SSD1306_STREAM_WAIT_LEN_HI:
+                decoder->length |= (uint16_t)b << 8;
+                decoder->crc = SSD1306_Stream_Crc(decoder->crc, b);
+                decoder->received = 0;
+                if (decoder->length > decoder->capacity)
+                {
+                    decoder->stats.format_errors++;
+                    decoder->state = SSD1306_STREAM_WAIT_SYNC;
+                }
+                else
+                {
+                    decoder->state = (decoder->length > 0) ? SSD1306_STREAM_WAIT_PAYLOAD :
+                                                                SSD1306_STREAM_WAIT_CRC;
+                }
+                break;
+            case SSD1306_STREAM_WAIT_PAYLOAD:
+                decoder->payload[decoder->received++] = b;
+                decoder->crc = SSD1306_Stream_Crc(decoder->crc, b);
+                if (decoder->received == decoder->length)
+                {
+                    decoder->state = SSD1306_STREAM_WAIT_CRC;
+                }
+                break;
+            case SSD1306_STREAM_WAIT_CRC:
+                decoder->state = SSD1306_STREAM_WAIT_SYNC;
+                if (b != decoder->crc)
+                {
+                    decoder->stats.crc_errors++;
+                    break;
+                }
+                // A delta of another buffer would corrupt the image until the next full frame
+                if ((decoder->type == SSD1306_STREAM_DELTA) && (decoder->length >= 2) &&
+                    (SSD1306_Stream_BaseCrc(SSD1306_GetBuffer()) !=
+                        (decoder->payload[0] | ((uint16_t)decoder->payload[1] << 8))))
+                {
+                    decoder->stats.base_errors++;
+                    decoder->key_needed = 1;
+                    break;
+                }
+                if (!SSD1306_Stream_Apply(decoder))
+                {
+                    decoder->stats.format_errors++;
+                    break;
+                }
+                if (decoder->type == SSD1306_STREAM_FULL)
+                {
+                    decoder->key_needed = 0;
+                }
+                decoder->stats.frames++;
+                applied++;
+                if (decoder->auto_flush && (SSD1306_DisplayDirty() != SSD1306_NO_ERROR))
+                {
+                    decoder->stats.flush_errors++;
+                }
+                break;
+            default:
+                decoder->state = SSD1306_STREAM_WAIT_SYNC;
+                break;
+        }
+    }
+    return applied;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,227 @@
+/**
+ *   \file SSD1306_Stream.h
+ *
+ *   \brief Framed protocol to stream screens from a host over a serial link.
+ *
+ *   Frame format:
+ *     - sync byte #SSD1306_STREAM_SYNC;
+ *     - frame type (1 byte);
+ *     - payload length (2 bytes, little-endian);
+ *     - payload;
+ *     - CRC-8 (polynomial 0x07) of type, length and payload.
+ *
+ *   Pixel data in the payloads is run-length encoded: a control byte n
+ *   below 128 is followed by n + 1 literal bytes, a control byte n from
+ *   128 is followed by one byte repeated n - 125 times (3 to 130).
+ *
+ *   Payloads:
+ *     - #SSD1306_STREAM_FULL: the whole buffer, encoded;
+ *     - #SSD1306_STREAM_DELTA: CRC-16 (polynomial 0x1021, initial value
+ *       0xFFFF, 2 bytes little-endian) of the buffer the delta applies to,
+ *       then for each changed page, page, first column and number of
+ *       columns (1 byte each) followed by the XOR of the old and new
+ *       columns, encoded;
+ *     - #SSD1306_STREAM_WINDOW: first and last page, first and last column
+ *       (1 byte each) followed by the bytes of the window, page by page,
+ *       encoded;
+ *     - #SSD1306_STREAM_COMMAND: one of the SSD1306_STREAM_CMD_* codes and
+ *       its argument (1 byte each).
+ *
+ *   A delta is only applied to the buffer it was encoded from: after a
+ *   lost frame the decoder drops the following deltas and sets
+ *   key_needed, until a full frame arrives. On a link with a return
+ *   channel the device sends #SSD1306_STREAM_KEY_REQUEST, and the host
+ *   answers with a full frame.
+ *
+ *   Encoders and decoder are plain C with no hardware dependency: the
+ *   encoders can be built into a host tool, the decoder runs on the
+ *   device, fed with the bytes received from a UART or USB-CDC link.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_STREAM_H__
+    #define __SSD1306_STREAM_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    #if !SSD1306_NO_FRAMEBUFFER
+
+    /**
+    *   \brief First byte of each frame.
+    */
+    #define SSD1306_STREAM_SYNC 0xA5
+
+    /**
+    *   \brief Byte sent back by the device to ask for a full frame.
+    */
+    #define SSD1306_STREAM_KEY_REQUEST 0x15
+
+    /**
+    *   \brief Size of a frame apart from its payload.
+    */
+    #define SSD1306_STREAM_OVERHEAD 5
+
+    /**
+    *   \brief Largest payload produced by the encoders.
+    *
+    *   Worst case of a delta: every page changed, incompressible data.
+    */
+    #define SSD1306_STREAM_MAX_PAYLOAD (SSD1306_BUFFER_SIZE + SSD1306_BUFFER_SIZE / 128 + 4 * SSD1306_PAGES + 6)
+
+    /**
+    *   \brief Largest frame produced by the encoders.
+    */
+    #define SSD1306_STREAM_MAX_FRAME (SSD1306_STREAM_MAX_PAYLOAD + SSD1306_STREAM_OVERHEAD)
+
+    /**********************************
+    *          FRAME TYPES
+    **********************************/
+
+    #define SSD1306_STREAM_FULL     0x01    ///< Whole buffer
+    #define SSD1306_STREAM_DELTA    0x02    ///< XOR of the changed columns of each page
+    #define SSD1306_STREAM_WINDOW   0x03    ///< Rectangular window
+    #define SSD1306_STREAM_COMMAND  0x04    ///< Display command
+
+    /**********************************
+    *          COMMANDS
+    **********************************/
+
+    #define SSD1306_STREAM_CMD_INVERT    0x01   ///< #SSD1306_InvertDisplay
+    #define SSD1306_STREAM_CMD_DIM       0x02   ///< #SSD1306_Dim
+    #define SSD1306_STREAM_CMD_CLOCK_DIV 0x03   ///< #SSD1306_SetClockDiv
+    #define SSD1306_STREAM_CMD_CLEAR     0x04   ///< #SSD1306_ClearDisplay
+    #define SSD1306_STREAM_CMD_REFRESH   0x05   ///< #SSD1306_Display
+
+    /**
+    *   \brief Decoder statistics.
+    */
+    typedef struct {
+        uint32_t frames;        ///< Frames applied
+        uint32_t crc_errors;    ///< Frames dropped because of a wrong CRC
+        uint32_t format_errors; ///< Frames with a malformed or too long payload
+        uint32_t base_errors;   ///< Deltas dropped because the buffer is not their base
+        uint32_t flush_errors;  ///< Refreshes that failed
+        uint32_t skipped;       ///< Bytes skipped while looking for a sync byte
+    } SSD1306_StreamStats;
+
+    /**
+    *   \brief State of a decoder.
+    */
+    typedef struct {
+        uint8_t *payload;           ///< Payload storage
+        uint16_t capacity;          ///< Size of the payload storage
+        uint16_t length;            ///< Length of the current payload
+        uint16_t received;          ///< Payload bytes received
+        uint8_t type;               ///< Type of the current frame
+        uint8_t state;              ///< Parser state
+        uint8_t crc;                ///< Running CRC
+        uint8_t auto_flush;         ///< Refresh the display after each frame
+        uint8_t key_needed;         ///< A delta was dropped, a full frame is needed
+        SSD1306_StreamStats stats;  ///< Statistics
+    } SSD1306_StreamDecoder;
+
+    /**
+    *   \brief Encode a whole buffer.
+    *
+    *   \param pixels page-major buffer.
+    *   \param out destination of the frame.
+    *   \param max size of the destination.
+    *   \return size of the frame, 0 if it does not fit.
+    */
+    uint16_t SSD1306_Stream_EncodeFull(const uint8_t *pixels, uint8_t *out, uint16_t max);
+
+    /**
+    *   \brief Encode the changes between two buffers.
+    *
+    *   \param previous buffer shown by the display.
+    *   \param pixels new buffer.
+    *   \param out destination of the frame.
+    *   \param max size of the destination.
+    *   \return size of the frame, 0 if it does not fit.
+    */
+    uint16_t SSD1306_Stream_EncodeDelta(const uint8_t *previous, const uint8_t *pixels,
+                                            uint8_t *out, uint16_t max);
+
+    /**
+    *   \brief Encode the changes between two buffers as a delta or a full frame.
+    *
+    *   The smaller of the two encodings is used. An unchanged buffer
+    *   gives a delta with no pages.
+    *
+    *   \param previous buffer shown by the display, NULL for a full frame.
+    *   \param pixels new buffer.
+    *   \param out destination of the frame.
+    *   \param max size of the destination.
+    *   \return size of the frame, 0 if it does not fit.
+    */
+    uint16_t SSD1306_Stream_Encode(const uint8_t *previous, const uint8_t *pixels,
+                                    uint8_t *out, uint16_t max);
+
+    /**
+    *   \brief Encode a window of a buffer.
+    *
+    *   \param pixels page-major buffer.
+    *   \param page_start first page of the window.
+    *   \param page_end last page of the window (included).
+    *   \param col_start first column of the window.
+    *   \param col_end last column of the window (included).
+    *   \param out destination of the frame.
+    *   \param max size of the destination.
+    *   \return size of the frame, 0 if it does not fit.
+    */
+    uint16_t SSD1306_Stream_EncodeWindow(const uint8_t *pixels, uint8_t page_start,
+                                            uint8_t page_end, uint8_t col_start,
+                                            uint8_t col_end, uint8_t *out, uint16_t max);
+
+    /**
+    *   \brief Encode a display command.
+    *
+    *   \param command one of the SSD1306_STREAM_CMD_* codes.
+    *   \param argument argument of the command.
+    *   \param out destination of the frame.
+    *   \param max size of the destination.
+    *   \return size of the frame, 0 if it does not fit.
+    */
+    uint16_t SSD1306_Stream_EncodeCommand(uint8_t command, uint8_t argument,
+                                            uint8_t *out, uint16_t max);
+
+    /**
+    *   \brief Initialize a decoder.
+    *
+    *   Frames are applied to the current render target and mark it dirty.
+    *
+    *   \param decoder decoder state.
+    *   \param payload storage of the payload, #SSD1306_STREAM_MAX_PAYLOAD
+    *       bytes to accept any frame of the encoders.
+    *   \param capacity size of the storage.
+    *   \param auto_flush 1 to call #SSD1306_DisplayDirty after each frame.
+    */
+    void SSD1306_Stream_Init(SSD1306_StreamDecoder *decoder, uint8_t *payload,
+                                uint16_t capacity, uint8_t auto_flush);
+
+    /**
+    *   \brief Feed received bytes to a decoder.
+    *
+    *   Bytes can be fed in chunks of any size, e.g. from a UART interrupt.
+    *
+    *   \param decoder decoder state.
+    *   \param data received bytes.
+    *   \param len number of bytes.
+    *   \return number of frames applied.
+    */
+    uint16_t SSD1306_Stream_Feed(SSD1306_StreamDecoder *decoder, const uint8_t *data,
+                                    uint16_t len);
+
+    #endif
+
+#endif
+
+/* [] END OF FILE */
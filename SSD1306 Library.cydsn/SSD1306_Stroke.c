@@ -0,0 +1,675 @@
+/**
+ *  \file SSD1306_Stroke.c
+ *
+ *  \brief Source file for thick lines and polylines.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Stroke.h"
+
+//***************************
+//          MACROS
+//***************************
+// A band crossed by all the edges of the table keeps at most two vertices
+// per edge, and two edges per piece
+#define SSD1306_STROKE_POINTS (SSD1306_GFX_MAX_EDGES * 2)   ///< Vertices of a batch
+#define SSD1306_STROKE_PIECES (SSD1306_GFX_MAX_EDGES / 2)   ///< Contours of a batch
+#define SSD1306_STROKE_QUAD_POINTS 12   ///< A segment and the two it may have to remove
+
+/**
+*   \brief Vector in 1 / #SSD1306_GFX_SUBPIXEL pixel units.
+*/
+typedef struct {
+    int32_t x;
+    int32_t y;
+} SSD1306_StrokeVec;
+
+/**
+*   \brief Geometry of a segment of a stroke.
+*/
+typedef struct {
+    SSD1306_StrokeVec n;        ///< Left normal, half width long
+    SSD1306_StrokeVec quad[4];  ///< Corners of the quadrilateral
+    int32_t dx;                 ///< Direction, in pixels
+    int32_t dy;                 ///< Direction, in pixels
+} SSD1306_StrokeSegment;
+
+// Pieces waiting to be filled together
+static struct {
+    SSD1306_Point points[SSD1306_STROKE_POINTS];
+    uint16_t counts[SSD1306_STROKE_PIECES];
+    uint8_t count;          ///< Vertices of the batch
+    uint8_t pieces;         ///< Pieces of the batch
+    int32_t first_quad;     ///< First segment of the batch, -1 if none
+    uint8_t split;          ///< 1 to fill the batch when it is full, 0 to give up
+    uint8_t overflow;       ///< Some pieces did not fit
+    uint8_t vertical;       ///< The band is a range of columns instead of rows
+    int32_t band0;          ///< First row (column) of the band, subpixel units
+    int32_t band1;          ///< End of the band (excluded), subpixel units
+} batch;
+
+// Stroke being drawn
+static struct {
+    const SSD1306_StrokeStyle *style;
+    int32_t hw;             ///< Half width, subpixel units
+    int16_t step;           ///< Angle between two vertices of an arc, degrees
+    uint16_t color;
+} stroke;
+
+/**
+*   \brief Integer square root.
+*/
+static uint32_t SSD1306_Stroke_Sqrt(uint64_t v)
+{
+    uint64_t r = 0, bit = 1ULL << 62;
+
+    while (bit > v)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+/**
+*   \brief Division rounding to nearest, for a positive divisor.
+*/
+static int32_t SSD1306_Stroke_Div(int64_t num, int64_t den)
+{
+    return (int32_t)((num >= 0) ? (num + den / 2) / den : -((-num + den / 2) / den));
+}
+
+/**
+*   \brief Center of a pixel, in subpixel units.
+*/
+static SSD1306_StrokeVec SSD1306_Stroke_Center(const SSD1306_Point *p)
+{
+    SSD1306_StrokeVec v;
+
+    v.x = (int32_t)p->x * SSD1306_GFX_SUBPIXEL + SSD1306_GFX_SUBPIXEL / 2;
+    v.y = (int32_t)p->y * SSD1306_GFX_SUBPIXEL + SSD1306_GFX_SUBPIXEL / 2;
+    return v;
+}
+
+/**
+*   \brief Sum of a point and a vector scaled by sign.
+*/
+static SSD1306_StrokeVec SSD1306_Stroke_Add(SSD1306_StrokeVec p, SSD1306_StrokeVec v, int8_t sign)
+{
+    p.x += sign * v.x;
+    p.y += sign * v.y;
+    return p;
+}
+
+/**
+*   \brief Rotate a vector by an angle in degrees.
+*/
+static SSD1306_StrokeVec SSD1306_Stroke_Rotate(SSD1306_StrokeVec v, int16_t angle)
+{
+    SSD1306_Fixed s = SSD1306_Path_Sin(angle);
+    SSD1306_Fixed c = SSD1306_Path_Cos(angle);
+    SSD1306_StrokeVec r;
+
+    r.x = SSD1306_Stroke_Div((int64_t)v.x * c - (int64_t)v.y * s, SSD1306_FIXED_ONE);
+    r.y = SSD1306_Stroke_Div((int64_t)v.x * s + (int64_t)v.y * c, SSD1306_FIXED_ONE);
+    return r;
+}
+
+/**
+*   \brief Fill the pieces of the batch.
+*/
+static void SSD1306_Stroke_Flush(void)
+{
+    if ((batch.pieces > 0) && !batch.overflow)
+    {
+        // Fails, before drawing, when more edges than the table holds cross the band
+        if (SSD1306_GFX_FillPathSubpixel(batch.points, batch.counts, batch.pieces,
+                                            SSD1306_GFX_POSITIVE, stroke.color) != SSD1306_NO_ERROR)
+        {
+            batch.overflow = 1;
+        }
+    }
+    batch.count = 0;
+    batch.pieces = 0;
+    batch.first_quad = -1;
+}
+
+/**
+*   \brief Make room in the batch, filling it if it can be split.
+*
+*   \return 1 if there is room, 0 otherwise.
+*/
+static uint8_t SSD1306_Stroke_Reserve(uint8_t points, uint8_t pieces)
+{
+    if ((batch.count + points > SSD1306_STROKE_POINTS) ||
+        (batch.pieces + pieces > SSD1306_STROKE_PIECES))
+    {
+        if (!batch.split)
+        {
+            batch.overflow = 1;
+            return 0;
+        }
+        SSD1306_Stroke_Flush();
+    }
+    return 1;
+}
+
+/**
+*   \brief Add a piece to the batch.
+*
+*   \param v vertices of the piece.
+*   \param n number of vertices.
+*   \param sign +1 to draw the piece, -1 to remove it from the other pieces.
+*/
+static void SSD1306_Stroke_Piece(const SSD1306_StrokeVec *v, uint8_t n, int8_t sign)
+{
+    int8_t side[SSD1306_GFX_MAX_EDGES];
+    int64_t area = 0;
+    uint8_t i, kept = 0, reverse;
+
+    // Side of each vertex: above the band (-1), crossing it (0) or below it (+1)
+    for (i = 0; i < n; i++)
+    {
+        const SSD1306_StrokeVec *a = &v[i];
+        const SSD1306_StrokeVec *b = &v[(i + 1 < n) ? i + 1 : 0];
+        int32_t c = batch.vertical ? a->x : a->y;
+        area += (int64_t)a->x * b->y - (int64_t)b->x * a->y;
+        side[i] = (c < batch.band0) ? -1 : (c >= batch.band1) ? 1 : 0;
+    }
+    // Edges between vertices on the same side of the band do not cross it,
+    // so the vertices in the middle of such runs are dropped
+    for (i = 0; i < n; i++)
+    {
+        kept += (side[i] == 0) || (side[i] != side[(i > 0) ? i - 1 : n - 1]) ||
+                (side[i] != side[(i + 1 < n) ? i + 1 : 0]);
+    }
+    if ((area == 0) || (kept == 0))
+    {
+        return;
+    }
+    // Contours with negative area (in y down coordinates) have winding +1
+    reverse = (sign > 0) ? (area > 0) : (area < 0);
+
+    if (!SSD1306_Stroke_Reserve(kept, 1))
+    {
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        uint8_t k = reverse ? n - 1 - i : i;
+        const SSD1306_StrokeVec *p = &v[k];
+        SSD1306_Point *q;
+
+        if ((side[k] != 0) && (side[k] == side[(k > 0) ? k - 1 : n - 1]) &&
+            (side[k] == side[(k + 1 < n) ? k + 1 : 0]))
+        {
+            continue;
+        }
+        q = &batch.points[batch.count++];
+        q->x = (p->x > INT16_MAX) ? INT16_MAX : (p->x < INT16_MIN) ? INT16_MIN : (int16_t)p->x;
+        q->y = (p->y > INT16_MAX) ? INT16_MAX : (p->y < INT16_MIN) ? INT16_MIN : (int16_t)p->y;
+    }
+    batch.counts[batch.pieces++] = kept;
+}
+
+/**
+*   \brief Append the inner vertices of an arc around a center.
+*
+*   \param v vertices, the arc is appended at v[*n].
+*   \param n number of vertices.
+*   \param center center of the arc.
+*   \param start vector from the center to the start of the arc.
+*   \param end vector from the center to the end of the arc.
+*   \param dir +1 to turn from start to end by positive angles, -1 otherwise.
+*/
+static void SSD1306_Stroke_Arc(SSD1306_StrokeVec *v, uint8_t *n, SSD1306_StrokeVec center,
+                                SSD1306_StrokeVec start, SSD1306_StrokeVec end, int8_t dir)
+{
+    int16_t angle;
+
+    for (angle = stroke.step; angle < 180; angle += stroke.step)
+    {
+        SSD1306_StrokeVec r = SSD1306_Stroke_Rotate(start, dir * angle);
+        // Stop once the end was reached or passed
+        if (((int64_t)r.x * end.y - (int64_t)r.y * end.x) * dir <= 0)
+        {
+            break;
+        }
+        v[(*n)++] = SSD1306_Stroke_Add(center, r, 1);
+    }
+}
+
+/**
+*   \brief Compute the geometry of a segment.
+*
+*   \param seg segment geometry.
+*   \param a first end point.
+*   \param b second end point.
+*   \param cap_a 1 if a is the start of an open stroke.
+*   \param cap_b 1 if b is the end of an open stroke.
+*/
+static void SSD1306_Stroke_Segment(SSD1306_StrokeSegment *seg, const SSD1306_Point *a,
+                                    const SSD1306_Point *b, uint8_t cap_a, uint8_t cap_b)
+{
+    SSD1306_StrokeVec pa = SSD1306_Stroke_Center(a);
+    SSD1306_StrokeVec pb = SSD1306_Stroke_Center(b);
+    SSD1306_StrokeVec t;
+    uint32_t len;
+
+    seg->dx = (int32_t)b->x - a->x;
+    seg->dy = (int32_t)b->y - a->y;
+    // Length with 8 fractional bits
+    len = SSD1306_Stroke_Sqrt(((uint64_t)((int64_t)seg->dx * seg->dx + (int64_t)seg->dy * seg->dy)) << 16);
+    seg->n.x = SSD1306_Stroke_Div(-(int64_t)seg->dy * stroke.hw * 256, len);
+    seg->n.y = SSD1306_Stroke_Div((int64_t)seg->dx * stroke.hw * 256, len);
+    t.x = seg->n.y;
+    t.y = -seg->n.x;
+
+    if (stroke.style->cap == SSD1306_STROKE_CAP_SQUARE)
+    {
+        if (cap_a)
+        {
+            pa = SSD1306_Stroke_Add(pa, t, -1);
+        }
+        if (cap_b)
+        {
+            pb = SSD1306_Stroke_Add(pb, t, 1);
+        }
+    }
+    seg->quad[0] = SSD1306_Stroke_Add(pa, seg->n, 1);
+    seg->quad[1] = SSD1306_Stroke_Add(pb, seg->n, 1);
+    seg->quad[2] = SSD1306_Stroke_Add(pb, seg->n, -1);
+    seg->quad[3] = SSD1306_Stroke_Add(pa, seg->n, -1);
+}
+
+/**
+*   \brief Add the quadrilateral of a segment.
+*
+*   When the batch is split, the neighbours filled by a previous batch
+*   are removed where they overlap, so that they are not drawn twice.
+*
+*   \param seg segment geometry.
+*   \param k index of the segment.
+*   \param prev previous segment, NULL if none.
+*   \param first first segment, if it is the next one, NULL otherwise.
+*/
+static void SSD1306_Stroke_Quad(const SSD1306_StrokeSegment *seg, int32_t k,
+                                const SSD1306_StrokeSegment *prev,
+                                const SSD1306_StrokeSegment *first)
+{
+    if (batch.split)
+    {
+        SSD1306_Stroke_Reserve(SSD1306_STROKE_QUAD_POINTS, 3);
+        if ((prev != NULL) && ((batch.first_quad < 0) || (batch.first_quad > k - 1)))
+        {
+            SSD1306_Stroke_Piece(prev->quad, 4, -1);
+        }
+        if ((first != NULL) && (k > 1) && (batch.first_quad != 0))
+        {
+            SSD1306_Stroke_Piece(first->quad, 4, -1);
+        }
+    }
+    SSD1306_Stroke_Piece(seg->quad, 4, 1);
+    if (batch.first_quad < 0)
+    {
+        batch.first_quad = k;
+    }
+}
+
+/**
+*   \brief Add the wedge that fills the outer side of a join.
+*
+*   \param v vertex shared by the segments.
+*   \param a segment ending at the vertex.
+*   \param b segment starting at the vertex.
+*/
+static void SSD1306_Stroke_Join(const SSD1306_Point *v, const SSD1306_StrokeSegment *a,
+                                const SSD1306_StrokeSegment *b)
+{
+    SSD1306_StrokeVec w[SSD1306_GFX_MAX_EDGES];
+    SSD1306_StrokeVec center = SSD1306_Stroke_Center(v);
+    int64_t cross = (int64_t)a->dx * b->dy - (int64_t)a->dy * b->dx;
+    int64_t dot = (int64_t)a->dx * b->dx + (int64_t)a->dy * b->dy;
+    int8_t side = (cross > 0) ? -1 : 1;
+    uint8_t n = 0;
+
+    if ((cross == 0) && (dot > 0))
+    {
+        return;
+    }
+    w[n++] = center;
+    w[n++] = SSD1306_Stroke_Add(center, a->n, side);
+    if (stroke.style->join == SSD1306_STROKE_JOIN_ROUND)
+    {
+        SSD1306_StrokeVec start = SSD1306_Stroke_Add((SSD1306_StrokeVec){ 0, 0 }, a->n, side);
+        SSD1306_StrokeVec end = SSD1306_Stroke_Add((SSD1306_StrokeVec){ 0, 0 }, b->n, side);
+        SSD1306_Stroke_Arc(w, &n, center, start, end, -side);
+    }
+    else if (stroke.style->join == SSD1306_STROKE_JOIN_MITER)
+    {
+        // The tip is at (na + nb) * hw^2 / (hw^2 + na.nb), within the limit
+        // if 1 / cos(half angle) <= limit
+        int64_t hw2 = (int64_t)stroke.hw * stroke.hw;
+        int64_t den = hw2 + (int64_t)a->n.x * b->n.x + (int64_t)a->n.y * b->n.y;
+        if ((den > 0) &&
+            (den * SSD1306_STROKE_MITER_LIMIT * SSD1306_STROKE_MITER_LIMIT >= 2 * hw2))
+        {
+            SSD1306_StrokeVec m;
+            m.x = SSD1306_Stroke_Div((int64_t)(a->n.x + b->n.x) * hw2, den);
+            m.y = SSD1306_Stroke_Div((int64_t)(a->n.y + b->n.y) * hw2, den);
+            w[n++] = SSD1306_Stroke_Add(center, m, side);
+        }
+    }
+    w[n++] = SSD1306_Stroke_Add(center, b->n, side);
+    SSD1306_Stroke_Piece(w, n, 1);
+}
+
+/**
+*   \brief Add the half disc of a round cap.
+*
+*   \param p end point.
+*   \param seg segment ending or starting at the point.
+*   \param end 1 at the end of the segment, 0 at its start.
+*/
+static void SSD1306_Stroke_Cap(const SSD1306_Point *p, const SSD1306_StrokeSegment *seg,
+                                uint8_t end)
+{
+    SSD1306_StrokeVec w[SSD1306_GFX_MAX_EDGES];
+    SSD1306_StrokeVec center = SSD1306_Stroke_Center(p);
+    SSD1306_StrokeVec start = SSD1306_Stroke_Add((SSD1306_StrokeVec){ 0, 0 }, seg->n, end ? -1 : 1);
+    SSD1306_StrokeVec stop = SSD1306_Stroke_Add((SSD1306_StrokeVec){ 0, 0 }, start, -1);
+    uint8_t n = 0;
+
+    if (stroke.style->cap != SSD1306_STROKE_CAP_ROUND)
+    {
+        return;
+    }
+    // Turning the normal by positive angles goes away from the segment
+    w[n++] = SSD1306_Stroke_Add(center, start, 1);
+    SSD1306_Stroke_Arc(w, &n, center, start, stop, 1);
+    w[n++] = SSD1306_Stroke_Add(center, stop, 1);
+    SSD1306_Stroke_Piece(w, n, 1);
+}
+
+/**
+*   \brief Draw a stroke of a single point.
+*/
+static void SSD1306_Stroke_Dot(const SSD1306_Point *p)
+{
+    SSD1306_StrokeVec w[SSD1306_GFX_MAX_EDGES];
+    SSD1306_StrokeVec center = SSD1306_Stroke_Center(p);
+    SSD1306_StrokeVec r = { stroke.hw, 0 };
+    uint8_t n = 0;
+    int16_t angle;
+
+    if (stroke.style->cap == SSD1306_STROKE_CAP_ROUND)
+    {
+        for (angle = 0; angle < 360; angle += stroke.step)
+        {
+            w[n++] = SSD1306_Stroke_Add(center, SSD1306_Stroke_Rotate(r, angle), 1);
+        }
+    }
+    else if (stroke.style->cap == SSD1306_STROKE_CAP_SQUARE)
+    {
+        w[n++] = (SSD1306_StrokeVec){ center.x - stroke.hw, center.y - stroke.hw };
+        w[n++] = (SSD1306_StrokeVec){ center.x + stroke.hw, center.y - stroke.hw };
+        w[n++] = (SSD1306_StrokeVec){ center.x + stroke.hw, center.y + stroke.hw };
+        w[n++] = (SSD1306_StrokeVec){ center.x - stroke.hw, center.y + stroke.hw };
+    }
+    if (n > 0)
+    {
+        SSD1306_Stroke_Piece(w, n, 1);
+    }
+}
+
+/**
+*   \brief Check if a stroke through some points can touch the clip rectangle.
+*/
+static uint8_t SSD1306_Stroke_Visible(const SSD1306_Point *points, uint16_t count)
+{
+    int16_t x_min = INT16_MAX, x_max = INT16_MIN;
+    int16_t y_min = INT16_MAX, y_max = INT16_MIN;
+    int16_t cx, cy, cw, ch;
+    // Miters reach farthest from the points
+    int32_t margin = (int32_t)stroke.style->width * SSD1306_STROKE_MITER_LIMIT / 2 + 1;
+    uint16_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        x_min = (points[i].x < x_min) ? points[i].x : x_min;
+        x_max = (points[i].x > x_max) ? points[i].x : x_max;
+        y_min = (points[i].y < y_min) ? points[i].y : y_min;
+        y_max = (points[i].y > y_max) ? points[i].y : y_max;
+    }
+    SSD1306_GetClip(&cx, &cy, &cw, &ch);
+    return (cw > 0) && (ch > 0) &&
+            (x_max + margin >= cx) && (x_min - margin < cx + cw) &&
+            (y_max + margin >= cy) && (y_min - margin < cy + ch);
+}
+
+void SSD1306_Stroke_Line(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                            const SSD1306_StrokeStyle *style, uint16_t color)
+{
+    SSD1306_Point points[2] = { { x0, y0 }, { x1, y1 } };
+
+    SSD1306_Stroke_Polyline(points, 2, 0, style, color);
+}
+
+/**
+*   \brief Fill the part of a stroke within a band of the display.
+*
+*   All the pieces crossing the band are filled together, so that every
+*   pixel is written once. If they do not fit in the batch or in the edge
+*   table nothing is drawn, unless split is set: the batch is then filled
+*   whenever it is full.
+*
+*   \param points vertices.
+*   \param last index of the last vertex.
+*   \param closed 1 for a closed stroke.
+*   \param segments number of segments.
+*   \param band0 first row of the band in rotated display coordinates,
+*       first column for rotations 1 and 3.
+*   \param band_size number of rows (columns) of the band, 0 for the whole display.
+*   \param split 1 to fill the batch in several parts if needed.
+*   \return 1 if the band was drawn, 0 otherwise.
+*/
+static uint8_t SSD1306_Stroke_Band(const SSD1306_Point *points, uint16_t last, uint8_t closed,
+                                    int32_t segments, int16_t band0, int16_t band_size,
+                                    uint8_t split)
+{
+    SSD1306_StrokeSegment seg, prev, first;
+    int16_t ox, oy, cx, cy, cw, ch;
+    int32_t k = 0;
+    uint16_t i, a;
+
+    batch.count = 0;
+    batch.pieces = 0;
+    batch.first_quad = -1;
+    batch.split = split;
+    batch.overflow = 0;
+    batch.vertical = SSD1306_GetRotation() & 0x01;
+    batch.band0 = INT32_MIN;
+    batch.band1 = INT32_MAX;
+    if (band_size > 0)
+    {
+        // Band in drawing coordinates, clipped for the fill
+        SSD1306_GetOrigin(&ox, &oy);
+        SSD1306_GetClip(&cx, &cy, &cw, &ch);
+        band0 -= batch.vertical ? ox : oy;
+        if (batch.vertical)
+        {
+            cx = band0;
+            cw = band_size;
+        }
+        else
+        {
+            cy = band0;
+            ch = band_size;
+        }
+        if (SSD1306_PushClip(cx, cy, cw, ch) != SSD1306_NO_ERROR)
+        {
+            return 0;
+        }
+        SSD1306_GetClip(&cx, &cy, &cw, &ch);
+        if ((cw == 0) || (ch == 0))
+        {
+            SSD1306_PopClip();
+            return 1;
+        }
+        // Half a pixel of margin around the band
+        batch.band0 = (int32_t)band0 * SSD1306_GFX_SUBPIXEL - SSD1306_GFX_SUBPIXEL / 2;
+        batch.band1 = (int32_t)(band0 + band_size) * SSD1306_GFX_SUBPIXEL + SSD1306_GFX_SUBPIXEL / 2;
+    }
+
+    if (segments == 0)
+    {
+        SSD1306_Stroke_Dot(&points[0]);
+    }
+    a = 0;
+    for (i = 1; (segments > 0) && (i <= last + (closed ? 1 : 0)); i++)
+    {
+        const SSD1306_Point *b = &points[(i > last) ? 0 : i];
+        uint8_t open_start = (k == 0) && !closed;
+        uint8_t open_end = (k == segments - 1) && !closed;
+
+        if ((points[a].x == b->x) && (points[a].y == b->y))
+        {
+            continue;
+        }
+        SSD1306_Stroke_Segment(&seg, &points[a], b, open_start, open_end);
+        SSD1306_Stroke_Quad(&seg, k, (k > 0) ? &prev : NULL,
+                            (closed && (k == segments - 1)) ? &first : NULL);
+        if (k > 0)
+        {
+            SSD1306_Stroke_Join(&points[a], &prev, &seg);
+        }
+        else
+        {
+            first = seg;
+        }
+        if (open_start)
+        {
+            SSD1306_Stroke_Cap(&points[a], &seg, 0);
+        }
+        if (open_end)
+        {
+            SSD1306_Stroke_Cap(b, &seg, 1);
+        }
+        prev = seg;
+        k++;
+        a = i;
+    }
+    if (closed && (segments > 0))
+    {
+        SSD1306_Stroke_Join(&points[0], &prev, &first);
+    }
+    SSD1306_Stroke_Flush();
+
+    if (band_size > 0)
+    {
+        SSD1306_PopClip();
+    }
+    return !batch.overflow;
+}
+
+void SSD1306_Stroke_Polyline(const SSD1306_Point *points, uint16_t count, uint8_t closed,
+                                const SSD1306_StrokeStyle *style, uint16_t color)
+{
+    int32_t segments = 0;
+    int16_t band, row;
+    uint16_t i, last;
+
+    if ((count == 0) || (style->width == 0))
+    {
+        return;
+    }
+    stroke.style = style;
+    stroke.color = color;
+    stroke.hw = (int32_t)style->width * SSD1306_GFX_SUBPIXEL / 2;
+    // Arcs within a sixteenth of a pixel of the circle up to 16 pixels wide
+    stroke.step = (style->width <= 2) ? 45 : (style->width <= 4) ? 30 :
+                    (style->width <= 10) ? 20 : 15;
+
+    // Points repeating the first one at the end of a closed stroke are dropped
+    last = count - 1;
+    while (closed && (last > 0) &&
+            (points[last].x == points[0].x) && (points[last].y == points[0].y))
+    {
+        last--;
+    }
+    for (i = 0; i < last; i++)
+    {
+        if ((points[i].x != points[i + 1].x) || (points[i].y != points[i + 1].y))
+        {
+            segments++;
+        }
+    }
+    if (closed && (segments > 0))
+    {
+        segments++;
+    }
+    if (!SSD1306_Stroke_Visible(points, last + 1))
+    {
+        return;
+    }
+
+    // The whole stroke in one fill, else one page of the controller at a
+    // time, else one row at a time. The pieces are computed again for
+    // each band, and only the ones crossing it are kept.
+    if (SSD1306_Stroke_Band(points, last, closed, segments, 0, 0, 0))
+    {
+        return;
+    }
+    for (band = 0; band < SSD1306_HEIGHT; band += 8)
+    {
+        if (SSD1306_Stroke_Band(points, last, closed, segments, band, 8, 0))
+        {
+            continue;
+        }
+        for (row = band; row < band + 8; row++)
+        {
+            if (!SSD1306_Stroke_Band(points, last, closed, segments, row, 1, 0))
+            {
+                // Too many edges in a single row: pieces may overlap
+                SSD1306_Stroke_Band(points, last, closed, segments, row, 1, 1);
+            }
+        }
+    }
+}
+
+void SSD1306_Stroke_Path(const SSD1306_Path *path, const SSD1306_StrokeStyle *style,
+                            uint16_t color)
+{
+    const SSD1306_Point *points = path->points;
+    uint8_t c;
+
+    for (c = 0; c < path->contours; c++)
+    {
+        SSD1306_Stroke_Polyline(points, path->counts[c], (path->closed >> c) & 0x01,
+                                style, color);
+        points += path->counts[c];
+    }
+}
+
+/* [] END OF FILE */
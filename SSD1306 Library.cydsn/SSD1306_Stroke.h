@@ -0,0 +1,143 @@
+/**
+ *   \file SSD1306_Stroke.h
+ *
+ *   \brief Thick lines and polylines with caps and joins.
+ *
+ *   A stroke is split into filled pieces: a quadrilateral for each
+ *   segment, a wedge on the outer side of each join (miter, bevel or
+ *   round) and a half disc or an extension for each cap. Vertices are
+ *   computed in fixed point with a fraction of a pixel, and the pieces are
+ *   filled together by #SSD1306_GFX_FillPathSubpixel, so that every byte
+ *   of a page is written once, the overlap of two segments at a join
+ *   included. A thick line therefore costs as much as a filled polygon,
+ *   without the gaps and the double inversion of offset thin lines.
+ *
+ *   Pieces are batched up to twice #SSD1306_GFX_MAX_EDGES vertices. A stroke
+ *   that does not fit is drawn a page of the controller at a time, and a
+ *   page that does not fit a row at a time: the pieces are computed again
+ *   for each band, keeping only the vertices of the edges crossing it, and
+ *   filled together. Only a row crossed by more edges than the table
+ *   holds is filled in several batches, removing the neighbours of each
+ *   segment filled before; there #SSD1306_INVERSE strokes crossing
+ *   themselves may be inverted twice.
+ *
+ *   Points are pixel centers in drawing coordinates, as for
+ *   #SSD1306_GFX_DrawLine, and must stay within 2000 pixels of the origin.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_STROKE_H__
+    #define __SSD1306_STROKE_H__
+
+    #include "cytypes.h"
+    #include "SSD1306_GFX.h"
+    #include "SSD1306_Path.h"
+
+    #if SSD1306_GFX_MAX_EDGES < 24
+        #error "SSD1306_Stroke requires SSD1306_GFX_MAX_EDGES of at least 24"
+    #endif
+
+    #ifndef SSD1306_STROKE_MITER_LIMIT
+        /**
+        *   \brief Longest miter, in half widths, before a join is beveled.
+        */
+        #define SSD1306_STROKE_MITER_LIMIT 4
+    #endif
+
+    /**********************************
+    *          CAPS
+    **********************************/
+
+    /**
+    *   \brief Stroke ends at the end points.
+    */
+    #define SSD1306_STROKE_CAP_BUTT 0
+
+    /**
+    *   \brief Stroke extends by half its width past the end points.
+    */
+    #define SSD1306_STROKE_CAP_SQUARE 1
+
+    /**
+    *   \brief Stroke ends with a half disc centered on the end points.
+    */
+    #define SSD1306_STROKE_CAP_ROUND 2
+
+    /**********************************
+    *          JOINS
+    **********************************/
+
+    /**
+    *   \brief Outer edges are extended until they meet, up to #SSD1306_STROKE_MITER_LIMIT.
+    */
+    #define SSD1306_STROKE_JOIN_MITER 0
+
+    /**
+    *   \brief Outer corners are joined by a straight edge.
+    */
+    #define SSD1306_STROKE_JOIN_BEVEL 1
+
+    /**
+    *   \brief Outer corners are joined by an arc centered on the vertex.
+    */
+    #define SSD1306_STROKE_JOIN_ROUND 2
+
+    /**
+    *   \brief Style of a stroke.
+    */
+    typedef struct {
+        uint8_t width;  ///< Width in pixels
+        uint8_t cap;    ///< One of the SSD1306_STROKE_CAP_* caps
+        uint8_t join;   ///< One of the SSD1306_STROKE_JOIN_* joins
+    } SSD1306_StrokeStyle;
+
+    /**
+    *   \brief Draw a thick line.
+    *
+    *   \param x0 x coordinate of the first end point.
+    *   \param y0 y coordinate of the first end point.
+    *   \param x1 x coordinate of the second end point.
+    *   \param y1 y coordinate of the second end point.
+    *   \param style style of the stroke.
+    *   \param color color of the stroke.
+    */
+    void SSD1306_Stroke_Line(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                const SSD1306_StrokeStyle *style, uint16_t color);
+
+    /**
+    *   \brief Draw thick connected lines through a list of points.
+    *
+    *   Repeated points are skipped. A single point is drawn as a disc or a
+    *   square, depending on the cap.
+    *
+    *   \param points vertices.
+    *   \param count number of vertices.
+    *   \param closed 1 to join the last vertex to the first one, with no caps.
+    *   \param style style of the stroke.
+    *   \param color color of the stroke.
+    */
+    void SSD1306_Stroke_Polyline(const SSD1306_Point *points, uint16_t count, uint8_t closed,
+                                    const SSD1306_StrokeStyle *style, uint16_t color);
+
+    /**
+    *   \brief Draw the contours of a path as thick lines.
+    *
+    *   The width is in pixels, not scaled by the transform of the path.
+    *
+    *   \param path path state.
+    *   \param style style of the stroke.
+    *   \param color color of the stroke.
+    */
+    void SSD1306_Stroke_Path(const SSD1306_Path *path, const SSD1306_StrokeStyle *style,
+                                uint16_t color);
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,384 @@
+/**
+ *  \file SSD1306_Text.c
+ *
+ *  \brief Source file for UTF-8 text and the glyph cache.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Text.h"
+#include "string.h"
+
+//***************************
+//          MACROS
+//***************************
+#define SSD1306_TEXT_HEADER_SIZE 16     ///< Size of the font header
+#define SSD1306_TEXT_ENTRY_SIZE  8      ///< Size of an index entry
+
+// Font header magic
+static const uint8_t font_magic[4] = { 'S', 'F', 'N', '1' };
+
+/**
+*   \brief Glyph held by the cache.
+*/
+typedef struct {
+    const SSD1306_Font *font;               ///< Font of the glyph, NULL if the entry is free
+    uint32_t codepoint;                     ///< Codepoint of the glyph
+    uint32_t used;                          ///< Time of the last use
+    uint8_t width;                          ///< Width in pixels
+    uint8_t found;                          ///< Glyph present in the font
+    uint8_t image[SSD1306_TEXT_GLYPH_BYTES];///< Page-major image
+} SSD1306_TextGlyph;
+
+static SSD1306_TextGlyph cache[SSD1306_TEXT_CACHE_GLYPHS];
+static uint32_t cache_clock;
+static SSD1306_TextCacheStats cache_stats;
+
+/**
+*   \brief Read a little-endian value.
+*
+*   \param src bytes.
+*   \param len number of bytes, at most 4.
+*   \return value.
+*/
+static uint32_t SSD1306_Text_Get(const uint8_t *src, uint8_t len)
+{
+    uint32_t value = 0;
+    while (len > 0)
+    {
+        len--;
+        value = (value << 8) | src[len];
+    }
+    return value;
+}
+
+/**
+*   \brief Read bytes of a font, counting the accesses to the storage.
+*
+*   \return 1 on success, 0 if the storage could not be read.
+*/
+static uint8_t SSD1306_Text_Read(const SSD1306_Font *font, uint32_t address,
+                                    uint8_t *dst, uint16_t len)
+{
+    cache_stats.reads++;
+    return font->read(address, dst, len, font->context) == 0;
+}
+
+/**
+*   \brief Load a glyph from storage into a cache entry.
+*
+*   \param font font.
+*   \param codepoint codepoint of the glyph.
+*   \param glyph cache entry, marked as missing if the font has no such glyph.
+*   \retval #SSD1306_NO_ERROR if the glyph was loaded or is missing.
+*   \retval #SSD1306_COMM_ERROR if the storage could not be read.
+*/
+static uint8_t SSD1306_Text_Load(const SSD1306_Font *font, uint32_t codepoint,
+                                    SSD1306_TextGlyph *glyph)
+{
+    uint8_t entry[SSD1306_TEXT_ENTRY_SIZE];
+    uint16_t lo = 0, hi = font->count;
+
+    glyph->found = 0;
+    glyph->width = 0;
+
+    // Binary search of the index, one entry read per step
+    while (lo < hi)
+    {
+        uint16_t mid = lo + (hi - lo) / 2;
+        uint32_t key;
+
+        if (!SSD1306_Text_Read(font, font->index + (uint32_t)mid * SSD1306_TEXT_ENTRY_SIZE,
+                                entry, SSD1306_TEXT_ENTRY_SIZE))
+        {
+            return SSD1306_COMM_ERROR;
+        }
+        key = SSD1306_Text_Get(entry, 3);
+        if (key < codepoint)
+        {
+            lo = mid + 1;
+        }
+        else if (key > codepoint)
+        {
+            hi = mid;
+        }
+        else
+        {
+            uint16_t size = (uint16_t)entry[3] * ((font->height + 7) / 8);
+            // Glyphs too large for the cache are missing
+            if (size > SSD1306_TEXT_GLYPH_BYTES)
+            {
+                return SSD1306_NO_ERROR;
+            }
+            if (!SSD1306_Text_Read(font, SSD1306_Text_Get(&entry[4], 4), glyph->image, size))
+            {
+                return SSD1306_COMM_ERROR;
+            }
+            glyph->width = entry[3];
+            glyph->found = 1;
+            return SSD1306_NO_ERROR;
+        }
+    }
+    return SSD1306_NO_ERROR;
+}
+
+/**
+*   \brief Get a glyph, from the cache or from storage.
+*
+*   \param font font.
+*   \param codepoint codepoint of the glyph.
+*   \param glyph destination of the cache entry of the glyph.
+*   \retval #SSD1306_NO_ERROR if the glyph was found or is missing.
+*   \retval #SSD1306_COMM_ERROR if the storage could not be read.
+*/
+static uint8_t SSD1306_Text_Glyph(const SSD1306_Font *font, uint32_t codepoint,
+                                    const SSD1306_TextGlyph **glyph)
+{
+    SSD1306_TextGlyph *victim = &cache[0];
+    uint8_t i;
+
+    cache_clock++;
+    for (i = 0; i < SSD1306_TEXT_CACHE_GLYPHS; i++)
+    {
+        SSD1306_TextGlyph *entry = &cache[i];
+        if ((entry->font == font) && (entry->codepoint == codepoint))
+        {
+            entry->used = cache_clock;
+            cache_stats.hits++;
+            *glyph = entry;
+            return SSD1306_NO_ERROR;
+        }
+        // Free entries first, then the least recently used
+        if ((victim->font != NULL) &&
+            ((entry->font == NULL) || (entry->used < victim->used)))
+        {
+            victim = entry;
+        }
+    }
+
+    cache_stats.misses++;
+    if (SSD1306_Text_Load(font, codepoint, victim) != SSD1306_NO_ERROR)
+    {
+        // Not cached, so that the next lookup reads the storage again
+        victim->font = NULL;
+        return SSD1306_COMM_ERROR;
+    }
+    victim->font = font;
+    victim->codepoint = codepoint;
+    victim->used = cache_clock;
+    *glyph = victim;
+    return SSD1306_NO_ERROR;
+}
+
+/**
+*   \brief Get the glyph drawn for a character.
+*
+*   \param glyph destination of the glyph of the character or of the
+*       fallback, NULL if neither exists.
+*   \retval #SSD1306_NO_ERROR if the glyphs were looked up.
+*   \retval #SSD1306_COMM_ERROR if the storage could not be read.
+*/
+static uint8_t SSD1306_Text_Lookup(const SSD1306_Font *font, uint32_t codepoint,
+                                    const SSD1306_TextGlyph **glyph)
+{
+    uint8_t error = SSD1306_Text_Glyph(font, codepoint, glyph);
+
+    if ((error == SSD1306_NO_ERROR) && !(*glyph)->found && (codepoint != font->fallback))
+    {
+        error = SSD1306_Text_Glyph(font, font->fallback, glyph);
+    }
+    if ((error != SSD1306_NO_ERROR) || !(*glyph)->found)
+    {
+        *glyph = NULL;
+    }
+    return error;
+}
+
+uint8_t SSD1306_Font_Open(SSD1306_Font *font, SSD1306_FontRead read, void *context)
+{
+    uint8_t header[SSD1306_TEXT_HEADER_SIZE];
+
+    font->read = read;
+    font->context = context;
+    font->count = 0;
+    if (!SSD1306_Text_Read(font, 0, header, SSD1306_TEXT_HEADER_SIZE))
+    {
+        return SSD1306_COMM_ERROR;
+    }
+    if ((memcmp(header, font_magic, sizeof(font_magic)) != 0) ||
+        (header[6] == 0) || (header[6] > 64))
+    {
+        return SSD1306_TEXT_FORMAT_ERROR;
+    }
+    font->height = header[6];
+    font->spacing = header[7];
+    font->index = SSD1306_Text_Get(&header[8], 4);
+    font->fallback = SSD1306_Text_Get(&header[12], 4);
+    font->count = (uint16_t)SSD1306_Text_Get(&header[4], 2);
+
+    // Glyphs of a font opened again in the same state may have changed
+    SSD1306_Text_FlushCache();
+    return SSD1306_NO_ERROR;
+}
+
+uint32_t SSD1306_Text_Decode(const char **text)
+{
+    const uint8_t *s = (const uint8_t *)*text;
+    uint32_t codepoint;
+    uint8_t extra, i;
+
+    if (s[0] == 0)
+    {
+        return 0;
+    }
+    if (s[0] < 0x80)
+    {
+        *text += 1;
+        return s[0];
+    }
+    if ((s[0] & 0xE0) == 0xC0)
+    {
+        codepoint = s[0] & 0x1F;
+        extra = 1;
+    }
+    else if ((s[0] & 0xF0) == 0xE0)
+    {
+        codepoint = s[0] & 0x0F;
+        extra = 2;
+    }
+    else if ((s[0] & 0xF8) == 0xF0)
+    {
+        codepoint = s[0] & 0x07;
+        extra = 3;
+    }
+    else
+    {
+        *text += 1;
+        return SSD1306_TEXT_REPLACEMENT;
+    }
+    for (i = 1; i <= extra; i++)
+    {
+        // Also stops at the terminator
+        if ((s[i] & 0xC0) != 0x80)
+        {
+            *text += 1;
+            return SSD1306_TEXT_REPLACEMENT;
+        }
+        codepoint = (codepoint << 6) | (s[i] & 0x3F);
+    }
+    // Overlong encodings, surrogates and values beyond Unicode
+    if ((codepoint < (extra == 1 ? 0x80UL : extra == 2 ? 0x800UL : 0x10000UL)) ||
+        ((codepoint >= 0xD800) && (codepoint <= 0xDFFF)) || (codepoint > 0x10FFFF))
+    {
+        *text += 1;
+        return SSD1306_TEXT_REPLACEMENT;
+    }
+    *text += extra + 1;
+    return codepoint;
+}
+
+uint8_t SSD1306_Text_Draw(const SSD1306_Font *font, int16_t x, int16_t y,
+                            const char *text, uint16_t color, int16_t *end)
+{
+    uint8_t error = SSD1306_NO_ERROR;
+    uint32_t codepoint;
+
+    while ((codepoint = SSD1306_Text_Decode(&text)) != 0)
+    {
+        const SSD1306_TextGlyph *glyph;
+        uint8_t col, row;
+
+        error = SSD1306_Text_Lookup(font, codepoint, &glyph);
+        if (error != SSD1306_NO_ERROR)
+        {
+            break;
+        }
+        if (glyph == NULL)
+        {
+            continue;
+        }
+        for (col = 0; col < glyph->width; col++)
+        {
+            // Vertical runs of set pixels of the column
+            row = 0;
+            while (row < font->height)
+            {
+                uint8_t start;
+
+                while ((row < font->height) &&
+                        !((glyph->image[col + (row / 8) * glyph->width] >> (row & 7)) & 0x01))
+                {
+                    row++;
+                }
+                start = row;
+                while ((row < font->height) &&
+                        ((glyph->image[col + (row / 8) * glyph->width] >> (row & 7)) & 0x01))
+                {
+                    row++;
+                }
+                if (row > start)
+                {
+                    SSD1306_DrawFastVLine(x + col, y + start, row - start, color);
+                }
+            }
+        }
+        x += glyph->width + font->spacing;
+    }
+    if (end != NULL)
+    {
+        *end = x;
+    }
+    return error;
+}
+
+uint8_t SSD1306_Text_Width(const SSD1306_Font *font, const char *text, int16_t *width)
+{
+    uint8_t error = SSD1306_NO_ERROR;
+    uint32_t codepoint;
+
+    *width = 0;
+    while ((codepoint = SSD1306_Text_Decode(&text)) != 0)
+    {
+        const SSD1306_TextGlyph *glyph;
+
+        error = SSD1306_Text_Lookup(font, codepoint, &glyph);
+        if (error != SSD1306_NO_ERROR)
+        {
+            break;
+        }
+        if (glyph != NULL)
+        {
+            *width += glyph->width + font->spacing;
+        }
+    }
+    return error;
+}
+
+void SSD1306_Text_FlushCache(void)
+{
+    uint8_t i;
+    for (i = 0; i < SSD1306_TEXT_CACHE_GLYPHS; i++)
+    {
+        cache[i].font = NULL;
+    }
+}
+
+void SSD1306_Text_GetCacheStats(SSD1306_TextCacheStats *stats)
+{
+    *stats = cache_stats;
+}
+
+void SSD1306_Text_ResetCacheStats(void)
+{
+    memset(&cache_stats, 0, sizeof(cache_stats));
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,175 @@
+/**
+ *   \file SSD1306_Text.h
+ *
+ *   \brief UTF-8 text with fonts on external storage and a glyph cache.
+ *
+ *   Fonts are read through a callback from any block device (SPI flash,
+ *   SD card, or a file on a host), so they do not need to fit in internal
+ *   flash. Font format, multi-byte values little-endian:
+ *     - header, 16 bytes:
+ *         - the four bytes 'S', 'F', 'N', '1';
+ *         - number of glyphs (2 bytes);
+ *         - glyph height in pixels, 1 to 64 (1 byte);
+ *         - blank columns after each glyph (1 byte);
+ *         - offset of the index from the start of the font (4 bytes);
+ *         - codepoint drawn for missing characters (4 bytes);
+ *     - index, one 8-byte entry per glyph sorted by codepoint:
+ *         - codepoint (3 bytes);
+ *         - glyph width in pixels (1 byte);
+ *         - offset of the glyph image from the start of the font (4 bytes);
+ *     - glyph images, page-major like the frame buffer: byte
+ *       (x + page * width) holds rows 8 * page to 8 * page + 7 of column x.
+ *
+ *   Glyphs are looked up with a binary search of the index and kept in a
+ *   RAM cache of #SSD1306_TEXT_CACHE_GLYPHS entries, the least recently
+ *   used entry being replaced on a miss. Missing characters are cached
+ *   too, so repeated characters never read the storage again; glyphs
+ *   whose storage read failed are not, and are read again next time.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_TEXT_H__
+    #define __SSD1306_TEXT_H__
+
+    #include "cytypes.h"
+
+    #ifndef SSD1306_TEXT_CACHE_GLYPHS
+        /**
+        *   \brief Number of glyphs held by the cache.
+        */
+        #define SSD1306_TEXT_CACHE_GLYPHS 16
+    #endif
+
+    #ifndef SSD1306_TEXT_GLYPH_BYTES
+        /**
+        *   \brief Maximum size of a glyph image, 32 bytes fit a 16x16 glyph.
+        */
+        #define SSD1306_TEXT_GLYPH_BYTES 32
+    #endif
+
+    /**
+    *   \brief Font is malformed.
+    */
+    #define SSD1306_TEXT_FORMAT_ERROR 5
+
+    /**
+    *   \brief Codepoint returned for malformed UTF-8 sequences.
+    */
+    #define SSD1306_TEXT_REPLACEMENT 0xFFFD
+
+    /**
+    *   \brief Read bytes of a font from storage.
+    *
+    *   \param address offset from the start of the font.
+    *   \param dst destination.
+    *   \param len number of bytes.
+    *   \param context argument given to #SSD1306_Font_Open.
+    *   \return 0 on success, non-zero if the storage could not be read.
+    */
+    typedef uint8_t (*SSD1306_FontRead)(uint32_t address, uint8_t *dst, uint16_t len, void *context);
+
+    /**
+    *   \brief Font opened on a storage device.
+    */
+    typedef struct {
+        SSD1306_FontRead read;  ///< Storage read function
+        void *context;          ///< Argument of the read function
+        uint32_t index;         ///< Offset of the index
+        uint32_t fallback;      ///< Codepoint drawn for missing characters
+        uint16_t count;         ///< Number of glyphs
+        uint8_t height;         ///< Glyph height in pixels
+        uint8_t spacing;        ///< Blank columns after each glyph
+    } SSD1306_Font;
+
+    /**
+    *   \brief Glyph cache counters.
+    */
+    typedef struct {
+        uint32_t hits;          ///< Glyphs found in the cache
+        uint32_t misses;        ///< Glyphs loaded from storage
+        uint32_t reads;         ///< Calls to the storage read function
+    } SSD1306_TextCacheStats;
+
+    /**
+    *   \brief Open a font.
+    *
+    *   \param font font state.
+    *   \param read storage read function.
+    *   \param context argument passed to the read function.
+    *   \retval #SSD1306_NO_ERROR if the font was opened.
+    *   \retval #SSD1306_COMM_ERROR if the storage could not be read.
+    *   \retval #SSD1306_TEXT_FORMAT_ERROR if the header is not valid.
+    */
+    uint8_t SSD1306_Font_Open(SSD1306_Font *font, SSD1306_FontRead read, void *context);
+
+    /**
+    *   \brief Decode the next character of a UTF-8 string.
+    *
+    *   Malformed, overlong and surrogate sequences decode to
+    *   #SSD1306_TEXT_REPLACEMENT, consuming one byte.
+    *
+    *   \param text string, advanced past the character.
+    *   \return codepoint, 0 at the end of the string.
+    */
+    uint32_t SSD1306_Text_Decode(const char **text);
+
+    /**
+    *   \brief Draw a UTF-8 string.
+    *
+    *   Set pixels of the glyphs are drawn with the given color, the
+    *   background is left unchanged.
+    *
+    *   \param font font.
+    *   \param x left column of the first character.
+    *   \param y top row of the characters.
+    *   \param text UTF-8 string.
+    *   \param color color of the text.
+    *   \param end destination of the column after the last character drawn, may be NULL.
+    *   \retval #SSD1306_NO_ERROR if the string was drawn.
+    *   \retval #SSD1306_COMM_ERROR if the storage could not be read: the
+    *       string is drawn up to the character that failed.
+    */
+    uint8_t SSD1306_Text_Draw(const SSD1306_Font *font, int16_t x, int16_t y,
+                                const char *text, uint16_t color, int16_t *end);
+
+    /**
+    *   \brief Get the width of a UTF-8 string.
+    *
+    *   \param font font.
+    *   \param text UTF-8 string.
+    *   \param width destination of the width in pixels, including the
+    *       spacing after the last character.
+    *   \retval #SSD1306_NO_ERROR if the width was measured.
+    *   \retval #SSD1306_COMM_ERROR if the storage could not be read.
+    */
+    uint8_t SSD1306_Text_Width(const SSD1306_Font *font, const char *text, int16_t *width);
+
+    /**
+    *   \brief Drop all the glyphs of the cache.
+    *
+    *   Needed if the content of a font on storage changes.
+    */
+    void SSD1306_Text_FlushCache(void);
+
+    /**
+    *   \brief Get the glyph cache counters.
+    *
+    *   \param stats destination of the counters.
+    */
+    void SSD1306_Text_GetCacheStats(SSD1306_TextCacheStats *stats);
+
+    /**
+    *   \brief Reset the glyph cache counters.
+    */
+    void SSD1306_Text_ResetCacheStats(void);
+
+#endif
+
+/* [] END OF FILE */
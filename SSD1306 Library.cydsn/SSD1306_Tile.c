@@ -0,0 +1,190 @@
+/**
+ *  \file SSD1306_Tile.c
+ *
+ *  \brief Source file for the tile map.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306_Tile.h"
+#include "string.h"
+
+/**
+*   \brief Copy a tile into the buffer and mark its cell.
+*/
+static void SSD1306_Tile_Write(SSD1306_TileMap *map, uint8_t column, uint8_t row, uint8_t tile)
+{
+#if !SSD1306_NO_FRAMEBUFFER
+    memcpy(&SSD1306_GetBuffer()[row * SSD1306_WIDTH + column * 8], &map->tileset[tile * 8], 8);
+#endif
+    map->cells[row * SSD1306_TILE_COLUMNS + column] = tile;
+    map->dirty[row] |= 1UL << column;
+}
+
+void SSD1306_Tile_Init(SSD1306_TileMap *map, uint8_t *cells, const uint8_t *tileset,
+                        uint8_t tile)
+{
+    uint8_t column, row;
+
+    map->cells = cells;
+    map->tileset = tileset;
+    for (row = 0; row < SSD1306_TILE_ROWS; row++)
+    {
+        for (column = 0; column < SSD1306_TILE_COLUMNS; column++)
+        {
+            SSD1306_Tile_Write(map, column, row, tile);
+        }
+    }
+}
+
+void SSD1306_Tile_Set(SSD1306_TileMap *map, uint8_t column, uint8_t row, uint8_t tile)
+{
+    if ((column >= SSD1306_TILE_COLUMNS) || (row >= SSD1306_TILE_ROWS) ||
+        (map->cells[row * SSD1306_TILE_COLUMNS + column] == tile))
+    {
+        return;
+    }
+    SSD1306_Tile_Write(map, column, row, tile);
+}
+
+uint8_t SSD1306_Tile_Get(const SSD1306_TileMap *map, uint8_t column, uint8_t row)
+{
+    if ((column >= SSD1306_TILE_COLUMNS) || (row >= SSD1306_TILE_ROWS))
+    {
+        return 0;
+    }
+    return map->cells[row * SSD1306_TILE_COLUMNS + column];
+}
+
+uint8_t SSD1306_Tile_Print(SSD1306_TileMap *map, uint8_t column, uint8_t row,
+                            const char *text)
+{
+    while ((*text != 0) && (column < SSD1306_TILE_COLUMNS))
+    {
+        SSD1306_Tile_Set(map, column++, row, (uint8_t)*text++);
+    }
+    return column;
+}
+
+void SSD1306_Tile_Render(const SSD1306_TileMap *map, uint8_t *pixels)
+{
+    uint8_t column, row;
+
+    for (row = 0; row < SSD1306_TILE_ROWS; row++)
+    {
+        for (column = 0; column < SSD1306_TILE_COLUMNS; column++)
+        {
+            memcpy(&pixels[row * SSD1306_WIDTH + column * 8],
+                    &map->tileset[map->cells[row * SSD1306_TILE_COLUMNS + column] * 8], 8);
+        }
+    }
+}
+
+void SSD1306_Tile_Invalidate(SSD1306_TileMap *map)
+{
+    uint8_t row;
+    for (row = 0; row < SSD1306_TILE_ROWS; row++)
+    {
+        map->dirty[row] = (SSD1306_TILE_COLUMNS < 32) ?
+                            (1UL << SSD1306_TILE_COLUMNS) - 1 : 0xFFFFFFFFUL;
+    }
+}
+
+/**
+*   \brief Send a run of cells of a row.
+*
+*   \param map tile map state.
+*   \param row row of the cells.
+*   \param first first cell of the run.
+*   \param last last cell of the run (included).
+*   \param sent first cell not sent, last + 1 if the run was sent.
+*   \return error code of the transfer.
+*/
+static uint8_t SSD1306_Tile_Send(const SSD1306_TileMap *map, uint8_t row,
+                                    uint8_t first, uint8_t last, uint8_t *sent)
+{
+#if SSD1306_NO_FRAMEBUFFER
+    uint8_t staging[SSD1306_TILE_STAGING * 8];
+    const uint8_t *cells = &map->cells[row * SSD1306_TILE_COLUMNS];
+
+    *sent = first;
+    while (*sent <= last)
+    {
+        uint8_t n = (last - *sent + 1 < SSD1306_TILE_STAGING) ? last - *sent + 1 : SSD1306_TILE_STAGING;
+        uint8_t i;
+
+        for (i = 0; i < n; i++)
+        {
+            memcpy(&staging[i * 8], &map->tileset[cells[*sent + i] * 8], 8);
+        }
+        if (SSD1306_WriteWindow(row, row, *sent * 8, (*sent + n) * 8 - 1,
+                                staging, n * 8) != SSD1306_NO_ERROR)
+        {
+            return SSD1306_COMM_ERROR;
+        }
+        *sent += n;
+    }
+    return SSD1306_NO_ERROR;
+#else
+    (void)map;
+    *sent = first;
+    if (SSD1306_DisplayWindow(row, row, first * 8, last * 8 + 7) != SSD1306_NO_ERROR)
+    {
+        return SSD1306_COMM_ERROR;
+    }
+    *sent = last + 1;
+    return SSD1306_NO_ERROR;
+#endif
+}
+
+uint8_t SSD1306_Tile_Flush(SSD1306_TileMap *map)
+{
+    uint8_t row, first, last, sent;
+
+    for (row = 0; row < SSD1306_TILE_ROWS; row++)
+    {
+        uint32_t dirty = map->dirty[row];
+
+        first = 0;
+        while (dirty != 0)
+        {
+            uint32_t run;
+            uint8_t err;
+
+            while (!(dirty & (1UL << first)))
+            {
+                first++;
+            }
+            // Extend the run over single clean cells: 8 data bytes cost
+            // less than a new window command
+            last = first;
+            while ((last + 1 < SSD1306_TILE_COLUMNS) &&
+                    ((dirty & (1UL << (last + 1))) ||
+                    ((last + 2 < SSD1306_TILE_COLUMNS) && (dirty & (1UL << (last + 2))))))
+            {
+                last++;
+            }
+            err = SSD1306_Tile_Send(map, row, first, last, &sent);
+            // Cells that were sent are clean
+            run = (sent - first < 32) ? ((1UL << (sent - first)) - 1) << first :
+                                        0xFFFFFFFFUL;
+            dirty &= ~run;
+            map->dirty[row] = dirty;
+            if (err != SSD1306_NO_ERROR)
+            {
+                return err;
+            }
+            first = last + 1;
+        }
+    }
+    return SSD1306_NO_ERROR;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,163 @@
+/**
+ *   \file SSD1306_Tile.h
+ *
+ *   \brief Tile map of 8x8 cells aligned to the pages.
+ *
+ *   The display is seen as a grid of #SSD1306_TILE_COLUMNS by
+ *   #SSD1306_TILE_ROWS cells, each showing a tile of a page-major tileset
+ *   (8 bytes per tile, one per column, LSB on top). Since a cell covers
+ *   exactly 8 columns of one page, writing a tile is an 8-byte copy into
+ *   the display buffer, and writing the tile a cell already shows costs
+ *   only a comparison.
+ *
+ *   Changed cells are tracked in a bitmap and #SSD1306_Tile_Flush sends
+ *   only the runs of changed cells of each row. Cells are written to the
+ *   display buffer, which must be the render target, without marking the
+ *   page dirty map: use #SSD1306_Tile_Flush instead of
+ *   #SSD1306_DisplayDirty for the tile map.
+ *
+ *   When #SSD1306_NO_FRAMEBUFFER is set there is no display buffer: the
+ *   tile codes of the cells are the only copy of the screen, and
+ *   #SSD1306_Tile_Flush copies the tiles of each run into a small staging
+ *   buffer of #SSD1306_TILE_STAGING cells and writes them straight to the
+ *   controller with #SSD1306_WriteWindow. The bytes sent are the same as
+ *   with the display buffer, so a text interface costs
+ *   #SSD1306_TILE_CELLS bytes of RAM instead of #SSD1306_BUFFER_SIZE.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_TILE_H__
+    #define __SSD1306_TILE_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    /**
+    *   \brief Number of cells of a row.
+    */
+    #define SSD1306_TILE_COLUMNS (SSD1306_WIDTH / 8)
+
+    /**
+    *   \brief Number of rows of cells.
+    */
+    #define SSD1306_TILE_ROWS SSD1306_PAGES
+
+    /**
+    *   \brief Number of cells of the map.
+    */
+    #define SSD1306_TILE_CELLS (SSD1306_TILE_COLUMNS * SSD1306_TILE_ROWS)
+
+    #ifndef SSD1306_TILE_STAGING
+        /**
+        *   \brief Cells sent per transfer when #SSD1306_NO_FRAMEBUFFER is set.
+        *
+        *   The staging buffer takes 8 bytes per cell. Longer runs are sent
+        *   in several transfers, which continue the same window.
+        */
+        #define SSD1306_TILE_STAGING 4
+    #endif
+
+    #if SSD1306_TILE_COLUMNS > 32
+        #error "SSD1306_Tile supports at most 32 cells per row"
+    #endif
+
+    /**
+    *   \brief State of a tile map.
+    */
+    typedef struct {
+        const uint8_t *tileset;             ///< Page-major tiles, 8 bytes each
+        uint8_t *cells;                     ///< Tile of each cell, #SSD1306_TILE_CELLS entries
+        uint32_t dirty[SSD1306_TILE_ROWS];  ///< Changed cells of each row, bit n for column n
+    } SSD1306_TileMap;
+
+    /**
+    *   \brief Fill the map with one tile.
+    *
+    *   All the cells are marked as changed.
+    *
+    *   \param map tile map state.
+    *   \param cells storage of #SSD1306_TILE_CELLS entries.
+    *   \param tileset page-major tiles, 8 bytes each.
+    *   \param tile tile of all the cells.
+    */
+    void SSD1306_Tile_Init(SSD1306_TileMap *map, uint8_t *cells, const uint8_t *tileset,
+                            uint8_t tile);
+
+    /**
+    *   \brief Show a tile in a cell.
+    *
+    *   \param map tile map state.
+    *   \param column column of the cell.
+    *   \param row row of the cell.
+    *   \param tile index of the tile in the tileset.
+    */
+    void SSD1306_Tile_Set(SSD1306_TileMap *map, uint8_t column, uint8_t row, uint8_t tile);
+
+    /**
+    *   \brief Get the tile of a cell.
+    *
+    *   \param map tile map state.
+    *   \param column column of the cell.
+    *   \param row row of the cell.
+    *   \return index of the tile, 0 outside the map.
+    */
+    uint8_t SSD1306_Tile_Get(const SSD1306_TileMap *map, uint8_t column, uint8_t row);
+
+    /**
+    *   \brief Show a string, one character per cell.
+    *
+    *   Characters are used as tile indexes, so the tileset is a font
+    *   indexed by character code. The string is cut at the end of the row.
+    *
+    *   \param map tile map state.
+    *   \param column column of the first cell.
+    *   \param row row of the cells.
+    *   \param text string to show.
+    *   \return column after the last character.
+    */
+    uint8_t SSD1306_Tile_Print(SSD1306_TileMap *map, uint8_t column, uint8_t row,
+                                const char *text);
+
+    /**
+    *   \brief Draw the tiles of the map into a page-major buffer.
+    *
+    *   Gives the image the map shows once flushed, e.g. to compare it with
+    *   an emulated controller or to export a screenshot when there is no
+    *   display buffer.
+    *
+    *   \param map tile map state.
+    *   \param pixels page-major buffer of #SSD1306_BUFFER_SIZE bytes.
+    */
+    void SSD1306_Tile_Render(const SSD1306_TileMap *map, uint8_t *pixels);
+
+    /**
+    *   \brief Mark all the cells as changed.
+    *
+    *   \param map tile map state.
+    */
+    void SSD1306_Tile_Invalidate(SSD1306_TileMap *map);
+
+    /**
+    *   \brief Send the changed cells.
+    *
+    *   Each run of changed cells of a row is sent as one window; runs
+    *   separated by a single unchanged cell are merged. Without the display
+    *   buffer the tiles are rendered straight to the controller.
+    *
+    *   \param map tile map state.
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during I2C communication,
+    *       in which case the cells not sent stay marked.
+    */
+    uint8_t SSD1306_Tile_Flush(SSD1306_TileMap *map);
+
+#endif
+
+/* [] END OF FILE */
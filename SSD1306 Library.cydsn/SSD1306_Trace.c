@@ -0,0 +1,305 @@
+/**
+ *  \file SSD1306_Trace.c
+ *
+ *  \brief Source file for the I2C traffic recorder and replayer.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "I2C_Interface.h"
+#include "SSD1306.h"
+#include "SSD1306_Trace.h"
+#include "string.h"
+
+//***************************
+//          MACROS
+//***************************
+#define SSD1306_TRACE_HEADER_SIZE 4     ///< Size of the log header
+#define SSD1306_TRACE_VARINT_MAX  5     ///< Maximum size of a 32-bit varint
+
+// Log header
+static const uint8_t trace_header[SSD1306_TRACE_HEADER_SIZE] = { 'S', 'T', 'R', '1' };
+
+/**
+*   \brief Struct with recorder state.
+*/
+static struct {
+    uint8_t *ring;                  ///< Ring buffer storage
+    uint16_t size;                  ///< Size of the ring buffer
+    uint16_t head;                  ///< Next byte to be written
+    uint16_t tail;                  ///< Next byte to be read
+    uint16_t used;                  ///< Bytes in the ring buffer
+    SSD1306_TraceSink sink;         ///< Sink function
+    SSD1306_CycleCounter clock;     ///< Timestamp source
+    uint32_t last_time;             ///< Timestamp of last record
+    uint32_t dropped;               ///< Records dropped
+    uint8_t recording;              ///< Recorder active
+} trace;
+
+/**
+*   \brief Encode an unsigned LEB128 varint.
+*
+*   \param dst destination, at least #SSD1306_TRACE_VARINT_MAX bytes.
+*   \param value value to be encoded.
+*   \return number of bytes written.
+*/
+static uint8_t SSD1306_Trace_PutVarint(uint8_t *dst, uint32_t value)
+{
+    uint8_t n = 0;
+    while (value >= 0x80)
+    {
+        dst[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    dst[n++] = (uint8_t)value;
+    return n;
+}
+
+/**
+*   \brief Append bytes to the log.
+*
+*   The caller must check that the ring buffer has enough free space.
+*/
+static void SSD1306_Trace_Put(const uint8_t *data, uint16_t len)
+{
+    if (trace.sink != NULL)
+    {
+        trace.sink(data, len);
+        return;
+    }
+    trace.used += len;
+    while (len > 0)
+    {
+        uint16_t chunk = trace.size - trace.head;
+        if (chunk > len)
+        {
+            chunk = len;
+        }
+        memcpy(&trace.ring[trace.head], data, chunk);
+        trace.head = (trace.head + chunk) % trace.size;
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+void SSD1306_Trace_StartRam(uint8_t *ring, uint16_t size)
+{
+    trace.recording = 0;
+    trace.sink = NULL;
+    trace.ring = ring;
+    trace.size = size;
+    trace.head = 0;
+    trace.tail = 0;
+    trace.used = 0;
+    trace.dropped = 0;
+    if ((ring != NULL) && (size >= SSD1306_TRACE_HEADER_SIZE))
+    {
+        trace.last_time = trace.clock ? trace.clock() : 0;
+        SSD1306_Trace_Put(trace_header, SSD1306_TRACE_HEADER_SIZE);
+        trace.recording = 1;
+    }
+}
+
+void SSD1306_Trace_StartSink(SSD1306_TraceSink sink)
+{
+    trace.recording = 0;
+    trace.sink = sink;
+    trace.used = 0;
+    trace.dropped = 0;
+    if (sink != NULL)
+    {
+        trace.last_time = trace.clock ? trace.clock() : 0;
+        SSD1306_Trace_Put(trace_header, SSD1306_TRACE_HEADER_SIZE);
+        trace.recording = 1;
+    }
+}
+
+void SSD1306_Trace_Stop(void)
+{
+    // The ring buffer is kept so that it can still be drained
+    trace.recording = 0;
+}
+
+void SSD1306_Trace_SetClock(SSD1306_CycleCounter clock)
+{
+    trace.clock = clock;
+}
+
+uint16_t SSD1306_Trace_Read(uint8_t *dst, uint16_t max)
+{
+    uint16_t moved = 0;
+    while ((trace.used > 0) && (moved < max))
+    {
+        uint16_t chunk = trace.size - trace.tail;
+        if (chunk > trace.used)
+        {
+            chunk = trace.used;
+        }
+        if (chunk > max - moved)
+        {
+            chunk = max - moved;
+        }
+        memcpy(&dst[moved], &trace.ring[trace.tail], chunk);
+        trace.tail = (trace.tail + chunk) % trace.size;
+        trace.used -= chunk;
+        moved += chunk;
+    }
+    return moved;
+}
+
+uint32_t SSD1306_Trace_GetDropped(void)
+{
+    return trace.dropped;
+}
+
+void SSD1306_Trace_Record(uint8_t device_address, uint8_t control,
+                            const uint8_t *data, uint16_t block_size,
+                            uint16_t block_count, uint16_t stride, uint8_t result)
+{
+    uint8_t head[2 * SSD1306_TRACE_VARINT_MAX + 2];
+    uint16_t len = block_size * block_count;
+    uint32_t now;
+    uint8_t n;
+
+    if (!trace.recording)
+    {
+        return;
+    }
+    now = trace.clock ? trace.clock() : 0;
+    n = SSD1306_Trace_PutVarint(head, now - trace.last_time);
+    head[n++] = (device_address & 0x7F) | (result != I2C_NO_ERROR ? 0x80 : 0x00);
+    head[n++] = control;
+    n += SSD1306_Trace_PutVarint(&head[n], len);
+
+    // Records are never split: drop the whole record if it does not fit
+    if ((trace.sink == NULL) && ((uint32_t)trace.size - trace.used < (uint32_t)n + len))
+    {
+        trace.dropped++;
+        return;
+    }
+    trace.last_time = now;
+    SSD1306_Trace_Put(head, n);
+    while (block_count > 0)
+    {
+        SSD1306_Trace_Put(data, block_size);
+        data += stride;
+        block_count--;
+    }
+}
+
+#if SSD1306_TRACE_REPLAY
+
+/**
+*   \brief Decode an unsigned LEB128 varint.
+*
+*   \param log log bytes.
+*   \param len size of the log.
+*   \param pos position in the log, advanced past the varint.
+*   \param value decoded value.
+*   \return 1 if decoded, 0 if the log is truncated or the varint too long.
+*/
+static uint8_t SSD1306_Trace_GetVarint(const uint8_t *log, uint32_t len, uint32_t *pos, uint32_t *value)
+{
+    uint8_t shift = 0;
+    *value = 0;
+    while ((*pos < len) && (shift < 7 * SSD1306_TRACE_VARINT_MAX))
+    {
+        uint8_t b = log[(*pos)++];
+        *value |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+        {
+            return 1;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+uint8_t SSD1306_Trace_Replay(const uint8_t *log, uint32_t len, SSD1306_Emu *emu,
+                                uint32_t bus_hz, SSD1306_TraceReplayStats *stats,
+                                SSD1306_TraceReplayCallback callback, void *context)
+{
+    SSD1306_TraceReplayStats local;
+    uint32_t pos = SSD1306_TRACE_HEADER_SIZE;
+    uint32_t timestamp = 0;
+
+    if (stats == NULL)
+    {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    if ((len < SSD1306_TRACE_HEADER_SIZE) ||
+        (memcmp(log, trace_header, SSD1306_TRACE_HEADER_SIZE) != 0))
+    {
+        return SSD1306_TRACE_FORMAT_ERROR;
+    }
+
+    while (pos < len)
+    {
+        uint32_t delta, payload;
+        uint8_t address, control;
+
+        if (!SSD1306_Trace_GetVarint(log, len, &pos, &delta) || (pos + 2 > len))
+        {
+            return SSD1306_TRACE_FORMAT_ERROR;
+        }
+        address = log[pos++];
+        control = log[pos++];
+        if (!SSD1306_Trace_GetVarint(log, len, &pos, &payload) ||
+            (payload > len - pos) || (payload > 0xFFFF))
+        {
+            return SSD1306_TRACE_FORMAT_ERROR;
+        }
+        // The first delta is measured from the start of the recording
+        if (stats->records > 0)
+        {
+            timestamp += delta;
+        }
+
+        stats->records++;
+        if (control & 0x40)
+        {
+            stats->data_bytes += payload;
+        }
+        else
+        {
+            stats->command_bytes += payload;
+        }
+        // Start + address and control bytes + payload, 9 bits each with ack, stop
+        stats->wire_bits += 1 + 9 * (2 + payload) + 1;
+
+        if (address & 0x80)
+        {
+            stats->failed++;
+        }
+        else
+        {
+            SSD1306_Emu_Write(emu, control, &log[pos], (uint16_t)payload);
+        }
+        pos += payload;
+
+        if (callback != NULL)
+        {
+            callback(emu, timestamp, context);
+        }
+    }
+
+    stats->duration = timestamp;
+    if (bus_hz > 0)
+    {
+        stats->wire_time_us = (uint32_t)((stats->wire_bits * 1000000) / bus_hz);
+    }
+    return SSD1306_NO_ERROR;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,178 @@
+/**
+ *   \file SSD1306_Trace.h
+ *
+ *   \brief Recorder and replayer of the I2C traffic sent to the display.
+ *
+ *   When #SSD1306_TRACE_ENABLED is set to 1, every write transaction done
+ *   through I2C_Interface is appended to a compact binary log, either in a
+ *   RAM ring buffer (to be drained by the application, e.g. over USB) or
+ *   directly to a sink function such as a UART transmit function.
+ *
+ *   Log format (multi-byte integers are unsigned LEB128 varints):
+ *     - header: the four bytes 'S', 'T', 'R', '1';
+ *     - one record per transaction:
+ *         - timestamp delta from previous record, in clock ticks (varint);
+ *         - 7-bit device address, bit 7 set if the transaction failed;
+ *         - control byte (register address);
+ *         - payload length (varint);
+ *         - payload bytes.
+ *
+ *   #SSD1306_Trace_Replay parses a log, feeds the records to the controller
+ *   emulator (SSD1306_Emu.h) and computes wire-time statistics, so that
+ *   refresh strategies can be compared offline on identical traffic. It is
+ *   compiled on the host only, when #SSD1306_TRACE_REPLAY is set, since the
+ *   emulator is not part of the firmware project.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_TRACE_H__
+    #define __SSD1306_TRACE_H__
+
+    #include "cytypes.h"
+    #include "SSD1306_Stats.h"
+
+    #ifndef SSD1306_TRACE_ENABLED
+        /**
+        *   \brief Set to 1 to compile the recorder in the I2C interface.
+        */
+        #define SSD1306_TRACE_ENABLED 0
+    #endif
+
+    #ifndef SSD1306_TRACE_REPLAY
+        /**
+        *   \brief Set to 1 to compile #SSD1306_Trace_Replay, with the emulator, on the host.
+        */
+        #define SSD1306_TRACE_REPLAY 0
+    #endif
+
+    /**
+    *   \brief Sink receiving the log bytes (e.g. a UART transmit function).
+    */
+    typedef void (*SSD1306_TraceSink)(const uint8_t *data, uint16_t len);
+
+    /**
+    *   \brief Start recording into a RAM ring buffer.
+    *
+    *   Records that do not fit in the free space are dropped entirely.
+    *
+    *   \param ring ring buffer storage.
+    *   \param size size of the storage in bytes.
+    */
+    void SSD1306_Trace_StartRam(uint8_t *ring, uint16_t size);
+
+    /**
+    *   \brief Start recording to a sink function.
+    *
+    *   \param sink function receiving the log bytes.
+    */
+    void SSD1306_Trace_StartSink(SSD1306_TraceSink sink);
+
+    /**
+    *   \brief Stop recording.
+    */
+    void SSD1306_Trace_Stop(void);
+
+    /**
+    *   \brief Set the clock used to timestamp records.
+    *
+    *   \param clock free-running counter, NULL to record zero deltas.
+    */
+    void SSD1306_Trace_SetClock(SSD1306_CycleCounter clock);
+
+    /**
+    *   \brief Move recorded bytes out of the RAM ring buffer.
+    *
+    *   \param dst destination.
+    *   \param max maximum number of bytes to move.
+    *   \return number of bytes moved.
+    */
+    uint16_t SSD1306_Trace_Read(uint8_t *dst, uint16_t max);
+
+    /**
+    *   \brief Get the number of records dropped because the ring buffer was full.
+    *
+    *   \return number of dropped records.
+    */
+    uint32_t SSD1306_Trace_GetDropped(void);
+
+    /**
+    *   \brief Record a write transaction.
+    *
+    *   Called by I2C_Interface through #SSD1306_TRACE_WRITE. The payload is
+    *   made of block_count blocks of block_size bytes, stride bytes apart.
+    */
+    void SSD1306_Trace_Record(uint8_t device_address, uint8_t control,
+                                const uint8_t *data, uint16_t block_size,
+                                uint16_t block_count, uint16_t stride, uint8_t result);
+
+    #if SSD1306_TRACE_REPLAY
+
+        #include "SSD1306_Emu.h"
+
+        /**
+        *   \brief Log is malformed or truncated.
+        */
+        #define SSD1306_TRACE_FORMAT_ERROR 2
+
+        /**
+        *   \brief Callback invoked after each record is applied to the emulator.
+        */
+        typedef void (*SSD1306_TraceReplayCallback)(const SSD1306_Emu *emu, uint32_t timestamp, void *context);
+
+        /**
+        *   \brief Statistics computed while replaying a log.
+        */
+        typedef struct {
+            uint32_t records;           ///< Number of transactions
+            uint32_t failed;            ///< Transactions recorded as failed
+            uint32_t command_bytes;     ///< Bytes sent with command control byte
+            uint32_t data_bytes;        ///< Bytes sent with data control byte
+            uint32_t duration;          ///< Time between first and last record, in clock ticks
+            uint64_t wire_bits;         ///< Bits on the wire, including start, stop and acks
+            uint32_t wire_time_us;      ///< Wire time at the replay bus frequency
+        } SSD1306_TraceReplayStats;
+
+        /**
+        *   \brief Replay a recorded log on the controller emulator.
+        *
+        *   Records flagged as failed are counted but not applied to the
+        *   emulator, although part of them may have reached the controller
+        *   before the error: the emulated GDDRAM (and the command being
+        *   received) can then differ from the display's until a successful
+        *   transfer rewrites them. Wire statistics count failed records as if
+        *   their whole payload had been sent.
+        *
+        *   \param log log bytes, starting with the header.
+        *   \param len number of bytes of the log.
+        *   \param emu emulator, already initialized.
+        *   \param bus_hz I2C clock frequency used to compute wire time.
+        *   \param stats statistics of the replay, may be NULL.
+        *   \param callback function called after each record, may be NULL.
+        *   \param context argument passed to the callback.
+        *   \retval #SSD1306_NO_ERROR if the whole log was replayed.
+        *   \retval #SSD1306_TRACE_FORMAT_ERROR if the log is malformed.
+        */
+        uint8_t SSD1306_Trace_Replay(const uint8_t *log, uint32_t len, SSD1306_Emu *emu,
+                                        uint32_t bus_hz, SSD1306_TraceReplayStats *stats,
+                                        SSD1306_TraceReplayCallback callback, void *context);
+
+    #endif
+
+    #if SSD1306_TRACE_ENABLED
+        /** \brief Record a write transaction of the I2C interface. */
+        #define SSD1306_TRACE_WRITE(addr, control, data, size, count, stride, result) \
+            SSD1306_Trace_Record((addr), (control), (data), (size), (count), (stride), (result))
+    #else
+        #define SSD1306_TRACE_WRITE(addr, control, data, size, count, stride, result)
+    #endif
+
+#endif
+
+/* [] END OF FILE */
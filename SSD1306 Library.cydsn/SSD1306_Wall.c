@@ -0,0 +1,317 @@
+/**
+ *  \file SSD1306_Wall.c
+ *
+ *  \brief Source file for walls of panels.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "I2C_Interface.h"
+#include "SSD1306_RegMap.h"
+#include "SSD1306_Wall.h"
+#include "string.h"
+
+//***************************
+//          MACROS
+//***************************
+#define SSD1306_WALL_COMMAND 0      ///< Next transfer is the command of a window
+#define SSD1306_WALL_DATA    1      ///< Next transfer is the data of a window
+#define SSD1306_WALL_DONE    2      ///< Nothing left to send
+#define SSD1306_WALL_PENDING 0x80   ///< Transfer in progress
+#define SSD1306_WALL_COMMAND_SIZE 6 ///< Window command: PAGEADDR and COLUMNADDR
+
+// Blocking bus of the I2C interface
+static const SSD1306_WallBus wall_i2c_bus = {
+    I2C_Peripheral_WriteRegisterMultiStrided,
+    NULL
+};
+
+/**
+*   \brief Mark a whole panel as clean.
+*/
+static void SSD1306_Panel_ClearDirty(SSD1306_Panel *panel)
+{
+    memset(panel->dirty_first, 0xFF, sizeof(panel->dirty_first));
+    memset(panel->dirty_last, 0x00, sizeof(panel->dirty_last));
+}
+
+/**
+*   \brief Account for the end of a transfer of a panel.
+*
+*   \param panel panel state.
+*/
+static void SSD1306_Wall_Complete(SSD1306_Panel *panel)
+{
+    panel->state &= ~SSD1306_WALL_PENDING;
+    if (panel->state == SSD1306_WALL_COMMAND)
+    {
+        panel->resync = 0;
+        panel->state = SSD1306_WALL_DATA;
+        return;
+    }
+    // Mark the pages as clean only once they were sent
+    for (; panel->page <= panel->page_end; panel->page++)
+    {
+        panel->dirty_first[panel->page] = 0xFF;
+        panel->dirty_last[panel->page] = 0x00;
+    }
+    panel->state = SSD1306_WALL_COMMAND;
+}
+
+/**
+*   \brief Account for a failed transfer of a panel.
+*
+*   A window command cut by the failure leaves the controller waiting for
+*   parameters: NOPs are sent in front of the next one to complete it.
+*   Panels on the I2C interface are left to #SSD1306_WriteWindow.
+*
+*   \param panel panel state.
+*/
+static void SSD1306_Wall_Fail(SSD1306_Panel *panel)
+{
+    if ((panel->bus != &wall_i2c_bus) &&
+        ((panel->state & ~SSD1306_WALL_PENDING) == SSD1306_WALL_COMMAND))
+    {
+        panel->resync = SSD1306_WALL_RESYNC_MAX;
+    }
+    panel->state = SSD1306_WALL_DONE;
+}
+
+/**
+*   \brief Start the next transfer of a panel.
+*
+*   Panels on the I2C interface are sent with #SSD1306_WriteWindow, which
+*   plans the setup, resends what was not acknowledged and recovers from
+*   cut commands. Other buses get the window command and the data as two
+*   transfers, and panels at the address of the driver make it forget
+*   the controller window.
+*
+*   \param panel panel state.
+*   \return result of the bus write.
+*/
+static uint8_t SSD1306_Wall_Start(SSD1306_Panel *panel)
+{
+    uint8_t *cmd = &panel->command[SSD1306_WALL_RESYNC_MAX];
+    uint8_t page = panel->page;
+    uint8_t result;
+
+    if (panel->state == SSD1306_WALL_COMMAND)
+    {
+        // Next group of consecutive dirty pages, as in SSD1306_DisplayDirty
+        while ((page < SSD1306_PAGES) && (panel->dirty_first[page] > panel->dirty_last[page]))
+        {
+            page++;
+        }
+        if (page >= SSD1306_PAGES)
+        {
+            panel->state = SSD1306_WALL_DONE;
+            return I2C_NO_ERROR;
+        }
+        panel->page = page;
+        cmd[0] = SSD1306_PAGEADDR;
+        cmd[1] = page;
+        cmd[3] = SSD1306_COLUMNADDR;
+        cmd[4] = panel->dirty_first[page];
+        cmd[5] = panel->dirty_last[page];
+        while ((page + 1 < SSD1306_PAGES) &&
+                (panel->dirty_first[page + 1] <= panel->dirty_last[page + 1]))
+        {
+            page++;
+            if (panel->dirty_first[page] < cmd[4])
+            {
+                cmd[4] = panel->dirty_first[page];
+            }
+            if (panel->dirty_last[page] > cmd[5])
+            {
+                cmd[5] = panel->dirty_last[page];
+            }
+        }
+        cmd[2] = page;
+        panel->page_end = page;
+        if (panel->bus == &wall_i2c_bus)
+        {
+            SSD1306_SetAddress(panel->address);
+            if (SSD1306_WriteWindow(panel->page, page, cmd[4], cmd[5],
+                                    &panel->pixels[panel->page * SSD1306_WIDTH + cmd[4]],
+                                    SSD1306_WIDTH) != SSD1306_NO_ERROR)
+            {
+                return I2C_ERROR;
+            }
+            panel->state = SSD1306_WALL_DATA;
+            SSD1306_Wall_Complete(panel);
+            return I2C_NO_ERROR;
+        }
+        SSD1306_ForgetAddressing(panel->address);
+        result = panel->bus->write(panel->address, 0x00,
+                                    SSD1306_WALL_COMMAND_SIZE + panel->resync, 1,
+                                    SSD1306_WALL_COMMAND_SIZE + panel->resync,
+                                    cmd - panel->resync);
+    }
+    else
+    {
+        result = panel->bus->write(panel->address, 0x40, cmd[5] - cmd[4] + 1,
+                                    panel->page_end - panel->page + 1, SSD1306_WIDTH,
+                                    &panel->pixels[panel->page * SSD1306_WIDTH + cmd[4]]);
+    }
+    if (result == I2C_NO_ERROR)
+    {
+        if (panel->bus->busy == NULL)
+        {
+            SSD1306_Wall_Complete(panel);
+        }
+        else
+        {
+            panel->state |= SSD1306_WALL_PENDING;
+        }
+    }
+    return result;
+}
+
+void SSD1306_Panel_Init(SSD1306_Panel *panel, uint8_t *pixels, const SSD1306_WallBus *bus,
+                            uint8_t address, int16_t x, int16_t y, uint8_t height)
+{
+    panel->pixels = pixels;
+    panel->bus = (bus != NULL) ? bus : &wall_i2c_bus;
+    panel->address = address;
+    panel->x = x;
+    panel->y = y;
+    panel->height = height;
+    panel->state = SSD1306_WALL_DONE;
+    panel->resync = 0;
+    memset(panel->command, SSD1306_NOP, SSD1306_WALL_RESYNC_MAX);
+    memset(pixels, 0, SSD1306_BUFFER_SIZE);
+    SSD1306_Panel_ClearDirty(panel);
+}
+
+void SSD1306_Wall_Init(SSD1306_Wall *wall, SSD1306_Panel *panels, uint8_t count)
+{
+    wall->panels = panels;
+    wall->count = count;
+    wall->current = -1;
+}
+
+void SSD1306_Wall_Select(SSD1306_Wall *wall, int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    SSD1306_GetOrigin(&wall->origin_x, &wall->origin_y);
+    wall->x = x + wall->origin_x;
+    wall->y = y + wall->origin_y;
+    wall->w = w;
+    wall->h = h;
+    wall->current = -1;
+}
+
+uint8_t SSD1306_Wall_Next(SSD1306_Wall *wall)
+{
+    int8_t i;
+
+    if (wall->current >= 0)
+    {
+        SSD1306_PopClip();
+    }
+    for (i = wall->current + 1; i < wall->count; i++)
+    {
+        SSD1306_Panel *panel = &wall->panels[i];
+        if ((wall->x < panel->x + SSD1306_WIDTH) && (wall->x + wall->w > panel->x) &&
+            (wall->y < panel->y + panel->height) && (wall->y + wall->h > panel->y))
+        {
+            SSD1306_SetTarget(panel->pixels, panel->dirty_first, panel->dirty_last);
+            // Clip to the panel, then move the origin to its position
+            SSD1306_SetOrigin(0, 0);
+            SSD1306_PushClip(0, 0, SSD1306_WIDTH, panel->height);
+            SSD1306_SetOrigin(wall->origin_x - panel->x, wall->origin_y - panel->y);
+            wall->current = i;
+            return 1;
+        }
+    }
+    wall->current = -1;
+    SSD1306_SetTarget(NULL, NULL, NULL);
+    SSD1306_SetOrigin(wall->origin_x, wall->origin_y);
+    return 0;
+}
+
+void SSD1306_Wall_Clear(SSD1306_Wall *wall)
+{
+    uint8_t i, page;
+
+    for (i = 0; i < wall->count; i++)
+    {
+        SSD1306_Panel *panel = &wall->panels[i];
+        memset(panel->pixels, 0, SSD1306_BUFFER_SIZE);
+        for (page = 0; page < (panel->height + 7) / 8; page++)
+        {
+            panel->dirty_first[page] = 0;
+            panel->dirty_last[page] = SSD1306_WIDTH - 1;
+        }
+    }
+}
+
+uint8_t SSD1306_Wall_Flush(SSD1306_Wall *wall)
+{
+    uint8_t address = SSD1306_GetAddress();
+    uint8_t error = SSD1306_NO_ERROR;
+    uint8_t active, i, j;
+
+    for (i = 0; i < wall->count; i++)
+    {
+        wall->panels[i].page = 0;
+        wall->panels[i].state = SSD1306_WALL_COMMAND;
+    }
+
+    // Each pass starts a transfer on every idle bus
+    do
+    {
+        active = 0;
+        for (i = 0; i < wall->count; i++)
+        {
+            SSD1306_Panel *panel = &wall->panels[i];
+            uint8_t result;
+
+            if (panel->state == SSD1306_WALL_DONE)
+            {
+                continue;
+            }
+            active = 1;
+            if (panel->state & SSD1306_WALL_PENDING)
+            {
+                result = panel->bus->busy();
+                if (result == I2C_BUSY)
+                {
+                    continue;
+                }
+                if (result != I2C_NO_ERROR)
+                {
+                    SSD1306_Wall_Fail(panel);
+                    error = SSD1306_COMM_ERROR;
+                    continue;
+                }
+                SSD1306_Wall_Complete(panel);
+            }
+            // Panels sharing a bus take turns
+            for (j = 0; j < wall->count; j++)
+            {
+                if ((j != i) && (wall->panels[j].bus == panel->bus) &&
+                    (wall->panels[j].state & SSD1306_WALL_PENDING))
+                {
+                    break;
+                }
+            }
+            if ((j == wall->count) && (SSD1306_Wall_Start(panel) != I2C_NO_ERROR))
+            {
+                SSD1306_Wall_Fail(panel);
+                error = SSD1306_COMM_ERROR;
+            }
+        }
+    } while (active);
+
+    SSD1306_SetAddress(address);
+    return error;
+}
+
+/* [] END OF FILE */
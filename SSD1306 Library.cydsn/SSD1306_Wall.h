@@ -0,0 +1,171 @@
+/**
+ *   \file SSD1306_Wall.h
+ *
+ *   \brief One drawing surface spanning several panels.
+ *
+ *   A wall is made of panels placed side by side or stacked, each with
+ *   its own page-major buffer and dirty map. Global coordinates are mapped
+ *   onto the panels by making each panel in turn the render target, with
+ *   the drawing origin moved to its position and the clip rectangle set
+ *   to its size:
+ *
+ *       SSD1306_Wall_Select(&wall, x - r, y - r, 2 * r + 1, 2 * r + 1);
+ *       while (SSD1306_Wall_Next(&wall))
+ *       {
+ *           SSD1306_GFX_FillCircle(x, y, r, SSD1306_WHITE);
+ *       }
+ *
+ *   Only the panels overlapping the selected rectangle are visited, and
+ *   the primitives clip their spans analytically, so a shape crossing a
+ *   seam is split without testing each pixel against the panels.
+ *
+ *   #SSD1306_Wall_Flush sends the dirty windows of each panel. Panels on
+ *   different buses are flushed in parallel when their bus transfers are
+ *   asynchronous; panels sharing a bus take turns. Panels on the I2C
+ *   interface are sent like the display buffer, with #SSD1306_SetAddress
+ *   and #SSD1306_WriteWindow, and recover from bus faults the same way.
+ *   On other buses a cut window command is completed with NOPs before the
+ *   next one.
+ *
+ *   Wall coordinates are not rotated: panels are used with rotation 0 and
+ *   must not be taller than #SSD1306_HEIGHT.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_WALL_H__
+    #define __SSD1306_WALL_H__
+
+    #include "cytypes.h"
+    #include "SSD1306.h"
+
+    /**
+    *   \brief Most NOPs owed to a panel: the parameters of a window command.
+    */
+    #define SSD1306_WALL_RESYNC_MAX 2
+
+    /**
+    *   \brief Bus used to flush panels.
+    *
+    *   write sends block_count blocks of block_size bytes, stride bytes
+    *   apart, after the control byte, with the same arguments as
+    *   I2C_Peripheral_WriteRegisterMultiStrided. It may return before the
+    *   transfer is over if busy is provided; the data stays valid until
+    *   busy reports completion.
+    */
+    typedef struct {
+        uint8_t (*write)(uint8_t device_address, uint8_t control, uint16_t block_size,
+                            uint16_t block_count, uint16_t stride, const uint8_t *data);
+        uint8_t (*busy)(void);  ///< I2C_BUSY, I2C_NO_ERROR or I2C_ERROR; NULL if write blocks
+    } SSD1306_WallBus;
+
+    /**
+    *   \brief State of a panel.
+    */
+    typedef struct {
+        uint8_t *pixels;                        ///< Page-major buffer, #SSD1306_BUFFER_SIZE bytes
+        uint8_t dirty_first[SSD1306_PAGES];     ///< First modified column of each page
+        uint8_t dirty_last[SSD1306_PAGES];      ///< Last modified column of each page
+        const SSD1306_WallBus *bus;             ///< Bus of the panel
+        uint8_t address;                        ///< I2C address of the panel
+        int16_t x;                              ///< Column of the panel in the wall
+        int16_t y;                              ///< Row of the panel in the wall
+        uint8_t height;                         ///< Height of the panel in pixels
+        uint8_t command[SSD1306_WALL_RESYNC_MAX + 6];   ///< NOPs, then the window command being sent
+        uint8_t resync;                         ///< NOPs owed after a cut window command
+        uint8_t page;                           ///< Next page to flush
+        uint8_t page_end;                       ///< Last page of the window being sent
+        uint8_t state;                          ///< Flush state
+    } SSD1306_Panel;
+
+    /**
+    *   \brief State of a wall.
+    */
+    typedef struct {
+        SSD1306_Panel *panels;  ///< Panels of the wall
+        uint8_t count;          ///< Number of panels
+        int8_t current;         ///< Panel being drawn, -1 if none
+        int16_t x;              ///< Selected rectangle
+        int16_t y;              ///< Selected rectangle
+        int16_t w;              ///< Selected rectangle
+        int16_t h;              ///< Selected rectangle
+        int16_t origin_x;       ///< Drawing origin before the selection
+        int16_t origin_y;       ///< Drawing origin before the selection
+    } SSD1306_Wall;
+
+    /**
+    *   \brief Initialize a blank panel.
+    *
+    *   The display itself is started separately, e.g. with
+    *   #SSD1306_SetAddress and #SSD1306_Start for the default bus.
+    *
+    *   \param panel panel state.
+    *   \param pixels buffer of #SSD1306_BUFFER_SIZE bytes.
+    *   \param bus bus of the panel, NULL for the I2C interface.
+    *   \param address I2C address of the panel.
+    *   \param x column of the panel in the wall.
+    *   \param y row of the panel in the wall.
+    *   \param height height of the panel in pixels.
+    */
+    void SSD1306_Panel_Init(SSD1306_Panel *panel, uint8_t *pixels, const SSD1306_WallBus *bus,
+                                uint8_t address, int16_t x, int16_t y, uint8_t height);
+
+    /**
+    *   \brief Initialize a wall.
+    *
+    *   \param wall wall state.
+    *   \param panels panels, already initialized.
+    *   \param count number of panels.
+    */
+    void SSD1306_Wall_Init(SSD1306_Wall *wall, SSD1306_Panel *panels, uint8_t count);
+
+    /**
+    *   \brief Select the wall area the next drawing operations touch.
+    *
+    *   \param wall wall state.
+    *   \param x left column of the area.
+    *   \param y top row of the area.
+    *   \param w width of the area.
+    *   \param h height of the area.
+    */
+    void SSD1306_Wall_Select(SSD1306_Wall *wall, int16_t x, int16_t y, int16_t w, int16_t h);
+
+    /**
+    *   \brief Make the next panel overlapping the selected area the render target.
+    *
+    *   When no panel is left, the display buffer becomes the render target
+    *   again and the origin is restored.
+    *
+    *   \param wall wall state.
+    *   \return 1 if a panel was selected, 0 when done.
+    */
+    uint8_t SSD1306_Wall_Next(SSD1306_Wall *wall);
+
+    /**
+    *   \brief Clear all the panels.
+    *
+    *   \param wall wall state.
+    */
+    void SSD1306_Wall_Clear(SSD1306_Wall *wall);
+
+    /**
+    *   \brief Send the modified windows of all the panels.
+    *
+    *   Panels that did not change are skipped. Windows not sent because of
+    *   an error stay dirty.
+    *
+    *   \param wall wall state.
+    *   \retval #SSD1306_NO_ERROR if no error occurred.
+    *   \retval #SSD1306_COMM_ERROR if error occurred during communication.
+    */
+    uint8_t SSD1306_Wall_Flush(SSD1306_Wall *wall);
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,377 @@
+/**
+ *  \file SSD1306_Widget.c
+ *
+ *  \brief Source file for the incremental widgets.
+ *
+ *  \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ *
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_GFX.h"
+#include "SSD1306_Path.h"
+#include "SSD1306_Widget.h"
+
+//***************************
+//          MACROS
+//***************************
+// Degrees of arc filled by one polygon: one outer and one inner vertex per degree
+#define SSD1306_WIDGET_ARC_CHUNK (SSD1306_GFX_MAX_EDGES / 2 - 1)
+
+// Segments of a seven-segment digit
+#define SSD1306_SEG_A 0x01
+#define SSD1306_SEG_B 0x02
+#define SSD1306_SEG_C 0x04
+#define SSD1306_SEG_D 0x08
+#define SSD1306_SEG_E 0x10
+#define SSD1306_SEG_F 0x20
+#define SSD1306_SEG_G 0x40
+
+// Segments of the digits 0 to 9
+static const uint8_t widget_digits[10] = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F
+};
+
+/**
+*   \brief Scale a length by the sine of an angle, rounding to nearest.
+*
+*   \param r length.
+*   \param angle angle in degrees, any value.
+*   \return r * sin(angle).
+*/
+static int16_t SSD1306_Widget_Sin(int16_t r, int16_t angle)
+{
+    SSD1306_Fixed s = SSD1306_Path_Sin(angle);
+    int16_t v;
+
+    // Rounded on the magnitude, so that symmetric angles give symmetric points
+    v = (int16_t)(((int32_t)r * (s < 0 ? -s : s) + 0x8000) >> 16);
+    return s < 0 ? -v : v;
+}
+
+/**
+*   \brief Map a value to a range of pixels or degrees.
+*
+*   \return value scaled from [min, max] to [0, span], clamped.
+*/
+static int16_t SSD1306_Widget_Scale(int16_t value, int16_t min, int16_t max, int16_t span)
+{
+    if (value <= min)
+    {
+        return 0;
+    }
+    if (value >= max)
+    {
+        return span;
+    }
+    return (int16_t)(((int32_t)(value - min) * span + (max - min) / 2) / (max - min));
+}
+
+void SSD1306_Bar_Init(SSD1306_Bar *bar, int16_t x, int16_t y, int16_t w, int16_t h,
+                        int16_t min, int16_t max, uint8_t direction)
+{
+    bar->x = x;
+    bar->y = y;
+    bar->w = w;
+    bar->h = h;
+    bar->min = min;
+    bar->max = max;
+    bar->direction = direction;
+    bar->length = 0;
+    SSD1306_GFX_DrawRect(x, y, w, h, SSD1306_WHITE);
+    SSD1306_GFX_FillRect(x + 1, y + 1, w - 2, h - 2, SSD1306_BLACK);
+}
+
+void SSD1306_Bar_Set(SSD1306_Bar *bar, int16_t value)
+{
+    int16_t extent = (bar->direction == SSD1306_WIDGET_BAR_UP ? bar->h : bar->w) - 2;
+    int16_t length = SSD1306_Widget_Scale(value, bar->min, bar->max, extent);
+    int16_t from = bar->length, to = length;
+    uint16_t color = SSD1306_WHITE;
+
+    if (length == bar->length)
+    {
+        return;
+    }
+    if (length < bar->length)
+    {
+        from = length;
+        to = bar->length;
+        color = SSD1306_BLACK;
+    }
+    // Only the span between the old and the new end
+    if (bar->direction == SSD1306_WIDGET_BAR_UP)
+    {
+        SSD1306_GFX_FillRect(bar->x + 1, bar->y + bar->h - 1 - to, bar->w - 2, to - from, color);
+    }
+    else
+    {
+        SSD1306_GFX_FillRect(bar->x + 1 + from, bar->y + 1, to - from, bar->h - 2, color);
+    }
+    bar->length = length;
+}
+
+/**
+*   \brief Fill the part of the ring of a gauge between two angles.
+*
+*   All vertices lie on whole degrees, so that the sectors drawn by
+*   successive updates add up exactly to the sector of the final value.
+*
+*   \param gauge gauge state.
+*   \param from first angle from the start.
+*   \param to last angle from the start.
+*   \param color fill color.
+*/
+static void SSD1306_Gauge_Sector(const SSD1306_Gauge *gauge, int16_t from, int16_t to,
+                                    uint16_t color)
+{
+    SSD1306_Point points[SSD1306_GFX_MAX_EDGES];
+    int16_t inner = gauge->radius - gauge->thickness;
+
+    while (from < to)
+    {
+        int16_t end = (to - from > SSD1306_WIDGET_ARC_CHUNK) ? from + SSD1306_WIDGET_ARC_CHUNK : to;
+        uint16_t n = 0;
+        int16_t a;
+
+        // Outer arc forwards, inner arc backwards
+        for (a = from; a <= end; a++)
+        {
+            points[n].x = gauge->cx + SSD1306_Widget_Sin(gauge->radius, gauge->start + a + 90);
+            points[n].y = gauge->cy + SSD1306_Widget_Sin(gauge->radius, gauge->start + a);
+            n++;
+        }
+        if (inner <= 0)
+        {
+            points[n].x = gauge->cx;
+            points[n].y = gauge->cy;
+            n++;
+        }
+        else
+        {
+            for (a = end; a >= from; a--)
+            {
+                points[n].x = gauge->cx + SSD1306_Widget_Sin(inner, gauge->start + a + 90);
+                points[n].y = gauge->cy + SSD1306_Widget_Sin(inner, gauge->start + a);
+                n++;
+            }
+        }
+        SSD1306_GFX_FillPolygon(points, n, SSD1306_GFX_NONZERO, color);
+        from = end;
+    }
+}
+
+void SSD1306_Gauge_Init(SSD1306_Gauge *gauge, int16_t cx, int16_t cy,
+                            uint8_t radius, uint8_t thickness, int16_t start,
+                            int16_t sweep, int16_t min, int16_t max)
+{
+    gauge->cx = cx;
+    gauge->cy = cy;
+    gauge->radius = radius;
+    gauge->thickness = thickness;
+    gauge->start = start;
+    gauge->sweep = sweep;
+    gauge->min = min;
+    gauge->max = max;
+    gauge->angle = 0;
+    SSD1306_Gauge_Sector(gauge, 0, sweep, SSD1306_BLACK);
+}
+
+void SSD1306_Gauge_Set(SSD1306_Gauge *gauge, int16_t value)
+{
+    int16_t angle = SSD1306_Widget_Scale(value, gauge->min, gauge->max, gauge->sweep);
+
+    if (angle > gauge->angle)
+    {
+        SSD1306_Gauge_Sector(gauge, gauge->angle, angle, SSD1306_WHITE);
+    }
+    else if (angle < gauge->angle)
+    {
+        SSD1306_Gauge_Sector(gauge, angle, gauge->angle, SSD1306_BLACK);
+    }
+    gauge->angle = angle;
+}
+
+void SSD1306_Numeric_Init(SSD1306_Numeric *numeric, int16_t x, int16_t y,
+                            uint8_t digits, uint8_t digit_w, uint8_t digit_h,
+                            uint8_t thickness, uint8_t spacing)
+{
+    uint8_t i;
+
+    numeric->x = x;
+    numeric->y = y;
+    numeric->digits = digits > SSD1306_WIDGET_DIGITS ? SSD1306_WIDGET_DIGITS : digits;
+    numeric->digit_w = digit_w;
+    numeric->digit_h = digit_h;
+    numeric->thickness = thickness;
+    numeric->spacing = spacing;
+    for (i = 0; i < numeric->digits; i++)
+    {
+        numeric->segments[i] = 0;
+    }
+    SSD1306_GFX_FillRect(x, y, numeric->digits * (digit_w + spacing) - spacing, digit_h,
+                            SSD1306_BLACK);
+}
+
+void SSD1306_Numeric_SetSegments(SSD1306_Numeric *numeric, uint8_t digit, uint8_t segments)
+{
+    int16_t x = numeric->x + digit * (numeric->digit_w + numeric->spacing);
+    int16_t y = numeric->y;
+    int16_t w = numeric->digit_w;
+    int16_t t = numeric->thickness;
+    // Top of the middle segment
+    int16_t mid = (numeric->digit_h - t) / 2;
+    int16_t upper = mid - t;
+    int16_t lower = numeric->digit_h - mid - 2 * t;
+    uint8_t changed;
+
+    if (digit >= numeric->digits)
+    {
+        return;
+    }
+    changed = numeric->segments[digit] ^ segments;
+    if (changed & SSD1306_SEG_A)
+    {
+        SSD1306_GFX_FillRect(x + t, y, w - 2 * t, t, segments & SSD1306_SEG_A ? SSD1306_WHITE : SSD1306_BLACK);
+    }
+    if (changed & SSD1306_SEG_B)
+    {
+        SSD1306_GFX_FillRect(x + w - t, y + t, t, upper, segments & SSD1306_SEG_B ? SSD1306_WHITE : SSD1306_BLACK);
+    }
+    if (changed & SSD1306_SEG_C)
+    {
+        SSD1306_GFX_FillRect(x + w - t, y + mid + t, t, lower, segments & SSD1306_SEG_C ? SSD1306_WHITE : SSD1306_BLACK);
+    }
+    if (changed & SSD1306_SEG_D)
+    {
+        SSD1306_GFX_FillRect(x + t, y + numeric->digit_h - t, w - 2 * t, t, segments & SSD1306_SEG_D ? SSD1306_WHITE : SSD1306_BLACK);
+    }
+    if (changed & SSD1306_SEG_E)
+    {
+        SSD1306_GFX_FillRect(x, y + mid + t, t, lower, segments & SSD1306_SEG_E ? SSD1306_WHITE : SSD1306_BLACK);
+    }
+    if (changed & SSD1306_SEG_F)
+    {
+        SSD1306_GFX_FillRect(x, y + t, t, upper, segments & SSD1306_SEG_F ? SSD1306_WHITE : SSD1306_BLACK);
+    }
+    if (changed & SSD1306_SEG_G)
+    {
+        SSD1306_GFX_FillRect(x + t, y + mid, w - 2 * t, t, segments & SSD1306_SEG_G ? SSD1306_WHITE : SSD1306_BLACK);
+    }
+    numeric->segments[digit] = segments;
+}
+
+void SSD1306_Numeric_Set(SSD1306_Numeric *numeric, int32_t value)
+{
+    uint8_t segments[SSD1306_WIDGET_DIGITS];
+    uint32_t magnitude = value < 0 ? 0UL - (uint32_t)value : (uint32_t)value;
+    int8_t i = numeric->digits - 1;
+    uint8_t fits = 1;
+
+    // Digits from the right, then the sign, then blanks
+    do
+    {
+        if (i < 0)
+        {
+            fits = 0;
+            break;
+        }
+        segments[i--] = widget_digits[magnitude % 10];
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0)
+    {
+        if (i < 0)
+        {
+            fits = 0;
+        }
+        else
+        {
+            segments[i--] = SSD1306_SEG_G;
+        }
+    }
+    for (; i >= 0; i--)
+    {
+        segments[i] = 0;
+    }
+    for (i = 0; i < numeric->digits; i++)
+    {
+        if (!fits)
+        {
+            segments[i] = SSD1306_SEG_G;
+        }
+    }
+    for (i = 0; i < numeric->digits; i++)
+    {
+        SSD1306_Numeric_SetSegments(numeric, i, segments[i]);
+    }
+}
+
+/**
+*   \brief Get a pixel of a page-major image.
+*
+*   \return 1 if the pixel is set, 0 otherwise or if image is NULL.
+*/
+static uint8_t SSD1306_Icon_Bit(const uint8_t *image, uint8_t width, uint8_t x, uint8_t y)
+{
+    return (image != NULL) && ((image[x + (y / 8) * width] >> (y & 7)) & 0x01);
+}
+
+void SSD1306_Icon_Init(SSD1306_Icon *icon, const uint8_t *on, const uint8_t *off,
+                        int16_t x, int16_t y, uint8_t width, uint8_t height,
+                        uint8_t state)
+{
+    uint8_t i, j;
+
+    icon->on = on;
+    icon->off = off;
+    icon->x = x;
+    icon->y = y;
+    icon->width = width;
+    icon->height = height;
+    icon->state = state ? 1 : 0;
+    for (i = 0; i < width; i++)
+    {
+        for (j = 0; j < height; j++)
+        {
+            SSD1306_DrawPixel(x + i, y + j,
+                                SSD1306_Icon_Bit(state ? on : off, width, i, j) ?
+                                SSD1306_WHITE : SSD1306_BLACK);
+        }
+    }
+}
+
+void SSD1306_Icon_Set(SSD1306_Icon *icon, uint8_t state)
+{
+    const uint8_t *image;
+    uint8_t i, j;
+
+    state = state ? 1 : 0;
+    if (state == icon->state)
+    {
+        return;
+    }
+    image = state ? icon->on : icon->off;
+    for (i = 0; i < icon->width; i++)
+    {
+        for (j = 0; j < icon->height; j++)
+        {
+            uint8_t bit = SSD1306_Icon_Bit(icon->on, icon->width, i, j);
+            if (bit != SSD1306_Icon_Bit(icon->off, icon->width, i, j))
+            {
+                SSD1306_DrawPixel(icon->x + i, icon->y + j,
+                                    SSD1306_Icon_Bit(image, icon->width, i, j) ?
+                                    SSD1306_WHITE : SSD1306_BLACK);
+            }
+        }
+    }
+    icon->state = state;
+}
+
+/* [] END OF FILE */
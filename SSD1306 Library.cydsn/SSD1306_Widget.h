@@ -0,0 +1,219 @@
+/**
+ *   \file SSD1306_Widget.h
+ *
+ *   \brief Bar graph, arc gauge, numeric readout and icon widgets.
+ *
+ *   Each widget remembers what it last rendered. Setting a new value only
+ *   redraws the part that changed (the span between the old and the new
+ *   length of a bar, the arc between the old and the new angle of a gauge,
+ *   the segments that changed in a numeric readout) with the GFX
+ *   primitives, which mark just that area dirty. Setting the same value
+ *   again draws nothing, so a dashboard can update all its widgets every
+ *   cycle and #SSD1306_DisplayDirty only sends what actually changed.
+ *
+ *   Coordinates are in drawing space, as for the GFX primitives. The
+ *   widget area must not be drawn over by other code.
+ *
+ *   \section author Author
+ *
+ *      Written by Davide Marzorati.
+ *
+ *  \section license License
+ *
+ *  BSD license, all text above must be included in any redistribution.
+ */
+
+#ifndef __SSD1306_WIDGET_H__
+    #define __SSD1306_WIDGET_H__
+
+    #include "cytypes.h"
+
+    #ifndef SSD1306_WIDGET_DIGITS
+        /**
+        *   \brief Maximum number of digits of a numeric readout.
+        */
+        #define SSD1306_WIDGET_DIGITS 8
+    #endif
+
+    /**
+    *   \brief Bar grows to the right.
+    */
+    #define SSD1306_WIDGET_BAR_RIGHT 0
+
+    /**
+    *   \brief Bar grows upwards.
+    */
+    #define SSD1306_WIDGET_BAR_UP 1
+
+    /**
+    *   \brief State of a bar graph.
+    */
+    typedef struct {
+        int16_t x;          ///< Left column of the frame
+        int16_t y;          ///< Top row of the frame
+        int16_t w;          ///< Width of the frame
+        int16_t h;          ///< Height of the frame
+        int16_t min;        ///< Value of an empty bar
+        int16_t max;        ///< Value of a full bar
+        uint8_t direction;  ///< Growing direction
+        int16_t length;     ///< Rendered length in pixels
+    } SSD1306_Bar;
+
+    /**
+    *   \brief State of an arc gauge.
+    *
+    *   Angles are in degrees, 0 pointing right and growing clockwise.
+    */
+    typedef struct {
+        int16_t cx;         ///< Column of the center
+        int16_t cy;         ///< Row of the center
+        uint8_t radius;     ///< Outer radius
+        uint8_t thickness;  ///< Thickness of the arc, radius for a pie
+        int16_t start;      ///< Angle of the minimum value
+        int16_t sweep;      ///< Angle between minimum and maximum value, 1 to 360
+        int16_t min;        ///< Minimum value
+        int16_t max;        ///< Maximum value
+        int16_t angle;      ///< Rendered angle from the start
+    } SSD1306_Gauge;
+
+    /**
+    *   \brief State of a seven-segment numeric readout.
+    */
+    typedef struct {
+        int16_t x;                                  ///< Left column of the first digit
+        int16_t y;                                  ///< Top row of the digits
+        uint8_t digit_w;                            ///< Width of a digit
+        uint8_t digit_h;                            ///< Height of a digit
+        uint8_t thickness;                          ///< Thickness of a segment
+        uint8_t spacing;                            ///< Gap between digits
+        uint8_t digits;                             ///< Number of digits
+        uint8_t segments[SSD1306_WIDGET_DIGITS];    ///< Rendered segments of each digit
+    } SSD1306_Numeric;
+
+    /**
+    *   \brief State of a two-state icon.
+    */
+    typedef struct {
+        const uint8_t *on;  ///< Page-major image of the on state
+        const uint8_t *off; ///< Page-major image of the off state, NULL for blank
+        int16_t x;          ///< Left column
+        int16_t y;          ///< Top row
+        uint8_t width;      ///< Width of the images
+        uint8_t height;     ///< Height of the images
+        uint8_t state;      ///< Rendered state
+    } SSD1306_Icon;
+
+    /**
+    *   \brief Draw the frame of an empty bar graph.
+    *
+    *   \param bar bar state.
+    *   \param x left column of the frame.
+    *   \param y top row of the frame.
+    *   \param w width of the frame.
+    *   \param h height of the frame.
+    *   \param min value of an empty bar.
+    *   \param max value of a full bar, greater than min.
+    *   \param direction #SSD1306_WIDGET_BAR_RIGHT or #SSD1306_WIDGET_BAR_UP.
+    */
+    void SSD1306_Bar_Init(SSD1306_Bar *bar, int16_t x, int16_t y, int16_t w, int16_t h,
+                            int16_t min, int16_t max, uint8_t direction);
+
+    /**
+    *   \brief Set the value of a bar graph.
+    *
+    *   \param bar bar state.
+    *   \param value new value, clamped to the range of the bar.
+    */
+    void SSD1306_Bar_Set(SSD1306_Bar *bar, int16_t value);
+
+    /**
+    *   \brief Clear the area of an empty arc gauge.
+    *
+    *   \param gauge gauge state.
+    *   \param cx column of the center.
+    *   \param cy row of the center.
+    *   \param radius outer radius.
+    *   \param thickness thickness of the arc, radius for a pie.
+    *   \param start angle of the minimum value.
+    *   \param sweep angle between minimum and maximum value, 1 to 360.
+    *   \param min minimum value.
+    *   \param max maximum value, greater than min.
+    */
+    void SSD1306_Gauge_Init(SSD1306_Gauge *gauge, int16_t cx, int16_t cy,
+                                uint8_t radius, uint8_t thickness, int16_t start,
+                                int16_t sweep, int16_t min, int16_t max);
+
+    /**
+    *   \brief Set the value of an arc gauge.
+    *
+    *   \param gauge gauge state.
+    *   \param value new value, clamped to the range of the gauge.
+    */
+    void SSD1306_Gauge_Set(SSD1306_Gauge *gauge, int16_t value);
+
+    /**
+    *   \brief Clear the area of a blank numeric readout.
+    *
+    *   \param numeric readout state.
+    *   \param x left column of the first digit.
+    *   \param y top row of the digits.
+    *   \param digits number of digits, at most #SSD1306_WIDGET_DIGITS.
+    *   \param digit_w width of a digit.
+    *   \param digit_h height of a digit.
+    *   \param thickness thickness of a segment.
+    *   \param spacing gap between digits.
+    */
+    void SSD1306_Numeric_Init(SSD1306_Numeric *numeric, int16_t x, int16_t y,
+                                uint8_t digits, uint8_t digit_w, uint8_t digit_h,
+                                uint8_t thickness, uint8_t spacing);
+
+    /**
+    *   \brief Show a number, right aligned.
+    *
+    *   Numbers that do not fit are shown as a row of dashes.
+    *
+    *   \param numeric readout state.
+    *   \param value number to show.
+    */
+    void SSD1306_Numeric_Set(SSD1306_Numeric *numeric, int32_t value);
+
+    /**
+    *   \brief Set the segments of one digit.
+    *
+    *   Bits 0 to 6 are segments a to g.
+    *
+    *   \param numeric readout state.
+    *   \param digit index of the digit, 0 being the leftmost.
+    *   \param segments segments to light.
+    */
+    void SSD1306_Numeric_SetSegments(SSD1306_Numeric *numeric, uint8_t digit, uint8_t segments);
+
+    /**
+    *   \brief Draw an icon.
+    *
+    *   \param icon icon state.
+    *   \param on page-major image of the on state.
+    *   \param off page-major image of the off state, NULL for blank.
+    *   \param x left column.
+    *   \param y top row.
+    *   \param width width of the images.
+    *   \param height height of the images.
+    *   \param state initial state.
+    */
+    void SSD1306_Icon_Init(SSD1306_Icon *icon, const uint8_t *on, const uint8_t *off,
+                            int16_t x, int16_t y, uint8_t width, uint8_t height,
+                            uint8_t state);
+
+    /**
+    *   \brief Set the state of an icon.
+    *
+    *   Only the pixels that differ between the two images are drawn.
+    *
+    *   \param icon icon state.
+    *   \param state 0 for off, on otherwise.
+    */
+    void SSD1306_Icon_Set(SSD1306_Icon *icon, uint8_t state);
+
+#endif
+
+/* [] END OF FILE */
@@ -14,7 +14,9 @@
 #include "SSD1306.h"
 #include "SSD1306_GFX.h"
 
+#if !SSD1306_NO_FRAMEBUFFER
 void testdrawline();
+#endif
 
 int main(void)
 {
@@ -23,9 +25,18 @@ int main(void)
     
     CyGlobalIntEnable; /* Enable global interrupts. */
     
-    CyDelay(100);
-    
-    SSD1306_Start();
+    // Start as soon as the display acknowledges its address
+    uint8_t attempts;
+    for (attempts = 0; attempts < 100; attempts++)
+    {
+        if (SSD1306_Start() == SSD1306_NO_ERROR)
+        {
+            break;
+        }
+        CyDelay(1);
+    }
+#if !SSD1306_NO_FRAMEBUFFER
+    // The line demo needs the display buffer
     SSD1306_Display();
     CyDelay(1000);
     
@@ -34,6 +45,7 @@ int main(void)
     CyDelay(1000);
     
     testdrawline();
+#endif
     
     SSD1306_StartScrollLeft(0x00, 0x0F);
     
@@ -43,6 +55,7 @@ int main(void)
     }
 }
 
+#if !SSD1306_NO_FRAMEBUFFER
 void testdrawline() {
     int16_t i;
 
@@ -113,4 +126,5 @@ void testdrawline() {
 
     CyDelay(2000); // Pause for 2 seconds
 }
+#endif
 /* [] END OF FILE */
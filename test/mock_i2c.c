@@ -0,0 +1,231 @@
+/*
+ * Mock of the I2C_Master component for the host tests.
+ */
+
+#include "mock_i2c.h"
+#include "I2C_Master.h"
+#include "SSD1306.h"
+#include <stdlib.h>
+
+#define MOCK_BYTE_NS 22500      // 9 clocks at 400 kHz
+#define MOCK_POLL_NS 1000       // CPU time of a status poll
+
+// Displays at both addresses of an SSD1306: SA0 low and SA0 high
+static SSD1306_Emu emu[2];
+static uint32_t fault_rate;
+static uint32_t faults;
+static uint32_t bytes;
+static uint64_t now;
+
+// Transaction in progress, byte by byte
+static int started;
+static SSD1306_Emu *device;
+static int has_control;
+static uint8_t control;
+
+// Interrupt driven transfer started by I2C_Master_MasterWriteBuf
+static uint8_t status;
+static uint64_t busy_until;
+
+// Decide if the next byte fails, and if a failing byte still reached the slave
+static int Mock_Fault(int *delivered)
+{
+    if ((fault_rate == 0) || ((uint32_t)(rand() % 1000000) >= fault_rate))
+    {
+        *delivered = 1;
+        return 0;
+    }
+    faults++;
+    *delivered = rand() & 1;
+    return 1;
+}
+
+static void Mock_Deliver(uint8_t b)
+{
+    if (device == NULL)
+    {
+        return;
+    }
+    if (!has_control)
+    {
+        control = b;
+        has_control = 1;
+    }
+    else
+    {
+        SSD1306_Emu_Write(device, control, &b, 1);
+    }
+}
+
+void Mock_I2C_Reset(void)
+{
+    SSD1306_Emu_Init(&emu[0]);
+    SSD1306_Emu_Init(&emu[1]);
+    fault_rate = 0;
+    faults = 0;
+    bytes = 0;
+    now = 0;
+    started = 0;
+    status = 0;
+    busy_until = 0;
+}
+
+SSD1306_Emu *Mock_I2C_Emu(void)
+{
+    return Mock_I2C_EmuAt(SSD1306_I2C_ADDR);
+}
+
+SSD1306_Emu *Mock_I2C_EmuAt(uint8_t address)
+{
+    if ((address & ~1) != (SSD1306_I2C_ADDR & ~1))
+    {
+        return NULL;
+    }
+    return &emu[address & 1];
+}
+
+void Mock_I2C_SetFaults(uint32_t per_million)
+{
+    fault_rate = per_million;
+}
+
+uint32_t Mock_I2C_GetFaults(void)
+{
+    return faults;
+}
+
+uint32_t Mock_I2C_GetBytes(void)
+{
+    return bytes;
+}
+
+uint64_t Mock_I2C_GetTime(void)
+{
+    return now;
+}
+
+void Mock_I2C_Advance(uint64_t ns)
+{
+    now += ns;
+}
+
+uint32_t Mock_I2C_Clock(void)
+{
+    now += MOCK_POLL_NS;
+    return (uint32_t)(now / 1000);
+}
+
+void I2C_Master_Start(void)
+{
+    started = 0;
+}
+
+void I2C_Master_Stop(void)
+{
+    started = 0;
+    status = 0;
+    busy_until = now;
+}
+
+uint8 I2C_Master_MasterSendStart(uint8 slaveAddress, uint8 R_nW)
+{
+    int delivered;
+
+    bytes++;
+    now += MOCK_BYTE_NS;
+    if (Mock_Fault(&delivered))
+    {
+        started = 0;
+        return I2C_Master_MSTR_ERR_LB_NAK;
+    }
+    started = 1;
+    device = (R_nW == I2C_Master_WRITE_XFER_MODE) ? Mock_I2C_EmuAt(slaveAddress) : NULL;
+    has_control = 0;
+    return I2C_Master_MSTR_NO_ERROR;
+}
+
+uint8 I2C_Master_MasterSendRestart(uint8 slaveAddress, uint8 R_nW)
+{
+    return I2C_Master_MasterSendStart(slaveAddress, R_nW);
+}
+
+uint8 I2C_Master_MasterSendStop(void)
+{
+    started = 0;
+    return I2C_Master_MSTR_NO_ERROR;
+}
+
+uint8 I2C_Master_MasterWriteByte(uint8 theByte)
+{
+    int delivered;
+    int fault;
+
+    if (!started)
+    {
+        return I2C_Master_MSTR_NOT_READY;
+    }
+    bytes++;
+    now += MOCK_BYTE_NS;
+    fault = Mock_Fault(&delivered);
+    if (delivered)
+    {
+        Mock_Deliver(theByte);
+    }
+    return fault ? I2C_Master_MSTR_ERR_LB_NAK : I2C_Master_MSTR_NO_ERROR;
+}
+
+uint8 I2C_Master_MasterReadByte(uint8 acknNak)
+{
+    (void)acknNak;
+    bytes++;
+    now += MOCK_BYTE_NS;
+    return 0;
+}
+
+uint8 I2C_Master_MasterWriteBuf(uint8 slaveAddress, uint8 *wrData, uint8 cnt, uint8 mode)
+{
+    uint8_t i;
+
+    (void)mode;
+    if (I2C_Master_MasterSendStart(slaveAddress, I2C_Master_WRITE_XFER_MODE) != I2C_Master_MSTR_NO_ERROR)
+    {
+        status = I2C_Master_MSTAT_WR_CMPLT | I2C_Master_MSTAT_ERR_XFER | I2C_Master_MSTAT_ERR_ADDR_NAK;
+        busy_until = now;
+        return I2C_Master_MSTR_NO_ERROR;
+    }
+    // The interrupt sends the whole buffer in the background
+    status = I2C_Master_MSTAT_WR_CMPLT;
+    for (i = 0; i < cnt; i++)
+    {
+        if (I2C_Master_MasterWriteByte(wrData[i]) != I2C_Master_MSTR_NO_ERROR)
+        {
+            status |= I2C_Master_MSTAT_ERR_XFER;
+            break;
+        }
+    }
+    started = 0;
+    busy_until = now;
+    now -= (uint64_t)i * MOCK_BYTE_NS;
+    return I2C_Master_MSTR_NO_ERROR;
+}
+
+uint8 I2C_Master_MasterStatus(void)
+{
+    now += MOCK_POLL_NS;
+    if (now < busy_until)
+    {
+        return I2C_Master_MSTAT_XFER_INP;
+    }
+    return status;
+}
+
+uint8 I2C_Master_MasterClearStatus(void)
+{
+    uint8 s = (now < busy_until) ? I2C_Master_MSTAT_XFER_INP : status;
+
+    if (now >= busy_until)
+    {
+        status = 0;
+    }
+    return s;
+}
@@ -0,0 +1,65 @@
+/*
+ * Mock of the I2C_Master component for the host tests.
+ *
+ * Write transactions addressed to a display are fed to an SSD1306
+ * controller emulator, byte by byte, so that tests can compare its
+ * GDDRAM with the display buffer. Bus time is simulated at 400 kHz.
+ * Faults can be injected on any byte: the byte may or may not reach the
+ * controller, as on a real bus, and the transaction is aborted.
+ */
+
+#ifndef MOCK_I2C_H
+#define MOCK_I2C_H
+
+#include "cytypes.h"
+#include "SSD1306_Emu.h"
+
+/**
+ * Reset the emulator, the bus time and the counters, and disable faults.
+ */
+void Mock_I2C_Reset(void);
+
+/**
+ * Get the emulated controller at #SSD1306_I2C_ADDR.
+ */
+SSD1306_Emu *Mock_I2C_Emu(void);
+
+/**
+ * Get the emulated controller at an address. Controllers answer at both
+ * addresses of an SSD1306 (SA0 low and high); NULL for other addresses,
+ * whose writes are acknowledged and dropped.
+ */
+SSD1306_Emu *Mock_I2C_EmuAt(uint8_t address);
+
+/**
+ * Inject faults on bytes with the given probability, in parts per million.
+ * Control bytes and data bytes are affected alike. 0 disables faults.
+ */
+void Mock_I2C_SetFaults(uint32_t per_million);
+
+/**
+ * Get the number of faults injected since the last reset.
+ */
+uint32_t Mock_I2C_GetFaults(void);
+
+/**
+ * Get the number of bytes sent on the bus since the last reset, addresses included.
+ */
+uint32_t Mock_I2C_GetBytes(void);
+
+/**
+ * Get the simulated bus time, in nanoseconds.
+ */
+uint64_t Mock_I2C_GetTime(void);
+
+/**
+ * Let simulated time pass, e.g. while the CPU does other work.
+ */
+void Mock_I2C_Advance(uint64_t ns);
+
+/**
+ * Free-running microsecond clock for I2C_Peripheral_SetTimeout.
+ */
+uint32_t Mock_I2C_Clock(void);
+
+#endif
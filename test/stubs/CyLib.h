@@ -0,0 +1,28 @@
+/*
+ * Host stand-in for the critical sections of the PSoC Creator CyLib.h.
+ *
+ * On a single core, disabling interrupts keeps every other context out
+ * of the critical section: a global lock does the same for host threads.
+ */
+
+#ifndef CYLIB_H
+#define CYLIB_H
+
+#include <pthread.h>
+#include "cytypes.h"
+
+static pthread_mutex_t cy_critical_section = PTHREAD_MUTEX_INITIALIZER;
+
+static inline uint8 CyEnterCriticalSection(void)
+{
+    pthread_mutex_lock(&cy_critical_section);
+    return 0;
+}
+
+static inline void CyExitCriticalSection(uint8 savedIntrStatus)
+{
+    (void)savedIntrStatus;
+    pthread_mutex_unlock(&cy_critical_section);
+}
+
+#endif
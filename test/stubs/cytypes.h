@@ -0,0 +1,20 @@
+/*
+ * Host stand-in for the PSoC Creator cytypes.h, enough to build the
+ * library for the tests.
+ */
+
+#ifndef CYTYPES_H
+#define CYTYPES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef volatile uint8_t reg8;
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * Canvas composition against a byte by byte reference.
+ *
+ * A stack of layers of every operation, one with a mask canvas, is drawn
+ * frame after frame with random shapes, rotations and clips, and layers
+ * are hidden and shown. Drawing into a canvas must leave the display
+ * buffer alone and mark every byte it changes in the dirty map of the
+ * canvas. The composition must equal the whole stack recomputed from
+ * scratch, recompose exactly the pages with dirty columns, and clear
+ * the dirty maps. Each frame is sent with SSD1306_DisplayDirty: the
+ * controller must follow the buffer, and a composition that changes no
+ * byte of the buffer must send nothing.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Canvas.h"
+#include "SSD1306_GFX.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAMES  3000
+#define LAYERS  5
+
+static uint32_t storage[LAYERS + 1][SSD1306_CANVAS_WORDS];
+static SSD1306_Canvas canvases[LAYERS + 1];
+static SSD1306_Canvas *layers[LAYERS];
+static uint8_t before[SSD1306_BUFFER_SIZE];
+static uint8_t frame[SSD1306_BUFFER_SIZE];
+static uint8_t expected[SSD1306_BUFFER_SIZE];
+
+/*
+ * Composite the visible layers, bottom first, starting from a blank page.
+ */
+static void Reference(void)
+{
+    int i, b;
+
+    memset(expected, 0, sizeof(expected));
+    for (i = 0; i < LAYERS; i++)
+    {
+        const SSD1306_Canvas *layer = layers[i];
+        const uint8_t *pixels = (const uint8_t *)layer->pixels;
+        const uint8_t *mask = (const uint8_t *)canvases[LAYERS].pixels;
+
+        if (!layer->visible)
+        {
+            continue;
+        }
+        for (b = 0; b < SSD1306_BUFFER_SIZE; b++)
+        {
+            switch (layer->op)
+            {
+                case SSD1306_CANVAS_COPY:
+                    expected[b] = pixels[b];
+                    break;
+                case SSD1306_CANVAS_OR:
+                    expected[b] |= pixels[b];
+                    break;
+                case SSD1306_CANVAS_AND:
+                    expected[b] &= pixels[b];
+                    break;
+                case SSD1306_CANVAS_XOR:
+                    expected[b] ^= pixels[b];
+                    break;
+                case SSD1306_CANVAS_MASK:
+                    expected[b] = (expected[b] & ~mask[b]) | (pixels[b] & mask[b]);
+                    break;
+            }
+        }
+    }
+}
+
+static int Dirty(const SSD1306_Canvas *canvas, int page)
+{
+    return canvas->dirty_first[page] <= canvas->dirty_last[page];
+}
+
+/*
+ * Draw random shapes into a canvas and check its dirty map. Returns the
+ * number of changed bytes outside the dirty columns.
+ */
+static int Draw(SSD1306_Canvas *canvas)
+{
+    const uint8_t *pixels = (const uint8_t *)canvas->pixels;
+    uint16_t colors[3] = { SSD1306_WHITE, SSD1306_BLACK, SSD1306_INVERSE };
+    int untracked = 0, k, b;
+
+    memcpy(before, pixels, sizeof(before));
+    SSD1306_Canvas_Begin(canvas);
+    SSD1306_SetRotation(rand() % 4);
+    if (rand() % 3 == 0)
+    {
+        SSD1306_PushClip(rand() % 60, rand() % 30, 10 + rand() % 80, 4 + rand() % 40);
+    }
+    for (k = rand() % 3; k >= 0; k--)
+    {
+        switch (rand() % 3)
+        {
+            case 0:
+                SSD1306_GFX_FillRect(rand() % 140 - 6, rand() % 140 - 6, 1 + rand() % 40,
+                                        1 + rand() % 20, colors[rand() % 3]);
+                break;
+            case 1:
+                SSD1306_GFX_FillCircle(rand() % 128, rand() % 128, rand() % 16,
+                                        colors[rand() % 3]);
+                break;
+            case 2:
+                SSD1306_GFX_DrawLine(rand() % 128, rand() % 128, rand() % 128, rand() % 128,
+                                        colors[rand() % 3]);
+                break;
+        }
+    }
+    SSD1306_ResetClip();
+    SSD1306_SetRotation(0);
+    SSD1306_Canvas_End();
+
+    for (b = 0; b < SSD1306_BUFFER_SIZE; b++)
+    {
+        int x = b % SSD1306_WIDTH, page = b / SSD1306_WIDTH;
+        untracked += (pixels[b] != before[b]) &&
+                        ((x < canvas->dirty_first[page]) || (x > canvas->dirty_last[page]));
+    }
+    return untracked;
+}
+
+int main(void)
+{
+    int wrong = 0, idle = 0, n, i, page;
+
+    Mock_I2C_Reset();
+    I2C_Peripheral_Start();
+    wrong |= SSD1306_Start() != SSD1306_NO_ERROR;
+    SSD1306_SetRotation(0);
+    SSD1306_ResetClip();
+
+    SSD1306_Canvas_Init(&canvases[0], storage[0], SSD1306_CANVAS_COPY);
+    SSD1306_Canvas_Init(&canvases[1], storage[1], SSD1306_CANVAS_OR);
+    SSD1306_Canvas_Init(&canvases[2], storage[2], SSD1306_CANVAS_MASK);
+    SSD1306_Canvas_Init(&canvases[3], storage[3], SSD1306_CANVAS_XOR);
+    SSD1306_Canvas_Init(&canvases[4], storage[4], SSD1306_CANVAS_AND);
+    SSD1306_Canvas_Init(&canvases[LAYERS], storage[LAYERS], SSD1306_CANVAS_COPY);
+    SSD1306_Canvas_SetMask(&canvases[2], &canvases[LAYERS]);
+    for (i = 0; i < LAYERS; i++)
+    {
+        layers[i] = &canvases[i];
+    }
+    // The AND layer starts set, so that it does not clear everything below
+    memset(storage[4], 0xFF, sizeof(storage[4]));
+
+    srand(3);
+    for (n = 0; n < FRAMES; n++)
+    {
+        uint32_t sent;
+        uint8_t composed, pages = 0;
+        int untracked = 0;
+
+        memcpy(frame, SSD1306_GetBuffer(), sizeof(frame));
+        switch (rand() % 6)
+        {
+            case 0:
+                // Nothing changed
+                break;
+            case 1:
+                i = rand() % LAYERS;
+                SSD1306_Canvas_SetVisible(layers[i], !layers[i]->visible);
+                break;
+            case 2:
+                untracked += Draw(&canvases[LAYERS]);
+                break;
+            default:
+                untracked += Draw(layers[rand() % LAYERS]);
+                break;
+        }
+        if (untracked != 0)
+        {
+            printf("frame %d: %d bytes drawn outside the dirty columns\n", n, untracked);
+            wrong = 1;
+        }
+        if (memcmp(frame, SSD1306_GetBuffer(), sizeof(frame)) != 0)
+        {
+            printf("frame %d: drawing into a canvas changed the display buffer\n", n);
+            wrong = 1;
+        }
+
+        // Pages with dirty columns in a layer or in the mask of a mask layer
+        for (page = 0; page < SSD1306_PAGES; page++)
+        {
+            int dirty = Dirty(&canvases[LAYERS], page);
+            for (i = 0; i < LAYERS; i++)
+            {
+                dirty |= Dirty(layers[i], page);
+            }
+            pages += dirty;
+        }
+
+        composed = SSD1306_Canvas_Compose(layers, LAYERS);
+        Reference();
+        if (memcmp(SSD1306_GetBuffer(), expected, sizeof(expected)) != 0)
+        {
+            printf("frame %d: composition differs from the reference\n", n);
+            wrong = 1;
+        }
+        if (composed != pages)
+        {
+            printf("frame %d: %u pages composed, %u dirty\n", n, composed, pages);
+            wrong = 1;
+        }
+        for (page = 0; page < SSD1306_PAGES; page++)
+        {
+            for (i = 0; i <= LAYERS; i++)
+            {
+                if (Dirty(&canvases[i], page))
+                {
+                    printf("frame %d: canvas %d still dirty after the composition\n", n, i);
+                    wrong = 1;
+                }
+            }
+        }
+
+        sent = Mock_I2C_Emu()->data_bytes;
+        wrong |= SSD1306_DisplayDirty() != SSD1306_NO_ERROR;
+        sent = Mock_I2C_Emu()->data_bytes - sent;
+        if (SSD1306_Emu_Compare(Mock_I2C_Emu(), SSD1306_GetBuffer(), SSD1306_WIDTH,
+                                SSD1306_PAGES) != 0)
+        {
+            printf("frame %d: controller differs from the buffer\n", n);
+            wrong = 1;
+        }
+        if (memcmp(frame, SSD1306_GetBuffer(), sizeof(frame)) == 0)
+        {
+            idle++;
+            if (sent != 0)
+            {
+                printf("frame %d: %u bytes sent for an unchanged buffer\n", n, sent);
+                wrong = 1;
+            }
+        }
+    }
+    printf("%d frames, %d unchanged, %u bytes of data sent\n", FRAMES, idle,
+            Mock_I2C_Emu()->data_bytes);
+    printf(wrong ? "FAIL\n" : "OK\n");
+    return wrong;
+}
@@ -0,0 +1,265 @@
+/*
+ * Strip charts on the controller emulator.
+ *
+ * A scrolling chart and a sweeping chart share the display with a random
+ * background, in random bands. Samples, some out of range, are pushed
+ * alternately and the range is changed from time to time. The buffer is
+ * checked against a model of the band columns: the scrolling chart
+ * moves them left, the sweeping one writes the sample at a cursor
+ * followed by a blank column. Each push sends one column (two for a
+ * sweep), so the controller matches the buffer only if the emulated
+ * content scroll (0x2C/0x2D) moved the band as the buffer was moved.
+ * Pushes on a lossy bus must leave the buffer right, and a refresh of
+ * the dirty areas must bring the controller back in sync.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Chart.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCENES      200
+#define PUSHES      400
+
+typedef struct {
+    SSD1306_Chart chart;
+    int16_t samples[SSD1306_WIDTH];
+    int16_t history[PUSHES];        // Every sample pushed, oldest first
+    int count;                      // Number of samples pushed
+    int16_t rows[SSD1306_WIDTH];    // Model: row of the sample of each column, -1 if blank
+    int16_t prevs[SSD1306_WIDTH];   // Model: row of the previous sample, -1 for a point
+} Strip;
+
+static Strip strips[2];
+static uint8_t expected[SSD1306_BUFFER_SIZE];
+
+/*
+ * Row of a sample in the band, 0 being the top row.
+ */
+static int16_t Row(const SSD1306_Chart *chart, int16_t sample)
+{
+    int rows = (chart->page_end - chart->page_start + 1) * 8;
+    int span = chart->max - chart->min;
+
+    if (sample <= chart->min)
+    {
+        return rows - 1;
+    }
+    if (sample >= chart->max)
+    {
+        return 0;
+    }
+    return rows - 1 - ((sample - chart->min) * (rows - 1) + span / 2) / span;
+}
+
+/*
+ * Row of the sample pushed age samples ago, -1 if it is not stored.
+ */
+static int16_t RowAt(const Strip *strip, int age)
+{
+    if ((age >= strip->count) || (age >= strip->chart.width))
+    {
+        return -1;
+    }
+    return Row(&strip->chart, strip->history[strip->count - 1 - age]);
+}
+
+/*
+ * Model of the whole band, as drawn from the stored samples.
+ */
+static void Redraw(Strip *strip)
+{
+    int width = strip->chart.width, col, age;
+    int head = strip->count % width;
+
+    for (col = 0; col < width; col++)
+    {
+        if (strip->chart.mode == SSD1306_CHART_SCROLL)
+        {
+            age = width - 1 - col;
+            strip->prevs[col] = RowAt(strip, age + 1);
+        }
+        else
+        {
+            age = (head + width - 1 - col) % width;
+            strip->prevs[col] = (col == (head + 1) % width) ? -1 : RowAt(strip, age + 1);
+        }
+        strip->rows[col] = ((strip->chart.mode == SSD1306_CHART_SWEEP) && (col == head)) ?
+                            -1 : RowAt(strip, age);
+    }
+}
+
+/*
+ * Model of a push: the band moves left and the sample is drawn in the
+ * last column, or the sample is drawn at the cursor and the next column
+ * is blanked.
+ */
+static void Push(Strip *strip, int16_t sample)
+{
+    int width = strip->chart.width;
+    int col = strip->count % width;
+
+    strip->history[strip->count++] = sample;
+    if (strip->chart.mode == SSD1306_CHART_SCROLL)
+    {
+        memmove(strip->rows, strip->rows + 1, (width - 1) * sizeof(strip->rows[0]));
+        memmove(strip->prevs, strip->prevs + 1, (width - 1) * sizeof(strip->prevs[0]));
+        col = width - 1;
+    }
+    strip->rows[col] = RowAt(strip, 0);
+    strip->prevs[col] = RowAt(strip, 1);
+    if (strip->chart.mode == SSD1306_CHART_SWEEP)
+    {
+        strip->rows[(col + 1) % width] = -1;
+    }
+}
+
+/*
+ * Render the model of a band into the expected buffer.
+ */
+static void Render(const Strip *strip)
+{
+    const SSD1306_Chart *chart = &strip->chart;
+    int col, y;
+
+    for (col = 0; col < chart->width; col++)
+    {
+        int16_t row = strip->rows[col], prev = strip->prevs[col];
+        int lo = ((prev >= 0) && (prev < row)) ? prev : row;
+        int hi = (prev > row) ? prev : row;
+
+        for (y = 0; y < (chart->page_end - chart->page_start + 1) * 8; y++)
+        {
+            uint8_t *byte = &expected[(chart->page_start + y / 8) * SSD1306_WIDTH +
+                                        chart->x + col];
+            if ((row >= 0) && (y >= lo) && (y <= hi))
+            {
+                *byte |= 1 << (y % 8);
+            }
+            else
+            {
+                *byte &= ~(1 << (y % 8));
+            }
+        }
+    }
+}
+
+static int Compare(int n, int k, const char *what)
+{
+    int wrong = 0;
+
+    Render(&strips[0]);
+    Render(&strips[1]);
+    if (memcmp(SSD1306_GetBuffer(), expected, sizeof(expected)) != 0)
+    {
+        printf("scene %d, push %d: buffer differs from the model after %s\n", n, k, what);
+        wrong = 1;
+    }
+    if (SSD1306_Emu_Compare(Mock_I2C_Emu(), SSD1306_GetBuffer(), SSD1306_WIDTH,
+                            SSD1306_PAGES) != 0)
+    {
+        printf("scene %d, push %d: controller differs from the buffer after %s\n", n, k, what);
+        wrong = 1;
+    }
+    return wrong;
+}
+
+static int16_t Sample(void)
+{
+    return rand() % 2400 - 1200;
+}
+
+int main(void)
+{
+    int wrong = 0, errors = 0, n, k, i;
+
+    Mock_I2C_Reset();
+    I2C_Peripheral_Start();
+    wrong |= SSD1306_Start() != SSD1306_NO_ERROR;
+    SSD1306_SetRotation(0);
+    SSD1306_ResetClip();
+
+    srand(7);
+    for (n = 0; n < SCENES; n++)
+    {
+        // Bands of whole pages, the scrolling chart above the sweeping one
+        int split = 1 + rand() % (SSD1306_PAGES - 1);
+        int lossy = (n % 4) == 3;
+
+        for (i = 0; i < SSD1306_BUFFER_SIZE; i++)
+        {
+            SSD1306_GetBuffer()[i] = rand();
+        }
+        wrong |= SSD1306_Display() != SSD1306_NO_ERROR;
+        for (i = 0; i < 2; i++)
+        {
+            Strip *strip = &strips[i];
+            int width = 2 + rand() % (SSD1306_WIDTH - 1);
+            int page_start = i ? split + rand() % (SSD1306_PAGES - split) : rand() % split;
+            int pages = 1 + rand() % ((i ? SSD1306_PAGES : split) - page_start);
+            int16_t min = rand() % 1000 - 700;
+
+            SSD1306_Chart_Init(&strip->chart, strip->samples,
+                                rand() % (SSD1306_WIDTH - width + 1), width, page_start, pages,
+                                min, min + 1 + rand() % 1000,
+                                i ? SSD1306_CHART_SWEEP : SSD1306_CHART_SCROLL);
+            strip->count = 0;
+            Redraw(strip);
+        }
+        memcpy(expected, SSD1306_GetBuffer(), sizeof(expected));
+        wrong |= SSD1306_DisplayDirty() != SSD1306_NO_ERROR;
+        wrong |= Compare(n, 0, "init");
+
+        Mock_I2C_SetFaults(lossy ? 20000 : 0);
+        for (k = 0; k < PUSHES; k++)
+        {
+            Strip *strip = &strips[k % 2];
+            int pages = strip->chart.page_end - strip->chart.page_start + 1;
+            uint32_t sent = Mock_I2C_Emu()->data_bytes;
+            int16_t sample = Sample();
+
+            if (rand() % 50 == 0)
+            {
+                int16_t min = rand() % 1000 - 700;
+                SSD1306_Chart_SetRange(&strip->chart, min, min + 1 + rand() % 1000);
+                Redraw(strip);
+                if (!lossy)
+                {
+                    wrong |= SSD1306_DisplayDirty() != SSD1306_NO_ERROR;
+                    wrong |= Compare(n, k, "a range change");
+                    sent = Mock_I2C_Emu()->data_bytes;
+                }
+            }
+
+            Push(strip, sample);
+            if (SSD1306_Chart_Push(&strip->chart, sample) != SSD1306_NO_ERROR)
+            {
+                errors++;
+                wrong |= !lossy;
+            }
+            if (lossy)
+            {
+                continue;
+            }
+            sent = Mock_I2C_Emu()->data_bytes - sent;
+            if (sent != (uint32_t)pages * (1 + strip->chart.mode))
+            {
+                printf("scene %d, push %d: %u data bytes sent for %d pages\n", n, k, sent, pages);
+                wrong = 1;
+            }
+            wrong |= Compare(n, k, "a push");
+        }
+
+        // The dirty areas left by failed pushes resynchronize the controller
+        Mock_I2C_SetFaults(0);
+        wrong |= SSD1306_DisplayDirty() != SSD1306_NO_ERROR;
+        wrong |= Compare(n, PUSHES, "the last refresh");
+    }
+    printf("%d scenes, %d failed pushes, %u commands, %u data bytes\n", SCENES, errors,
+            Mock_I2C_Emu()->commands, Mock_I2C_Emu()->data_bytes);
+    printf(wrong ? "FAIL\n" : "OK\n");
+    return wrong;
+}
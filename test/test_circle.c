@@ -0,0 +1,112 @@
+/*
+ * Circle outlines drawn in SSD1306_INVERSE against SSD1306_WHITE.
+ *
+ * On a blank display the two must light the same pixels: a pixel shared
+ * by two octants of a circle, or by an arc and a side of a rounded
+ * rectangle, must be inverted only once. Random circles and rounded
+ * rectangles, including degenerate sizes and radii, are drawn with every
+ * rotation, an offset origin and a clip rectangle, after the case that
+ * used to overdraw.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_GFX.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHAPES 20000
+
+static uint8_t white[SSD1306_BUFFER_SIZE];
+
+typedef struct {
+    uint8_t round_rect;
+    int16_t x, y, w, h, r;
+} Shape;
+
+static int Popcount(uint8_t b)
+{
+    int n = 0;
+
+    for (; b; b >>= 1)
+    {
+        n += b & 1;
+    }
+    return n;
+}
+
+static void Draw(const Shape *shape, uint16_t color)
+{
+    if (shape->round_rect)
+    {
+        SSD1306_GFX_DrawRoundRect(shape->x, shape->y, shape->w, shape->h, shape->r, color);
+    }
+    else
+    {
+        SSD1306_GFX_DrawCircle(shape->x, shape->y, shape->r, color);
+    }
+}
+
+/*
+ * Draw a shape in white and in inverse. Returns the number of pixels that
+ * differ.
+ */
+static int Compare(const Shape *shape)
+{
+    uint8_t *pixels = SSD1306_GetBuffer();
+    int diff = 0, i;
+
+    SSD1306_ClearDisplay();
+    Draw(shape, SSD1306_WHITE);
+    memcpy(white, pixels, sizeof(white));
+    SSD1306_ClearDisplay();
+    Draw(shape, SSD1306_INVERSE);
+    for (i = 0; i < SSD1306_BUFFER_SIZE; i++)
+    {
+        diff += Popcount(white[i] ^ pixels[i]);
+    }
+    return diff;
+}
+
+int main(void)
+{
+    static const Shape repro = { 0, 17, -9, 0, 0, 23 };
+    Shape shape;
+    int wrong = 0, diff, n;
+
+    SSD1306_SetRotation(3);
+    SSD1306_ResetClip();
+    diff = Compare(&repro);
+    printf("circle (17, -9) radius 23, rotation 3: %d pixels differ\n", diff);
+    wrong += (diff != 0);
+
+    srand(3);
+    for (n = 0; n < SHAPES; n++)
+    {
+        SSD1306_SetRotation(rand() % 4);
+        SSD1306_SetOrigin(rand() % 9 - 4, rand() % 9 - 4);
+        SSD1306_ResetClip();
+        if (rand() % 3 == 0)
+        {
+            SSD1306_PushClip(rand() % 40, rand() % 20, 20 + rand() % 100, 8 + rand() % 30);
+        }
+        shape.round_rect = rand() % 2;
+        shape.x = rand() % (SSD1306_GetWidth() + 40) - 20;
+        shape.y = rand() % (SSD1306_GetHeight() + 40) - 20;
+        // Mostly small shapes, where the octants and corners meet
+        shape.w = (rand() % 2) ? 1 + rand() % 8 : 1 + rand() % 60;
+        shape.h = (rand() % 2) ? 1 + rand() % 8 : 1 + rand() % 40;
+        shape.r = (rand() % 2) ? rand() % 4 : rand() % 40;
+        diff = Compare(&shape);
+        if (diff != 0)
+        {
+            printf("shape %d: %s (%d, %d) %dx%d radius %d, rotation %u: %d pixels differ\n",
+                    n, shape.round_rect ? "round rect" : "circle", shape.x, shape.y,
+                    shape.w, shape.h, shape.r, SSD1306_GetRotation(), diff);
+            wrong++;
+        }
+    }
+    printf("%d shapes, %d wrong\n", SHAPES + 1, wrong);
+    printf(wrong ? "FAIL\n" : "OK\n");
+    return wrong != 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Framebuffer-less build (SSD1306_NO_FRAMEBUFFER=1).
+ *
+ * Drawing functions must do nothing while no buffer is selected. A tile
+ * map flushed straight to the controller, also on a bus that loses
+ * bytes, must leave in the controller RAM the image SSD1306_Tile_Render
+ * gives, and drawing into a buffer selected with SSD1306_SetTarget must
+ * work as with the display buffer.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Blit.h"
+#include "SSD1306_Dither.h"
+#include "SSD1306_GFX.h"
+#include "SSD1306_Sprite.h"
+#include "SSD1306_Stroke.h"
+#include "SSD1306_Tile.h"
+#include "SSD1306_Widget.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !SSD1306_NO_FRAMEBUFFER
+    #error "test_direct must be built with SSD1306_NO_FRAMEBUFFER=1"
+#endif
+
+static uint8_t tileset[256 * 8];
+static uint8_t image[16 * 2];
+
+static void Draw(void)
+{
+    static const SSD1306_Point points[] = { {2, 2}, {60, 8}, {30, 30}, {90, 20} };
+    static const SSD1306_StrokeStyle style = { 5, SSD1306_STROKE_CAP_ROUND,
+                                                SSD1306_STROKE_JOIN_ROUND };
+    uint8_t save[16 * 3], row[40];
+    SSD1306_Sprite sprite;
+    SSD1306_Bar bar;
+    SSD1306_Gauge gauge;
+    SSD1306_Numeric numeric;
+    uint8_t i;
+
+    SSD1306_ClearDisplay();
+    SSD1306_DrawPixel(3, 4, SSD1306_WHITE);
+    SSD1306_DrawFastHLine(0, 10, 100, SSD1306_INVERSE);
+    SSD1306_DrawFastVLine(50, 0, 32, SSD1306_INVERSE);
+    SSD1306_GFX_DrawLine(0, 0, 127, 31, SSD1306_WHITE);
+    SSD1306_GFX_FillRect(70, 5, 20, 20, SSD1306_INVERSE);
+    SSD1306_GFX_DrawCircle(100, 16, 12, SSD1306_WHITE);
+    SSD1306_GFX_FillCircle(20, 20, 8, SSD1306_INVERSE);
+    SSD1306_GFX_FillTriangle(0, 31, 40, 0, 60, 31, SSD1306_INVERSE);
+    SSD1306_GFX_FillPolygon(points, 4, SSD1306_GFX_EVEN_ODD, SSD1306_INVERSE);
+    SSD1306_GFX_FloodFill(120, 2, SSD1306_INVERSE);
+    SSD1306_Stroke_Polyline(points, 4, 0, &style, SSD1306_INVERSE);
+    SSD1306_Blit_Draw(image, 16, 12, 30, 3, 2, SSD1306_BLIT_XOR);
+    SSD1306_Sprite_Init(&sprite, image, NULL, 16, 12, SSD1306_BLIT_OR, save);
+    SSD1306_Sprite_Move(&sprite, 100, 10);
+    SSD1306_Sprite_Move(&sprite, 104, 13);
+    SSD1306_Bar_Init(&bar, 2, 24, 60, 7, 0, 100, SSD1306_WIDGET_BAR_RIGHT);
+    SSD1306_Bar_Set(&bar, 40);
+    SSD1306_Gauge_Init(&gauge, 64, 31, 20, 4, 180, 180, 0, 100);
+    SSD1306_Gauge_Set(&gauge, 70);
+    SSD1306_Numeric_Init(&numeric, 90, 2, 3, 8, 14, 2, 2);
+    SSD1306_Numeric_Set(&numeric, 428);
+    SSD1306_Dither_Begin(10, 2, sizeof(row), SSD1306_DITHER_BAYER);
+    for (i = 0; i < 20; i++)
+    {
+        memset(row, i * 12, sizeof(row));
+        SSD1306_Dither_WriteRow(row);
+    }
+    SSD1306_Dither_End();
+}
+
+static int NoTarget(void)
+{
+    uint32_t bytes = Mock_I2C_GetBytes();
+    int16_t x, y;
+    int failed = 0;
+
+    SSD1306_SetTarget(NULL, NULL, NULL);
+    Draw();
+    for (y = 0; y < SSD1306_HEIGHT; y++)
+    {
+        for (x = 0; x < SSD1306_WIDTH; x++)
+        {
+            failed |= SSD1306_GetPixel(x, y);
+        }
+    }
+    failed |= (SSD1306_GetBuffer() != NULL) || (Mock_I2C_GetBytes() != bytes);
+    printf("no target: %s\n", failed ? "wrong" : "nothing drawn");
+    return failed;
+}
+
+static int Target(void)
+{
+    static uint8_t pixels[SSD1306_BUFFER_SIZE];
+    uint8_t first[SSD1306_PAGES], last[SSD1306_PAGES];
+    uint16_t mismatch;
+    int lit = 0, i;
+
+    memset(first, 0xFF, sizeof(first));
+    memset(last, 0, sizeof(last));
+    SSD1306_SetTarget(pixels, first, last);
+    Draw();
+    for (i = 0; i < SSD1306_BUFFER_SIZE; i++)
+    {
+        lit += (pixels[i] != 0);
+    }
+    if (SSD1306_WriteWindow(0, SSD1306_PAGES - 1, 0, SSD1306_WIDTH - 1,
+                            pixels, SSD1306_WIDTH) != SSD1306_NO_ERROR)
+    {
+        printf("target: write failed\n");
+        return 1;
+    }
+    mismatch = SSD1306_Emu_Compare(Mock_I2C_Emu(), pixels, SSD1306_WIDTH, SSD1306_PAGES);
+    printf("target: %d bytes drawn, %u wrong in the controller\n", lit, mismatch);
+    SSD1306_SetTarget(NULL, NULL, NULL);
+    return (lit == 0) || (mismatch != 0);
+}
+
+static int Tiles(uint32_t rate)
+{
+    static uint8_t cells[SSD1306_TILE_CELLS];
+    static uint8_t expected[SSD1306_BUFFER_SIZE];
+    SSD1306_TileMap map;
+    int t, wrong = 0, failures = 0;
+
+    Mock_I2C_SetFaults(rate);
+    SSD1306_Tile_Init(&map, cells, tileset, ' ');
+    for (t = 0; t < 500; t++)
+    {
+        int n = rand() % 8, tries;
+
+        while (n-- > 0)
+        {
+            SSD1306_Tile_Set(&map, rand() % SSD1306_TILE_COLUMNS, rand() % SSD1306_TILE_ROWS,
+                                rand() % 256);
+        }
+        if (rand() % 4 == 0)
+        {
+            SSD1306_Tile_Print(&map, rand() % SSD1306_TILE_COLUMNS, rand() % SSD1306_TILE_ROWS,
+                                "tiles");
+        }
+        // Cells left dirty by a failed flush are sent by the next one
+        for (tries = 0; SSD1306_Tile_Flush(&map) != SSD1306_NO_ERROR; tries++)
+        {
+            failures++;
+            if (tries == 100)
+            {
+                printf("tiles: flush keeps failing\n");
+                return 1;
+            }
+        }
+        SSD1306_Tile_Render(&map, expected);
+        wrong += SSD1306_Emu_Compare(Mock_I2C_Emu(), expected, SSD1306_WIDTH, SSD1306_PAGES) != 0;
+    }
+    Mock_I2C_SetFaults(0);
+    printf("tiles, faults %5u: %d failed flushes, %d wrong after a flush\n",
+            Mock_I2C_GetFaults(), failures, wrong);
+    return wrong != 0;
+}
+
+int main(void)
+{
+    int failed = 0;
+    unsigned i;
+
+    srand(1);
+    for (i = 0; i < sizeof(tileset); i++)
+    {
+        tileset[i] = rand();
+    }
+    for (i = 0; i < sizeof(image); i++)
+    {
+        image[i] = rand();
+    }
+    Mock_I2C_Reset();
+    I2C_Peripheral_SetRetries(2);
+    I2C_Peripheral_Start();
+    SSD1306_SetAddressingMode(SSD1306_ADDRESSING_AUTO);
+    if (SSD1306_Start() != SSD1306_NO_ERROR)
+    {
+        printf("start failed\n");
+        return 1;
+    }
+    failed |= NoTarget();
+    failed |= Tiles(0);
+    failed |= Tiles(20000);
+    failed |= Target();
+    printf(failed ? "FAIL\n" : "OK\n");
+    return failed;
+}
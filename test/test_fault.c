@@ -0,0 +1,194 @@
+/*
+ * Fault injection: random drawing and refreshes on a bus that loses
+ * bytes, in blocking and timed mode. Whenever a refresh reports success,
+ * and after a final refresh without faults, the controller RAM must hold
+ * the display buffer.
+ *
+ * Then two displays at the two addresses of an SSD1306 are written in
+ * turn on the same lossy bus: a command cut on one must not make the
+ * other one, or its own next command, go wrong.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_GFX.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint16_t Mismatch(void)
+{
+    return SSD1306_Emu_Compare(Mock_I2C_Emu(), SSD1306_GetBuffer(), SSD1306_WIDTH, SSD1306_PAGES);
+}
+
+static int Run(unsigned seed, int timed, uint32_t rate)
+{
+    int reported = 0, desync = 0, t;
+
+    srand(seed);
+    Mock_I2C_Reset();
+    I2C_Peripheral_SetTimeout(timed ? Mock_I2C_Clock : NULL, 10000);
+    I2C_Peripheral_SetRetries(2);
+    I2C_Peripheral_Start();
+    SSD1306_SetAddressingMode(SSD1306_ADDRESSING_AUTO);
+    if ((SSD1306_Start() != SSD1306_NO_ERROR) || (SSD1306_Display() != SSD1306_NO_ERROR))
+    {
+        printf("start failed\n");
+        return 1;
+    }
+
+    Mock_I2C_SetFaults(rate);
+    for (t = 0; t < 3000; t++)
+    {
+        uint8_t ps = rand() % SSD1306_PAGES, pe = ps + rand() % (SSD1306_PAGES - ps);
+        uint8_t cs = rand() % (SSD1306_WIDTH - 1), ce = cs + 1 + rand() % (SSD1306_WIDTH - 1 - cs);
+
+        SSD1306_GFX_FillRect(rand() % SSD1306_WIDTH, rand() % SSD1306_HEIGHT,
+                                rand() % 24 + 1, rand() % 12 + 1, SSD1306_INVERSE);
+        switch (rand() % 6)
+        {
+            case 0:
+                SSD1306_DisplayWindow(ps, pe, cs, ce);
+                break;
+            case 1:
+                SSD1306_ScrollColumn(rand() % 2, ps, pe, cs, ce);
+                break;
+            case 2:
+                SSD1306_Dim(rand() % 2);
+                break;
+            case 3:
+                SSD1306_SetAddressingMode(rand() % 4);
+                break;
+            default:
+                break;
+        }
+        if ((SSD1306_DisplayDirty() == SSD1306_NO_ERROR) && Mismatch())
+        {
+            reported++;
+        }
+    }
+
+    Mock_I2C_SetFaults(0);
+    if (SSD1306_DisplayDirty() != SSD1306_NO_ERROR)
+    {
+        desync++;
+    }
+    desync += Mismatch();
+    printf("seed %u %s: faults %u, wrong after success %d, wrong at the end %d\n",
+            seed, timed ? "timed   " : "blocking", Mock_I2C_GetFaults(), reported, desync);
+    return (reported != 0) || (desync != 0);
+}
+
+/*
+ * Two displays, each with its own image and contrast, written in turn. A
+ * display whose last write failed is sent its whole image the next time.
+ * The contrast command is checked as well: right after a cut command it
+ * has no setup in front of it to absorb NOPs sent to the wrong display.
+ */
+static int RunTwo(unsigned seed)
+{
+    static uint8_t images[2][SSD1306_BUFFER_SIZE];
+    static const uint8_t addresses[2] = { SSD1306_I2C_ADDR, SSD1306_I2C_ADDR ^ 1 };
+    uint8_t stale[2] = { 1, 1 };
+    uint8_t contrast[2] = { 0x8F, 0x8F };
+    int reported = 0, desync = 0, t, d;
+
+    srand(seed);
+    Mock_I2C_Reset();
+    I2C_Peripheral_SetTimeout(NULL, 0);
+    I2C_Peripheral_SetRetries(0);
+    I2C_Peripheral_Start();
+    SSD1306_SetAddressingMode(SSD1306_ADDRESSING_AUTO);
+    for (d = 0; d < 2; d++)
+    {
+        memset(images[d], 0, SSD1306_BUFFER_SIZE);
+        SSD1306_SetAddress(addresses[d]);
+        if (SSD1306_Start() != SSD1306_NO_ERROR)
+        {
+            printf("start failed\n");
+            return 1;
+        }
+    }
+
+    Mock_I2C_SetFaults(20000);
+    for (t = 0; t < 4000; t++)
+    {
+        uint8_t ps = rand() % SSD1306_PAGES, pe = ps + rand() % (SSD1306_PAGES - ps);
+        uint8_t cs = rand() % SSD1306_WIDTH, ce = cs + rand() % (SSD1306_WIDTH - cs);
+        uint8_t p, c;
+
+        d = rand() % 2;
+        SSD1306_SetAddress(addresses[d]);
+        for (p = ps; p <= pe; p++)
+        {
+            for (c = cs; c <= ce; c++)
+            {
+                images[d][p * SSD1306_WIDTH + c] ^= (uint8_t)rand();
+            }
+        }
+        if (stale[d])
+        {
+            ps = 0;
+            pe = SSD1306_PAGES - 1;
+            cs = 0;
+            ce = SSD1306_WIDTH - 1;
+        }
+        if (rand() % 2)
+        {
+            uint8_t dim = rand() % 2;
+            if (SSD1306_Dim(dim) == SSD1306_NO_ERROR)
+            {
+                contrast[d] = dim ? 0 : 0x8F;
+                reported += Mock_I2C_EmuAt(addresses[d])->contrast != contrast[d];
+            }
+        }
+        stale[d] = SSD1306_WriteWindow(ps, pe, cs, ce, &images[d][ps * SSD1306_WIDTH + cs],
+                                        SSD1306_WIDTH) != SSD1306_NO_ERROR;
+        if (!stale[d] && SSD1306_Emu_Compare(Mock_I2C_EmuAt(addresses[d]), images[d],
+                                                SSD1306_WIDTH, SSD1306_PAGES))
+        {
+            reported++;
+        }
+    }
+
+    Mock_I2C_SetFaults(0);
+    for (d = 0; d < 2; d++)
+    {
+        SSD1306_SetAddress(addresses[d]);
+        if ((SSD1306_Dim(contrast[d] == 0) != SSD1306_NO_ERROR) ||
+            (SSD1306_WriteWindow(0, SSD1306_PAGES - 1, 0, SSD1306_WIDTH - 1, images[d],
+                                    SSD1306_WIDTH) != SSD1306_NO_ERROR))
+        {
+            desync++;
+        }
+    }
+    for (d = 0; d < 2; d++)
+    {
+        desync += SSD1306_Emu_Compare(Mock_I2C_EmuAt(addresses[d]), images[d],
+                                        SSD1306_WIDTH, SSD1306_PAGES);
+        desync += Mock_I2C_EmuAt(addresses[d])->contrast != contrast[d];
+    }
+    SSD1306_SetAddress(SSD1306_I2C_ADDR);
+    printf("seed %u two displays: faults %u, wrong after success %d, wrong at the end %d\n",
+            seed, Mock_I2C_GetFaults(), reported, desync);
+    return (reported != 0) || (desync != 0);
+}
+
+int main(void)
+{
+    int failed = 0;
+    unsigned seed;
+
+    for (seed = 1; seed <= 4; seed++)
+    {
+        failed |= Run(seed, 0, 2000);
+        failed |= Run(seed, 1, 2000);
+    }
+    for (seed = 1; seed <= 4; seed++)
+    {
+        failed |= RunTwo(seed);
+    }
+    printf(failed ? "FAIL\n" : "OK\n");
+    return failed;
+}
@@ -0,0 +1,180 @@
+/*
+ * Flood fill against a pixel by pixel breadth-first reference.
+ *
+ * Random scenes of outlines and noise are filled from a random seed,
+ * with every rotation, an offset origin and a clip rectangle. The fill
+ * must change exactly the pixels of the 4-connected region of the seed,
+ * or only some of them when it reports an overflow. Built with the
+ * default stack and pending rows and, as test_flood_stack8, with tiny
+ * ones that overflow on many scenes.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_GFX.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCENES 2000
+
+static uint8_t scene[SSD1306_BUFFER_SIZE];
+static uint8_t expected[SSD1306_BUFFER_SIZE];
+static uint8_t queue_x[SSD1306_WIDTH * SSD1306_HEIGHT];
+static uint8_t queue_y[SSD1306_WIDTH * SSD1306_HEIGHT];
+
+static int Get(const uint8_t *pixels, int x, int y)
+{
+    return (pixels[x + (y / 8) * SSD1306_WIDTH] >> (y & 7)) & 1;
+}
+
+static void Flip(uint8_t *pixels, int x, int y)
+{
+    pixels[x + (y / 8) * SSD1306_WIDTH] ^= 1 << (y & 7);
+}
+
+/*
+ * Invert the region of (x, y) within the clip rectangle, in controller
+ * coordinates.
+ */
+static void Reference(uint8_t *pixels, int x, int y, int cx, int cy, int cw, int ch)
+{
+    static const int dx[4] = { 1, -1, 0, 0 }, dy[4] = { 0, 0, 1, -1 };
+    int old = Get(pixels, x, y), head = 0, tail = 0, d;
+
+    Flip(pixels, x, y);
+    queue_x[tail] = x;
+    queue_y[tail++] = y;
+    while (head < tail)
+    {
+        for (d = 0; d < 4; d++)
+        {
+            int nx = queue_x[head] + dx[d], ny = queue_y[head] + dy[d];
+            if ((nx >= cx) && (nx < cx + cw) && (ny >= cy) && (ny < cy + ch) &&
+                (Get(pixels, nx, ny) == old))
+            {
+                Flip(pixels, nx, ny);
+                queue_x[tail] = nx;
+                queue_y[tail++] = ny;
+            }
+        }
+        head++;
+    }
+}
+
+static void ToController(int16_t *x, int16_t *y)
+{
+    int16_t ox, oy, t;
+
+    SSD1306_GetOrigin(&ox, &oy);
+    *x += ox;
+    *y += oy;
+    switch (SSD1306_GetRotation())
+    {
+        case 1:
+            t = *x;
+            *x = SSD1306_WIDTH - *y - 1;
+            *y = t;
+            break;
+        case 2:
+            *x = SSD1306_WIDTH - *x - 1;
+            *y = SSD1306_HEIGHT - *y - 1;
+            break;
+        case 3:
+            t = *x;
+            *x = *y;
+            *y = SSD1306_HEIGHT - t - 1;
+            break;
+    }
+}
+
+int main(void)
+{
+    int wrong = 0, overflows = 0, n, i;
+
+    srand(11);
+    for (n = 0; n < SCENES; n++)
+    {
+        int16_t cx, cy, cw, ch, sx, sy, x, y, k;
+        uint8_t *pixels = SSD1306_GetBuffer();
+        int outside = 0, missing = 0;
+        uint16_t color;
+        uint8_t status;
+
+        SSD1306_SetRotation(0);
+        SSD1306_SetOrigin(0, 0);
+        SSD1306_ResetClip();
+        SSD1306_ClearDisplay();
+        if (n % 2)
+        {
+            for (k = 0; k < 20; k++)
+            {
+                SSD1306_GFX_DrawCircle(rand() % SSD1306_WIDTH, rand() % SSD1306_HEIGHT,
+                                        rand() % 20, SSD1306_WHITE);
+                SSD1306_GFX_DrawLine(rand() % SSD1306_WIDTH, rand() % SSD1306_HEIGHT,
+                                        rand() % SSD1306_WIDTH, rand() % SSD1306_HEIGHT,
+                                        SSD1306_WHITE);
+            }
+        }
+        else
+        {
+            int density = 2 + rand() % 3;
+            for (i = 0; i < SSD1306_BUFFER_SIZE * 8; i++)
+            {
+                if (rand() % 10 < density)
+                {
+                    Flip(pixels, i % SSD1306_WIDTH, i / SSD1306_WIDTH);
+                }
+            }
+        }
+
+        SSD1306_SetRotation(rand() % 4);
+        SSD1306_SetOrigin(rand() % 5 - 2, rand() % 5 - 2);
+        if (rand() % 2)
+        {
+            SSD1306_PushClip(rand() % 40, rand() % 10, 30 + rand() % 100, 8 + rand() % 30);
+        }
+        SSD1306_GetControllerClip(&cx, &cy, &cw, &ch);
+        if ((cw == 0) || (ch == 0))
+        {
+            continue;
+        }
+        memcpy(scene, pixels, sizeof(scene));
+
+        // Random seed inside the clip, found by scanning drawing coordinates
+        sx = rand() % SSD1306_GetWidth();
+        sy = rand() % SSD1306_GetHeight();
+        color = (rand() % 2) ? SSD1306_INVERSE : (Get(scene, 0, 0) ? SSD1306_BLACK : SSD1306_WHITE);
+        status = SSD1306_GFX_FloodFill(sx, sy, color);
+        overflows += status == SSD1306_GFX_OVERFLOW_ERROR;
+
+        // Reference in controller coordinates
+        memcpy(expected, scene, sizeof(expected));
+        ToController(&sx, &sy);
+        if ((sx >= cx) && (sx < cx + cw) && (sy >= cy) && (sy < cy + ch) &&
+            !((color == SSD1306_WHITE) && Get(scene, sx, sy)) &&
+            !((color == SSD1306_BLACK) && !Get(scene, sx, sy)))
+        {
+            Reference(expected, sx, sy, cx, cy, cw, ch);
+        }
+        for (y = 0; y < SSD1306_HEIGHT; y++)
+        {
+            for (x = 0; x < SSD1306_WIDTH; x++)
+            {
+                int changed = Get(scene, x, y) != Get(pixels, x, y);
+                int in_region = Get(scene, x, y) != Get(expected, x, y);
+                outside += changed && !in_region;
+                missing += in_region && !changed;
+            }
+        }
+        if ((outside != 0) || ((missing != 0) && (status == SSD1306_NO_ERROR)))
+        {
+            printf("scene %d: %d pixels filled outside the region, %d missing\n",
+                    n, outside, missing);
+            wrong++;
+        }
+    }
+    printf("stack %d, pending %d: %d scenes, %d overflowed, %d wrong\n", SSD1306_GFX_FILL_STACK,
+            SSD1306_GFX_FILL_PENDING, SCENES, overflows, wrong);
+    printf(wrong ? "FAIL\n" : "OK\n");
+    return wrong != 0;
+}
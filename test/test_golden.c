@@ -0,0 +1,356 @@
+/*
+ * Golden images: reference scenes compared bit-exactly, and timed.
+ *
+ * Each scene is drawn on a cleared buffer and written as a PNG with
+ * SSD1306_Export_Png, whose output only depends on the pixels. The bytes
+ * must equal golden/<scene>.png; a scene that differs is written to
+ * build/golden/<scene>.png for inspection. Each scene is then drawn again
+ * in a loop to report its drawing time, so that optimizations of the
+ * primitives can be measured and cannot change their output unnoticed.
+ *
+ * One scene is also written as a PBM with SSD1306_Export_Pbm, and shown
+ * on the controller emulator through the mock bus: the PBM and PNG
+ * exports of the emulator GDDRAM must equal the golden images too.
+ *
+ *     build/test_golden            compare and time
+ *     build/test_golden --update   rewrite the golden images
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Blit.h"
+#include "SSD1306_Dither.h"
+#include "SSD1306_Export.h"
+#include "SSD1306_GFX.h"
+#include "SSD1306_Path.h"
+#include "SSD1306_Stroke.h"
+#include "SSD1306_Widget.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define MAX_IMAGE   4096
+#define TIME_NS     20000000ull     // Drawing time measured for each scene
+
+typedef struct {
+    uint8_t bytes[MAX_IMAGE];
+    size_t len;
+} Image;
+
+typedef struct {
+    const char *name;
+    uint8_t rotation;
+    void (*draw)(void);
+} Scene;
+
+static const SSD1306_Point star[] = {
+    {20, 2}, {26, 28}, {4, 10}, {36, 10}, {14, 28}
+};
+
+static void Lines(void)
+{
+    int16_t i;
+
+    for (i = 0; i < 16; i++)
+    {
+        SSD1306_GFX_DrawLine(64, 16, i * 9 - 4, (i & 1) ? -3 : 34, SSD1306_WHITE);
+    }
+    SSD1306_GFX_DrawLine(0, 31, 127, 0, SSD1306_INVERSE);
+    SSD1306_GFX_DrawPolyline(star, 5, 1, SSD1306_WHITE);
+}
+
+static void Shapes(void)
+{
+    SSD1306_GFX_DrawRect(1, 1, 30, 20, SSD1306_WHITE);
+    SSD1306_GFX_FillRect(10, 8, 30, 20, SSD1306_INVERSE);
+    SSD1306_GFX_DrawCircle(60, 15, 14, SSD1306_WHITE);
+    SSD1306_GFX_FillCircle(60, 15, 6, SSD1306_WHITE);
+    SSD1306_GFX_DrawEllipse(100, 12, 25, 9, SSD1306_WHITE);
+    SSD1306_GFX_FillEllipse(100, 24, 12, 5, SSD1306_INVERSE);
+    SSD1306_GFX_DrawRoundRect(2, 22, 40, 10, 4, SSD1306_WHITE);
+    SSD1306_GFX_FillRoundRect(78, 2, 20, 12, 5, SSD1306_INVERSE);
+    SSD1306_GFX_DrawTriangle(110, 0, 127, 31, 90, 31, SSD1306_WHITE);
+    SSD1306_GFX_FillTriangle(30, 31, 45, 18, 52, 30, SSD1306_INVERSE);
+}
+
+static void Polygons(void)
+{
+    SSD1306_Point shifted[5];
+    uint8_t i;
+
+    SSD1306_GFX_FillPolygon(star, 5, SSD1306_GFX_EVEN_ODD, SSD1306_WHITE);
+    for (i = 0; i < 5; i++)
+    {
+        shifted[i].x = star[i].x + 45;
+        shifted[i].y = star[i].y;
+    }
+    SSD1306_GFX_FillPolygon(shifted, 5, SSD1306_GFX_NONZERO, SSD1306_WHITE);
+    SSD1306_GFX_DrawCircle(110, 16, 12, SSD1306_WHITE);
+    SSD1306_GFX_DrawLine(98, 16, 122, 16, SSD1306_WHITE);
+    SSD1306_GFX_FloodFill(110, 10, SSD1306_INVERSE);
+}
+
+static void Strokes(void)
+{
+    static const SSD1306_Point zigzag[] = { {4, 26}, {24, 6}, {44, 26}, {64, 6}, {84, 26} };
+    static const SSD1306_StrokeStyle round = { 5, SSD1306_STROKE_CAP_ROUND,
+                                                SSD1306_STROKE_JOIN_ROUND };
+    static const SSD1306_StrokeStyle miter = { 3, SSD1306_STROKE_CAP_SQUARE,
+                                                SSD1306_STROKE_JOIN_MITER };
+
+    SSD1306_Stroke_Polyline(zigzag, 5, 0, &round, SSD1306_WHITE);
+    SSD1306_Stroke_Polyline(star, 5, 1, &miter, SSD1306_INVERSE);
+    SSD1306_Stroke_Line(90, 4, 124, 28, &round, SSD1306_INVERSE);
+}
+
+static void Paths(void)
+{
+    SSD1306_Point points[16];
+    SSD1306_Path path;
+    uint8_t i;
+
+    SSD1306_Path_Init(&path, points, 16);
+    SSD1306_Path_Translate(&path.transform, 64L << 16, 16L << 16);
+    SSD1306_Path_Rotate(&path.transform, 30);
+    for (i = 0; i < 5; i++)
+    {
+        SSD1306_Path_LineTo(&path, star[i].x - 20, star[i].y - 15);
+    }
+    SSD1306_Path_Close(&path);
+    SSD1306_Path_Fill(&path, SSD1306_GFX_NONZERO, SSD1306_WHITE);
+    SSD1306_Path_Stroke(&path, SSD1306_INVERSE);
+}
+
+static void Widgets(void)
+{
+    SSD1306_Bar bar;
+    SSD1306_Gauge gauge;
+    SSD1306_Numeric numeric;
+
+    SSD1306_Bar_Init(&bar, 2, 2, 50, 8, 0, 100, SSD1306_WIDGET_BAR_RIGHT);
+    SSD1306_Bar_Set(&bar, 63);
+    SSD1306_Gauge_Init(&gauge, 30, 31, 18, 4, 180, 180, 0, 100);
+    SSD1306_Gauge_Set(&gauge, 40);
+    SSD1306_Numeric_Init(&numeric, 64, 4, 4, 10, 20, 2, 3);
+    SSD1306_Numeric_Set(&numeric, 2718);
+}
+
+static void Dither(void)
+{
+    uint8_t row[128];
+    uint8_t x, y;
+
+    SSD1306_Dither_Begin(0, 0, sizeof(row), SSD1306_DITHER_BAYER);
+    for (y = 0; y < 16; y++)
+    {
+        for (x = 0; x < sizeof(row); x++)
+        {
+            row[x] = x * 2;
+        }
+        SSD1306_Dither_WriteRow(row);
+    }
+    SSD1306_Dither_End();
+    SSD1306_Dither_Begin(0, 16, sizeof(row), SSD1306_DITHER_FLOYD_STEINBERG);
+    for (y = 0; y < 16; y++)
+    {
+        for (x = 0; x < sizeof(row); x++)
+        {
+            row[x] = (uint8_t)((x * 2 + y * 8) & 0xFF);
+        }
+        SSD1306_Dither_WriteRow(row);
+    }
+    SSD1306_Dither_End();
+}
+
+static void Blit(void)
+{
+    static const uint8_t arrow[16 * 2] = {
+        0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE, 0xFF,
+        0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x80,
+        0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF,
+        0xFF, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x03, 0x01
+    };
+    int16_t i;
+
+    for (i = 0; i < 6; i++)
+    {
+        SSD1306_Blit_Draw(arrow, 16, 16, i * 21 - 3, (i * 5) % 20 - 2, 1 + (i == 5),
+                            (i & 1) ? SSD1306_BLIT_XOR : SSD1306_BLIT_OR);
+    }
+}
+
+static const Scene scenes[] = {
+    { "lines", 0, Lines },
+    { "lines_rot1", 1, Lines },
+    { "shapes", 0, Shapes },
+    { "shapes_rot2", 2, Shapes },
+    { "polygons", 0, Polygons },
+    { "polygons_rot3", 3, Polygons },
+    { "strokes", 0, Strokes },
+    { "strokes_rot1", 1, Strokes },
+    { "paths", 0, Paths },
+    { "widgets", 0, Widgets },
+    { "dither", 0, Dither },
+    { "blit", 0, Blit },
+    { "blit_rot2", 2, Blit },
+};
+
+static void Append(const uint8_t *data, uint16_t len, void *context)
+{
+    Image *image = context;
+
+    if (image->len + len <= MAX_IMAGE)
+    {
+        memcpy(&image->bytes[image->len], data, len);
+    }
+    image->len += len;
+}
+
+static uint64_t Now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+static void Draw(const Scene *scene)
+{
+    SSD1306_SetRotation(scene->rotation);
+    SSD1306_SetOrigin(0, 0);
+    SSD1306_ResetClip();
+    SSD1306_ClearDisplay();
+    scene->draw();
+}
+
+static int WriteFile(const char *path, const Image *image)
+{
+    FILE *f = fopen(path, "wb");
+    int failed;
+
+    if (f == NULL)
+    {
+        return 1;
+    }
+    failed = fwrite(image->bytes, 1, image->len, f) != image->len;
+    return fclose(f) || failed;
+}
+
+static int ReadFile(const char *path, Image *image)
+{
+    FILE *f = fopen(path, "rb");
+
+    if (f == NULL)
+    {
+        return 1;
+    }
+    image->len = fread(image->bytes, 1, MAX_IMAGE, f);
+    fclose(f);
+    return 0;
+}
+
+/*
+ * Compare an image with golden/<name>, or rewrite it when updating. An
+ * image that differs is written to build/golden/<name>. Returns the result
+ * to print, which is "ok" or "written" on success.
+ */
+static const char *Check(const char *name, const Image *actual, int update)
+{
+    static Image golden;
+    char path[64];
+    const char *result;
+
+    snprintf(path, sizeof(path), "golden/%s", name);
+    if (update)
+    {
+        return WriteFile(path, actual) ? "ERROR" : "written";
+    }
+    if (ReadFile(path, &golden) != 0)
+    {
+        result = "MISSING";
+    }
+    else if ((golden.len == actual->len) &&
+                (memcmp(golden.bytes, actual->bytes, actual->len) == 0))
+    {
+        return "ok";
+    }
+    else
+    {
+        result = "DIFFERS";
+    }
+    mkdir("build/golden", 0777);
+    snprintf(path, sizeof(path), "build/golden/%s", name);
+    WriteFile(path, actual);
+    return result;
+}
+
+static int Passed(const char *result)
+{
+    return (strcmp(result, "ok") == 0) || (strcmp(result, "written") == 0);
+}
+
+int main(int argc, char **argv)
+{
+    static Image actual;
+    int update = (argc > 1) && (strcmp(argv[1], "--update") == 0);
+    int failed = 0;
+    const char *result;
+    unsigned i;
+
+    printf("%-16s %-8s %10s\n", "scene", "result", "us/draw");
+    for (i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++)
+    {
+        const Scene *scene = &scenes[i];
+        char name[64];
+        uint64_t start, elapsed;
+        uint32_t draws = 0;
+
+        Draw(scene);
+        actual.len = 0;
+        SSD1306_Export_Png(SSD1306_GetBuffer(), SSD1306_WIDTH, SSD1306_WIDTH, SSD1306_HEIGHT,
+                            Append, &actual);
+        snprintf(name, sizeof(name), "%s.png", scene->name);
+        result = Check(name, &actual, update);
+        failed |= !Passed(result);
+
+        start = Now();
+        do
+        {
+            Draw(scene);
+            draws++;
+            elapsed = Now() - start;
+        } while (elapsed < TIME_NS);
+        printf("%-16s %-8s %10.2f\n", scene->name, result, elapsed / 1000.0 / draws);
+    }
+
+    // The shapes as a PBM, and as shown by the controller after a refresh
+    Mock_I2C_Reset();
+    I2C_Peripheral_Start();
+    failed |= SSD1306_Start() != SSD1306_NO_ERROR;
+    Draw(&scenes[2]);
+    actual.len = 0;
+    SSD1306_Export_Pbm(SSD1306_GetBuffer(), SSD1306_WIDTH, SSD1306_WIDTH, SSD1306_HEIGHT,
+                        Append, &actual);
+    result = Check("shapes.pbm", &actual, update);
+    printf("%-16s %s\n", "shapes.pbm", result);
+    failed |= !Passed(result);
+    failed |= SSD1306_Display() != SSD1306_NO_ERROR;
+    actual.len = 0;
+    SSD1306_Export_Pbm(Mock_I2C_Emu()->gddram, SSD1306_EMU_COLUMNS, SSD1306_WIDTH,
+                        SSD1306_HEIGHT, Append, &actual);
+    result = Check("shapes.pbm", &actual, 0);
+    printf("%-16s %s\n", "gddram.pbm", result);
+    failed |= !Passed(result);
+    actual.len = 0;
+    SSD1306_Export_Png(Mock_I2C_Emu()->gddram, SSD1306_EMU_COLUMNS, SSD1306_WIDTH,
+                        SSD1306_HEIGHT, Append, &actual);
+    result = Check("shapes.png", &actual, 0);
+    printf("%-16s %s\n", "gddram.png", result);
+    failed |= !Passed(result);
+
+    printf(failed ? "FAIL\n" : "OK\n");
+    return failed;
+}
@@ -0,0 +1,117 @@
+/*
+ * Grayscale: sustained plane rate and recovery from bus faults.
+ *
+ * The planes are driven as in an application: SSD1306_Gray_Tick once per
+ * controller frame and SSD1306_Gray_Update in a loop, on the simulated
+ * bus time. The plane rate is measured for a blank image, where pages
+ * equal in all planes are skipped, for a static gray image and for an
+ * image redrawn at every plane. Whenever a plane is reported as sent, the
+ * controller RAM must hold it, with faults on the bus too, and planes
+ * must keep being sent once faults stop.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Gray.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PLANES      3
+#define LOOP_NS     5000        // CPU time of an iteration of the main loop
+
+static uint8_t planes[SSD1306_GRAY_PLANES_SIZE(PLANES)];
+
+static void Scribble(int pixels)
+{
+    while (pixels-- > 0)
+    {
+        SSD1306_Gray_DrawPixel(rand() % SSD1306_WIDTH, rand() % SSD1306_HEIGHT,
+                                rand() % (1 << PLANES));
+    }
+}
+
+/*
+ * Run the main loop for the given simulated time, redrawing pixels after
+ * each plane. Returns the number of planes sent, or -1 if the controller
+ * RAM did not hold a plane reported as sent.
+ */
+static long Run(double seconds, int redraw)
+{
+    uint64_t frame_ns = 1000000000ull / SSD1306_GetFrameRate();
+    uint64_t end = Mock_I2C_GetTime() + (uint64_t)(seconds * 1e9);
+    uint64_t next_frame = Mock_I2C_GetTime() + frame_ns;
+    uint32_t start = SSD1306_Gray_GetPlanesSent();
+    uint32_t sent = start;
+
+    while (Mock_I2C_GetTime() < end)
+    {
+        while (Mock_I2C_GetTime() >= next_frame)
+        {
+            SSD1306_Gray_Tick();
+            next_frame += frame_ns;
+        }
+        SSD1306_Gray_Update();
+        Mock_I2C_Advance(LOOP_NS);
+        if (SSD1306_Gray_GetPlanesSent() != sent)
+        {
+            uint8_t shown;
+
+            sent = SSD1306_Gray_GetPlanesSent();
+            shown = (sent - 1) % PLANES;
+            if (SSD1306_Emu_Compare(Mock_I2C_Emu(), &planes[shown * SSD1306_BUFFER_SIZE],
+                                    SSD1306_WIDTH, SSD1306_PAGES))
+            {
+                printf("plane %u not in the controller RAM\n", shown);
+                return -1;
+            }
+            Scribble(redraw);
+        }
+    }
+    return sent - start;
+}
+
+int main(void)
+{
+    int failed = 0;
+    double ideal;
+    long n;
+
+    srand(1);
+    Mock_I2C_Reset();
+    I2C_Peripheral_SetTimeout(NULL, 0);
+    I2C_Peripheral_SetRetries(2);
+    I2C_Peripheral_Start();
+    if ((SSD1306_Start() != SSD1306_NO_ERROR) ||
+        (SSD1306_Gray_Start(planes, PLANES) != SSD1306_NO_ERROR))
+    {
+        printf("start failed\n");
+        return 1;
+    }
+    // Plane k is shown for 2^k frames
+    ideal = (double)PLANES * SSD1306_GetFrameRate() / ((1 << PLANES) - 1);
+
+    n = Run(2.0, 0);
+    printf("blank image:      %7.1f planes/s (frame limit %.1f)\n", n / 2.0, ideal);
+    failed |= (n < 0);
+    Scribble(SSD1306_WIDTH * SSD1306_HEIGHT);
+    n = Run(2.0, 0);
+    printf("static image:     %7.1f planes/s\n", n / 2.0);
+    failed |= (n < 0);
+    n = Run(2.0, 64);
+    printf("redrawn image:    %7.1f planes/s\n", n / 2.0);
+    failed |= (n < 0);
+
+    Mock_I2C_SetFaults(2000);
+    n = Run(5.0, 64);
+    printf("faults (%5u):    %7.1f planes/s\n", Mock_I2C_GetFaults(), n / 5.0);
+    failed |= (n < 0);
+    Mock_I2C_SetFaults(0);
+    n = Run(1.0, 64);
+    printf("after the faults: %7.1f planes/s\n", n / 1.0);
+    failed |= (n <= 0);
+
+    SSD1306_Gray_Stop();
+    printf(failed ? "FAIL\n" : "OK\n");
+    return failed;
+}
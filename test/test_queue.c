@@ -0,0 +1,119 @@
+/*
+ * Queue: several producer threads and a display thread.
+ *
+ * Producers push numbered SSD1306_QUEUE_CALL commands as fast as they can,
+ * retrying when the queue is full; the display thread drains them. Every
+ * command must be executed exactly once and, for each producer, in the
+ * order it was pushed, and the counters must add up. The push rate is
+ * reported. Built with the compare-and-swap claim (test_queue) and with
+ * the critical section used on Cortex-M0 (test_queue_critical).
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Queue.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if !SSD1306_QUEUE_MULTI_PRODUCER
+    #error "test_queue must be built with SSD1306_QUEUE_MULTI_PRODUCER=1"
+#endif
+
+#define PRODUCERS   4
+#define COMMANDS    200000      // Commands of each producer
+#define SLOTS       64
+
+static SSD1306_QueueSlot slots[SLOTS];
+static SSD1306_Queue queue;
+static uint32_t next_seq[PRODUCERS];    // Next command expected from each producer
+static uint32_t out_of_order;
+static uint32_t full[PRODUCERS];        // Pushes refused because the queue was full
+static volatile uint32_t received;
+
+static void Record(void *context)
+{
+    uintptr_t value = (uintptr_t)context;
+    uint32_t id = (uint32_t)(value >> 24), seq = (uint32_t)(value & 0xFFFFFF);
+
+    if ((id >= PRODUCERS) || (seq != next_seq[id]))
+    {
+        out_of_order++;
+    }
+    else
+    {
+        next_seq[id]++;
+    }
+    received++;
+}
+
+static void *Producer(void *arg)
+{
+    uintptr_t id = (uintptr_t)arg;
+    uint32_t i;
+
+    for (i = 0; i < COMMANDS; i++)
+    {
+        while (SSD1306_Queue_Call(&queue, Record, (void *)((id << 24) | i)) != SSD1306_NO_ERROR)
+        {
+            full[id]++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *Display(void *arg)
+{
+    (void)arg;
+    while (received < PRODUCERS * COMMANDS)
+    {
+        if (SSD1306_Queue_Drain(&queue, 16) == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t producers[PRODUCERS], display;
+    struct timespec start, end;
+    uint32_t dropped = 0;
+    double seconds;
+    uintptr_t i;
+    int failed = 0;
+
+    SSD1306_Queue_Init(&queue, slots, SLOTS);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&display, NULL, Display, NULL);
+    for (i = 0; i < PRODUCERS; i++)
+    {
+        pthread_create(&producers[i], NULL, Producer, (void *)i);
+    }
+    for (i = 0; i < PRODUCERS; i++)
+    {
+        pthread_join(producers[i], NULL);
+        dropped += full[i];
+    }
+    pthread_join(display, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    for (i = 0; i < PRODUCERS; i++)
+    {
+        failed |= (next_seq[i] != COMMANDS);
+    }
+    failed |= (out_of_order != 0) || (SSD1306_Queue_GetCount(&queue) != 0) ||
+                (queue.stats.pushed != PRODUCERS * COMMANDS) ||
+                (queue.stats.executed != PRODUCERS * COMMANDS) ||
+                (queue.stats.dropped != dropped);
+    printf("%s: %d producers, %u commands, %u out of order, %u refused (counted %u)\n",
+            SSD1306_QUEUE_CRITICAL ? "critical section" : "compare-and-swap",
+            PRODUCERS, queue.stats.executed, out_of_order, dropped, queue.stats.dropped);
+    printf("%.2f M commands/s\n", PRODUCERS * COMMANDS / seconds / 1e6);
+    printf(failed ? "FAIL\n" : "OK\n");
+    return failed;
+}
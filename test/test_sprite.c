@@ -0,0 +1,199 @@
+/*
+ * Sprites with save-under against a pixel by pixel reference.
+ *
+ * Sprites of every mode and of random sizes are stacked over a random
+ * background, partly off the display and inside a random clip. Each
+ * time the top sprite is moved, the buffer must be the background with
+ * the sprites composited at their positions, and hiding them in the
+ * reverse order must give the background back byte for byte. Every step
+ * is sent with SSD1306_DisplayDirty, so the marked footprints must be
+ * enough for the controller to follow the buffer.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Sprite.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCENES      300
+#define SPRITES     4
+#define MOVES       6
+#define MAX_SIZE    40
+
+typedef struct {
+    SSD1306_Sprite sprite;
+    uint8_t image[MAX_SIZE * ((MAX_SIZE + 7) / 8)];
+    uint8_t mask[MAX_SIZE * ((MAX_SIZE + 7) / 8)];
+    uint8_t save[SSD1306_SPRITE_SAVE_SIZE(MAX_SIZE, MAX_SIZE)];
+} Item;
+
+static Item items[SPRITES];
+static uint8_t background[SSD1306_BUFFER_SIZE];
+static uint8_t expected[SSD1306_BUFFER_SIZE];
+
+static int Get(const uint8_t *pixels, int width, int x, int y)
+{
+    return (pixels[x + (y / 8) * width] >> (y & 7)) & 1;
+}
+
+static void Put(uint8_t *pixels, int x, int y, int on)
+{
+    if (on)
+    {
+        pixels[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y & 7);
+    }
+    else
+    {
+        pixels[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y & 7));
+    }
+}
+
+/*
+ * Composite the first count sprites over the background, in the order
+ * they were shown, limited to the clip rectangle.
+ */
+static void Reference(int count, int cx, int cy, int cw, int ch)
+{
+    int i, x, y;
+
+    memcpy(expected, background, sizeof(expected));
+    for (i = 0; i < count; i++)
+    {
+        const SSD1306_Sprite *s = &items[i].sprite;
+        for (y = 0; y < s->height; y++)
+        {
+            for (x = 0; x < s->width; x++)
+            {
+                int px = s->x + x, py = s->y + y;
+                int bit = Get(s->image, s->width, x, y), old;
+                if ((px < cx) || (px >= cx + cw) || (py < cy) || (py >= cy + ch))
+                {
+                    continue;
+                }
+                old = Get(expected, SSD1306_WIDTH, px, py);
+                switch (s->mode)
+                {
+                    case SSD1306_SPRITE_OR:
+                        Put(expected, px, py, old | bit);
+                        break;
+                    case SSD1306_SPRITE_AND:
+                        Put(expected, px, py, old & bit);
+                        break;
+                    case SSD1306_SPRITE_XOR:
+                        Put(expected, px, py, old ^ bit);
+                        break;
+                    case SSD1306_SPRITE_MASK:
+                        Put(expected, px, py, Get(s->mask, s->width, x, y) ? bit : old);
+                        break;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Send the dirty areas and check the buffer and the controller.
+ */
+static int Check(const char *step, int n, int count, int cx, int cy, int cw, int ch)
+{
+    const uint8_t *want = background;
+    int wrong = 0;
+
+    if (count > 0)
+    {
+        Reference(count, cx, cy, cw, ch);
+        want = expected;
+    }
+    if (memcmp(SSD1306_GetBuffer(), want, SSD1306_BUFFER_SIZE) != 0)
+    {
+        printf("scene %d: buffer wrong after %s with %d sprites\n", n, step, count);
+        wrong = 1;
+    }
+    if ((SSD1306_DisplayDirty() != SSD1306_NO_ERROR) ||
+        (SSD1306_Emu_Compare(Mock_I2C_Emu(), SSD1306_GetBuffer(), SSD1306_WIDTH,
+                                SSD1306_PAGES) != 0))
+    {
+        printf("scene %d: controller differs after %s with %d sprites\n", n, step, count);
+        wrong = 1;
+    }
+    return wrong;
+}
+
+static int16_t Position(int size, int limit)
+{
+    return rand() % (limit + 2 * size) - size;
+}
+
+int main(void)
+{
+    int wrong = 0, n, i, k;
+
+    Mock_I2C_Reset();
+    I2C_Peripheral_Start();
+    wrong |= SSD1306_Start() != SSD1306_NO_ERROR;
+    SSD1306_SetRotation(0);
+    SSD1306_ResetClip();
+
+    srand(5);
+    for (n = 0; n < SCENES; n++)
+    {
+        int16_t cx, cy, cw, ch;
+        int count = 1 + rand() % SPRITES;
+
+        SSD1306_ResetClip();
+        for (i = 0; i < SSD1306_BUFFER_SIZE; i++)
+        {
+            SSD1306_GetBuffer()[i] = rand();
+        }
+        SSD1306_MarkDirty(0, 0, SSD1306_WIDTH, SSD1306_HEIGHT);
+        memcpy(background, SSD1306_GetBuffer(), sizeof(background));
+        wrong |= Check("background", n, 0, 0, 0, 0, 0);
+        if (rand() % 2)
+        {
+            SSD1306_PushClip(rand() % 40, rand() % 16, 20 + rand() % 100, 4 + rand() % 28);
+        }
+        SSD1306_GetControllerClip(&cx, &cy, &cw, &ch);
+
+        // Stack the sprites, moving the top one around after each is shown
+        for (i = 0; i < count; i++)
+        {
+            Item *item = &items[i];
+            uint8_t w = 1 + rand() % MAX_SIZE, h = 1 + rand() % MAX_SIZE;
+
+            for (k = 0; k < (int)sizeof(item->image); k++)
+            {
+                item->image[k] = rand();
+                item->mask[k] = rand();
+            }
+            SSD1306_Sprite_Init(&item->sprite, item->image, item->mask, w, h, rand() % 4,
+                                item->save);
+            for (k = 0; k < MOVES; k++)
+            {
+                SSD1306_Sprite_Move(&item->sprite, Position(w, SSD1306_WIDTH),
+                                    Position(h, SSD1306_HEIGHT));
+                wrong |= Check("move", n, i + 1, cx, cy, cw, ch);
+            }
+        }
+
+        // A new image at the same position
+        for (k = 0; k < (int)sizeof(items[0].image); k++)
+        {
+            items[count - 1].image[k] = ~items[count - 1].image[k];
+        }
+        SSD1306_Sprite_SetImage(&items[count - 1].sprite, items[count - 1].image,
+                                items[count - 1].mask);
+        wrong |= Check("new image", n, count, cx, cy, cw, ch);
+
+        for (i = count - 1; i >= 0; i--)
+        {
+            SSD1306_Sprite_Hide(&items[i].sprite);
+            wrong |= Check("hide", n, i, cx, cy, cw, ch);
+        }
+    }
+    printf("%d scenes, %u bytes of data sent\n", SCENES, Mock_I2C_Emu()->data_bytes);
+    printf(wrong ? "FAIL\n" : "OK\n");
+    return wrong;
+}
@@ -0,0 +1,252 @@
+/*
+ * Stream: host to device over a pseudo-terminal, with lost frames.
+ *
+ * A child process plays the host: it draws a sequence of scenes and sends
+ * each one with SSD1306_Stream_Encode to the master side of a pty, in raw
+ * mode, corrupting or dropping some frames on the way. The parent plays
+ * the device: it feeds what it reads from the slave side to a decoder
+ * that refreshes the emulated display, and sends
+ * SSD1306_STREAM_KEY_REQUEST back whenever a delta was dropped.
+ *
+ * The host keeps sending the last scene as deltas until the device has
+ * it, so the device only gets there if deltas are never applied to the
+ * wrong buffer and key frames are requested after a loss.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_GFX.h"
+#include "SSD1306_Stream.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SCENES      400
+#define LOSS        4       // Percentage of frames corrupted, and of frames dropped
+#define DONE        'Q'     // Sent by the device once it shows the last scene
+#define TIMEOUT_S   20
+
+static uint8_t expected[SSD1306_BUFFER_SIZE];
+static uint8_t previous[SSD1306_BUFFER_SIZE];
+static uint8_t frame[SSD1306_STREAM_MAX_FRAME];
+static uint8_t payload[SSD1306_STREAM_MAX_PAYLOAD];
+static uint32_t scene_seed;
+
+/*
+ * Scenes use their own generator, so that host and device draw the same
+ * ones whatever else calls rand().
+ */
+static int16_t Random(int16_t n)
+{
+    scene_seed = scene_seed * 1103515245u + 12345u;
+    return (int16_t)((scene_seed >> 16) % n);
+}
+
+static void Scene(int n)
+{
+    int k;
+
+    if (n % 50 == 0)
+    {
+        SSD1306_ClearDisplay();
+    }
+    for (k = Random(4); k >= 0; k--)
+    {
+        SSD1306_GFX_FillRect(Random(SSD1306_WIDTH), Random(SSD1306_HEIGHT),
+                                1 + Random(40), 1 + Random(20), SSD1306_INVERSE);
+        SSD1306_GFX_DrawLine(Random(SSD1306_WIDTH), Random(SSD1306_HEIGHT),
+                                Random(SSD1306_WIDTH), Random(SSD1306_HEIGHT), SSD1306_INVERSE);
+    }
+}
+
+static int WriteAll(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0)
+        {
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*
+ * Host: send the scenes, then the last one until the device has it.
+ */
+static int Host(int fd)
+{
+    int n = 0, key = 1, done = 0;
+
+    srand(7);
+    scene_seed = 1;
+    SSD1306_ClearDisplay();
+    memset(previous, 0, sizeof(previous));
+    while (!done)
+    {
+        struct pollfd p = { fd, POLLIN, 0 };
+        uint16_t len;
+        uint8_t c;
+
+        while ((poll(&p, 1, 0) > 0) && (read(fd, &c, 1) == 1))
+        {
+            key |= (c == SSD1306_STREAM_KEY_REQUEST);
+            done |= (c == DONE);
+        }
+        if (n < SCENES)
+        {
+            Scene(n++);
+        }
+        else
+        {
+            usleep(1000);
+        }
+        len = SSD1306_Stream_Encode(key ? NULL : previous, SSD1306_GetBuffer(),
+                                    frame, sizeof(frame));
+        key = 0;
+        memcpy(previous, SSD1306_GetBuffer(), sizeof(previous));
+        if (len == 0)
+        {
+            return 1;
+        }
+        if (rand() % 100 < LOSS)
+        {
+            frame[1 + rand() % (len - 1)] ^= 1 << (rand() % 8);
+        }
+        if ((rand() % 100 >= LOSS) && (WriteAll(fd, frame, len) != 0))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    SSD1306_StreamDecoder decoder;
+    struct termios tio;
+    int master, slave, status, n, failed = 0;
+    uint32_t requests = 0, base_errors = 0, bytes = 0;
+    time_t start;
+    pid_t host;
+
+    // The last scene, as drawn by the host
+    SSD1306_SetRotation(0);
+    SSD1306_ResetClip();
+    scene_seed = 1;
+    SSD1306_ClearDisplay();
+    for (n = 0; n < SCENES; n++)
+    {
+        Scene(n);
+    }
+    memcpy(expected, SSD1306_GetBuffer(), sizeof(expected));
+
+    if (openpty(&master, &slave, NULL, NULL, NULL) != 0)
+    {
+        perror("openpty");
+        return 1;
+    }
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    host = fork();
+    if (host == 0)
+    {
+        close(slave);
+        _exit(Host(master));
+    }
+    close(master);
+
+    Mock_I2C_Reset();
+    I2C_Peripheral_Start();
+    SSD1306_SetAddressingMode(SSD1306_ADDRESSING_AUTO);
+    if (SSD1306_Start() != SSD1306_NO_ERROR)
+    {
+        printf("start failed\n");
+        kill(host, SIGKILL);
+        return 1;
+    }
+    SSD1306_ClearDisplay();
+    SSD1306_Stream_Init(&decoder, payload, sizeof(payload), 1);
+    start = time(NULL);
+    for (;;)
+    {
+        struct pollfd p = { slave, POLLIN, 0 };
+        uint8_t chunk[64], c;
+        ssize_t len;
+
+        if (time(NULL) - start > TIMEOUT_S)
+        {
+            printf("timeout: the device never showed the last scene\n");
+            failed = 1;
+            break;
+        }
+        if (poll(&p, 1, 100) <= 0)
+        {
+            continue;
+        }
+        len = read(slave, chunk, sizeof(chunk));
+        if (len <= 0)
+        {
+            printf("link closed\n");
+            failed = 1;
+            break;
+        }
+        bytes += len;
+        SSD1306_Stream_Feed(&decoder, chunk, (uint16_t)len);
+        if (decoder.key_needed && (decoder.stats.base_errors != base_errors))
+        {
+            c = SSD1306_STREAM_KEY_REQUEST;
+            write(slave, &c, 1);
+            requests++;
+        }
+        base_errors = decoder.stats.base_errors;
+        if (memcmp(SSD1306_GetBuffer(), expected, sizeof(expected)) == 0)
+        {
+            c = DONE;
+            write(slave, &c, 1);
+            break;
+        }
+    }
+    if (failed)
+    {
+        kill(host, SIGKILL);
+    }
+    // The host may be blocked writing until it reads the last byte
+    while (waitpid(host, &status, WNOHANG) == 0)
+    {
+        struct pollfd p = { slave, POLLIN, 0 };
+        uint8_t chunk[64];
+
+        if ((poll(&p, 1, 10) > 0) && (read(slave, chunk, sizeof(chunk)) <= 0))
+        {
+            waitpid(host, &status, 0);
+            break;
+        }
+    }
+    failed |= !WIFEXITED(status) || (WEXITSTATUS(status) != 0);
+
+    printf("%u bytes, %u frames, %u CRC errors, %u deltas dropped, %u key requests\n",
+            bytes, decoder.stats.frames, decoder.stats.crc_errors,
+            decoder.stats.base_errors, requests);
+    if (SSD1306_Emu_Compare(Mock_I2C_Emu(), expected, SSD1306_WIDTH, SSD1306_PAGES) != 0)
+    {
+        printf("controller RAM differs from the last scene\n");
+        failed = 1;
+    }
+    // With this loss rate some deltas must have been dropped and recovered
+    failed |= (decoder.stats.base_errors == 0) || (requests == 0);
+    printf(failed ? "FAIL\n" : "OK\n");
+    return failed;
+}
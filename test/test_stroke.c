@@ -0,0 +1,101 @@
+/*
+ * Thick strokes drawn in SSD1306_INVERSE against SSD1306_WHITE.
+ *
+ * On a blank display the two must light the same pixels: a pixel covered
+ * by two pieces of a stroke (segments, joins, caps) must be inverted only
+ * once. Random polylines of every width, cap and join, open and closed,
+ * are drawn with every rotation, an offset origin and a clip rectangle,
+ * after the case that used to overdraw across batches.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Stroke.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STROKES 3000
+
+static uint8_t white[SSD1306_BUFFER_SIZE];
+
+static int Popcount(uint8_t b)
+{
+    int n = 0;
+
+    for (; b; b >>= 1)
+    {
+        n += b & 1;
+    }
+    return n;
+}
+
+/*
+ * Draw a stroke in white and in inverse. Returns the number of pixels
+ * that differ.
+ */
+static int Compare(const SSD1306_Point *points, uint16_t count, uint8_t closed,
+                    const SSD1306_StrokeStyle *style)
+{
+    uint8_t *pixels = SSD1306_GetBuffer();
+    int diff = 0, i;
+
+    SSD1306_ClearDisplay();
+    SSD1306_Stroke_Polyline(points, count, closed, style, SSD1306_WHITE);
+    memcpy(white, pixels, sizeof(white));
+    SSD1306_ClearDisplay();
+    SSD1306_Stroke_Polyline(points, count, closed, style, SSD1306_INVERSE);
+    for (i = 0; i < SSD1306_BUFFER_SIZE; i++)
+    {
+        diff += Popcount(white[i] ^ pixels[i]);
+    }
+    return diff;
+}
+
+int main(void)
+{
+    static const SSD1306_Point repro[] = { {52, 34}, {82, 28}, {67, 28} };
+    static const SSD1306_StrokeStyle repro_style = { 12, SSD1306_STROKE_CAP_ROUND,
+                                                    SSD1306_STROKE_JOIN_BEVEL };
+    int wrong = 0, diff, n;
+
+    SSD1306_SetRotation(0);
+    diff = Compare(repro, 3, 0, &repro_style);
+    printf("3 points, width 12: %d pixels differ\n", diff);
+    wrong += (diff != 0);
+
+    srand(5);
+    for (n = 0; n < STROKES; n++)
+    {
+        SSD1306_Point points[6];
+        SSD1306_StrokeStyle style;
+        uint16_t count = 1 + rand() % 6, i;
+        uint8_t closed = rand() % 3 == 0;
+
+        SSD1306_SetRotation(rand() % 4);
+        SSD1306_SetOrigin(rand() % 9 - 4, rand() % 9 - 4);
+        SSD1306_ResetClip();
+        if (rand() % 3 == 0)
+        {
+            SSD1306_PushClip(rand() % 40, rand() % 20, 20 + rand() % 100, 8 + rand() % 30);
+        }
+        for (i = 0; i < count; i++)
+        {
+            points[i].x = rand() % (SSD1306_GetWidth() + 20) - 10;
+            points[i].y = rand() % (SSD1306_GetHeight() + 20) - 10;
+        }
+        style.width = 1 + rand() % 20;
+        style.cap = rand() % 3;
+        style.join = rand() % 3;
+        diff = Compare(points, count, closed, &style);
+        if (diff != 0)
+        {
+            printf("stroke %d: %u points%s, width %u, cap %u, join %u, rotation %u: "
+                    "%d pixels differ\n", n, count, closed ? " closed" : "", style.width,
+                    style.cap, style.join, SSD1306_GetRotation(), diff);
+            wrong++;
+        }
+    }
+    printf("%d strokes, %d wrong\n", STROKES + 1, wrong);
+    printf(wrong ? "FAIL\n" : "OK\n");
+    return wrong != 0;
+}
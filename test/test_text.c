@@ -0,0 +1,130 @@
+/*
+ * Text: storage read failures are reported and not cached.
+ *
+ * A small font is read from RAM through a callback that can be made to
+ * fail. Drawing while the storage fails must return SSD1306_COMM_ERROR,
+ * and once it works again the same characters must be read and drawn as
+ * if the failure never happened. Missing characters must still be cached.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Text.h"
+#include <stdio.h>
+#include <string.h>
+
+#define GLYPHS 3
+#define WIDTH  5
+
+static uint8_t font_data[16 + GLYPHS * 8 + GLYPHS * WIDTH];
+static uint8_t reference[SSD1306_BUFFER_SIZE];
+static int failing;
+
+static uint8_t Read(uint32_t address, uint8_t *dst, uint16_t len, void *context)
+{
+    (void)context;
+    if (failing || (address + len > sizeof(font_data)))
+    {
+        return 1;
+    }
+    memcpy(dst, &font_data[address], len);
+    return 0;
+}
+
+static void Put(uint8_t *dst, uint32_t value, uint8_t len)
+{
+    while (len-- > 0)
+    {
+        *dst++ = value & 0xFF;
+        value >>= 8;
+    }
+}
+
+/*
+ * Font of 8-pixel glyphs for 'A', 'B' and '?', the fallback.
+ */
+static void Build(void)
+{
+    static const char codepoints[GLYPHS] = { '?', 'A', 'B' };
+    uint32_t image = 16 + GLYPHS * 8;
+    int i, col;
+
+    memcpy(font_data, "SFN1", 4);
+    Put(&font_data[4], GLYPHS, 2);
+    font_data[6] = 8;
+    font_data[7] = 1;
+    Put(&font_data[8], 16, 4);
+    Put(&font_data[12], '?', 4);
+    for (i = 0; i < GLYPHS; i++)
+    {
+        uint8_t *entry = &font_data[16 + i * 8];
+        Put(entry, codepoints[i], 3);
+        entry[3] = WIDTH;
+        Put(&entry[4], image + i * WIDTH, 4);
+        for (col = 0; col < WIDTH; col++)
+        {
+            font_data[image + i * WIDTH + col] = (uint8_t)(0x11 * (i + 1) + col * 7);
+        }
+    }
+}
+
+int main(void)
+{
+    SSD1306_Font font;
+    SSD1306_TextCacheStats stats;
+    int16_t end, width;
+    uint32_t reads;
+    int failed = 0;
+
+    Build();
+    if (SSD1306_Font_Open(&font, Read, NULL) != SSD1306_NO_ERROR)
+    {
+        printf("open failed\n");
+        return 1;
+    }
+    SSD1306_ClearDisplay();
+    failed |= SSD1306_Text_Draw(&font, 0, 0, "AB", SSD1306_WHITE, &end) != SSD1306_NO_ERROR;
+    memcpy(reference, SSD1306_GetBuffer(), sizeof(reference));
+
+    // Fresh cache, failing storage
+    SSD1306_Text_FlushCache();
+    SSD1306_ClearDisplay();
+    failing = 1;
+    if ((SSD1306_Text_Draw(&font, 0, 0, "AB", SSD1306_WHITE, &end) != SSD1306_COMM_ERROR) ||
+        (SSD1306_Text_Width(&font, "AB", &width) != SSD1306_COMM_ERROR) || (end != 0))
+    {
+        printf("read failure not reported\n");
+        failed = 1;
+    }
+
+    // The failed glyphs are read again
+    failing = 0;
+    SSD1306_ClearDisplay();
+    if ((SSD1306_Text_Draw(&font, 0, 0, "AB", SSD1306_WHITE, &end) != SSD1306_NO_ERROR) ||
+        (end != 2 * (WIDTH + 1)) ||
+        (memcmp(reference, SSD1306_GetBuffer(), sizeof(reference)) != 0))
+    {
+        printf("glyphs not drawn after the storage recovered\n");
+        failed = 1;
+    }
+    if ((SSD1306_Text_Width(&font, "AB", &width) != SSD1306_NO_ERROR) || (width != end))
+    {
+        printf("width %d, expected %d\n", width, end);
+        failed = 1;
+    }
+
+    // Missing characters are cached: no read the second time
+    SSD1306_Text_Width(&font, "Z", &width);
+    SSD1306_Text_GetCacheStats(&stats);
+    reads = stats.reads;
+    SSD1306_Text_Width(&font, "Z", &width);
+    SSD1306_Text_GetCacheStats(&stats);
+    if ((stats.reads != reads) || (width != WIDTH + 1))
+    {
+        printf("missing character read again (%u reads), width %d\n",
+                (unsigned)(stats.reads - reads), width);
+        failed = 1;
+    }
+
+    printf(failed ? "FAIL\n" : "OK\n");
+    return failed;
+}
@@ -0,0 +1,116 @@
+/*
+ * Traffic recorder and replay on the controller emulator.
+ *
+ * Frames are drawn and refreshed on a lossy bus while every transaction
+ * is recorded in a small RAM ring buffer, drained after each frame as an
+ * application would. After a last refresh without faults the log is
+ * replayed on a fresh emulator: its GDDRAM must match the display
+ * buffer and the controller that received the traffic, and every
+ * transaction must be in the log. Records of failed transactions are
+ * left out by the replay, so only the end of the session is compared.
+ * With an argument, the log is also written to that file for the replay
+ * tool (trace_replay.c).
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_GFX.h"
+#include "SSD1306_Trace.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAMES      400
+#define RING_SIZE   2048
+
+static uint8_t ring[RING_SIZE];
+static uint8_t log_bytes[4 * 1024 * 1024];
+static uint32_t log_len;
+
+/*
+ * Move the recorded bytes from the ring buffer to the log.
+ */
+static void Drain(void)
+{
+    log_len += SSD1306_Trace_Read(&log_bytes[log_len], RING_SIZE);
+}
+
+static void Scene(int n)
+{
+    srand(n);
+    SSD1306_GFX_FillCircle(rand() % SSD1306_WIDTH, rand() % SSD1306_HEIGHT, 2 + rand() % 12,
+                            SSD1306_INVERSE);
+    SSD1306_GFX_DrawLine(rand() % SSD1306_WIDTH, rand() % SSD1306_HEIGHT,
+                            rand() % SSD1306_WIDTH, rand() % SSD1306_HEIGHT, SSD1306_INVERSE);
+}
+
+int main(int argc, char **argv)
+{
+    SSD1306_TraceReplayStats stats;
+    SSD1306_Emu replayed;
+    int failed = 0, n;
+
+    Mock_I2C_Reset();
+    I2C_Peripheral_Start();
+    SSD1306_Trace_SetClock(Mock_I2C_Clock);
+    SSD1306_Trace_StartRam(ring, sizeof(ring));
+    failed |= SSD1306_Start() != SSD1306_NO_ERROR;
+    SSD1306_SetRotation(0);
+    SSD1306_ResetClip();
+    Drain();
+
+    Mock_I2C_SetFaults(2000);
+    for (n = 0; n < FRAMES; n++)
+    {
+        Scene(n);
+        SSD1306_DisplayDirty();
+        Drain();
+    }
+    Mock_I2C_SetFaults(0);
+    failed |= SSD1306_Display() != SSD1306_NO_ERROR;
+    Drain();
+    SSD1306_Trace_Stop();
+    failed |= SSD1306_Trace_GetDropped() != 0;
+
+    SSD1306_Emu_Init(&replayed);
+    if (SSD1306_Trace_Replay(log_bytes, log_len, &replayed, 400000, &stats, NULL, NULL) !=
+        SSD1306_NO_ERROR)
+    {
+        printf("log of %u bytes not replayed\n", log_len);
+        failed = 1;
+    }
+    printf("%u faults, %u bytes of log, %u records, %u failed, %u command and %u data bytes\n",
+            Mock_I2C_GetFaults(), log_len, stats.records, stats.failed, stats.command_bytes,
+            stats.data_bytes);
+    printf("%u us recorded, %u us on the wire at 400 kHz\n", stats.duration,
+            stats.wire_time_us);
+    failed |= (stats.failed == 0) || (stats.data_bytes < SSD1306_BUFFER_SIZE);
+    if (SSD1306_Emu_Compare(&replayed, SSD1306_GetBuffer(), SSD1306_WIDTH, SSD1306_PAGES) != 0)
+    {
+        printf("replayed GDDRAM differs from the display buffer\n");
+        failed = 1;
+    }
+    if (memcmp(replayed.gddram, Mock_I2C_Emu()->gddram, sizeof(replayed.gddram)) != 0)
+    {
+        printf("replayed GDDRAM differs from the controller\n");
+        failed = 1;
+    }
+
+    // A truncated log is reported
+    failed |= SSD1306_Trace_Replay(log_bytes, log_len - 1, &replayed, 400000, NULL, NULL, NULL) !=
+                SSD1306_TRACE_FORMAT_ERROR;
+
+    if (argc > 1)
+    {
+        FILE *f = fopen(argv[1], "wb");
+        if ((f == NULL) || (fwrite(log_bytes, 1, log_len, f) != log_len) || (fclose(f) != 0))
+        {
+            printf("cannot write %s\n", argv[1]);
+            failed = 1;
+        }
+    }
+
+    printf(failed ? "FAIL\n" : "OK\n");
+    return failed;
+}
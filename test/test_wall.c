@@ -0,0 +1,157 @@
+/*
+ * Wall: two panels side by side, at the two addresses of an SSD1306.
+ *
+ * The left panel is on the I2C interface, the right one on a bus whose
+ * transfers complete later and report their errors then, as an
+ * interrupt-driven one would. Shapes drawn across the seam must split
+ * exactly as they are drawn on a single display moved by the origin.
+ * Flushes on a lossy bus must leave each controller with its panel
+ * whenever they succeed, and after a final flush without faults. The
+ * driver talking to the controller of the right panel must not rely on
+ * a window the wall moved.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_GFX.h"
+#include "SSD1306_Wall.h"
+#include "I2C_Interface.h"
+#include "mock_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEFT    SSD1306_I2C_ADDR
+#define RIGHT   (SSD1306_I2C_ADDR ^ 1)
+
+static uint8_t pixels[2][SSD1306_BUFFER_SIZE];
+static SSD1306_Panel panels[2];
+static SSD1306_Wall wall;
+static uint8_t deferred;    // Result of the last write, reported by Busy
+
+static uint8_t Write(uint8_t device_address, uint8_t control, uint16_t block_size,
+                        uint16_t block_count, uint16_t stride, const uint8_t *data)
+{
+    deferred = I2C_Peripheral_WriteRegisterMultiStrided(device_address, control, block_size,
+                                                        block_count, stride, data);
+    return I2C_NO_ERROR;
+}
+
+static uint8_t Busy(void)
+{
+    return deferred;
+}
+
+static const SSD1306_WallBus deferred_bus = { Write, Busy };
+
+/*
+ * Draw the scene of a step in global coordinates.
+ */
+static void Scene(int n)
+{
+    srand(n);
+    SSD1306_GFX_FillCircle(100 + rand() % 56, rand() % 32, 4 + rand() % 20, SSD1306_INVERSE);
+    SSD1306_GFX_DrawLine(rand() % 256, rand() % 32, rand() % 256, rand() % 32, SSD1306_INVERSE);
+    SSD1306_GFX_FillRect(rand() % 256 - 20, rand() % 40 - 8, 1 + rand() % 60, 1 + rand() % 20,
+                            SSD1306_INVERSE);
+}
+
+/*
+ * Draw a scene on the wall, on the panels it overlaps.
+ */
+static void WallScene(int n)
+{
+    SSD1306_Wall_Select(&wall, -32, -32, 320, 96);
+    while (SSD1306_Wall_Next(&wall))
+    {
+        Scene(n);
+    }
+}
+
+static int Mismatch(void)
+{
+    return SSD1306_Emu_Compare(Mock_I2C_EmuAt(LEFT), pixels[0], SSD1306_WIDTH, SSD1306_PAGES) +
+            SSD1306_Emu_Compare(Mock_I2C_EmuAt(RIGHT), pixels[1], SSD1306_WIDTH, SSD1306_PAGES);
+}
+
+int main(void)
+{
+    int failed = 0, reported = 0, n, i;
+
+    Mock_I2C_Reset();
+    I2C_Peripheral_Start();
+    SSD1306_SetAddressingMode(SSD1306_ADDRESSING_AUTO);
+    SSD1306_SetAddress(RIGHT);
+    failed |= SSD1306_Start() != SSD1306_NO_ERROR;
+    SSD1306_SetAddress(LEFT);
+    failed |= SSD1306_Start() != SSD1306_NO_ERROR;
+    SSD1306_SetRotation(0);
+    SSD1306_ResetClip();
+    SSD1306_Panel_Init(&panels[0], pixels[0], NULL, LEFT, 0, 0, SSD1306_HEIGHT);
+    SSD1306_Panel_Init(&panels[1], pixels[1], &deferred_bus, RIGHT, SSD1306_WIDTH, 0,
+                        SSD1306_HEIGHT);
+    SSD1306_Wall_Init(&wall, panels, 2);
+
+    // Shapes across the seam, against the display buffer moved by the origin
+    for (n = 0; n < 200; n++)
+    {
+        SSD1306_Wall_Clear(&wall);
+        WallScene(n);
+        for (i = 0; i < 2; i++)
+        {
+            SSD1306_ClearDisplay();
+            SSD1306_SetOrigin(-panels[i].x, 0);
+            Scene(n);
+            SSD1306_SetOrigin(0, 0);
+            if (memcmp(SSD1306_GetBuffer(), pixels[i], SSD1306_BUFFER_SIZE) != 0)
+            {
+                printf("scene %d: panel %d differs from the display buffer\n", n, i);
+                failed = 1;
+            }
+        }
+    }
+    failed |= (SSD1306_Wall_Flush(&wall) != SSD1306_NO_ERROR) || Mismatch();
+
+    // Flushes on a lossy bus
+    Mock_I2C_SetFaults(1000);
+    for (n = 0; n < 3000; n++)
+    {
+        WallScene(n);
+        if ((SSD1306_Wall_Flush(&wall) == SSD1306_NO_ERROR) && Mismatch())
+        {
+            reported++;
+        }
+    }
+    Mock_I2C_SetFaults(0);
+    failed |= SSD1306_Wall_Flush(&wall) != SSD1306_NO_ERROR;
+    printf("%u faults, wrong after success %d, wrong at the end %d\n",
+            Mock_I2C_GetFaults(), reported, Mismatch());
+    failed |= (reported != 0) || Mismatch();
+    failed |= SSD1306_GetAddress() != LEFT;
+
+    // The driver refreshes the right controller after the wall moved its
+    // window; in horizontal mode it would send no setup for a known window
+    SSD1306_SetAddress(RIGHT);
+    SSD1306_SetAddressingMode(SSD1306_ADDRESSING_HORIZONTAL);
+    SSD1306_ClearDisplay();
+    SSD1306_GFX_FillCircle(64, 16, 12, SSD1306_WHITE);
+    SSD1306_GFX_FillRect(0, 0, 16, 16, SSD1306_WHITE);
+    failed |= SSD1306_Display() != SSD1306_NO_ERROR;
+    SSD1306_Wall_Select(&wall, SSD1306_WIDTH + 3, 3, 4, 4);
+    while (SSD1306_Wall_Next(&wall))
+    {
+        SSD1306_GFX_FillRect(SSD1306_WIDTH + 3, 3, 4, 4, SSD1306_INVERSE);
+    }
+    failed |= SSD1306_Wall_Flush(&wall) != SSD1306_NO_ERROR;
+    failed |= SSD1306_Display() != SSD1306_NO_ERROR;
+    if (SSD1306_Emu_Compare(Mock_I2C_EmuAt(RIGHT), SSD1306_GetBuffer(),
+                            SSD1306_WIDTH, SSD1306_PAGES) != 0)
+    {
+        printf("display buffer not shown after a wall flush\n");
+        failed = 1;
+    }
+    SSD1306_SetAddressingMode(SSD1306_ADDRESSING_AUTO);
+    SSD1306_SetAddress(LEFT);
+
+    printf(failed ? "FAIL\n" : "OK\n");
+    return failed;
+}
@@ -0,0 +1,89 @@
+/*
+ * Replay of a traffic log recorded by SSD1306_Trace on the host.
+ *
+ *     trace_replay LOG [BUS_HZ [IMAGE.pbm]]
+ *
+ * The log, as drained from the ring buffer or received from the sink, is
+ * fed to the controller emulator. Wire statistics are printed for the
+ * given bus frequency (400 kHz by default), and the GDDRAM left by the
+ * log can be written as a PBM image. Records of failed transactions are
+ * counted but not replayed, although part of them may have reached the
+ * controller: until a later refresh rewrites them, the replayed pixels
+ * may differ from the ones that were on the display.
+ */
+
+#include "SSD1306.h"
+#include "SSD1306_Emu.h"
+#include "SSD1306_Export.h"
+#include "SSD1306_Trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static void FileSink(const uint8_t *data, uint16_t len, void *context)
+{
+    fwrite(data, 1, len, context);
+}
+
+int main(int argc, char **argv)
+{
+    SSD1306_TraceReplayStats stats;
+    SSD1306_Emu emu;
+    uint32_t bus_hz = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 400000;
+    uint8_t *log_bytes;
+    long len;
+    FILE *f;
+
+    if ((argc < 2) || (bus_hz == 0))
+    {
+        fprintf(stderr, "usage: %s LOG [BUS_HZ [IMAGE.pbm]]\n", argv[0]);
+        return 2;
+    }
+    f = fopen(argv[1], "rb");
+    if ((f == NULL) || (fseek(f, 0, SEEK_END) != 0) || ((len = ftell(f)) < 0) ||
+        (fseek(f, 0, SEEK_SET) != 0))
+    {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    log_bytes = malloc(len ? len : 1);
+    if ((log_bytes == NULL) || (fread(log_bytes, 1, len, f) != (size_t)len))
+    {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    fclose(f);
+
+    SSD1306_Emu_Init(&emu);
+    if (SSD1306_Trace_Replay(log_bytes, len, &emu, bus_hz, &stats, NULL, NULL) !=
+        SSD1306_NO_ERROR)
+    {
+        fprintf(stderr, "%s: malformed or truncated log\n", argv[1]);
+        return 1;
+    }
+    printf("records          %10u\n", stats.records);
+    printf("failed           %10u  (not replayed)\n", stats.failed);
+    printf("command bytes    %10u\n", stats.command_bytes);
+    printf("data bytes       %10u\n", stats.data_bytes);
+    printf("recorded ticks   %10u\n", stats.duration);
+    printf("wire bits        %10llu\n", (unsigned long long)stats.wire_bits);
+    printf("wire time (us)   %10u  at %u Hz\n", stats.wire_time_us, bus_hz);
+    if (stats.records > 0)
+    {
+        printf("bits per record  %10.1f\n", (double)stats.wire_bits / stats.records);
+    }
+
+    if (argc > 3)
+    {
+        f = fopen(argv[3], "wb");
+        if (f == NULL)
+        {
+            fprintf(stderr, "cannot write %s\n", argv[3]);
+            return 1;
+        }
+        SSD1306_Export_Pbm(emu.gddram, SSD1306_EMU_COLUMNS, SSD1306_WIDTH, SSD1306_HEIGHT,
+                            FileSink, f);
+        fclose(f);
+    }
+    free(log_bytes);
+    return 0;
+}